@@ -0,0 +1,98 @@
+//! Measure how calls into WebAssembly scale when many threads call
+//! at the same time, which stresses the shared state touched by every
+//! call (e.g. the pool of Wasm stacks).
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::Instant;
+
+use wasmer::*;
+
+static EMPTY_WAT: &str = r#"(module
+    (func (export "empty")))"#;
+
+const THREADS: &[usize] = &[1, 4, 16, 64];
+
+pub fn run_call_contention(store: &Store, compiler_name: &str, c: &mut Criterion) {
+    let module = Module::new(&store, EMPTY_WAT).unwrap();
+    let instance = Instance::new(&module, &imports! {}).unwrap();
+    let f: NativeFunc<(), ()> = instance.exports.get_native_function("empty").unwrap();
+
+    let mut group = c.benchmark_group(format!("call contention {}", compiler_name));
+
+    for &threads in THREADS {
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &threads,
+            |b, &threads| {
+                // Measures the time taken by `iters` calls spread across
+                // `threads` threads.
+                b.iter_custom(|iters| {
+                    let calls_per_thread = (iters as usize + threads - 1) / threads;
+                    let barrier = Arc::new(Barrier::new(threads + 1));
+
+                    let handles = (0..threads)
+                        .map(|_| {
+                            let f = f.clone();
+                            let barrier = barrier.clone();
+
+                            thread::spawn(move || {
+                                // Warm up the stack cache of the thread.
+                                f.call().unwrap();
+                                barrier.wait();
+
+                                for _ in 0..calls_per_thread {
+                                    black_box(f.call().unwrap());
+                                }
+                            })
+                        })
+                        .collect::<Vec<_>>();
+
+                    barrier.wait();
+                    let start = Instant::now();
+
+                    for handle in handles {
+                        handle.join().unwrap();
+                    }
+
+                    start.elapsed()
+                })
+            },
+        );
+    }
+
+    group.finish();
+
+    let stats = vm::stack_pool_stats();
+    println!(
+        "stack pool: {} allocations, {} thread reuses, {} global reuses, {} evictions",
+        stats.allocations, stats.thread_reuses, stats.global_reuses, stats.evictions
+    );
+}
+
+fn run_contention_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "llvm")]
+    {
+        let store = Store::new(&Universal::new(wasmer_compiler_llvm::LLVM::new()).engine());
+        run_call_contention(&store, "llvm", _c);
+    }
+
+    #[cfg(feature = "cranelift")]
+    {
+        let store =
+            Store::new(&Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine());
+        run_call_contention(&store, "cranelift", _c);
+    }
+
+    #[cfg(feature = "singlepass")]
+    {
+        let store =
+            Store::new(&Universal::new(wasmer_compiler_singlepass::Singlepass::new()).engine());
+        run_call_contention(&store, "singlepass", _c);
+    }
+}
+
+criterion_group!(benches, run_contention_benchmarks);
+
+criterion_main!(benches);
@@ -0,0 +1,120 @@
+//! Measure how instantiating modules scales when many threads
+//! instantiate into the same engine at the same time, and hand the
+//! functions of each instance to a table, which stresses the shared
+//! `FuncDataRegistry`: every function stored from the host registers a
+//! funcref, and every freed instance releases its funcrefs.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::Instant;
+
+use wasmer::*;
+
+const THREADS: &[usize] = &[1, 4, 16];
+
+const FUNCTIONS: usize = 16;
+
+// A module with a table and many small exported functions.
+#[cfg(feature = "cranelift")]
+fn many_functions_wat(functions: usize) -> String {
+    let mut wat = format!(
+        "(module\n    (table (export \"table\") {} funcref)\n",
+        functions
+    );
+    for i in 0..functions {
+        wat.push_str(&format!(
+            "    (func (export \"f{}\") (result i32) (i32.const {}))\n",
+            i, i
+        ));
+    }
+    wat.push(')');
+    wat
+}
+
+#[cfg(feature = "cranelift")]
+fn instantiate_and_register(module: &Module) {
+    let instance = Instance::new(module, &imports! {}).unwrap();
+    let table = instance.exports.get_table("table").unwrap();
+
+    for i in 0..FUNCTIONS {
+        let function = instance.exports.get_function(&format!("f{}", i)).unwrap();
+        table
+            .set(i as u32, Val::FuncRef(Some(function.clone())))
+            .unwrap();
+    }
+}
+
+#[cfg(feature = "cranelift")]
+fn run_func_data_registry_benchmark(c: &mut Criterion) {
+    let engine = Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine();
+    let store = Store::new(&engine);
+    let module = Module::new(&store, many_functions_wat(FUNCTIONS)).unwrap();
+
+    let mut group = c.benchmark_group("parallel instantiation funcrefs cranelift");
+
+    for &threads in THREADS {
+        let before = engine.func_data_stats();
+
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &threads,
+            |b, &threads| {
+                // Measures the time taken by `iters` instantiations spread
+                // across `threads` threads.
+                b.iter_custom(|iters| {
+                    let instances_per_thread = (iters as usize + threads - 1) / threads;
+                    let barrier = Arc::new(Barrier::new(threads + 1));
+
+                    let handles = (0..threads)
+                        .map(|_| {
+                            let module = module.clone();
+                            let barrier = barrier.clone();
+
+                            thread::spawn(move || {
+                                barrier.wait();
+
+                                for _ in 0..instances_per_thread {
+                                    instantiate_and_register(&module);
+                                }
+                            })
+                        })
+                        .collect::<Vec<_>>();
+
+                    barrier.wait();
+                    let start = Instant::now();
+
+                    for handle in handles {
+                        handle.join().unwrap();
+                    }
+
+                    start.elapsed()
+                })
+            },
+        );
+
+        let after = engine.func_data_stats();
+        eprintln!(
+            "{} threads: {} funcrefs registered, {} contended locks",
+            threads,
+            after.registrations - before.registrations,
+            after.contended - before.contended,
+        );
+
+        // Every instance released its funcrefs when it was freed.
+        assert_eq!(after.live, 0);
+    }
+
+    group.finish();
+}
+
+fn run_func_data_registry_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "cranelift")]
+    {
+        run_func_data_registry_benchmark(_c);
+    }
+}
+
+criterion_group!(benches, run_func_data_registry_benchmarks);
+
+criterion_main!(benches);
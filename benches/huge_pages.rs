@@ -0,0 +1,80 @@
+//! Compare the cost of random accesses over a large linear memory
+//! backed by native pages, transparent huge pages, and `MAP_HUGETLB`
+//! huge pages. The backing actually obtained depends on the system,
+//! and is printed for each run.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+
+use wasmer::*;
+
+// 512 MiB: far more than the dTLB covers with 4 KiB pages.
+#[cfg(feature = "cranelift")]
+const HEAP_PAGES: u32 = 8192;
+
+// Random loads and stores over the whole heap, driven by a linear
+// congruential generator, so that nearly every access misses the dTLB.
+#[cfg(feature = "cranelift")]
+static WORK_WAT: &str = r#"(module
+    (memory (export "memory") 8192 8192)
+    (func (export "scatter") (param $n i32) (result i32)
+        (local $x i32)
+        (local $addr i32)
+        (local $acc i32)
+        (local.set $x (i32.const 12345))
+        (loop $continue
+            (local.set $x (i32.add (i32.mul (local.get $x) (i32.const 1103515245)) (i32.const 12345)))
+            (local.set $addr (i32.and (local.get $x) (i32.const 0x1FFFFFFC)))
+            (local.set $acc (i32.add (local.get $acc) (i32.load (local.get $addr))))
+            (i32.store (local.get $addr) (local.get $acc))
+            (local.set $n (i32.sub (local.get $n) (i32.const 1)))
+            (br_if $continue (local.get $n)))
+        (local.get $acc)))"#;
+
+#[cfg(feature = "cranelift")]
+fn run_huge_pages_benchmark(c: &mut Criterion, name: &str, backing: PageBacking) {
+    let engine = Universal::new(wasmer_compiler_cranelift::Cranelift::new())
+        .code_page_backing(backing)
+        .engine();
+    let mut tunables = BaseTunables::for_target(engine.target());
+    tunables.memory_page_backing = backing;
+    let store = Store::new_with_tunables(&engine, tunables);
+
+    let module = Module::new(&store, WORK_WAT).unwrap();
+    let instance = Instance::new(&module, &imports! {}).unwrap();
+    let memory = instance.exports.get_memory("memory").unwrap();
+    assert_eq!(memory.size(), Pages(HEAP_PAGES));
+    let scatter: NativeFunc<i32, i32> = instance.exports.get_native_function("scatter").unwrap();
+
+    // Fault the whole heap in before measuring.
+    unsafe {
+        std::ptr::write_bytes(memory.data_ptr(), 1, memory.data_size() as usize);
+    }
+
+    println!(
+        "{}: memory backed by {:?} pages, code by {:?} pages",
+        name,
+        memory.page_backing(),
+        engine.code_page_backing(),
+    );
+
+    let mut group = c.benchmark_group("huge pages cranelift");
+
+    group.bench_function(BenchmarkId::new("random accesses", name), |b| {
+        b.iter(|| black_box(scatter.call(black_box(1_000_000)).unwrap()))
+    });
+
+    group.finish();
+}
+
+fn run_huge_pages_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "cranelift")]
+    {
+        run_huge_pages_benchmark(_c, "base", PageBacking::Base);
+        run_huge_pages_benchmark(_c, "transparent", PageBacking::TransparentHuge);
+        run_huge_pages_benchmark(_c, "hugetlb", PageBacking::HugeTlb);
+    }
+}
+
+criterion_group!(benches, run_huge_pages_benchmarks);
+
+criterion_main!(benches);
@@ -0,0 +1,67 @@
+//! Measure the throughput of instantiating a small module, with the
+//! default tunables and with the pooling tunables.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+
+use wasmer::*;
+
+static MODULE_WAT: &str = r#"(module
+    (memory (export "memory") 1)
+    (table 10 funcref)
+    (global $counter (mut i32) (i32.const 0))
+    (func (export "increment") (result i32)
+       (global.set $counter (i32.add (global.get $counter) (i32.const 1)))
+       (global.get $counter)))"#;
+
+pub fn run_instantiate(
+    engine: &(dyn Engine + Send + Sync),
+    compiler_name: &str,
+    c: &mut Criterion,
+) {
+    let store = Store::new(engine);
+    let module = Module::new(&store, MODULE_WAT).unwrap();
+
+    c.bench_function(&format!("instantiate {}", compiler_name), |b| {
+        b.iter(|| {
+            black_box(Instance::new(&module, &imports! {}).unwrap());
+        })
+    });
+
+    let tunables = PoolingTunables::for_target(engine.target(), 16).unwrap();
+    let store = Store::new_with_tunables(engine, tunables.clone());
+    let module = Module::new(&store, MODULE_WAT).unwrap();
+
+    c.bench_function(&format!("instantiate pooled {}", compiler_name), |b| {
+        b.iter(|| {
+            black_box(Instance::new(&module, &imports! {}).unwrap());
+        })
+    });
+
+    let stats = tunables.stats();
+    assert_eq!(stats.instance_fallbacks, 0);
+    assert_eq!(stats.memory_fallbacks, 0);
+}
+
+fn run_instantiate_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "llvm")]
+    {
+        let engine = Universal::new(wasmer_compiler_llvm::LLVM::new()).engine();
+        run_instantiate(&engine, "llvm", _c);
+    }
+
+    #[cfg(feature = "cranelift")]
+    {
+        let engine = Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine();
+        run_instantiate(&engine, "cranelift", _c);
+    }
+
+    #[cfg(feature = "singlepass")]
+    {
+        let engine = Universal::new(wasmer_compiler_singlepass::Singlepass::new()).engine();
+        run_instantiate(&engine, "singlepass", _c);
+    }
+}
+
+criterion_group!(benches, run_instantiate_benchmarks);
+
+criterion_main!(benches);
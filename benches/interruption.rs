@@ -0,0 +1,96 @@
+//! Compare the throughput cost of the ways to bound the execution of
+//! WebAssembly code: none, the `Metering` middleware, and the
+//! `EpochInterruption` middleware.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+use std::sync::Arc;
+
+use wasmer::wasmparser::Operator;
+use wasmer::*;
+use wasmer_middlewares::epoch::Epoch;
+use wasmer_middlewares::{EpochInterruption, Metering};
+
+// A tight loop, and a call-heavy recursion: the checks are inserted at
+// loop headers and function entries, the metering at every basic block.
+static WORK_WAT: &str = r#"(module
+    (func (export "sum") (param $n i32) (result i32)
+        (local $i i32)
+        (local $acc i32)
+        (loop $continue
+            (local.set $acc (i32.add (local.get $acc) (i32.mul (local.get $i) (local.get $i))))
+            (local.set $i (i32.add (local.get $i) (i32.const 1)))
+            (br_if $continue (i32.lt_u (local.get $i) (local.get $n))))
+        (local.get $acc))
+    (func $fib (export "fib") (param $n i32) (result i32)
+        (if (result i32) (i32.lt_u (local.get $n) (i32.const 2))
+            (then (local.get $n))
+            (else (i32.add (call $fib (i32.sub (local.get $n) (i32.const 1)))
+                           (call $fib (i32.sub (local.get $n) (i32.const 2))))))))"#;
+
+fn run_interruption_benchmark(
+    mut compiler_config: impl CompilerConfig + 'static,
+    compiler_name: &str,
+    middleware: &str,
+    c: &mut Criterion,
+) {
+    match middleware {
+        "metering" => compiler_config
+            .push_middleware(Arc::new(Metering::new(u64::MAX, |_: &Operator| -> u64 {
+                1
+            }))),
+        "epoch" => compiler_config.push_middleware(Arc::new(EpochInterruption::new())),
+        _ => {}
+    }
+
+    let store = Store::new(&Universal::new(compiler_config).engine());
+    let module = Module::new(&store, WORK_WAT).unwrap();
+    let instance = Instance::new(&module, &imports! {}).unwrap();
+
+    // Keep a far deadline pending, as a server would.
+    let epoch = Epoch::new();
+    if middleware == "epoch" {
+        epoch.set_deadline(&instance, u64::MAX);
+    }
+
+    let sum: NativeFunc<i32, i32> = instance.exports.get_native_function("sum").unwrap();
+    let fib: NativeFunc<i32, i32> = instance.exports.get_native_function("fib").unwrap();
+
+    let mut group = c.benchmark_group(format!("interruption {}", compiler_name));
+
+    group.bench_function(BenchmarkId::new("loop", middleware), |b| {
+        b.iter(|| black_box(sum.call(black_box(100_000)).unwrap()))
+    });
+
+    group.bench_function(BenchmarkId::new("calls", middleware), |b| {
+        b.iter(|| black_box(fib.call(black_box(20)).unwrap()))
+    });
+
+    group.finish();
+}
+
+fn run_interruption_benchmarks(_c: &mut Criterion) {
+    for middleware in &["none", "metering", "epoch"] {
+        #[cfg(feature = "llvm")]
+        run_interruption_benchmark(wasmer_compiler_llvm::LLVM::new(), "llvm", middleware, _c);
+
+        #[cfg(feature = "cranelift")]
+        run_interruption_benchmark(
+            wasmer_compiler_cranelift::Cranelift::new(),
+            "cranelift",
+            middleware,
+            _c,
+        );
+
+        #[cfg(feature = "singlepass")]
+        run_interruption_benchmark(
+            wasmer_compiler_singlepass::Singlepass::new(),
+            "singlepass",
+            middleware,
+            _c,
+        );
+    }
+}
+
+criterion_group!(benches, run_interruption_benchmarks);
+
+criterion_main!(benches);
@@ -0,0 +1,66 @@
+//! Compare the cost of the bounds checks of linear memory accesses:
+//! a 32-bit memory, whose checks are elided by the guard region, a
+//! 64-bit memory with a maximum, that is static, and an unbounded
+//! 64-bit memory, that is dynamic and checked explicitly.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+
+use wasmer::*;
+
+// A loop that loads, updates and stores every 32-bit word of the first
+// page, so the time goes to the memory accesses.
+#[cfg(feature = "cranelift")]
+fn work_wat(index_type: &str, limits: &str) -> String {
+    format!(
+        r#"(module
+    (memory {index_type} {limits})
+    (func (export "update") (param $rounds i32)
+        (local $i {index_type})
+        (loop $round
+            (local.set $i ({index_type}.const 0))
+            (loop $word
+                (i32.store (local.get $i) (i32.add (i32.load (local.get $i)) (i32.const 1)))
+                (local.set $i ({index_type}.add (local.get $i) ({index_type}.const 4)))
+                (br_if $word ({index_type}.lt_u (local.get $i) ({index_type}.const 65536))))
+            (local.set $rounds (i32.sub (local.get $rounds) (i32.const 1)))
+            (br_if $round (local.get $rounds)))))"#,
+        index_type = index_type,
+        limits = limits,
+    )
+}
+
+#[cfg(feature = "cranelift")]
+fn run_memory64_benchmark(c: &mut Criterion, memory: &str, index_type: &str, limits: &str) {
+    let mut features = Features::new();
+    features.memory64(true);
+
+    let store = Store::new(
+        &Universal::new(wasmer_compiler_cranelift::Cranelift::new())
+            .features(features)
+            .engine(),
+    );
+    let module = Module::new(&store, work_wat(index_type, limits)).unwrap();
+    let instance = Instance::new(&module, &imports! {}).unwrap();
+    let update: NativeFunc<i32, ()> = instance.exports.get_native_function("update").unwrap();
+
+    let mut group = c.benchmark_group("memory accesses cranelift");
+
+    group.bench_function(BenchmarkId::new("update", memory), |b| {
+        b.iter(|| update.call(black_box(10)).unwrap())
+    });
+
+    group.finish();
+}
+
+fn run_memory64_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "cranelift")]
+    {
+        run_memory64_benchmark(_c, "memory32", "i32", "1");
+        run_memory64_benchmark(_c, "memory64 static", "i64", "1 1");
+        run_memory64_benchmark(_c, "memory64 dynamic", "i64", "1");
+    }
+}
+
+criterion_group!(benches, run_memory64_benchmarks);
+
+criterion_main!(benches);
@@ -0,0 +1,103 @@
+//! Measure how `Module::deserialize` scales when many threads load
+//! modules into the same engine at the same time. The modules carry a
+//! lot of code and few signatures, so that the time goes into
+//! allocating, linking and publishing the code of each artifact.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::Instant;
+
+use wasmer::*;
+
+const THREADS: &[usize] = &[1, 4, 16];
+
+// A module with many functions calling each other, which all share the
+// same signature.
+#[cfg(feature = "cranelift")]
+fn many_functions_wat(functions: usize) -> String {
+    let mut wat = String::from("(module\n");
+    wat.push_str("    (func $f0 (param i32) (result i32) (local.get 0))\n");
+    for i in 1..functions {
+        wat.push_str(&format!(
+            "    (func $f{} (param i32) (result i32)
+        (i32.add (call $f{} (local.get 0)) (i32.const {})))\n",
+            i,
+            i - 1,
+            i
+        ));
+    }
+    wat.push_str(&format!(
+        "    (export \"main\" (func $f{})))",
+        functions - 1
+    ));
+    wat
+}
+
+#[cfg(feature = "cranelift")]
+fn run_module_deserialize_benchmark(c: &mut Criterion) {
+    let store = Store::new(&Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine());
+    let serialized = Arc::new(
+        Module::new(&store, many_functions_wat(1024))
+            .unwrap()
+            .serialize()
+            .unwrap(),
+    );
+
+    let mut group = c.benchmark_group("parallel module deserialize cranelift");
+    group.throughput(Throughput::Elements(1));
+
+    for &threads in THREADS {
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &threads,
+            |b, &threads| {
+                // Measures the time taken by `iters` deserializations
+                // spread across `threads` threads. Perfect scaling keeps
+                // the time per deserialization falling with the threads.
+                b.iter_custom(|iters| {
+                    let loads_per_thread = (iters as usize + threads - 1) / threads;
+                    let barrier = Arc::new(Barrier::new(threads + 1));
+
+                    let handles = (0..threads)
+                        .map(|_| {
+                            let store = store.clone();
+                            let serialized = serialized.clone();
+                            let barrier = barrier.clone();
+
+                            thread::spawn(move || {
+                                barrier.wait();
+
+                                for _ in 0..loads_per_thread {
+                                    unsafe { Module::deserialize(&store, &serialized).unwrap() };
+                                }
+                            })
+                        })
+                        .collect::<Vec<_>>();
+
+                    barrier.wait();
+                    let start = Instant::now();
+
+                    for handle in handles {
+                        handle.join().unwrap();
+                    }
+
+                    start.elapsed()
+                })
+            },
+        );
+    }
+
+    group.finish();
+}
+
+fn run_module_deserialize_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "cranelift")]
+    {
+        run_module_deserialize_benchmark(_c);
+    }
+}
+
+criterion_group!(benches, run_module_deserialize_benchmarks);
+
+criterion_main!(benches);
@@ -0,0 +1,103 @@
+//! Measure how loading modules scales when many threads load modules
+//! into the same engine at the same time, which stresses the shared
+//! signature registry: every loaded module registers its signatures,
+//! and releases them when dropped.
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use std::sync::{Arc, Barrier};
+use std::thread;
+use std::time::Instant;
+
+use wasmer::*;
+
+const THREADS: &[usize] = &[1, 4, 16];
+
+// A module with many signatures, and little code.
+#[cfg(feature = "cranelift")]
+fn many_signatures_wat(signatures: usize) -> String {
+    let mut wat = String::from("(module\n");
+    for i in 0..signatures {
+        let params = (0..i % 16)
+            .map(|p| {
+                if (i >> 4) & (1 << p) != 0 {
+                    "i64"
+                } else {
+                    "i32"
+                }
+            })
+            .collect::<Vec<_>>()
+            .join(" ");
+        wat.push_str(&format!(
+            "    (type (func (param {}) (result i32)))\n",
+            params
+        ));
+    }
+    wat.push_str("    (func (export \"main\") (result i32) (i32.const 0)))");
+    wat
+}
+
+#[cfg(feature = "cranelift")]
+fn run_signature_registry_benchmark(c: &mut Criterion) {
+    let store = Store::new(&Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine());
+    let serialized = Arc::new(
+        Module::new(&store, many_signatures_wat(256))
+            .unwrap()
+            .serialize()
+            .unwrap(),
+    );
+
+    let mut group = c.benchmark_group("module loading contention cranelift");
+
+    for &threads in THREADS {
+        group.bench_with_input(
+            BenchmarkId::from_parameter(threads),
+            &threads,
+            |b, &threads| {
+                // Measures the time taken by `iters` module loads spread
+                // across `threads` threads.
+                b.iter_custom(|iters| {
+                    let loads_per_thread = (iters as usize + threads - 1) / threads;
+                    let barrier = Arc::new(Barrier::new(threads + 1));
+
+                    let handles = (0..threads)
+                        .map(|_| {
+                            let store = store.clone();
+                            let serialized = serialized.clone();
+                            let barrier = barrier.clone();
+
+                            thread::spawn(move || {
+                                barrier.wait();
+
+                                for _ in 0..loads_per_thread {
+                                    unsafe { Module::deserialize(&store, &serialized).unwrap() };
+                                }
+                            })
+                        })
+                        .collect::<Vec<_>>();
+
+                    barrier.wait();
+                    let start = Instant::now();
+
+                    for handle in handles {
+                        handle.join().unwrap();
+                    }
+
+                    start.elapsed()
+                })
+            },
+        );
+    }
+
+    group.finish();
+}
+
+fn run_signature_registry_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "cranelift")]
+    {
+        run_signature_registry_benchmark(_c);
+    }
+}
+
+criterion_group!(benches, run_signature_registry_benchmarks);
+
+criterion_main!(benches);
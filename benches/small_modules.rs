@@ -0,0 +1,58 @@
+//! Measure loading many tiny modules at once, whose code takes a small
+//! part of a page each, and report how much memory their code takes.
+
+use criterion::{criterion_group, criterion_main, Criterion};
+
+use wasmer::*;
+
+const MODULES: usize = 1000;
+
+#[cfg(feature = "cranelift")]
+fn run_small_modules_benchmark(c: &mut Criterion) {
+    let engine = Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine();
+    let store = Store::new(&engine);
+    let serialized = Module::new(
+        &store,
+        r#"(module (func (export "add") (param i32 i32) (result i32)
+            (i32.add (local.get 0) (local.get 1))))"#,
+    )
+    .unwrap()
+    .serialize()
+    .unwrap();
+
+    let modules = (0..MODULES)
+        .map(|_| unsafe { Module::deserialize(&store, &serialized).unwrap() })
+        .collect::<Vec<_>>();
+    let stats = engine.code_stats();
+    println!(
+        "{} modules: {} bytes of code resident, {} of padding, {} slabs",
+        modules.len(),
+        stats.resident_bytes(),
+        stats.padding_bytes(),
+        stats.slabs,
+    );
+    drop(modules);
+
+    let mut group = c.benchmark_group("small modules cranelift");
+
+    group.bench_function("load and drop 1000 modules", |b| {
+        b.iter(|| {
+            (0..MODULES)
+                .map(|_| unsafe { Module::deserialize(&store, &serialized).unwrap() })
+                .collect::<Vec<_>>()
+        })
+    });
+
+    group.finish();
+}
+
+fn run_small_modules_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "cranelift")]
+    {
+        run_small_modules_benchmark(_c);
+    }
+}
+
+criterion_group!(benches, run_small_modules_benchmarks);
+
+criterion_main!(benches);
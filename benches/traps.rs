@@ -0,0 +1,109 @@
+//! Measure the cost of trap-heavy workloads: guests that exit through a
+//! trap, and host functions that return an error, a few frames deep.
+//! The backtraces are captured and never looked at, looked at, or not
+//! captured at all.
+
+use criterion::{black_box, criterion_group, criterion_main, BenchmarkId, Criterion};
+
+use wasmer::*;
+
+static TRAPS_WAT: &str = r#"(module
+    (import "env" "exit" (func $exit (param i32)))
+    (func $unreachable unreachable)
+    (func $trap (export "trap") (param $depth i32)
+        (if (local.get $depth)
+            (then (call $trap (i32.sub (local.get $depth) (i32.const 1))))
+            (else (call $unreachable))))
+    (func $exit_deep (export "exit") (param $depth i32)
+        (if (local.get $depth)
+            (then (call $exit_deep (i32.sub (local.get $depth) (i32.const 1))))
+            (else (call $exit (i32.const 0))))))"#;
+
+const DEPTH: i32 = 8;
+
+#[derive(Debug)]
+struct Exit(i32);
+
+impl std::fmt::Display for Exit {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "exit({})", self.0)
+    }
+}
+
+impl std::error::Error for Exit {}
+
+fn exit(code: i32) -> Result<(), RuntimeError> {
+    Err(RuntimeError::user(Box::new(Exit(code))))
+}
+
+fn run_traps_benchmark(
+    engine: &(dyn Engine + Send + Sync),
+    compiler_name: &str,
+    c: &mut Criterion,
+) {
+    let store = Store::new(engine);
+    let module = Module::new(&store, TRAPS_WAT).unwrap();
+    let import_object = imports! {
+        "env" => {
+            "exit" => Function::new_native(&store, exit),
+        },
+    };
+    let instance = Instance::new(&module, &import_object).unwrap();
+
+    let trap: NativeFunc<i32, ()> = instance.exports.get_native_function("trap").unwrap();
+    let exit: NativeFunc<i32, ()> = instance.exports.get_native_function("exit").unwrap();
+
+    let mut group = c.benchmark_group(format!("traps {}", compiler_name));
+
+    for (mode, capture, trace) in [
+        ("captured", true, false),
+        ("traced", true, true),
+        ("not captured", false, false),
+    ] {
+        store.set_capture_backtraces(capture);
+
+        group.bench_function(BenchmarkId::new("unreachable", mode), |b| {
+            b.iter(|| {
+                let error = trap.call(black_box(DEPTH)).unwrap_err();
+                if trace {
+                    black_box(error.trace());
+                }
+            })
+        });
+
+        group.bench_function(BenchmarkId::new("host exit", mode), |b| {
+            b.iter(|| {
+                let error = exit.call(black_box(DEPTH)).unwrap_err();
+                if trace {
+                    black_box(error.trace());
+                }
+            })
+        });
+    }
+
+    group.finish();
+}
+
+fn run_traps_benchmarks(_c: &mut Criterion) {
+    #[cfg(feature = "llvm")]
+    {
+        let engine = Universal::new(wasmer_compiler_llvm::LLVM::new()).engine();
+        run_traps_benchmark(&engine, "llvm", _c);
+    }
+
+    #[cfg(feature = "cranelift")]
+    {
+        let engine = Universal::new(wasmer_compiler_cranelift::Cranelift::new()).engine();
+        run_traps_benchmark(&engine, "cranelift", _c);
+    }
+
+    #[cfg(feature = "singlepass")]
+    {
+        let engine = Universal::new(wasmer_compiler_singlepass::Singlepass::new()).engine();
+        run_traps_benchmark(&engine, "singlepass", _c);
+    }
+}
+
+criterion_group!(benches, run_traps_benchmarks);
+
+criterion_main!(benches);
@@ -78,7 +78,7 @@ pub use crate::js::types::{Val as Value, ValType as Type};
 pub use wasmer_types::is_wasm;
 pub use wasmer_types::{
     Atomically, Bytes, ExportIndex, GlobalInit, LocalFunctionIndex, MemoryView, Pages, ValueType,
-    WASM_MAX_PAGES, WASM_MIN_PAGES, WASM_PAGE_SIZE,
+    WASM64_MAX_PAGES, WASM_MAX_PAGES, WASM_MIN_PAGES, WASM_PAGE_SIZE,
 };
 
 #[cfg(feature = "wat")]
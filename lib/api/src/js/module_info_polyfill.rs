@@ -388,6 +388,7 @@ pub fn parse_import_section<'data>(
                         minimum: Pages(initial as u32),
                         maximum: maximum.map(|p| Pages(p as u32)),
                         shared,
+                        memory64: false,
                     },
                     module_name,
                     field_name.unwrap_or_default(),
@@ -475,6 +476,7 @@ pub fn parse_memory_section(
             minimum: Pages(initial as u32),
             maximum: maximum.map(|p| Pages(p as u32)),
             shared,
+            memory64: false,
         })?;
     }
 
@@ -12,10 +12,16 @@ use loupe::MemoryUsage;
 use std::cmp::max;
 use std::ffi::c_void;
 use std::fmt;
+use std::future::Future;
+use std::panic::{self, AssertUnwindSafe};
+use std::pin::Pin;
 use std::sync::Arc;
+use std::task::{Context, Poll};
+use thiserror::Error;
 use wasmer_engine::{Export, ExportFunction, ExportFunctionMetadata};
 use wasmer_vm::{
-    on_host_stack, raise_user_trap, resume_panic, wasmer_call_trampoline, ImportInitializerFuncPtr,
+    block_on_wasm_call, on_host_stack, raise_user_trap, resume_panic, wasmer_call_trampoline,
+    wasmer_call_trampoline_async, wasmer_call_trampoline_batch, ImportInitializerFuncPtr,
     VMCallerCheckedAnyfunc, VMDynamicFunctionContext, VMFuncRef, VMFunction, VMFunctionBody,
     VMFunctionEnvironment, VMFunctionKind, VMTrampoline,
 };
@@ -67,6 +73,21 @@ impl wasmer_types::WasmValueType for Function {
     }
 }
 
+/// The error raised when one of the calls of a batch fails, see
+/// [`Function::call_batch`] and [`NativeFunc::call_batch`].
+///
+/// The calls before `index` have been executed successfully, the
+/// calls after it have not been executed at all.
+#[derive(Error, Debug)]
+#[error("Call #{index} of the batch failed: {error}")]
+pub struct CallBatchError {
+    /// The index of the call that failed.
+    pub index: usize,
+    /// The error raised by the call.
+    #[source]
+    pub error: RuntimeError,
+}
+
 fn build_export_function_metadata<Env>(
     env: Env,
     import_init_function_ptr: for<'a> fn(
@@ -204,12 +225,105 @@ impl Function {
         FT: Into<FunctionType>,
         F: Fn(&Env, &[Val]) -> Result<Vec<Val>, RuntimeError> + 'static + Send + Sync,
         Env: Sized + WasmerEnv + 'static,
+    {
+        Self::new_dynamic(store, ty, env, DynamicFunctionBody::Sync(Arc::new(func)))
+    }
+
+    /// Creates a new asynchronous host `Function` (dynamic) with the
+    /// provided signature.
+    ///
+    /// The function returns a future. When it is called by WebAssembly
+    /// code entered with [`Function::call_async`], the call is
+    /// suspended until the future is ready, and the thread is free to
+    /// run other calls meanwhile. Otherwise, the thread is blocked
+    /// until the future is ready.
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// # use wasmer::{Function, FunctionType, Type, Store, Value};
+    /// # let store = Store::default();
+    /// #
+    /// let signature = FunctionType::new(vec![Type::I32, Type::I32], vec![Type::I32]);
+    ///
+    /// let f = Function::new_async(&store, &signature, |args| {
+    ///     let sum = args[0].unwrap_i32() + args[1].unwrap_i32();
+    ///
+    ///     async move {
+    ///         // Wait for a timer, a socket, etc.
+    ///         Ok(vec![Value::I32(sum)])
+    ///     }
+    /// });
+    /// ```
+    pub fn new_async<FT, F, Fut>(store: &Store, ty: FT, func: F) -> Self
+    where
+        FT: Into<FunctionType>,
+        F: Fn(&[Val]) -> Fut + 'static + Send + Sync,
+        Fut: Future<Output = Result<Vec<Val>, RuntimeError>> + 'static + Send,
+    {
+        let wrapped_func =
+            move |_env: &WithoutEnv, args: &[Val]| -> HostFuture { Box::pin(func(args)) };
+        Self::new_dynamic(
+            store,
+            ty,
+            WithoutEnv,
+            DynamicFunctionBody::Async(Arc::new(wrapped_func)),
+        )
+    }
+
+    /// Creates a new asynchronous host `Function` (dynamic) with the
+    /// provided signature and environment.
+    ///
+    /// See [`Function::new_async`]. The future can't borrow the
+    /// environment: the parts it needs must be cloned into it.
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// # use wasmer::{Function, FunctionType, Type, Store, Value, WasmerEnv};
+    /// # let store = Store::default();
+    /// #
+    /// #[derive(WasmerEnv, Clone)]
+    /// struct Env {
+    ///   multiplier: i32,
+    /// };
+    /// let env = Env { multiplier: 2 };
+    ///
+    /// let signature = FunctionType::new(vec![Type::I32, Type::I32], vec![Type::I32]);
+    ///
+    /// let f = Function::new_async_with_env(&store, &signature, env, |env, args| {
+    ///     let result = env.multiplier * (args[0].unwrap_i32() + args[1].unwrap_i32());
+    ///
+    ///     async move { Ok(vec![Value::I32(result)]) }
+    /// });
+    /// ```
+    pub fn new_async_with_env<FT, F, Fut, Env>(store: &Store, ty: FT, env: Env, func: F) -> Self
+    where
+        FT: Into<FunctionType>,
+        F: Fn(&Env, &[Val]) -> Fut + 'static + Send + Sync,
+        Fut: Future<Output = Result<Vec<Val>, RuntimeError>> + 'static + Send,
+        Env: Sized + WasmerEnv + 'static,
+    {
+        let wrapped_func =
+            move |env: &Env, args: &[Val]| -> HostFuture { Box::pin(func(env, args)) };
+        Self::new_dynamic(
+            store,
+            ty,
+            env,
+            DynamicFunctionBody::Async(Arc::new(wrapped_func)),
+        )
+    }
+
+    fn new_dynamic<FT, Env>(store: &Store, ty: FT, env: Env, func: DynamicFunctionBody<Env>) -> Self
+    where
+        FT: Into<FunctionType>,
+        Env: Sized + WasmerEnv + 'static,
     {
         let ty: FunctionType = ty.into();
         let dynamic_ctx: VMDynamicFunctionContext<DynamicFunction<Env>> =
             VMDynamicFunctionContext::from_context(DynamicFunction {
                 env: Box::new(env),
-                func: Arc::new(func),
+                func,
                 store: store.clone(),
                 function_type: ty.clone(),
             });
@@ -356,6 +470,52 @@ impl Function {
         }
     }
 
+    /// Creates a new host `Function` from a raw pointer to a function
+    /// that follows the native ABI of the given signature.
+    ///
+    /// This is the untyped counterpart of [`Function::new_native`],
+    /// mostly meant for bindings to other languages: `address` is
+    /// called directly by the WebAssembly code, without any
+    /// conversion of the arguments or of the results. Its first
+    /// argument is `host_env`, given as is, followed by the
+    /// parameters of `ty`.
+    ///
+    /// Such a function can only be called from WebAssembly, i.e. once
+    /// imported by an instance.
+    ///
+    /// # Safety
+    ///
+    /// `address` must point to an `extern "C"` function whose
+    /// signature matches `ty`, with an additional pointer-sized first
+    /// parameter. `host_env` is not owned by the `Function`: it must
+    /// outlive every instance importing it.
+    pub unsafe fn new_native_raw<FT>(
+        store: &Store,
+        ty: FT,
+        address: *const c_void,
+        host_env: *mut c_void,
+    ) -> Self
+    where
+        FT: Into<FunctionType>,
+    {
+        let vmctx = VMFunctionEnvironment { host_env };
+
+        Self {
+            store: store.clone(),
+            exported: ExportFunction {
+                metadata: None,
+                vm_function: VMFunction {
+                    address: address as *const VMFunctionBody,
+                    kind: VMFunctionKind::Static,
+                    vmctx,
+                    signature: ty.into(),
+                    call_trampoline: None,
+                    instance_ref: None,
+                },
+            },
+        }
+    }
+
     /// Returns the [`FunctionType`] of the `Function`.
     ///
     /// # Example
@@ -382,19 +542,9 @@ impl Function {
         &self.store
     }
 
-    fn call_wasm(
-        &self,
-        trampoline: VMTrampoline,
-        params: &[Val],
-        results: &mut [Val],
-    ) -> Result<(), RuntimeError> {
-        let format_types_for_error_message = |items: &[Val]| {
-            items
-                .iter()
-                .map(|param| param.ty().to_string())
-                .collect::<Vec<String>>()
-                .join(", ")
-        };
+    /// Checks the arguments against the signature, and stores them
+    /// into a new `values_vec`, large enough to receive the results.
+    fn write_params(&self, params: &[Val]) -> Result<Vec<i128>, RuntimeError> {
         let signature = self.ty();
         if signature.params().len() != params.len() {
             return Err(RuntimeError::new(format!(
@@ -403,15 +553,8 @@ impl Function {
                 &signature
             )));
         }
-        if signature.results().len() != results.len() {
-            return Err(RuntimeError::new(format!(
-                "Results of type [{}] did not match signature {}",
-                format_types_for_error_message(results),
-                &signature,
-            )));
-        }
 
-        let mut values_vec = vec![0; max(params.len(), results.len())];
+        let mut values_vec = vec![0; max(params.len(), self.result_arity())];
 
         // Store the argument values into `values_vec`.
         let param_tys = signature.params().iter();
@@ -428,6 +571,26 @@ impl Function {
             }
         }
 
+        Ok(values_vec)
+    }
+
+    fn call_wasm(
+        &self,
+        trampoline: VMTrampoline,
+        params: &[Val],
+        results: &mut [Val],
+    ) -> Result<(), RuntimeError> {
+        let signature = self.ty();
+        if signature.results().len() != results.len() {
+            return Err(RuntimeError::new(format!(
+                "Results of type [{}] did not match signature {}",
+                format_types_for_error_message(results),
+                &signature,
+            )));
+        }
+
+        let mut values_vec = self.write_params(params)?;
+
         // Call the trampoline.
         if let Err(error) = unsafe {
             wasmer_call_trampoline(
@@ -534,14 +697,339 @@ impl Function {
             VMFunctionKind::Dynamic => unsafe {
                 type VMContextWithEnv = VMDynamicFunctionContext<DynamicFunction<std::ffi::c_void>>;
                 let ctx = self.exported.vm_function.vmctx.host_env as *mut VMContextWithEnv;
-                Ok((*ctx).ctx.call(&params)?.into_boxed_slice())
+                Ok((*ctx).ctx.call(&params).wait()?.into_boxed_slice())
             },
-            VMFunctionKind::Static => {
-                unimplemented!(
-                    "Native function definitions can't be directly called from the host yet"
-                );
+            VMFunctionKind::Static => Err(RuntimeError::new(
+                "Native function definitions can't be directly called from the host yet",
+            )),
+        }
+    }
+
+    /// Call the `Function` asynchronously.
+    ///
+    /// It returns a future which runs the function when polled. While
+    /// an asynchronous host function (see [`Function::new_async`])
+    /// called by the WebAssembly code waits for its own future, the
+    /// call is suspended instead of blocking the thread: the returned
+    /// future is pending, and polling it again resumes the call. It
+    /// can be polled from any thread, so that many calls can share a
+    /// few threads.
+    ///
+    /// Dropping the future while the call is suspended cancels it: the
+    /// suspended host function returns a trap, and the WebAssembly
+    /// code is unwound.
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// # use wasmer::{imports, wat2wasm, Function, Instance, Module, Store, Type, Value};
+    /// # let store = Store::default();
+    /// # let wasm_bytes = wat2wasm(r#"
+    /// # (module
+    /// #   (func (export "sum") (param $x i32) (param $y i32) (result i32)
+    /// #     local.get $x
+    /// #     local.get $y
+    /// #     i32.add
+    /// #   ))
+    /// # "#.as_bytes()).unwrap();
+    /// # let module = Module::new(&store, wasm_bytes).unwrap();
+    /// # let import_object = imports! {};
+    /// # let instance = Instance::new(&module, &import_object).unwrap();
+    /// #
+    /// let sum = instance.exports.get_function("sum").unwrap();
+    /// let results = futures::executor::block_on(sum.call_async(&[Value::I32(1), Value::I32(2)]));
+    ///
+    /// assert_eq!(results.unwrap().to_vec(), vec![Value::I32(3)]);
+    /// ```
+    pub fn call_async<'a>(
+        &'a self,
+        params: &[Val],
+    ) -> impl Future<Output = Result<Box<[Val]>, RuntimeError>> + Send + 'a {
+        // Everything that depends on `params` is done now, so that the
+        // future doesn't borrow them.
+        let call = if let Some(trampoline) = self.exported.vm_function.call_trampoline {
+            self.write_params(params)
+                .map(|values_vec| PendingCall::Wasm(trampoline, values_vec))
+        } else {
+            match self.exported.vm_function.kind {
+                VMFunctionKind::Dynamic => unsafe {
+                    type VMContextWithEnv =
+                        VMDynamicFunctionContext<DynamicFunction<std::ffi::c_void>>;
+                    let ctx = self.exported.vm_function.vmctx.host_env as *mut VMContextWithEnv;
+                    Ok(match (*ctx).ctx.call(params) {
+                        DynamicCall::Ready(results) => {
+                            PendingCall::Ready(ReadyResults(results.map(Vec::into_boxed_slice)))
+                        }
+                        DynamicCall::Pending(future) => PendingCall::Host(future),
+                    })
+                },
+                VMFunctionKind::Static => Err(RuntimeError::new(
+                    "Native function definitions can't be directly called from the host yet",
+                )),
+            }
+        };
+
+        async move {
+            match call? {
+                PendingCall::Ready(results) => results.0,
+                PendingCall::Host(future) => Ok(future.await?.into_boxed_slice()),
+                PendingCall::Wasm(trampoline, mut values_vec) => {
+                    let call = unsafe {
+                        wasmer_call_trampoline_async(
+                            &self.store,
+                            self.exported.vm_function.vmctx,
+                            trampoline,
+                            self.exported.vm_function.address,
+                            values_vec.as_mut_ptr() as *mut u8,
+                        )
+                    }
+                    .map_err(RuntimeError::from_trap)?;
+
+                    call.await.map_err(RuntimeError::from_trap)?;
+
+                    // Load the return values out of `values_vec`.
+                    let results = self
+                        .ty()
+                        .results()
+                        .iter()
+                        .enumerate()
+                        .map(|(index, &value_type)| unsafe {
+                            Val::read_value_from(
+                                &self.store,
+                                values_vec.as_ptr().add(index),
+                                value_type,
+                            )
+                        })
+                        .collect();
+
+                    Ok(results)
+                }
+            }
+        }
+    }
+
+    /// Call the `Function` with its arguments and results passed as raw
+    /// 128-bit slots, as expected by the function's trampoline.
+    ///
+    /// Unlike [`Function::call`], no [`Val`] is built and nothing is
+    /// allocated for a function defined in a WebAssembly module: the
+    /// arguments are read from `values_vec`, and the results are
+    /// written back into it, starting at the first slot.
+    ///
+    /// # Safety
+    ///
+    /// `values_vec` must point to at least
+    /// `max(self.param_arity(), self.result_arity())` slots, and each
+    /// argument slot must hold a value of the matching parameter type,
+    /// stored in the native endianness at the start of the slot. It is
+    /// the responsibility of the caller to check the signature of the
+    /// function beforehand, see [`Function::ty`].
+    pub unsafe fn call_raw(&self, values_vec: *mut i128) -> Result<(), RuntimeError> {
+        // If it's a function defined in the Wasm, it will always have a call_trampoline
+        if let Some(trampoline) = self.exported.vm_function.call_trampoline {
+            return wasmer_call_trampoline(
+                &self.store,
+                self.exported.vm_function.vmctx,
+                trampoline,
+                self.exported.vm_function.address,
+                values_vec as *mut u8,
+            )
+            .map_err(RuntimeError::from_trap);
+        }
+
+        // If it's a function defined in the host
+        match self.exported.vm_function.kind {
+            VMFunctionKind::Dynamic => {
+                type VMContextWithEnv = VMDynamicFunctionContext<DynamicFunction<std::ffi::c_void>>;
+                let ctx = self.exported.vm_function.vmctx.host_env as *mut VMContextWithEnv;
+                let signature = self.ty();
+                let params = signature
+                    .params()
+                    .iter()
+                    .enumerate()
+                    .map(|(index, &ty)| {
+                        Val::read_value_from(&self.store, values_vec.add(index), ty)
+                    })
+                    .collect::<Vec<_>>();
+                let results = (*ctx).ctx.call(&params).wait()?;
+
+                if results.len() != signature.results().len() {
+                    return Err(RuntimeError::new(format!(
+                        "Dynamic function returned {} values but {} were expected by signature {}",
+                        results.len(),
+                        signature.results().len(),
+                        signature,
+                    )));
+                }
+
+                for (index, result) in results.iter().enumerate() {
+                    result.write_value_to(values_vec.add(index));
+                }
+
+                Ok(())
             }
+            VMFunctionKind::Static => Err(RuntimeError::new(
+                "Native function definitions can't be directly called from the host yet",
+            )),
+        }
+    }
+
+    /// Call the `Function` once per set of parameters in `params`.
+    ///
+    /// This is equivalent to calling [`Function::call`] in a loop, but
+    /// for a function defined in a WebAssembly module, the runtime
+    /// enters WebAssembly only once for the whole batch. The results
+    /// are returned in the same order as `params`.
+    ///
+    /// If a call fails, the batch stops and the index of the failing
+    /// call is reported.
+    ///
+    /// # Examples
+    ///
+    /// ```
+    /// # use wasmer::{imports, wat2wasm, Function, Instance, Module, Store, Type, Value};
+    /// # let store = Store::default();
+    /// # let wasm_bytes = wat2wasm(r#"
+    /// # (module
+    /// #   (func (export "sum") (param $x i32) (param $y i32) (result i32)
+    /// #     local.get $x
+    /// #     local.get $y
+    /// #     i32.add
+    /// #   ))
+    /// # "#.as_bytes()).unwrap();
+    /// # let module = Module::new(&store, wasm_bytes).unwrap();
+    /// # let import_object = imports! {};
+    /// # let instance = Instance::new(&module, &import_object).unwrap();
+    /// #
+    /// let sum = instance.exports.get_function("sum").unwrap();
+    /// let results = sum
+    ///     .call_batch(&[
+    ///         &[Value::I32(1), Value::I32(2)],
+    ///         &[Value::I32(3), Value::I32(4)],
+    ///     ])
+    ///     .unwrap();
+    ///
+    /// assert_eq!(results[0].to_vec(), vec![Value::I32(3)]);
+    /// assert_eq!(results[1].to_vec(), vec![Value::I32(7)]);
+    /// ```
+    pub fn call_batch(&self, params: &[&[Val]]) -> Result<Vec<Box<[Val]>>, CallBatchError> {
+        if self.exported.vm_function.call_trampoline.is_none() {
+            return params
+                .iter()
+                .enumerate()
+                .map(|(index, params)| {
+                    self.call(params)
+                        .map_err(|error| CallBatchError { index, error })
+                })
+                .collect();
+        }
+
+        // Check all the parameters before entering the batch.
+        let signature = self.ty();
+        for (index, params) in params.iter().enumerate() {
+            if params.len() != signature.params().len()
+                || params
+                    .iter()
+                    .zip(signature.params())
+                    .any(|(param, ty)| param.ty() != *ty)
+            {
+                let param_types = params
+                    .iter()
+                    .map(|param| param.ty().to_string())
+                    .collect::<Vec<String>>()
+                    .join(", ");
+
+                return Err(CallBatchError {
+                    index,
+                    error: RuntimeError::new(format!(
+                        "Parameters of type [{}] did not match signature {}",
+                        param_types, &signature,
+                    )),
+                });
+            }
+        }
+
+        let mut results = Vec::with_capacity(params.len());
+
+        unsafe {
+            self.call_raw_batch(
+                params.len(),
+                |index, values_vec| {
+                    for (slot, param) in params[index].iter().enumerate() {
+                        param.write_value_to(values_vec.add(slot));
+                    }
+                },
+                |_, values_vec| {
+                    results.push(
+                        signature
+                            .results()
+                            .iter()
+                            .enumerate()
+                            .map(|(slot, &ty)| {
+                                Val::read_value_from(&self.store, values_vec.add(slot), ty)
+                            })
+                            .collect(),
+                    );
+                },
+            )?;
         }
+
+        Ok(results)
+    }
+
+    /// Call the `Function` `count` times, with its arguments and
+    /// results passed as raw 128-bit slots, see [`Function::call_raw`].
+    ///
+    /// Before each call, `before_call` is called with the index of
+    /// the call and the slots, to write the arguments. After each
+    /// call, `after_call` is called with the index of the call and the
+    /// slots, to read the results. For a function defined in a
+    /// WebAssembly module, the runtime enters WebAssembly only once for
+    /// the whole batch.
+    ///
+    /// If a call fails, the batch stops and the index of the failing
+    /// call is reported.
+    ///
+    /// # Safety
+    ///
+    /// `before_call` must write a value of the matching parameter type
+    /// in each argument slot, as for [`Function::call_raw`]. If a call
+    /// traps, the destructors owned by `before_call` and `after_call`
+    /// may not run.
+    pub unsafe fn call_raw_batch(
+        &self,
+        count: usize,
+        mut before_call: impl FnMut(usize, *mut i128),
+        mut after_call: impl FnMut(usize, *const i128),
+    ) -> Result<(), CallBatchError> {
+        let mut values_vec = vec![0; max(self.param_arity(), self.result_arity())];
+
+        // If it's a function defined in the Wasm, it will always have a call_trampoline
+        if let Some(trampoline) = self.exported.vm_function.call_trampoline {
+            return wasmer_call_trampoline_batch(
+                &self.store,
+                self.exported.vm_function.vmctx,
+                trampoline,
+                self.exported.vm_function.address,
+                values_vec.as_mut_ptr() as *mut u8,
+                count,
+                |index, values_vec| before_call(index, values_vec as *mut i128),
+                |index, values_vec| after_call(index, values_vec as *const i128),
+            )
+            .map_err(|(index, trap)| CallBatchError {
+                index,
+                error: RuntimeError::from_trap(trap),
+            });
+        }
+
+        for index in 0..count {
+            before_call(index, values_vec.as_mut_ptr());
+            self.call_raw(values_vec.as_mut_ptr())
+                .map_err(|error| CallBatchError { index, error })?;
+            after_call(index, values_vec.as_ptr());
+        }
+
+        Ok(())
     }
 
     pub(crate) fn from_vm_export(store: &Store, wasmer_export: ExportFunction) -> Self {
@@ -732,20 +1220,105 @@ impl fmt::Debug for Function {
     }
 }
 
+fn format_types_for_error_message(items: &[Val]) -> String {
+    items
+        .iter()
+        .map(|param| param.ty().to_string())
+        .collect::<Vec<String>>()
+        .join(", ")
+}
+
+/// The future returned by an asynchronous host function.
+type HostFuture = Pin<Box<dyn Future<Output = Result<Vec<Val>, RuntimeError>> + Send>>;
+
+/// A call started by [`Function::call_async`].
+enum PendingCall {
+    /// A function defined in WebAssembly, with its trampoline and its
+    /// `values_vec`.
+    Wasm(VMTrampoline, Vec<i128>),
+    /// An asynchronous host function.
+    Host(HostFuture),
+    /// A synchronous host function, which has already returned.
+    Ready(ReadyResults),
+}
+
+/// The results of a synchronous host function called by
+/// [`Function::call_async`].
+struct ReadyResults(Result<Box<[Val]>, RuntimeError>);
+
+/// # Safety
+/// `Val` is only `!Send` because of `ExternRef`, whose reference count
+/// is atomic and whose data is `Send + Sync`.
+unsafe impl Send for ReadyResults {}
+
+/// Catches the panics of a host future, so that they are not unwound
+/// through WebAssembly frames.
+struct CatchUnwind<F>(F);
+
+impl<F: Future + Unpin> Future for CatchUnwind<F> {
+    type Output = std::thread::Result<F::Output>;
+
+    fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let future = &mut self.0;
+
+        match panic::catch_unwind(AssertUnwindSafe(|| Pin::new(future).poll(cx))) {
+            Ok(Poll::Ready(output)) => Poll::Ready(Ok(output)),
+            Ok(Poll::Pending) => Poll::Pending,
+            Err(panic) => Poll::Ready(Err(panic)),
+        }
+    }
+}
+
+/// The outcome of calling a dynamic function.
+pub(crate) enum DynamicCall {
+    /// The results of a synchronous function.
+    Ready(Result<Vec<Val>, RuntimeError>),
+    /// The future of an asynchronous function.
+    Pending(HostFuture),
+}
+
+impl DynamicCall {
+    /// Waits for the results, suspending the current asynchronous
+    /// call if there is one, see [`block_on_wasm_call`].
+    fn wait(self) -> Result<Vec<Val>, RuntimeError> {
+        match self {
+            Self::Ready(results) => results,
+            Self::Pending(future) => {
+                block_on_wasm_call(future).map_err(|error| RuntimeError::user(Box::new(error)))?
+            }
+        }
+    }
+}
+
 /// This trait is one that all dynamic functions must fulfill.
 pub(crate) trait VMDynamicFunction: Send + Sync {
-    fn call(&self, args: &[Val]) -> Result<Vec<Val>, RuntimeError>;
+    fn call(&self, args: &[Val]) -> DynamicCall;
     fn function_type(&self) -> &FunctionType;
     fn store(&self) -> &Store;
 }
 
+/// The host function behind a dynamic function.
+#[allow(clippy::type_complexity)]
+pub(crate) enum DynamicFunctionBody<Env> {
+    Sync(Arc<dyn Fn(&Env, &[Val]) -> Result<Vec<Val>, RuntimeError> + 'static + Send + Sync>),
+    Async(Arc<dyn Fn(&Env, &[Val]) -> HostFuture + 'static + Send + Sync>),
+}
+
+impl<Env> Clone for DynamicFunctionBody<Env> {
+    fn clone(&self) -> Self {
+        match self {
+            Self::Sync(func) => Self::Sync(func.clone()),
+            Self::Async(func) => Self::Async(func.clone()),
+        }
+    }
+}
+
 pub(crate) struct DynamicFunction<Env>
 where
     Env: Sized + 'static + Send + Sync,
 {
     function_type: FunctionType,
-    #[allow(clippy::type_complexity)]
-    func: Arc<dyn Fn(&Env, &[Val]) -> Result<Vec<Val>, RuntimeError> + 'static + Send + Sync>,
+    func: DynamicFunctionBody<Env>,
     store: Store,
     env: Box<Env>,
 }
@@ -765,8 +1338,11 @@ impl<Env> VMDynamicFunction for DynamicFunction<Env>
 where
     Env: Sized + 'static + Send + Sync,
 {
-    fn call(&self, args: &[Val]) -> Result<Vec<Val>, RuntimeError> {
-        (*self.func)(&*self.env, &args)
+    fn call(&self, args: &[Val]) -> DynamicCall {
+        match &self.func {
+            DynamicFunctionBody::Sync(func) => DynamicCall::Ready(func(&*self.env, &args)),
+            DynamicFunctionBody::Async(func) => DynamicCall::Pending(func(&*self.env, &args)),
+        }
     }
     fn function_type(&self) -> &FunctionType {
         &self.function_type
@@ -802,7 +1378,6 @@ impl<T: VMDynamicFunction> VMDynamicFunctionCall<T> for VMDynamicFunctionContext
         &self,
         values_vec: *mut i128,
     ) {
-        use std::panic::{self, AssertUnwindSafe};
         let result = on_host_stack(|| {
             panic::catch_unwind(AssertUnwindSafe(|| {
                 let func_ty = self.ctx.function_type();
@@ -811,27 +1386,34 @@ impl<T: VMDynamicFunction> VMDynamicFunctionCall<T> for VMDynamicFunctionContext
                 for (i, ty) in func_ty.params().iter().enumerate() {
                     args.push(Val::read_value_from(store, values_vec.add(i), *ty));
                 }
-                let returns = self.ctx.call(&args)?;
-
-                // We need to dynamically check that the returns
-                // match the expected types, as well as expected length.
-                let return_types = returns.iter().map(|ret| ret.ty()).collect::<Vec<_>>();
-                if return_types != func_ty.results() {
-                    return Err(RuntimeError::new(format!(
-                        "Dynamic function returned wrong signature. Expected {:?} but got {:?}",
-                        func_ty.results(),
-                        return_types
-                    )));
-                }
-                for (i, ret) in returns.iter().enumerate() {
-                    ret.write_value_to(values_vec.add(i));
+                match self.ctx.call(&args) {
+                    DynamicCall::Ready(returns) => {
+                        write_dynamic_returns(func_ty, returns?, values_vec).map(|()| None)
+                    }
+                    DynamicCall::Pending(future) => Ok(Some(future)),
                 }
-                Ok(())
             })) // We get extern ref drops at the end of this block that we don't need.
                 // By preventing extern ref incs in the code above we can save the work of
                 // incrementing and decrementing. However the logic as-is is correct.
         });
 
+        // An asynchronous function waits for its future from the Wasm
+        // stack, so that an asynchronous call can be suspended meanwhile.
+        let result = match result {
+            Ok(Ok(Some(future))) => match block_on_wasm_call(CatchUnwind(future)) {
+                Ok(Ok(returns)) => on_host_stack(|| {
+                    panic::catch_unwind(AssertUnwindSafe(|| {
+                        write_dynamic_returns(self.ctx.function_type(), returns?, values_vec)
+                    }))
+                }),
+                Ok(Err(panic)) => Err(panic),
+                Err(cancelled) => Ok(Err(RuntimeError::user(Box::new(cancelled)))),
+            },
+            Ok(Ok(None)) => Ok(Ok(())),
+            Ok(Err(trap)) => Ok(Err(trap)),
+            Err(panic) => Err(panic),
+        };
+
         match result {
             Ok(Ok(())) => {}
             Ok(Err(trap)) => raise_user_trap(Box::new(trap)),
@@ -840,6 +1422,28 @@ impl<T: VMDynamicFunction> VMDynamicFunctionCall<T> for VMDynamicFunctionContext
     }
 }
 
+/// Writes the values returned by a dynamic function into `values_vec`.
+unsafe fn write_dynamic_returns(
+    func_ty: &FunctionType,
+    returns: Vec<Val>,
+    values_vec: *mut i128,
+) -> Result<(), RuntimeError> {
+    // We need to dynamically check that the returns
+    // match the expected types, as well as expected length.
+    let return_types = returns.iter().map(|ret| ret.ty()).collect::<Vec<_>>();
+    if return_types != func_ty.results() {
+        return Err(RuntimeError::new(format!(
+            "Dynamic function returned wrong signature. Expected {:?} but got {:?}",
+            func_ty.results(),
+            return_types
+        )));
+    }
+    for (i, ret) in returns.iter().enumerate() {
+        ret.write_value_to(values_vec.add(i));
+    }
+    Ok(())
+}
+
 /// This private inner module contains the low-level implementation
 /// for `Function` and its siblings.
 mod inner {
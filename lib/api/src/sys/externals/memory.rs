@@ -8,7 +8,7 @@ use std::slice;
 use std::sync::Arc;
 use wasmer_engine::Export;
 use wasmer_types::{Pages, ValueType};
-use wasmer_vm::{MemoryError, VMMemory};
+use wasmer_vm::{MemoryError, MemoryStyle, PageBacking, VMMemory};
 
 /// A WebAssembly `memory` instance.
 ///
@@ -77,6 +77,43 @@ impl Memory {
         self.vm_memory.from.ty()
     }
 
+    /// Returns the [`MemoryStyle`] of the `Memory`, which the
+    /// [`Tunables`](crate::Tunables) of the store chose when the module
+    /// defining it was compiled.
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// # use wasmer::{Memory, MemoryType, Store};
+    /// # use wasmer::vm::MemoryStyle;
+    /// # let store = Store::default();
+    /// #
+    /// let m = Memory::new(&store, MemoryType::new(1, Some(1), false)).unwrap();
+    ///
+    /// assert!(matches!(m.style(), MemoryStyle::Static { .. }));
+    /// ```
+    pub fn style(&self) -> MemoryStyle {
+        self.vm_memory.from.style().clone()
+    }
+
+    /// Returns the kind of pages backing the `Memory`, which may be
+    /// less than what the [`BaseTunables`](crate::BaseTunables) of
+    /// the store requested, depending on what the system provides.
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// # use wasmer::{Memory, MemoryType, PageBacking, Store};
+    /// # let store = Store::default();
+    /// #
+    /// let m = Memory::new(&store, MemoryType::new(1, None, false)).unwrap();
+    ///
+    /// assert_eq!(m.page_backing(), PageBacking::Base);
+    /// ```
+    pub fn page_backing(&self) -> PageBacking {
+        self.vm_memory.from.page_backing()
+    }
+
     /// Returns the [`Store`] where the `Memory` belongs.
     ///
     /// # Example
@@ -4,7 +4,7 @@ mod memory;
 mod table;
 
 pub use self::function::{
-    FromToNativeWasmType, Function, HostFunction, WasmTypeList, WithEnv, WithoutEnv,
+    CallBatchError, FromToNativeWasmType, Function, HostFunction, WasmTypeList, WithEnv, WithoutEnv,
 };
 
 pub use self::global::Global;
@@ -8,7 +8,7 @@ use std::fmt;
 use std::sync::{Arc, Mutex};
 use thiserror::Error;
 use wasmer_engine::Resolver;
-use wasmer_vm::{InstanceHandle, VMContext};
+use wasmer_vm::{InstanceHandle, SnapshotError, VMContext};
 
 /// A WebAssembly Instance is a stateful, executable
 /// instance of a WebAssembly [`Module`].
@@ -122,8 +122,52 @@ impl Instance {
         module: &Module,
         resolver: &(dyn Resolver + Send + Sync),
     ) -> Result<Self, InstantiationError> {
-        let store = module.store();
         let handle = module.instantiate(resolver)?;
+
+        Self::from_handle(module, handle)
+    }
+
+    /// Creates a new `Instance` of the [`Module`] a [`InstanceSnapshot`]
+    /// was taken from, in the state captured by the snapshot.
+    ///
+    /// The memories, tables and globals defined by the module are not
+    /// initialized, and its start function is not called: they are
+    /// restored from the snapshot instead. The memories map the captured
+    /// content copy-on-write when the platform supports it. The imports
+    /// are resolved by `resolver`, as with [`Instance::new`].
+    ///
+    /// ```
+    /// # use wasmer::{imports, Instance, Module, Store, Value};
+    /// # fn main() -> anyhow::Result<()> {
+    /// let store = Store::default();
+    /// let module = Module::new(&store, r#"
+    /// (module
+    ///   (global $counter (export "counter") (mut i32) (i32.const 0))
+    ///   (func (export "initialize")
+    ///     (global.set $counter (i32.const 42))))
+    /// "#)?;
+    ///
+    /// let instance = Instance::new(&module, &imports! {})?;
+    /// instance.exports.get_function("initialize")?.call(&[])?;
+    /// let snapshot = instance.snapshot()?;
+    ///
+    /// let forked = Instance::from_snapshot(&snapshot, &imports! {})?;
+    /// assert_eq!(forked.exports.get_global("counter")?.get(), Value::I32(42));
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub fn from_snapshot(
+        snapshot: &InstanceSnapshot,
+        resolver: &(dyn Resolver + Send + Sync),
+    ) -> Result<Self, InstantiationError> {
+        let module = &snapshot.module;
+        let handle = module.instantiate_from_snapshot(resolver, &snapshot.inner)?;
+
+        Self::from_handle(module, handle)
+    }
+
+    fn from_handle(module: &Module, handle: InstanceHandle) -> Result<Self, InstantiationError> {
+        let store = module.store();
         let exports = module
             .exports()
             .map(|export| {
@@ -169,12 +213,58 @@ impl Instance {
         self.module.store()
     }
 
+    /// Captures the state of the memories, tables and globals defined by
+    /// this instance, so that new instances can be created in this state
+    /// with [`Instance::from_snapshot`].
+    ///
+    /// Imported memories, tables and globals are not captured. The
+    /// instance must not be running while the snapshot is taken.
+    ///
+    /// ## Errors
+    ///
+    /// A snapshot can't be taken if a table or a global of the instance
+    /// refers to a function that is neither defined nor imported by the
+    /// instance.
+    pub fn snapshot(&self) -> Result<InstanceSnapshot, SnapshotError> {
+        let inner = self.handle.lock().unwrap().snapshot()?;
+
+        Ok(InstanceSnapshot {
+            module: self.module.clone(),
+            inner: Arc::new(inner),
+        })
+    }
+
     #[doc(hidden)]
     pub fn vmctx_ptr(&self) -> *mut VMContext {
         self.handle.lock().unwrap().vmctx_ptr()
     }
 }
 
+/// An immutable snapshot of the state of an [`Instance`], taken by
+/// [`Instance::snapshot`].
+///
+/// It can be shared by threads, and cloning it is cheap.
+#[derive(Clone)]
+pub struct InstanceSnapshot {
+    module: Module,
+    inner: Arc<wasmer_vm::InstanceSnapshot>,
+}
+
+impl InstanceSnapshot {
+    /// Gets the [`Module`] of the instance the snapshot was taken from.
+    pub fn module(&self) -> &Module {
+        &self.module
+    }
+}
+
+impl fmt::Debug for InstanceSnapshot {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("InstanceSnapshot")
+            .field("module", &self.module)
+            .finish()
+    }
+}
+
 impl fmt::Debug for Instance {
     fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
         f.debug_struct("Instance")
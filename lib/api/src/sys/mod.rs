@@ -30,15 +30,16 @@ pub use crate::sys::cell::WasmCell;
 pub use crate::sys::env::{HostEnvInitError, LazyInit, WasmerEnv};
 pub use crate::sys::exports::{ExportError, Exportable, Exports, ExportsIterator};
 pub use crate::sys::externals::{
-    Extern, FromToNativeWasmType, Function, Global, HostFunction, Memory, Table, WasmTypeList,
+    CallBatchError, Extern, FromToNativeWasmType, Function, Global, HostFunction, Memory, Table,
+    WasmTypeList,
 };
 pub use crate::sys::import_object::{ImportObject, ImportObjectIterator, LikeNamespace};
-pub use crate::sys::instance::{Instance, InstantiationError};
-pub use crate::sys::module::Module;
+pub use crate::sys::instance::{Instance, InstanceSnapshot, InstantiationError};
+pub use crate::sys::module::{Module, ModuleStream};
 pub use crate::sys::native::NativeFunc;
 pub use crate::sys::ptr::{Array, Item, WasmPtr};
 pub use crate::sys::store::{Store, StoreObject};
-pub use crate::sys::tunables::BaseTunables;
+pub use crate::sys::tunables::{AdaptiveStats, AdaptiveTunables, BaseTunables, PoolingTunables};
 pub use crate::sys::types::{
     ExportType, ExternType, FunctionType, GlobalType, ImportType, MemoryType, Mutability,
     TableType, Val, ValType,
@@ -47,8 +48,8 @@ pub use crate::sys::types::{Val as Value, ValType as Type};
 pub use target_lexicon::{Architecture, CallingConvention, OperatingSystem, Triple, HOST};
 #[cfg(feature = "compiler")]
 pub use wasmer_compiler::{
-    wasmparser, CompilerConfig, FunctionMiddleware, MiddlewareError, MiddlewareReaderState,
-    ModuleMiddleware,
+    wasmparser, CompileMonitor, CompilePool, CompilePoolConfig, CompilerConfig, FunctionCache,
+    FunctionCacheKey, FunctionMiddleware, MiddlewareError, MiddlewareReaderState, ModuleMiddleware,
 };
 pub use wasmer_compiler::{
     CompileError, CpuFeature, Features, ParseCpuFeatureError, Target, WasmError, WasmResult,
@@ -62,17 +63,19 @@ pub use wasmer_types::is_wasm;
 pub use wasmer_types::ExternRef;
 pub use wasmer_types::{
     Atomically, Bytes, ExportIndex, GlobalInit, LocalFunctionIndex, MemoryView, Pages, ValueType,
-    WASM_MAX_PAGES, WASM_MIN_PAGES, WASM_PAGE_SIZE,
+    WASM64_MAX_PAGES, WASM_MAX_PAGES, WASM_MIN_PAGES, WASM_PAGE_SIZE,
 };
 
 // TODO: should those be moved into wasmer::vm as well?
-pub use wasmer_vm::{raise_user_trap, MemoryError};
+pub use wasmer_vm::{raise_user_trap, MemoryError, PageBacking, SnapshotError};
 pub mod vm {
     //! The `vm` module re-exports wasmer-vm types.
 
     pub use wasmer_vm::{
-        Memory, MemoryError, MemoryStyle, Table, TableStyle, VMExtern, VMMemoryDefinition,
-        VMTableDefinition,
+        set_stack_pool_limits, stack_pool_limits, stack_pool_stats, Memory, MemoryError,
+        MemoryStyle, PoolingAllocator, PoolingConfig, PoolingStats, StackPoolLimits,
+        StackPoolStats, Table, TableStyle, VMExtern, VMMemoryDefinition, VMTableDefinition,
+        DEFAULT_STACK_SIZE,
     };
 }
 
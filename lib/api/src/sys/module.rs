@@ -1,6 +1,6 @@
 use crate::sys::store::Store;
 use crate::sys::types::{ExportType, ImportType};
-use crate::sys::InstantiationError;
+use crate::sys::{InstantiationError, RuntimeError};
 use loupe::MemoryUsage;
 use std::fmt;
 use std::io;
@@ -10,9 +10,9 @@ use thiserror::Error;
 use wasmer_compiler::CompileError;
 #[cfg(feature = "wat")]
 use wasmer_compiler::WasmError;
-use wasmer_engine::{Artifact, DeserializeError, Resolver, SerializeError};
+use wasmer_engine::{Artifact, ArtifactStream, DeserializeError, Resolver, SerializeError};
 use wasmer_types::{ExportsIterator, ImportsIterator, ModuleInfo};
-use wasmer_vm::InstanceHandle;
+use wasmer_vm::{InstanceHandle, InstanceSnapshot};
 
 #[derive(Error, Debug)]
 pub enum IoCompileError {
@@ -178,6 +178,56 @@ impl Module {
         Ok(Self::from_artifact(store, artifact))
     }
 
+    /// Starts compiling a WebAssembly binary given the configuration in
+    /// the Store, while its bytes are written to the returned
+    /// [`ModuleStream`] as they are received.
+    ///
+    /// The binary is validated as it is received. The Universal engine
+    /// compiles each function as soon as its body is received, so that
+    /// compiling the module overlaps receiving it; the other engines
+    /// compile the binary once all of it has been received.
+    ///
+    /// # Usage
+    ///
+    /// ```
+    /// # use wasmer::*;
+    /// # fn main() -> anyhow::Result<()> {
+    /// # let store = Store::default();
+    /// let wasm = wat2wasm(b"(module (func (export \"run\")))")?;
+    /// let mut stream = Module::streaming(&store)?;
+    /// for chunk in wasm.chunks(4) {
+    ///     stream.write(chunk)?;
+    /// }
+    /// let module = stream.finish()?;
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub fn streaming(store: &Store) -> Result<ModuleStream, CompileError> {
+        let inner = store
+            .engine()
+            .compile_streaming(store.shared_tunables().clone())?;
+        Ok(ModuleStream {
+            store: store.clone(),
+            inner,
+        })
+    }
+
+    /// Creates a new WebAssembly module from a reader, such as a socket,
+    /// compiling it while it is read, see [`Module::streaming`].
+    pub fn from_reader(store: &Store, mut reader: impl io::Read) -> Result<Self, IoCompileError> {
+        let mut stream = Self::streaming(store)?;
+        let mut buffer = vec![0; 64 * 1024];
+        loop {
+            match reader.read(&mut buffer) {
+                Ok(0) => break,
+                Ok(len) => stream.write(&buffer[..len])?,
+                Err(error) if error.kind() == io::ErrorKind::Interrupted => {}
+                Err(error) => return Err(error.into()),
+            }
+        }
+        Ok(stream.finish()?)
+    }
+
     /// Serializes a module into a binary representation that the `Engine`
     /// can later process via [`Module::deserialize`].
     ///
@@ -267,6 +317,35 @@ impl Module {
         Ok(Self::from_artifact(store, artifact))
     }
 
+    /// Deserializes a serialized Module located in a `Path` into a `Module`,
+    /// like [`Module::deserialize_from_file`], but reads the file in place
+    /// from a memory mapping: with the `Universal` engine, only the
+    /// metadata of the module is deserialized, and its code is copied
+    /// once, straight from the file into executable memory.
+    ///
+    /// # Safety
+    ///
+    /// Please check [`Module::deserialize`]. Also, the file must not be
+    /// modified while the `Module` is alive.
+    ///
+    /// # Usage
+    ///
+    /// ```ignore
+    /// # use wasmer::*;
+    /// # let store = Store::default();
+    /// # fn main() -> anyhow::Result<()> {
+    /// let module = Module::deserialize_from_file_mmap(&store, path)?;
+    /// # Ok(())
+    /// # }
+    /// ```
+    pub unsafe fn deserialize_from_file_mmap(
+        store: &Store,
+        path: impl AsRef<Path>,
+    ) -> Result<Self, DeserializeError> {
+        let artifact = store.engine().deserialize_from_file_mmap(path.as_ref())?;
+        Ok(Self::from_artifact(store, artifact))
+    }
+
     fn from_artifact(store: &Store, artifact: Arc<dyn Artifact>) -> Self {
         Self {
             store: store.clone(),
@@ -297,6 +376,29 @@ impl Module {
         }
     }
 
+    /// Like [`Module::instantiate`], but restores the state captured in
+    /// `snapshot` instead of initializing the instance and calling its
+    /// start function.
+    pub(crate) fn instantiate_from_snapshot(
+        &self,
+        resolver: &dyn Resolver,
+        snapshot: &InstanceSnapshot,
+    ) -> Result<InstanceHandle, InstantiationError> {
+        unsafe {
+            let instance_handle = self.artifact.instantiate(
+                self.store.tunables(),
+                resolver,
+                Box::new(self.clone()),
+            )?;
+
+            instance_handle
+                .restore_snapshot(snapshot)
+                .map_err(|e| InstantiationError::Start(RuntimeError::new(e.to_string())))?;
+
+            Ok(instance_handle)
+        }
+    }
+
     /// Returns the name of the current module.
     ///
     /// This name is normally set in the WebAssembly bytecode by some
@@ -420,6 +522,34 @@ impl Module {
         &self.store
     }
 
+    /// Returns this module for `store`, sharing its compiled code, or
+    /// `None` if `store` doesn't use the engine of this module, or if the
+    /// tunables of `store` pick other memory or table styles than the ones
+    /// compiled into the code.
+    pub fn for_store(&self, store: &Store) -> Option<Self> {
+        if !Store::same(&self.store, store) {
+            return None;
+        }
+        if !Arc::ptr_eq(self.store.shared_tunables(), store.shared_tunables()) {
+            let module = self.info();
+            let tunables = store.tunables();
+            let memory_styles = self.artifact.memory_styles();
+            let table_styles = self.artifact.table_styles();
+            let same_memory_styles = module
+                .memories
+                .iter()
+                .all(|(index, ty)| tunables.memory_style(ty) == memory_styles[index]);
+            let same_table_styles = module
+                .tables
+                .iter()
+                .all(|(index, ty)| tunables.table_style(ty) == table_styles[index]);
+            if !same_memory_styles || !same_table_styles {
+                return None;
+            }
+        }
+        Some(Self::from_artifact(store, self.artifact.clone()))
+    }
+
     /// The ABI of the ModuleInfo is very unstable, we refactor it very often.
     /// This function is public because in some cases it can be useful to get some
     /// extra information from the module.
@@ -448,3 +578,32 @@ impl fmt::Debug for Module {
             .finish()
     }
 }
+
+/// A WebAssembly module being compiled while its bytes are received,
+/// see [`Module::streaming`].
+pub struct ModuleStream {
+    store: Store,
+    inner: Box<dyn ArtifactStream>,
+}
+
+impl ModuleStream {
+    /// Writes the next bytes of the binary.
+    ///
+    /// It fails as soon as the bytes written so far are known to be an
+    /// invalid binary, after which the stream can't be used anymore.
+    pub fn write(&mut self, bytes: &[u8]) -> Result<(), CompileError> {
+        self.inner.write(bytes)
+    }
+
+    /// Ends the binary, and returns the module once compiled.
+    pub fn finish(self) -> Result<Module, CompileError> {
+        let artifact = self.inner.finish()?;
+        Ok(Module::from_artifact(&self.store, artifact))
+    }
+}
+
+impl fmt::Debug for ModuleStream {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("ModuleStream").finish()
+    }
+}
@@ -10,8 +10,12 @@
 use std::marker::PhantomData;
 
 use crate::sys::externals::function::{DynamicFunction, VMDynamicFunction};
-use crate::sys::{FromToNativeWasmType, Function, RuntimeError, Store, WasmTypeList};
+use crate::sys::{
+    CallBatchError, FromToNativeWasmType, Function, RuntimeError, Store, WasmTypeList,
+};
+use std::cmp::max;
 use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::ptr;
 use wasmer_engine::ExportFunction;
 use wasmer_types::NativeWasmType;
 use wasmer_vm::{VMDynamicFunctionContext, VMFunctionBody, VMFunctionEnvironment, VMFunctionKind};
@@ -55,6 +59,63 @@ where
         self.exported.vm_function.kind
     }
 
+    /// Calls the WebAssembly function once per set of parameters,
+    /// entering WebAssembly only once for the whole batch.
+    fn call_wasm_batch(
+        &self,
+        mut params: impl ExactSizeIterator<Item = Args>,
+    ) -> Result<Vec<Rets>, CallBatchError> {
+        // We assume the trampoline is always going to be present for
+        // Wasm functions
+        let trampoline = self
+            .exported
+            .vm_function
+            .call_trampoline
+            .expect("Call trampoline not found in wasm function");
+        let count = params.len();
+        let mut results = Vec::with_capacity(count);
+        let mut values_vec = vec![0i128; max(Args::wasm_types().len(), Rets::wasm_types().len())];
+
+        unsafe {
+            wasmer_vm::wasmer_call_trampoline_batch(
+                &self.store,
+                self.vmctx(),
+                trampoline,
+                self.address(),
+                values_vec.as_mut_ptr() as *mut u8,
+                count,
+                |_, values_vec| {
+                    let mut params_list = params
+                        .next()
+                        .expect("The iterator yielded less items than its length")
+                        .into_array();
+                    let params_list = params_list.as_mut();
+                    ptr::copy_nonoverlapping(
+                        params_list.as_ptr(),
+                        values_vec as *mut i128,
+                        params_list.len(),
+                    );
+                },
+                |_, values_vec| {
+                    let mut rets_list_array = Rets::empty_array();
+                    let rets_list = rets_list_array.as_mut();
+                    ptr::copy_nonoverlapping(
+                        values_vec as *const i128,
+                        rets_list.as_mut_ptr(),
+                        rets_list.len(),
+                    );
+                    results.push(Rets::from_array(rets_list_array));
+                },
+            )
+        }
+        .map_err(|(index, trap)| CallBatchError {
+            index,
+            error: RuntimeError::from_trap(trap),
+        })?;
+
+        Ok(results)
+    }
+
     /// Get access to the backing VM value for this extern. This function is for
     /// tests it should not be called by users of the Wasmer API.
     ///
@@ -220,6 +281,32 @@ macro_rules! impl_native_traits {
                 }
             }
 
+            /// Call the typed func once per set of parameters, and return
+            /// the results in the same order.
+            ///
+            /// This is equivalent to calling [`NativeFunc::call`] in a loop,
+            /// but for a function defined in a WebAssembly module, the
+            /// runtime enters WebAssembly only once for the whole batch. If
+            /// a call fails, the batch stops and the index of the failing
+            /// call is reported.
+            pub fn call_batch<I>(&self, params: I) -> Result<Vec<Rets>, CallBatchError>
+            where
+                I: IntoIterator<Item = ( $( $x ),* )>,
+                I::IntoIter: ExactSizeIterator,
+            {
+                let params = params.into_iter();
+
+                if !self.is_host() {
+                    return self.call_wasm_batch(params);
+                }
+
+                params
+                    .enumerate()
+                    .map(|(index, ( $( $x ),* ))| {
+                        self.call( $( $x ),* ).map_err(|error| CallBatchError { index, error })
+                    })
+                    .collect()
+            }
         }
 
         #[allow(unused_parens)]
@@ -1,11 +1,12 @@
 use crate::sys::tunables::BaseTunables;
 use loupe::MemoryUsage;
 use std::fmt;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 use std::sync::{Arc, RwLock};
 #[cfg(all(feature = "compiler", feature = "engine"))]
 use wasmer_compiler::CompilerConfig;
 use wasmer_engine::{Engine, Tunables};
-use wasmer_vm::{init_traps, TrapHandler, TrapHandlerFn};
+use wasmer_vm::{init_traps, TrapHandler, TrapHandlerFn, DEFAULT_STACK_SIZE};
 
 /// The store represents all global state that can be manipulated by
 /// WebAssembly programs. It consists of the runtime representation
@@ -23,6 +24,10 @@ pub struct Store {
     tunables: Arc<dyn Tunables + Send + Sync>,
     #[loupe(skip)]
     trap_handler: Arc<RwLock<Option<Box<TrapHandlerFn>>>>,
+    #[loupe(skip)]
+    stack_size: Arc<AtomicUsize>,
+    #[loupe(skip)]
+    capture_backtraces: Arc<AtomicBool>,
 }
 
 impl Store {
@@ -40,6 +45,39 @@ impl Store {
         *m = handler;
     }
 
+    /// Set the size, in bytes, of the stacks on which the WebAssembly
+    /// code called through this store runs.
+    ///
+    /// The stacks are taken from a pool shared by all the stores, see
+    /// [`vm::stack_pool_stats`](crate::vm::stack_pool_stats). It
+    /// defaults to [`DEFAULT_STACK_SIZE`] (1 MiB).
+    pub fn set_stack_size(&self, size: usize) {
+        self.stack_size.store(size, Ordering::Relaxed);
+    }
+
+    /// Returns the size, in bytes, of the stacks on which the
+    /// WebAssembly code called through this store runs.
+    pub fn stack_size(&self) -> usize {
+        self.stack_size.load(Ordering::Relaxed)
+    }
+
+    /// Set whether the native backtrace is captured when the WebAssembly
+    /// code called through this store traps. It defaults to `true`.
+    ///
+    /// The backtrace is only symbolicated when
+    /// [`RuntimeError::trace`](crate::RuntimeError::trace) is called,
+    /// but walking the stack still has a cost. Without it, the errors
+    /// of the traps have an empty trace.
+    pub fn set_capture_backtraces(&self, capture: bool) {
+        self.capture_backtraces.store(capture, Ordering::Relaxed);
+    }
+
+    /// Returns whether the native backtrace is captured when the
+    /// WebAssembly code called through this store traps.
+    pub fn capture_backtraces(&self) -> bool {
+        self.capture_backtraces.load(Ordering::Relaxed)
+    }
+
     /// Creates a new `Store` with a specific [`Engine`] and [`Tunables`].
     pub fn new_with_tunables<E>(engine: &E, tunables: impl Tunables + Send + Sync + 'static) -> Self
     where
@@ -53,6 +91,8 @@ impl Store {
             engine: engine.cloned(),
             tunables: Arc::new(tunables),
             trap_handler: Arc::new(RwLock::new(None)),
+            stack_size: Arc::new(AtomicUsize::new(DEFAULT_STACK_SIZE)),
+            capture_backtraces: Arc::new(AtomicBool::new(true)),
         }
     }
 
@@ -61,6 +101,12 @@ impl Store {
         self.tunables.as_ref()
     }
 
+    /// Returns the [`Tunables`], to share them with the compilations
+    /// outliving a borrow of the store.
+    pub(crate) fn shared_tunables(&self) -> &Arc<dyn Tunables + Send + Sync> {
+        &self.tunables
+    }
+
     /// Returns the [`Engine`].
     pub fn engine(&self) -> &Arc<dyn Engine + Send + Sync> {
         &self.engine
@@ -88,6 +134,14 @@ unsafe impl TrapHandler for Store {
             false
         }
     }
+
+    fn stack_size(&self) -> usize {
+        self.stack_size.load(Ordering::Relaxed)
+    }
+
+    fn capture_backtraces(&self) -> bool {
+        self.capture_backtraces.load(Ordering::Relaxed)
+    }
 }
 
 // This is required to be able to set the trap_handler in the
@@ -1,14 +1,17 @@
-use crate::sys::{MemoryType, Pages, TableType};
+use crate::sys::{MemoryType, Pages, TableType, WASM_PAGE_SIZE};
 use loupe::MemoryUsage;
 use std::ptr::NonNull;
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
 use target_lexicon::PointerWidth;
 use wasmer_compiler::Target;
 use wasmer_engine::Tunables;
+use wasmer_types::ModuleInfo;
 use wasmer_vm::MemoryError;
 use wasmer_vm::{
-    LinearMemory, LinearTable, Memory, MemoryStyle, Table, TableStyle, VMMemoryDefinition,
-    VMTableDefinition,
+    reservation_size, InstanceAllocator, LinearMemory, LinearTable, Memory, MemoryImage,
+    MemoryStyle, PageBacking, PoolingAllocator, PoolingConfig, PoolingStats, Table, TableStyle,
+    VMMemoryDefinition, VMTableDefinition,
 };
 
 /// Tunable parameters for WebAssembly compilation.
@@ -29,6 +32,12 @@ pub struct BaseTunables {
 
     /// The size in bytes of the offset guard for dynamic heaps.
     pub dynamic_memory_offset_guard_size: u64,
+
+    /// The kind of pages to back linear memories with. Large memories
+    /// accessed randomly spend less time in TLB misses with huge pages.
+    /// [`Memory::page_backing`](crate::Memory::page_backing) tells
+    /// which kind has been obtained for a given memory.
+    pub memory_page_backing: PageBacking,
 }
 
 impl BaseTunables {
@@ -63,6 +72,7 @@ impl BaseTunables {
             static_memory_bound,
             static_memory_offset_guard_size,
             dynamic_memory_offset_guard_size,
+            memory_page_backing: PageBacking::Base,
         }
     }
 }
@@ -73,8 +83,10 @@ impl Tunables for BaseTunables {
         // A heap with a maximum that doesn't exceed the static memory bound specified by the
         // tunables make it static.
         //
-        // If the module doesn't declare an explicit maximum treat it as 4GiB.
-        let maximum = memory.maximum.unwrap_or_else(Pages::max_value);
+        // If the module doesn't declare an explicit maximum treat it as 4GiB, or as the
+        // whole 64-bit index space for a 64-bit memory, which is always dynamic then:
+        // its bounds must be checked explicitly anyway.
+        let maximum = memory.maximum.unwrap_or_else(|| memory.page_limit());
         if maximum <= self.static_memory_bound {
             MemoryStyle::Static {
                 // Bound can be larger than the maximum for performance reasons
@@ -99,7 +111,11 @@ impl Tunables for BaseTunables {
         ty: &MemoryType,
         style: &MemoryStyle,
     ) -> Result<Arc<dyn Memory>, MemoryError> {
-        Ok(Arc::new(LinearMemory::new(ty, style)?))
+        Ok(Arc::new(LinearMemory::new_with_backing(
+            ty,
+            style,
+            self.memory_page_backing,
+        )?))
     }
 
     /// Create a memory owned by the VM given a [`MemoryType`] and a [`MemoryStyle`].
@@ -113,10 +129,11 @@ impl Tunables for BaseTunables {
         style: &MemoryStyle,
         vm_definition_location: NonNull<VMMemoryDefinition>,
     ) -> Result<Arc<dyn Memory>, MemoryError> {
-        Ok(Arc::new(LinearMemory::from_definition(
+        Ok(Arc::new(LinearMemory::from_definition_with_backing(
             ty,
             style,
             vm_definition_location,
+            self.memory_page_backing,
         )?))
     }
 
@@ -148,6 +165,421 @@ impl Tunables for BaseTunables {
     }
 }
 
+/// Tunables that allocate instances and their memories from a
+/// [`PoolingAllocator`], and otherwise behave like the wrapped
+/// [`BaseTunables`].
+///
+/// All the slots of the pool are reserved up front and recycled as
+/// instances are dropped, which makes instantiating short-lived
+/// instances much cheaper. See [`PoolingAllocator`] for the details.
+///
+/// # Example
+///
+/// ```
+/// # use wasmer::{imports, Instance, Module, PoolingTunables, Store};
+/// let engine = Store::default().engine().clone();
+/// let tunables = PoolingTunables::for_target(engine.target(), 10).unwrap();
+/// let store = Store::new_with_tunables(&*engine, tunables.clone());
+///
+/// let module = Module::new(&store, "(module (memory 1))").unwrap();
+///
+/// for _ in 0..100 {
+///     let _instance = Instance::new(&module, &imports! {}).unwrap();
+///     assert_eq!(tunables.stats().instances_in_use, 1);
+/// }
+///
+/// assert_eq!(tunables.stats().instance_fallbacks, 0);
+/// ```
+#[derive(Clone, MemoryUsage)]
+pub struct PoolingTunables {
+    base: BaseTunables,
+    #[loupe(skip)]
+    pool: PoolingAllocator,
+}
+
+impl PoolingTunables {
+    /// Creates new `PoolingTunables` wrapping `base`, with a pool
+    /// configured by `config`.
+    pub fn new(base: BaseTunables, config: PoolingConfig) -> Result<Self, String> {
+        Ok(Self {
+            base,
+            pool: PoolingAllocator::new(config)?,
+        })
+    }
+
+    /// Creates new `PoolingTunables` for a specific `Target`, with
+    /// `max_instances` instance slots and as many memory slots. The
+    /// memory slots are large enough for the static memories of the
+    /// [`BaseTunables`] of this target.
+    pub fn for_target(target: &Target, max_instances: usize) -> Result<Self, String> {
+        let base = BaseTunables::for_target(target);
+        let config = PoolingConfig {
+            max_instances,
+            max_memories: max_instances,
+            // One more page, so that the reservation is strictly
+            // smaller than the slot.
+            memory_slot_size: (base.static_memory_bound.bytes().0 as u64
+                + base.static_memory_offset_guard_size
+                + WASM_PAGE_SIZE as u64) as usize,
+            ..PoolingConfig::default()
+        };
+
+        Self::new(base, config)
+    }
+
+    /// Returns the occupancy statistics of the pool.
+    pub fn stats(&self) -> PoolingStats {
+        self.pool.stats()
+    }
+}
+
+impl Tunables for PoolingTunables {
+    fn memory_style(&self, memory: &MemoryType) -> MemoryStyle {
+        self.base.memory_style(memory)
+    }
+
+    fn table_style(&self, table: &TableType) -> TableStyle {
+        self.base.table_style(table)
+    }
+
+    fn create_host_memory(
+        &self,
+        ty: &MemoryType,
+        style: &MemoryStyle,
+    ) -> Result<Arc<dyn Memory>, MemoryError> {
+        self.base.create_host_memory(ty, style)
+    }
+
+    /// Create a memory owned by the VM in a slot of the pool.
+    ///
+    /// # Safety
+    /// - `vm_definition_location` must point to a valid, owned `VMMemoryDefinition`,
+    ///   for example in `VMContext`.
+    unsafe fn create_vm_memory(
+        &self,
+        ty: &MemoryType,
+        style: &MemoryStyle,
+        vm_definition_location: NonNull<VMMemoryDefinition>,
+    ) -> Result<Arc<dyn Memory>, MemoryError> {
+        Ok(Arc::new(self.pool.create_vm_memory(
+            ty,
+            style,
+            vm_definition_location,
+        )?))
+    }
+
+    fn create_host_table(
+        &self,
+        ty: &TableType,
+        style: &TableStyle,
+    ) -> Result<Arc<dyn Table>, String> {
+        self.base.create_host_table(ty, style)
+    }
+
+    unsafe fn create_vm_table(
+        &self,
+        ty: &TableType,
+        style: &TableStyle,
+        vm_definition_location: NonNull<VMTableDefinition>,
+    ) -> Result<Arc<dyn Table>, String> {
+        self.base.create_vm_table(ty, style, vm_definition_location)
+    }
+
+    /// Allocate the instance data in a slot of the pool.
+    fn allocate_instance(
+        &self,
+        module: &ModuleInfo,
+    ) -> (
+        InstanceAllocator,
+        Vec<NonNull<VMMemoryDefinition>>,
+        Vec<NonNull<VMTableDefinition>>,
+    ) {
+        self.pool.allocate_instance(module)
+    }
+}
+
+/// Tunables that behave like the wrapped [`BaseTunables`] until the
+/// memories they created reserve a given budget of address space, and
+/// then give the memories of the modules compiled afterwards a dynamic
+/// style.
+///
+/// A static memory reserves its whole bound and offset guard, which is
+/// 6 GiB by default on 64-bit targets: a few tens of thousands of
+/// them exhaust the address space. A dynamic memory only reserves its
+/// current size and a small guard, at the cost of explicit bounds
+/// checks.
+///
+/// The style of a memory is compiled in the code of its module, so the
+/// decision is taken when a module is compiled, from the address space
+/// reserved by the live memories at that time. The instances of a
+/// module compiled with static memories can't switch to dynamic ones:
+/// once the budget is reached, their instantiation fails with a
+/// [`MemoryError::Region`] instead of exhausting the address space, and
+/// compiling the module again gives it dynamic memories. Dynamic
+/// memories are charged to the budget, but never refused.
+/// [`Memory::style`](crate::Memory::style) tells the style chosen for a
+/// given memory.
+///
+/// The clones of `AdaptiveTunables` share their budget.
+///
+/// # Example
+///
+/// ```
+/// # use wasmer::{imports, Instance, Module, AdaptiveTunables, Store};
+/// let engine = Store::default().engine().clone();
+/// // No room for a static memory.
+/// let tunables = AdaptiveTunables::for_target(engine.target(), 1 << 30);
+/// let store = Store::new_with_tunables(&*engine, tunables.clone());
+///
+/// let module = Module::new(&store, "(module (memory 1))").unwrap();
+/// let _instance = Instance::new(&module, &imports! {}).unwrap();
+///
+/// assert_eq!(tunables.stats().dynamic_memories, 1);
+/// assert!(tunables.stats().reserved_bytes < 1 << 30);
+/// ```
+#[derive(Clone, MemoryUsage)]
+pub struct AdaptiveTunables {
+    base: BaseTunables,
+    reservation_budget: usize,
+    #[loupe(skip)]
+    counters: Arc<AdaptiveCounters>,
+}
+
+#[derive(Debug, Default)]
+struct AdaptiveCounters {
+    reserved_bytes: AtomicUsize,
+    static_memories: AtomicUsize,
+    dynamic_memories: AtomicUsize,
+    refused_memories: AtomicUsize,
+}
+
+/// The address space used by an [`AdaptiveTunables`], and the memories
+/// it created, see [`AdaptiveTunables::stats`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AdaptiveStats {
+    /// The budget of address space, in bytes.
+    pub reservation_budget: usize,
+    /// The address space reserved by the live memories, in bytes.
+    pub reserved_bytes: usize,
+    /// The number of memories created with a static style.
+    pub static_memories: usize,
+    /// The number of memories created with a dynamic style instead of
+    /// the static style of the [`BaseTunables`], because of the budget.
+    pub dynamic_memories: usize,
+    /// The number of static memories refused, because their reservation
+    /// would have exceeded the budget.
+    pub refused_memories: usize,
+}
+
+impl AdaptiveTunables {
+    /// Creates new `AdaptiveTunables` wrapping `base`, whose memories
+    /// reserve at most `reservation_budget` bytes of address space
+    /// before the next modules get dynamic memories.
+    pub fn new(base: BaseTunables, reservation_budget: usize) -> Self {
+        Self {
+            base,
+            reservation_budget,
+            counters: Arc::new(AdaptiveCounters::default()),
+        }
+    }
+
+    /// Creates new `AdaptiveTunables` wrapping the [`BaseTunables`] of
+    /// a specific `Target`.
+    pub fn for_target(target: &Target, reservation_budget: usize) -> Self {
+        Self::new(BaseTunables::for_target(target), reservation_budget)
+    }
+
+    /// Returns the address space used, and the memories created so far.
+    pub fn stats(&self) -> AdaptiveStats {
+        AdaptiveStats {
+            reservation_budget: self.reservation_budget,
+            reserved_bytes: self.counters.reserved_bytes.load(Ordering::Relaxed),
+            static_memories: self.counters.static_memories.load(Ordering::Relaxed),
+            dynamic_memories: self.counters.dynamic_memories.load(Ordering::Relaxed),
+            refused_memories: self.counters.refused_memories.load(Ordering::Relaxed),
+        }
+    }
+
+    /// Charge the reservation of a memory of type `ty` and style `style`
+    /// to the budget, before the memory is created. A static memory is
+    /// refused past the budget, since its reservation can't shrink.
+    fn reserve(&self, ty: &MemoryType, style: &MemoryStyle) -> Result<Reservation, MemoryError> {
+        let bytes = reservation_size(ty, style);
+        let is_static = matches!(style, MemoryStyle::Static { .. });
+
+        let charged = self.counters.reserved_bytes.fetch_update(
+            Ordering::Relaxed,
+            Ordering::Relaxed,
+            |reserved| {
+                reserved
+                    .checked_add(bytes)
+                    .filter(|&total| !is_static || total <= self.reservation_budget)
+            },
+        );
+        if let Err(reserved) = charged {
+            self.counters
+                .refused_memories
+                .fetch_add(1, Ordering::Relaxed);
+            return Err(MemoryError::Region(format!(
+                "a static memory would reserve {} bytes of address space, with {} bytes \
+                 reserved already, past the reservation budget of {} bytes; compile the \
+                 module again to give it dynamic memories",
+                bytes, reserved, self.reservation_budget
+            )));
+        }
+
+        if is_static {
+            self.counters
+                .static_memories
+                .fetch_add(1, Ordering::Relaxed);
+        } else if let MemoryStyle::Static { .. } = self.base.memory_style(ty) {
+            self.counters
+                .dynamic_memories
+                .fetch_add(1, Ordering::Relaxed);
+        }
+
+        Ok(Reservation {
+            bytes,
+            counters: self.counters.clone(),
+        })
+    }
+}
+
+impl Tunables for AdaptiveTunables {
+    /// Get the `MemoryStyle` of the [`BaseTunables`], unless it's static
+    /// and its reservation would exceed the budget, in which case it's
+    /// dynamic.
+    fn memory_style(&self, memory: &MemoryType) -> MemoryStyle {
+        let style = self.base.memory_style(memory);
+
+        if let MemoryStyle::Dynamic { .. } = style {
+            return style;
+        }
+
+        let reserved_bytes = self.counters.reserved_bytes.load(Ordering::Relaxed);
+        let within_budget = reserved_bytes
+            .checked_add(reservation_size(memory, &style))
+            .map_or(false, |total| total <= self.reservation_budget);
+
+        if within_budget {
+            style
+        } else {
+            MemoryStyle::Dynamic {
+                offset_guard_size: self.base.dynamic_memory_offset_guard_size,
+            }
+        }
+    }
+
+    fn table_style(&self, table: &TableType) -> TableStyle {
+        self.base.table_style(table)
+    }
+
+    fn create_host_memory(
+        &self,
+        ty: &MemoryType,
+        style: &MemoryStyle,
+    ) -> Result<Arc<dyn Memory>, MemoryError> {
+        let reservation = self.reserve(ty, style)?;
+        Ok(Arc::new(BudgetedMemory {
+            memory: self.base.create_host_memory(ty, style)?,
+            reservation,
+        }))
+    }
+
+    /// Create a memory owned by the VM, whose reservation is charged to
+    /// the budget. A static memory is refused past the budget.
+    ///
+    /// # Safety
+    /// - `vm_definition_location` must point to a valid, owned `VMMemoryDefinition`,
+    ///   for example in `VMContext`.
+    unsafe fn create_vm_memory(
+        &self,
+        ty: &MemoryType,
+        style: &MemoryStyle,
+        vm_definition_location: NonNull<VMMemoryDefinition>,
+    ) -> Result<Arc<dyn Memory>, MemoryError> {
+        let reservation = self.reserve(ty, style)?;
+        Ok(Arc::new(BudgetedMemory {
+            memory: self
+                .base
+                .create_vm_memory(ty, style, vm_definition_location)?,
+            reservation,
+        }))
+    }
+
+    fn create_host_table(
+        &self,
+        ty: &TableType,
+        style: &TableStyle,
+    ) -> Result<Arc<dyn Table>, String> {
+        self.base.create_host_table(ty, style)
+    }
+
+    unsafe fn create_vm_table(
+        &self,
+        ty: &TableType,
+        style: &TableStyle,
+        vm_definition_location: NonNull<VMTableDefinition>,
+    ) -> Result<Arc<dyn Table>, String> {
+        self.base.create_vm_table(ty, style, vm_definition_location)
+    }
+}
+
+/// Address space charged to the budget of an [`AdaptiveTunables`] until
+/// it's dropped.
+#[derive(Debug)]
+struct Reservation {
+    bytes: usize,
+    counters: Arc<AdaptiveCounters>,
+}
+
+impl Drop for Reservation {
+    fn drop(&mut self) {
+        self.counters
+            .reserved_bytes
+            .fetch_sub(self.bytes, Ordering::Relaxed);
+    }
+}
+
+/// A memory whose reservation is charged to the budget of an
+/// [`AdaptiveTunables`] until it's dropped.
+#[derive(Debug, MemoryUsage)]
+struct BudgetedMemory {
+    memory: Arc<dyn Memory>,
+    #[loupe(skip)]
+    reservation: Reservation,
+}
+
+impl Memory for BudgetedMemory {
+    fn ty(&self) -> MemoryType {
+        self.memory.ty()
+    }
+
+    fn style(&self) -> &MemoryStyle {
+        self.memory.style()
+    }
+
+    fn size(&self) -> Pages {
+        self.memory.size()
+    }
+
+    fn grow(&self, delta: Pages) -> Result<Pages, MemoryError> {
+        self.memory.grow(delta)
+    }
+
+    fn vmmemory(&self) -> NonNull<VMMemoryDefinition> {
+        self.memory.vmmemory()
+    }
+
+    unsafe fn map_image(&self, image: &MemoryImage) -> Result<bool, MemoryError> {
+        self.memory.map_image(image)
+    }
+
+    fn page_backing(&self) -> PageBacking {
+        self.memory.page_backing()
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -158,6 +590,7 @@ mod tests {
             static_memory_bound: Pages(2048),
             static_memory_offset_guard_size: 128,
             dynamic_memory_offset_guard_size: 256,
+            memory_page_backing: PageBacking::Base,
         };
 
         // No maximum
@@ -190,4 +623,56 @@ mod tests {
             s => panic!("Unexpected memory style: {:?}", s),
         }
     }
+
+    #[test]
+    fn adaptive_memory_style() {
+        let base = BaseTunables {
+            static_memory_bound: Pages(2048),
+            static_memory_offset_guard_size: 128,
+            dynamic_memory_offset_guard_size: 256,
+            memory_page_backing: PageBacking::Base,
+        };
+        // Room for a single static memory.
+        let tunables = AdaptiveTunables::new(base, Pages(2048).bytes().0 + 128);
+        let requested = MemoryType::new(3, Some(16), false);
+
+        let static_style = tunables.memory_style(&requested);
+        assert!(matches!(static_style, MemoryStyle::Static { .. }));
+        let memory = tunables
+            .create_host_memory(&requested, &static_style)
+            .unwrap();
+        assert_eq!(tunables.stats().reserved_bytes, Pages(2048).bytes().0 + 128);
+
+        // Past the budget.
+        let dynamic_style = tunables.memory_style(&requested);
+        match dynamic_style {
+            MemoryStyle::Dynamic { offset_guard_size } => assert_eq!(offset_guard_size, 256),
+            s => panic!("Unexpected memory style: {:?}", s),
+        }
+
+        // A module compiled with a static memory before can't be given
+        // another one, but a dynamic memory is still given.
+        match tunables.create_host_memory(&requested, &static_style) {
+            Err(MemoryError::Region(_)) => {}
+            _ => panic!("a static memory was given past the budget"),
+        }
+        let dynamic_memory = tunables
+            .create_host_memory(&requested, &dynamic_style)
+            .unwrap();
+        assert!(tunables.stats().reserved_bytes > Pages(2048).bytes().0 + 128);
+
+        // The reservation is given back with the memory.
+        drop(memory);
+        drop(dynamic_memory);
+        assert_eq!(tunables.stats().reserved_bytes, 0);
+        assert!(matches!(
+            tunables.memory_style(&requested),
+            MemoryStyle::Static { .. }
+        ));
+
+        let stats = tunables.stats();
+        assert_eq!(stats.static_memories, 1);
+        assert_eq!(stats.dynamic_memories, 1);
+        assert_eq!(stats.refused_memories, 1);
+    }
 }
@@ -142,6 +142,7 @@ mod js {
             shared: false,
             minimum: Pages(0),
             maximum: Some(Pages(10)),
+            memory64: false,
         };
         let memory = Memory::new(&store, memory_type).unwrap();
         assert_eq!(memory.size(), Pages(0));
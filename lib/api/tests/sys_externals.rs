@@ -143,6 +143,7 @@ mod sys {
             shared: false,
             minimum: Pages(0),
             maximum: Some(Pages(10)),
+            memory64: false,
         };
         let memory = Memory::new(&store, memory_type)?;
         assert_eq!(memory.size(), Pages(0));
@@ -179,6 +180,141 @@ mod sys {
         Ok(())
     }
 
+    #[test]
+    fn shared_memory_grows_in_place() -> Result<()> {
+        let store = Store::default();
+
+        let memory = Memory::new(&store, MemoryType::new(Pages(1), Some(Pages(100)), true))?;
+        let base = memory.data_ptr();
+
+        assert_eq!(memory.grow(Pages(50))?, Pages(1));
+        assert_eq!(memory.size(), Pages(51));
+        assert_eq!(memory.data_ptr(), base);
+
+        // A shared memory must have a maximum.
+        let bad_result = Memory::new(&store, MemoryType::new(Pages(1), None, true));
+        assert!(matches!(bad_result, Err(MemoryError::InvalidMemory { .. })));
+
+        Ok(())
+    }
+
+    #[cfg(feature = "cranelift")]
+    #[test]
+    fn shared_memory_atomic_wait_notify() -> Result<()> {
+        let mut features = Features::new();
+        features.threads(true);
+        let store = Store::new(
+            &Universal::new(Cranelift::default())
+                .features(features)
+                .engine(),
+        );
+        let module = Module::new(
+            &store,
+            r#"
+(module
+  (import "env" "memory" (memory 1 1 shared))
+  (func (export "wait") (result i32)
+    (memory.atomic.wait32 (i32.const 0) (i32.const 0) (i64.const -1)))
+  (func (export "notify") (result i32)
+    (memory.atomic.notify (i32.const 0) (i32.const 1))))
+"#,
+        )?;
+        let memory = Memory::new(&store, MemoryType::new(Pages(1), Some(Pages(1)), true))?;
+
+        // Each thread has its own instance, importing the same memory.
+        let waiter = {
+            let module = module.clone();
+            let memory = memory.clone();
+
+            std::thread::spawn(move || -> Result<i32> {
+                let instance = Instance::new(
+                    &module,
+                    &imports! {
+                        "env" => {
+                            "memory" => memory,
+                        },
+                    },
+                )?;
+                let wait: NativeFunc<(), i32> = instance.exports.get_native_function("wait")?;
+
+                Ok(wait.call()?)
+            })
+        };
+
+        let instance = Instance::new(
+            &module,
+            &imports! {
+                "env" => {
+                    "memory" => memory,
+                },
+            },
+        )?;
+        let notify: NativeFunc<(), i32> = instance.exports.get_native_function("notify")?;
+
+        // Notify until the waiter has started waiting, and is woken up.
+        while notify.call()? == 0 {
+            std::thread::yield_now();
+        }
+
+        assert_eq!(waiter.join().unwrap()?, 0);
+
+        Ok(())
+    }
+
+    #[cfg(feature = "cranelift")]
+    #[test]
+    fn memory64_access_and_grow() -> Result<()> {
+        let mut features = Features::new();
+        features.memory64(true);
+        let store = Store::new(
+            &Universal::new(Cranelift::default())
+                .features(features)
+                .engine(),
+        );
+        let module = Module::new(
+            &store,
+            r#"
+(module
+  (memory (export "memory") i64 1)
+  (func (export "store") (param i64 i32)
+    (i32.store (local.get 0) (local.get 1)))
+  (func (export "load") (param i64) (result i32)
+    (i32.load (local.get 0)))
+  (func (export "load_far") (param i64) (result i32)
+    (i32.load offset=0x100000000 (local.get 0)))
+  (func (export "grow") (param i64) (result i64)
+    (memory.grow (local.get 0)))
+  (func (export "size") (result i64)
+    (memory.size)))
+"#,
+        )?;
+        let instance = Instance::new(&module, &imports! {})?;
+        let memory = instance.exports.get_memory("memory")?;
+        assert!(memory.ty().memory64);
+
+        let store_fn: NativeFunc<(i64, i32), ()> = instance.exports.get_native_function("store")?;
+        let load: NativeFunc<i64, i32> = instance.exports.get_native_function("load")?;
+        let load_far: NativeFunc<i64, i32> = instance.exports.get_native_function("load_far")?;
+        let grow: NativeFunc<i64, i64> = instance.exports.get_native_function("grow")?;
+        let size: NativeFunc<(), i64> = instance.exports.get_native_function("size")?;
+
+        store_fn.call(65532, 42)?;
+        assert_eq!(load.call(65532)?, 42);
+        assert!(load.call(65536).is_err());
+        assert!(load.call(1 << 40).is_err());
+        assert!(load.call(-1).is_err());
+        assert!(load_far.call(0).is_err());
+        assert!(load_far.call(-1).is_err());
+
+        assert_eq!(grow.call(1)?, 1);
+        assert_eq!(size.call()?, 2);
+        assert_eq!(load.call(65536)?, 0);
+        assert_eq!(grow.call(1 << 40)?, -1);
+        assert_eq!(size.call()?, 2);
+
+        Ok(())
+    }
+
     #[test]
     fn function_new() -> Result<()> {
         let store = Store::default();
@@ -382,6 +518,114 @@ mod sys {
         Ok(())
     }
 
+    fn batch_instance(store: &Store) -> Result<Instance> {
+        let module = Module::new(
+            store,
+            r#"(module
+  (global $calls (export "calls") (mut i32) (i32.const 0))
+  (func (export "div") (param i32 i32) (result i32)
+    (global.set $calls (i32.add (global.get $calls) (i32.const 1)))
+    (i32.div_s (local.get 0) (local.get 1))))
+"#,
+        )?;
+        Ok(Instance::new(&module, &imports! {})?)
+    }
+
+    #[test]
+    fn function_call_batch() -> Result<()> {
+        let store = Store::default();
+        let instance = batch_instance(&store)?;
+        let div = instance.exports.get_function("div")?;
+        let calls = instance.exports.get_global("calls")?;
+
+        let results = div.call_batch(&[
+            &[Value::I32(6), Value::I32(3)],
+            &[Value::I32(8), Value::I32(2)],
+            &[Value::I32(-9), Value::I32(3)],
+        ])?;
+        assert_eq!(
+            results.iter().map(|r| r.to_vec()).collect::<Vec<_>>(),
+            vec![
+                vec![Value::I32(2)],
+                vec![Value::I32(4)],
+                vec![Value::I32(-3)]
+            ]
+        );
+        assert_eq!(calls.get(), Value::I32(3));
+        assert!(div.call_batch(&[])?.is_empty());
+
+        // The batch stops at the call that traps.
+        let error = div
+            .call_batch(&[
+                &[Value::I32(6), Value::I32(3)],
+                &[Value::I32(1), Value::I32(0)],
+                &[Value::I32(8), Value::I32(2)],
+            ])
+            .unwrap_err();
+        assert_eq!(error.index, 1);
+        assert_eq!(calls.get(), Value::I32(5));
+
+        // The parameters are all checked before any call.
+        let error = div
+            .call_batch(&[&[Value::I32(6), Value::I32(3)], &[Value::I32(1)]])
+            .unwrap_err();
+        assert_eq!(error.index, 1);
+        let error = div
+            .call_batch(&[&[Value::I32(6), Value::I64(3)]])
+            .unwrap_err();
+        assert_eq!(error.index, 0);
+        assert_eq!(calls.get(), Value::I32(5));
+
+        Ok(())
+    }
+
+    #[test]
+    fn function_call_raw_batch() -> Result<()> {
+        let store = Store::default();
+        let instance = batch_instance(&store)?;
+        let div = instance.exports.get_function("div")?;
+
+        let params = [(42, 2), (42, 1), (42, 0), (42, 3)];
+        let mut results = vec![];
+        let error = unsafe {
+            div.call_raw_batch(
+                params.len(),
+                |index, slots| {
+                    *slots = params[index].0 as i128;
+                    *slots.add(1) = params[index].1 as i128;
+                },
+                |_, slots| results.push(*slots as i32),
+            )
+        }
+        .unwrap_err();
+        assert_eq!(error.index, 2);
+        assert_eq!(results, vec![21, 42]);
+
+        Ok(())
+    }
+
+    #[test]
+    fn native_function_call_batch() -> Result<()> {
+        let store = Store::default();
+        let instance = batch_instance(&store)?;
+        let div: NativeFunc<(i32, i32), i32> = instance.exports.get_native_function("div")?;
+
+        assert_eq!(div.call_batch(vec![(6, 3), (8, 2)])?, vec![2, 4]);
+        assert!(div.call_batch(vec![])?.is_empty());
+
+        let error = div.call_batch(vec![(6, 3), (8, 2), (1, 0)]).unwrap_err();
+        assert_eq!(error.index, 2);
+
+        // Host functions are called one after the other.
+        let function = Function::new_native(&store, |a: i32| -> i32 { a * 2 });
+        let native_function: NativeFunc<i32, i32> = function.native()?;
+        assert_eq!(native_function.call_batch(vec![1, 2, 3])?, vec![2, 4, 6]);
+        let results = function.call_batch(&[&[Value::I32(5)], &[Value::I32(6)]])?;
+        assert_eq!(results[1].to_vec(), vec![Value::I32(12)]);
+
+        Ok(())
+    }
+
     #[test]
     fn function_outlives_instance() -> Result<()> {
         let store = Store::default();
@@ -464,4 +708,81 @@ mod sys {
 
         Ok(())
     }
+
+    #[test]
+    fn async_host_function_suspends_call() -> Result<()> {
+        use std::future::Future;
+        use std::sync::atomic::{AtomicBool, Ordering};
+        use std::sync::Arc;
+        use std::task::{Context, Poll};
+
+        let store = Store::default();
+        let module = Module::new(
+            &store,
+            r#"
+(module
+  (import "env" "wait" (func $wait (param i32) (result i32)))
+  (func (export "run") (param i32) (result i32)
+    (i32.add (call $wait (local.get 0)) (i32.const 1))))
+"#,
+        )?;
+
+        // The future of `wait` is pending until `ready` is set.
+        let ready = Arc::new(AtomicBool::new(false));
+        let wait = Function::new_async(
+            &store,
+            FunctionType::new(vec![Type::I32], vec![Type::I32]),
+            {
+                let ready = ready.clone();
+                move |args| {
+                    let value = args[0].unwrap_i32();
+                    let ready = ready.clone();
+
+                    futures::future::poll_fn(move |_| {
+                        if ready.load(Ordering::SeqCst) {
+                            Poll::Ready(Ok(vec![Value::I32(value * 2)]))
+                        } else {
+                            Poll::Pending
+                        }
+                    })
+                }
+            },
+        );
+
+        let instance = Instance::new(
+            &module,
+            &imports! {
+                "env" => {
+                    "wait" => wait,
+                },
+            },
+        )?;
+        let run = instance.exports.get_function("run")?;
+
+        let waker = futures::task::noop_waker();
+        let mut cx = Context::from_waker(&waker);
+
+        // The call is suspended until the future is ready.
+        let mut call = Box::pin(run.call_async(&[Value::I32(20)]));
+        assert!(call.as_mut().poll(&mut cx).is_pending());
+        assert!(call.as_mut().poll(&mut cx).is_pending());
+
+        ready.store(true, Ordering::SeqCst);
+        match call.as_mut().poll(&mut cx) {
+            Poll::Ready(results) => assert_eq!(results?.to_vec(), vec![Value::I32(41)]),
+            Poll::Pending => panic!("the call should have completed"),
+        }
+
+        // A suspended call can be dropped.
+        ready.store(false, Ordering::SeqCst);
+        let mut call = Box::pin(run.call_async(&[Value::I32(1)]));
+        assert!(call.as_mut().poll(&mut cx).is_pending());
+        drop(call);
+
+        // A synchronous call blocks on the future instead.
+        ready.store(true, Ordering::SeqCst);
+        assert_eq!(run.call(&[Value::I32(1)])?.to_vec(), vec![Value::I32(3)]);
+
+        Ok(())
+    }
 }
@@ -40,6 +40,79 @@ mod sys {
         Ok(())
     }
 
+    #[test]
+    fn signatures_outlive_the_module_while_its_functions_are_referenced() -> Result<()> {
+        let store = Store::default();
+        let module = Module::new(
+            &store,
+            "
+    (module
+      (func (export \"double\") (param i32) (result i32)
+        local.get 0
+        i32.const 2
+        i32.mul))
+",
+        )?;
+        let instance = Instance::new(&module, &imports! {})?;
+        let double = instance.exports.get_function("double")?.clone();
+
+        let table_module = Module::new(&store, "(module (table (export \"table\") 1 funcref))")?;
+        let table_instance = Instance::new(&table_module, &imports! {})?;
+        let table = table_instance.exports.get_table("table")?;
+        table.set(0, Val::FuncRef(Some(double)))?;
+
+        // Only the function in the table is left of the module.
+        drop(instance);
+        drop(module);
+
+        // Register enough other signatures for one of them to reuse the
+        // index of the signature of the function, if it was released.
+        let signatures = 64;
+        let mut wat = String::from("(module (import \"env\" \"table\" (table 1 funcref))");
+        for params in 0..signatures {
+            wat.push_str(&format!(
+                "(type $t{0} (func (param{1}) (result i32)))
+                 (func (export \"call{0}\") (result i32)
+                   {2} i32.const 0 call_indirect (type $t{0}))",
+                params,
+                " i64".repeat(params),
+                "i64.const 0 ".repeat(params),
+            ));
+        }
+        wat.push(')');
+        let module = Module::new(&store, wat)?;
+        let instance = Instance::new(
+            &module,
+            &imports! {
+                "env" => {
+                    "table" => table.clone(),
+                },
+            },
+        )?;
+
+        // None of them matches the signature of the function.
+        for params in 0..signatures {
+            let call = instance.exports.get_function(&format!("call{}", params))?;
+            let error = call.call(&[]).unwrap_err();
+            assert_eq!(error.message(), "indirect call type mismatch");
+        }
+
+        let double = match table.get(0) {
+            Some(Val::FuncRef(Some(double))) => double,
+            _ => panic!("the table lost the function"),
+        };
+        assert_eq!(
+            double.ty(),
+            &FunctionType::new(vec![Type::I32], vec![Type::I32]),
+        );
+        assert_eq!(
+            double.call(&[Value::I32(21)])?.into_vec(),
+            vec![Value::I32(42)],
+        );
+
+        Ok(())
+    }
+
     #[test]
     fn unit_native_function_env() -> Result<()> {
         let store = Store::default();
@@ -67,4 +140,109 @@ mod sys {
 
         Ok(())
     }
+
+    #[test]
+    fn store_stack_size() -> Result<()> {
+        let store = Store::default();
+        let module = Module::new(
+            &store,
+            "
+    (module
+      (func $depth (export \"depth\") (param $n i32) (result i32)
+        local.get $n
+        i32.eqz
+        if
+          i32.const 0
+          return
+        end
+        local.get $n
+        i32.const 1
+        i32.sub
+        call $depth
+        i32.const 1
+        i32.add))
+",
+        )?;
+
+        let import_object = ImportObject::new();
+        let instance = Instance::new(&module, &import_object)?;
+        let depth = instance.exports.get_function("depth")?;
+
+        assert_eq!(store.stack_size(), vm::DEFAULT_STACK_SIZE);
+        assert_eq!(
+            depth.call(&[Value::I32(2000)])?.into_vec(),
+            vec![Value::I32(2000)],
+        );
+
+        // The same recursion overflows a much smaller stack.
+        store.set_stack_size(64 * 1024);
+        assert!(depth.call(&[Value::I32(2000)]).is_err());
+
+        // The stacks are reused from one call to the next.
+        let before = vm::stack_pool_stats();
+        depth.call(&[Value::I32(1)])?;
+        depth.call(&[Value::I32(1)])?;
+        let after = vm::stack_pool_stats();
+        assert!(after.reuses() > before.reuses());
+
+        Ok(())
+    }
+
+    #[test]
+    fn instance_snapshot() -> Result<()> {
+        let store = Store::default();
+        let module = Module::new(
+            &store,
+            "
+    (module
+      (memory (export \"memory\") 2)
+      (table $table 1 funcref)
+      (global $counter (export \"counter\") (mut i32) (i32.const 0))
+      (type $get (func (result i32)))
+      (func $forty_two (result i32) i32.const 42)
+      (elem declare func $forty_two)
+      (func (export \"initialize\")
+        (i32.store (i32.const 0x1_0000) (i32.const 7))
+        (drop (memory.grow (i32.const 1)))
+        (i32.store (i32.const 0x2_0000) (i32.const 9))
+        (table.set $table (i32.const 0) (ref.func $forty_two))
+        (global.set $counter (i32.const 1)))
+      (func (export \"get\") (result i32)
+        (call_indirect (type $get) (i32.const 0))))
+",
+        )?;
+
+        let import_object = ImportObject::new();
+        let instance = Instance::new(&module, &import_object)?;
+        instance.exports.get_function("initialize")?.call(&[])?;
+        let snapshot = instance.snapshot()?;
+
+        let first = Instance::from_snapshot(&snapshot, &import_object)?;
+        let second = Instance::from_snapshot(&snapshot, &import_object)?;
+
+        for forked in &[&first, &second] {
+            let memory = forked.exports.get_memory("memory")?;
+            assert_eq!(memory.size(), Pages(3));
+            assert_eq!(memory.view::<u32>()[0x1_0000 / 4].get(), 7);
+            assert_eq!(memory.view::<u32>()[0x2_0000 / 4].get(), 9);
+            assert_eq!(forked.exports.get_global("counter")?.get(), Value::I32(1));
+            assert_eq!(
+                forked.exports.get_function("get")?.call(&[])?.into_vec(),
+                vec![Value::I32(42)],
+            );
+        }
+
+        // The forked instances don't share their memories.
+        first.exports.get_memory("memory")?.view::<u32>()[0x1_0000 / 4].set(8);
+        assert_eq!(
+            second.exports.get_memory("memory")?.view::<u32>()[0x1_0000 / 4].get(),
+            7
+        );
+        assert_eq!(
+            instance.exports.get_memory("memory")?.view::<u32>()[0x1_0000 / 4].get(),
+            7
+        );
+
+        Ok(())
+    }
 }
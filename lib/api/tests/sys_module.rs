@@ -248,4 +248,84 @@ mod sys {
 
         Ok(())
     }
+
+    #[test]
+    fn module_streaming() -> Result<()> {
+        let store = Store::default();
+        let wasm = wat2wasm(
+            br#"(module $name
+    (func (export "add") (param i32 i32) (result i32)
+        (i32.add (local.get 0) (local.get 1)))
+    (data "x")
+)"#,
+        )?;
+        let mut stream = Module::streaming(&store)?;
+        for chunk in wasm.chunks(3) {
+            stream.write(chunk)?;
+        }
+        let module = stream.finish()?;
+        // The name is declared after the code section.
+        assert_eq!(module.name(), Some("name"));
+
+        let instance = Instance::new(&module, &imports! {})?;
+        let add: NativeFunc<(i32, i32), i32> = instance.exports.get_native_function("add")?;
+        assert_eq!(add.call(1, 2)?, 3);
+
+        let module = Module::from_reader(&store, &wasm[..])?;
+        assert_eq!(module.exports().count(), 1);
+
+        Ok(())
+    }
+
+    #[test]
+    fn module_streaming_leaves_the_engine_free() -> Result<()> {
+        let store = Store::default();
+        let wasm = wat2wasm(
+            br#"(module $name
+    (func (export "one") (result i32) (i32.const 1))
+    (data "x")
+)"#,
+        )?;
+        let (first, last) = wasm.split_at(wasm.len() - 1);
+        let mut stream = Module::streaming(&store)?;
+        stream.write(first)?;
+
+        // The engine compiles other modules while the stream waits for
+        // the rest of its bytes, on the thread writing them.
+        let other = Module::new(&store, r#"(module (func (export "two")))"#)?;
+        Module::validate(&store, &wasm)?;
+        let mut other_stream = Module::streaming(&store)?;
+        other_stream.write(&wasm)?;
+        let other_streamed = other_stream.finish()?;
+
+        stream.write(last)?;
+        let module = stream.finish()?;
+        assert_eq!(module.name(), Some("name"));
+        assert_eq!(other.exports().count(), 1);
+        assert_eq!(other_streamed.name(), Some("name"));
+
+        let instance = Instance::new(&module, &imports! {})?;
+        let one: NativeFunc<(), i32> = instance.exports.get_native_function("one")?;
+        assert_eq!(one.call()?, 1);
+
+        Ok(())
+    }
+
+    #[test]
+    fn module_streaming_fails_on_invalid_bytes() -> Result<()> {
+        let store = Store::default();
+        let mut wasm = wat2wasm(br#"(module (func (result i32) (i32.const 1)))"#)?.to_vec();
+        // Make the function return an `i64`.
+        let last = wasm.len() - 3;
+        assert_eq!(wasm[last], 0x41);
+        wasm[last] = 0x42;
+
+        let mut stream = Module::streaming(&store)?;
+        assert!(stream.write(&wasm).is_err());
+
+        let stream = Module::streaming(&store)?;
+        assert!(stream.finish().is_err());
+
+        Ok(())
+    }
 }
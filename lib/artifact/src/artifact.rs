@@ -109,7 +109,11 @@ pub struct MetadataHeader {
 impl MetadataHeader {
     /// Current ABI version. Increment this any time breaking changes are made
     /// to the format of the serialized data.
-    const CURRENT_VERSION: u32 = 1;
+    ///
+    /// Version 2 renumbered the libcalls and the builtin functions of the
+    /// `VMContext`, with the atomic wait and notify ones and the 64-bit
+    /// memory ones.
+    const CURRENT_VERSION: u32 = 2;
 
     /// Magic number to identify wasmer metadata.
     const MAGIC: [u8; 8] = *b"WASMER\0\0";
@@ -0,0 +1,110 @@
+//! Compare the cost of calling a function through the standard
+//! `wasm_func_call` and through the Wasmer-specific
+//! `wasmer_func_call_raw` and `wasmer_func_call_batch`.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use std::convert::TryFrom;
+
+use wasmer::wasm_c_api::engine::{wasm_engine_delete, wasm_engine_new};
+use wasmer::wasm_c_api::externals::{wasm_extern_as_func, wasm_extern_vec_t, wasm_func_call};
+use wasmer::wasm_c_api::instance::{wasm_instance_exports, wasm_instance_new};
+use wasmer::wasm_c_api::module::wasm_module_new;
+use wasmer::wasm_c_api::store::{wasm_store_delete, wasm_store_new};
+use wasmer::wasm_c_api::types::wasm_byte_vec_t;
+use wasmer::wasm_c_api::unstable::function::{
+    wasmer_func_call_batch, wasmer_func_call_handle_new, wasmer_func_call_raw, wasmer_raw_val_t,
+};
+use wasmer::wasm_c_api::value::{wasm_val_t, wasm_val_vec_t};
+use wasmer_api::Val;
+
+static ADD_WAT: &str = r#"(module
+    (func (export "add") (param i32 i32) (result i32)
+       (i32.add (local.get 0)
+                (local.get 1))))"#;
+
+fn run_func_call_benchmarks(c: &mut Criterion) {
+    unsafe {
+        let engine = wasm_engine_new();
+        let store = wasm_store_new(Some(&engine)).unwrap();
+
+        let wasm: wasm_byte_vec_t = wasmer_api::wat2wasm(ADD_WAT.as_bytes())
+            .unwrap()
+            .into_owned()
+            .into();
+        let module = wasm_module_new(Some(&store), Some(&wasm)).unwrap();
+
+        let imports: wasm_extern_vec_t = Vec::new().into();
+        let instance =
+            wasm_instance_new(Some(&store), Some(&module), Some(&imports), None).unwrap();
+
+        let mut exports: wasm_extern_vec_t = Vec::new().into();
+        wasm_instance_exports(&instance, &mut exports);
+        let add = wasm_extern_as_func(exports.as_slice()[0].as_deref()).unwrap();
+
+        c.bench_function("wasm_func_call", |b| {
+            let args: wasm_val_vec_t = vec![
+                wasm_val_t::try_from(Val::I32(4)).unwrap(),
+                wasm_val_t::try_from(Val::I32(6)).unwrap(),
+            ]
+            .into();
+            let mut results: wasm_val_vec_t =
+                vec![wasm_val_t::try_from(Val::I32(0)).unwrap()].into();
+
+            b.iter(|| {
+                let trap = wasm_func_call(Some(add), Some(black_box(&args)), &mut results);
+                assert!(trap.is_none());
+            })
+        });
+
+        let handle = wasmer_func_call_handle_new(Some(add), None).unwrap();
+
+        c.bench_function("wasmer_func_call_raw", |b| {
+            let mut slots = [wasmer_raw_val_t { i64: 0 }; 2];
+
+            b.iter(|| {
+                slots[0].i32 = 4;
+                slots[1].i32 = 6;
+
+                let trap =
+                    wasmer_func_call_raw(Some(&handle), black_box(slots.as_mut_ptr()), slots.len());
+                assert!(trap.is_none());
+                assert_eq!(slots[0].i32, 10);
+            })
+        });
+
+        const BATCH_SIZE: usize = 1000;
+
+        c.bench_function("wasmer_func_call_batch (1000 calls)", |b| {
+            let mut args = vec![wasmer_raw_val_t { i64: 0 }; 2 * BATCH_SIZE];
+            let mut results = vec![wasmer_raw_val_t { i64: 0 }; BATCH_SIZE];
+
+            for (index, row) in args.chunks_mut(2).enumerate() {
+                row[0].i32 = index as i32;
+                row[1].i32 = 6;
+            }
+
+            b.iter(|| {
+                let trap = wasmer_func_call_batch(
+                    Some(&handle),
+                    black_box(args.as_ptr()),
+                    results.as_mut_ptr(),
+                    BATCH_SIZE,
+                    None,
+                );
+                assert!(trap.is_none());
+                assert_eq!(results[BATCH_SIZE - 1].i32, BATCH_SIZE as i32 + 5);
+            })
+        });
+
+        drop(handle);
+        drop(exports);
+        drop(instance);
+        drop(module);
+        wasm_store_delete(Some(store));
+        wasm_engine_delete(Some(engine));
+    }
+}
+
+criterion_group!(benches, run_func_call_benchmarks);
+
+criterion_main!(benches);
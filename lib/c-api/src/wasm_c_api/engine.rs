@@ -1,7 +1,13 @@
 #[cfg(feature = "compiler")]
 pub use super::unstable::engine::wasmer_is_compiler_available;
+#[cfg(feature = "compiler")]
+pub use super::unstable::engine::{
+    wasm_config_set_compile_cpu_affinity, wasm_config_set_compile_priority,
+    wasm_config_set_compile_threads,
+};
 pub use super::unstable::engine::{
-    wasm_config_set_features, wasm_config_set_target, wasmer_is_engine_available,
+    wasm_config_set_features, wasm_config_set_target, wasmer_engine_cancel_compilations,
+    wasmer_is_engine_available,
 };
 use super::unstable::features::wasmer_features_t;
 #[cfg(feature = "middlewares")]
@@ -107,6 +113,8 @@ pub struct wasm_config_t {
     #[cfg(feature = "middlewares")]
     pub(super) middlewares: Vec<wasmer_middleware_t>,
     pub(super) nan_canonicalization: bool,
+    #[cfg(feature = "compiler")]
+    pub(super) compile_pool: CompilePoolConfig,
     pub(super) features: Option<Box<wasmer_features_t>>,
     pub(super) target: Option<Box<wasmer_target_t>>,
 }
@@ -287,7 +295,7 @@ pub struct wasm_engine_t {
 }
 
 #[cfg(feature = "compiler")]
-use wasmer_api::CompilerConfig;
+use wasmer_api::{CompilePool, CompilePoolConfig, CompilerConfig};
 
 #[cfg(all(feature = "compiler", any(feature = "universal", feature = "dylib")))]
 fn get_default_compiler_config() -> Box<dyn CompilerConfig> {
@@ -483,6 +491,11 @@ pub extern "C" fn wasm_engine_new_with_config(
                 compiler_config.canonicalize_nans(true);
             }
 
+            match CompilePool::new(config.compile_pool) {
+                Ok(compile_pool) => compiler_config.compile_pool(compile_pool),
+                Err(error) => return return_with_error(&error.to_string()),
+            }
+
             let inner: Arc<dyn Engine + Send + Sync> = match config.engine {
                 wasmer_engine_t::UNIVERSAL => {
                     cfg_if! {
@@ -4,7 +4,7 @@ use super::store::wasm_store_t;
 use super::trap::wasm_trap_t;
 use crate::ordered_resolver::OrderedResolver;
 use std::sync::Arc;
-use wasmer_api::{Extern, Instance, InstantiationError};
+use wasmer_api::{Extern, Instance, InstantiationError, Module};
 
 /// Opaque type representing a WebAssembly instance.
 #[allow(non_camel_case_types)]
@@ -46,16 +46,34 @@ pub unsafe extern "C" fn wasm_instance_new(
     let imports = imports?;
 
     let wasm_module = &module.inner;
-    let module_imports = wasm_module.imports();
-    let module_import_count = module_imports.len();
-    let resolver: OrderedResolver = imports
+    let resolver = resolver_from_imports(wasm_module, imports);
+
+    wasm_instance_from_result(Instance::new(wasm_module, &resolver), trap)
+}
+
+/// Resolves the imports of `module` in order, from `imports`.
+pub(crate) unsafe fn resolver_from_imports(
+    module: &Module,
+    imports: &wasm_extern_vec_t,
+) -> OrderedResolver {
+    let module_import_count = module.imports().len();
+
+    imports
         .as_slice()
         .iter()
         .map(|imp| Extern::from(imp.as_ref().unwrap().as_ref().clone()))
         .take(module_import_count)
-        .collect();
+        .collect()
+}
 
-    let instance = match Instance::new(wasm_module, &resolver) {
+/// Turns the result of an instantiation into a `wasm_instance_t`. A
+/// failure is stored in `trap` if it is a runtime error, or as the last
+/// error otherwise.
+pub(crate) unsafe fn wasm_instance_from_result(
+    result: Result<Instance, InstantiationError>,
+    trap: Option<&mut *mut wasm_trap_t>,
+) -> Option<Box<wasm_instance_t>> {
+    let instance = match result {
         Ok(instance) => Arc::new(instance),
 
         Err(InstantiationError::Link(link_error)) => {
@@ -0,0 +1,473 @@
+//! Unstable non-standard Wasmer-specific API to create asynchronous
+//! host functions, and to call functions asynchronously.
+//!
+//! An asynchronous host function doesn't return its results: it
+//! receives a [`wasmer_async_completion_t`], starts an operation (I/O,
+//! a timer, a request to another thread…), and returns immediately.
+//! The results are given later, from any thread, with
+//! [`wasmer_async_completion_complete`].
+//!
+//! A function called with [`wasmer_func_call_async_new`] is suspended
+//! while such a host function is pending, instead of blocking the
+//! thread: [`wasmer_func_call_async_poll`] returns `false`, and the
+//! wake callback is called once the call can make progress again. The
+//! host event loop then polls the call again, from any thread. This
+//! allows many calls to share a few threads.
+//!
+//! When an asynchronous host function is called by a synchronous call,
+//! e.g. `wasm_func_call`, the thread is blocked until it completes.
+//!
+//! # Example
+//!
+//! ```rust
+//! # use inline_c::assert_c;
+//! # fn main() {
+//! #    (assert_c! {
+//! # #include "tests/wasmer.h"
+//! #
+//! wasmer_async_completion_t* pending = NULL;
+//! int32_t pending_value = 0;
+//! int wakes = 0;
+//!
+//! // Start the operation, and return without completing it.
+//! void read_value(void* env, const wasm_val_vec_t* args, wasmer_async_completion_t* completion) {
+//!     pending = completion;
+//!     pending_value = args->data[0].of.i32;
+//! }
+//!
+//! void wake(void* env) {
+//!     wakes += 1;
+//! }
+//!
+//! int main() {
+//!     // Create the engine and the store.
+//!     wasm_engine_t* engine = wasm_engine_new();
+//!     wasm_store_t* store = wasm_store_new(engine);
+//!
+//!     // Create a WebAssembly module from a WAT definition.
+//!     wasm_byte_vec_t wat;
+//!     wasmer_byte_vec_new_from_string(
+//!         &wat,
+//!         "(module\n"
+//!         "  (import \"env\" \"read_value\" (func $read_value (param i32) (result i32)))\n"
+//!         "  (func (export \"run\") (param i32) (result i32)\n"
+//!         "    local.get 0\n"
+//!         "    call $read_value\n"
+//!         "    i32.const 1\n"
+//!         "    i32.add))"
+//!     );
+//!     wasm_byte_vec_t wasm;
+//!     wat2wasm(&wat, &wasm);
+//!
+//!     wasm_module_t* module = wasm_module_new(store, &wasm);
+//!     assert(module);
+//!
+//!     // Create the asynchronous host function.
+//!     wasm_functype_t* read_value_type = wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+//!     wasm_func_t* read_value_func = wasmer_func_new_async(store, read_value_type, read_value, NULL);
+//!     assert(read_value_func);
+//!     wasm_functype_delete(read_value_type);
+//!
+//!     // Instantiate the module.
+//!     wasm_extern_t* externs[] = { wasm_func_as_extern(read_value_func) };
+//!     wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+//!     wasm_trap_t* trap = NULL;
+//!     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+//!     assert(instance);
+//!
+//!     wasm_extern_vec_t exports;
+//!     wasm_instance_exports(instance, &exports);
+//!     const wasm_func_t* run = wasm_extern_as_func(exports.data[0]);
+//!
+//!     // Start an asynchronous call of `run`.
+//!     wasm_val_t arguments[1] = { WASM_I32_VAL(20) };
+//!     wasm_val_t results[1] = { WASM_INIT_VAL };
+//!     wasm_val_vec_t arguments_as_array = WASM_ARRAY_VEC(arguments);
+//!     wasm_val_vec_t results_as_array = WASM_ARRAY_VEC(results);
+//!
+//!     wasmer_func_call_async_t* call = wasmer_func_call_async_new(run, &arguments_as_array, wake, NULL);
+//!     assert(call);
+//!
+//!     // The call is suspended while `read_value` is pending.
+//!     assert(!wasmer_func_call_async_poll(call, &results_as_array, &trap));
+//!     assert(pending != NULL);
+//!     assert(wakes == 0);
+//!
+//!     // Complete `read_value`: the call is woken up.
+//!     wasm_val_t value[1] = { WASM_I32_VAL(pending_value * 2) };
+//!     wasm_val_vec_t value_as_array = WASM_ARRAY_VEC(value);
+//!     wasmer_async_completion_complete(pending, &value_as_array, NULL);
+//!     assert(wakes == 1);
+//!
+//!     // The call can now complete.
+//!     assert(wasmer_func_call_async_poll(call, &results_as_array, &trap));
+//!     assert(trap == NULL);
+//!     assert(results[0].of.i32 == 41);
+//!
+//!     // Free everything.
+//!     wasmer_func_call_async_delete(call);
+//!     wasm_extern_vec_delete(&exports);
+//!     wasm_instance_delete(instance);
+//!     wasm_func_delete(read_value_func);
+//!     wasm_module_delete(module);
+//!     wasm_byte_vec_delete(&wasm);
+//!     wasm_byte_vec_delete(&wat);
+//!     wasm_store_delete(store);
+//!     wasm_engine_delete(engine);
+//!
+//!     return 0;
+//! }
+//! #    })
+//! #    .success();
+//! # }
+//! ```
+
+use super::super::externals::wasm_func_t;
+use super::super::store::wasm_store_t;
+use super::super::trap::wasm_trap_t;
+use super::super::types::wasm_functype_t;
+use super::super::value::{wasm_val_t, wasm_val_vec_t};
+use std::convert::TryInto;
+use std::ffi::c_void;
+use std::future::Future;
+use std::mem::MaybeUninit;
+use std::pin::Pin;
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Wake, Waker};
+use wasmer_api::{Function, RuntimeError, Val};
+
+/// The shared state of a pending asynchronous host function.
+#[derive(Default)]
+struct Completion {
+    state: Mutex<CompletionState>,
+}
+
+#[derive(Default)]
+struct CompletionState {
+    result: Option<Result<Vec<Val>, RuntimeError>>,
+    waker: Option<Waker>,
+}
+
+/// # Safety
+/// The results are only moved from the completing thread to the
+/// polling one. `Val` is only `!Send` because of `ExternRef`, whose
+/// reference count is atomic.
+unsafe impl Send for Completion {}
+/// # Safety
+/// See the `Send` implementation.
+unsafe impl Sync for Completion {}
+
+impl Completion {
+    fn complete(&self, result: Result<Vec<Val>, RuntimeError>) {
+        let waker = {
+            let mut state = self.state.lock().unwrap();
+            state.result = Some(result);
+            state.waker.take()
+        };
+
+        if let Some(waker) = waker {
+            waker.wake();
+        }
+    }
+}
+
+/// The future of an asynchronous host function implemented in C.
+struct CompletionFuture(Arc<Completion>);
+
+impl Future for CompletionFuture {
+    type Output = Result<Vec<Val>, RuntimeError>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let mut state = self.0.state.lock().unwrap();
+
+        match state.result.take() {
+            Some(result) => Poll::Ready(result),
+            None => {
+                state.waker = Some(cx.waker().clone());
+
+                Poll::Pending
+            }
+        }
+    }
+}
+
+/// Opaque type representing a pending call of an asynchronous host
+/// function, see [`wasmer_func_new_async`].
+///
+/// It must be completed exactly once, with
+/// [`wasmer_async_completion_complete`], which also deletes it.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_async_completion_t {
+    inner: Arc<Completion>,
+}
+
+/// Function type to represent an asynchronous host function
+/// implemented in C.
+///
+/// It receives the `env` given to [`wasmer_func_new_async`], the
+/// arguments, which are only valid during the call, and the completion
+/// to give the results to.
+#[allow(non_camel_case_types)]
+pub type wasmer_func_async_callback_t = unsafe extern "C" fn(
+    env: *mut c_void,
+    args: &wasm_val_vec_t,
+    completion: Box<wasmer_async_completion_t>,
+);
+
+/// Creates a new asynchronous host function.
+///
+/// `callback` starts the operation and returns immediately; the
+/// results are given later, from any thread, with
+/// [`wasmer_async_completion_complete`].
+///
+/// `env` is not owned by the function, it must outlive all the
+/// instances importing it. It can be used from any thread.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_new_async(
+    store: Option<&wasm_store_t>,
+    function_type: Option<&wasm_functype_t>,
+    callback: Option<wasmer_func_async_callback_t>,
+    env: *mut c_void,
+) -> Option<Box<wasm_func_t>> {
+    let store = store?;
+    let function_type = function_type?;
+    let callback = callback?;
+
+    struct CallbackEnv(*mut c_void);
+
+    impl CallbackEnv {
+        fn get(&self) -> *mut c_void {
+            self.0
+        }
+    }
+
+    // The caller of `wasmer_func_new_async` guarantees that the
+    // environment can be used from any thread.
+    unsafe impl Send for CallbackEnv {}
+    unsafe impl Sync for CallbackEnv {}
+
+    let env = CallbackEnv(env);
+    let func_sig = &function_type.inner().function_type;
+
+    let function = Function::new_async(&store.inner, func_sig, move |args: &[Val]| {
+        let processed_args: wasm_val_vec_t = args
+            .iter()
+            .map(TryInto::try_into)
+            .collect::<Result<Vec<wasm_val_t>, _>>()
+            .expect("Argument conversion failed")
+            .into();
+
+        let completion = Arc::new(Completion::default());
+
+        callback(
+            env.get(),
+            &processed_args,
+            Box::new(wasmer_async_completion_t {
+                inner: completion.clone(),
+            }),
+        );
+
+        CompletionFuture(completion)
+    });
+
+    Some(Box::new(wasm_func_t::new(function)))
+}
+
+/// Completes a pending asynchronous host function, with its results,
+/// or with a trap if `trap` is not `NULL`. It can be called from any
+/// thread.
+///
+/// This function takes ownership of `completion` and of `trap`.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_async_completion_complete(
+    completion: Option<Box<wasmer_async_completion_t>>,
+    results: Option<&wasm_val_vec_t>,
+    trap: Option<Box<wasm_trap_t>>,
+) {
+    let completion = match completion {
+        Some(completion) => completion,
+        None => return,
+    };
+
+    let result = match trap {
+        Some(trap) => Err(trap.inner),
+        None => Ok(results
+            .map(|results| {
+                results
+                    .as_slice()
+                    .iter()
+                    .cloned()
+                    .map(TryInto::try_into)
+                    .collect::<Result<Vec<Val>, _>>()
+                    .expect("Result conversion failed")
+            })
+            .unwrap_or_default()),
+    };
+
+    completion.inner.complete(result);
+}
+
+/// Function type to represent the wake callback of an asynchronous
+/// call, see [`wasmer_func_call_async_new`].
+///
+/// It is called, possibly from another thread, when the call can make
+/// progress and must be polled again.
+#[allow(non_camel_case_types)]
+pub type wasmer_func_call_async_wake_t = unsafe extern "C" fn(env: *mut c_void);
+
+struct CallbackWaker {
+    wake: wasmer_func_call_async_wake_t,
+    env: *mut c_void,
+}
+
+// The caller of `wasmer_func_call_async_new` guarantees that the wake
+// callback can be called from any thread.
+unsafe impl Send for CallbackWaker {}
+unsafe impl Sync for CallbackWaker {}
+
+impl Wake for CallbackWaker {
+    fn wake(self: Arc<Self>) {
+        unsafe { (self.wake)(self.env) }
+    }
+}
+
+/// Opaque type representing an asynchronous call of a function.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_func_call_async_t {
+    /// The call, which borrows `function`: it's declared first so that
+    /// it is dropped first.
+    future: Option<Pin<Box<dyn Future<Output = Result<Box<[Val]>, RuntimeError>> + Send>>>,
+    _function: Box<Function>,
+    waker: Waker,
+}
+
+/// Starts an asynchronous call of `func`. Nothing runs until the call
+/// is polled with [`wasmer_func_call_async_poll`].
+///
+/// `wake` is called with `wake_env`, possibly from another thread,
+/// whenever the call must be polled again.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_call_async_new(
+    func: Option<&wasm_func_t>,
+    args: Option<&wasm_val_vec_t>,
+    wake: Option<wasmer_func_call_async_wake_t>,
+    wake_env: *mut c_void,
+) -> Option<Box<wasmer_func_call_async_t>> {
+    let func = func?;
+    let args = args?;
+    let wake = wake?;
+
+    let params = args
+        .as_slice()
+        .iter()
+        .cloned()
+        .map(TryInto::try_into)
+        .collect::<Result<Vec<Val>, _>>()
+        .expect("Arguments conversion failed");
+
+    let function = func.inner.clone();
+
+    // The function is boxed, its address doesn't change when the call
+    // is moved.
+    let borrowed_function = &*(&*function as *const Function);
+    let future = Box::pin(borrowed_function.call_async(&params));
+
+    Some(Box::new(wasmer_func_call_async_t {
+        future: Some(future),
+        _function: function,
+        waker: Arc::new(CallbackWaker {
+            wake,
+            env: wake_env,
+        })
+        .into(),
+    }))
+}
+
+/// Resumes an asynchronous call, until it completes or is suspended
+/// again.
+///
+/// It returns `false` if the call is suspended: it must be polled
+/// again once the wake callback has been called. It returns `true`
+/// once the call has completed: the results are then written in
+/// `results`, or the trap in `trap` if the call has failed.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_call_async_poll(
+    call: Option<&mut wasmer_func_call_async_t>,
+    results: &mut wasm_val_vec_t,
+    trap: &mut *mut wasm_trap_t,
+) -> bool {
+    let call = match call {
+        Some(call) => call,
+        None => return false,
+    };
+
+    let future = match &mut call.future {
+        Some(future) => future,
+        None => return true,
+    };
+
+    let mut cx = Context::from_waker(&call.waker);
+
+    let result = match future.as_mut().poll(&mut cx) {
+        Poll::Ready(result) => result,
+        Poll::Pending => return false,
+    };
+
+    call.future = None;
+
+    match result {
+        Ok(wasm_results) => {
+            for (slot, val) in results
+                .as_uninit_slice()
+                .iter_mut()
+                .zip(wasm_results.iter().cloned())
+            {
+                *slot = MaybeUninit::new(val.try_into().expect("Results conversion failed"));
+            }
+
+            *trap = std::ptr::null_mut();
+        }
+        Err(e) => *trap = Box::into_raw(Box::new(e.into())),
+    }
+
+    true
+}
+
+/// Deletes an asynchronous call.
+///
+/// If the call is suspended, it is cancelled: the pending asynchronous
+/// host function gets a trap, and the WebAssembly code is unwound. Its
+/// completion can still be completed, it is then ignored.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_call_async_delete(
+    _call: Option<Box<wasmer_func_call_async_t>>,
+) {
+}
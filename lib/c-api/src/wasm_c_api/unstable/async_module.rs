@@ -0,0 +1,640 @@
+//! Unstable non-standard Wasmer-specific API to compile modules
+//! asynchronously.
+//!
+//! [`wasmer_module_new_async`] returns immediately, and the module is
+//! given to a callback once compiled. The functions of the module are
+//! compiled on the compile pool of the engine, see
+//! `wasm_config_set_compile_threads`. Meanwhile, the progress of the
+//! compilation can be read with [`wasmer_module_compilation_progress`],
+//! and the compilation can be cancelled with
+//! [`wasmer_module_compilation_cancel`].
+//!
+//! The asynchronous compilations of the same bytes by the same engine
+//! that overlap are compiled once, and share the compiled code. The
+//! memory and table styles picked by the tunables of the store are
+//! compiled into the code, so a request whose store picks other styles
+//! than the store of the first request gets the module compiled again
+//! for its store.
+//!
+//! # Example
+//!
+//! ```rust
+//! # use inline_c::assert_c;
+//! # fn main() {
+//! #    (assert_c! {
+//! # #include "tests/wasmer.h"
+//! # #include <pthread.h>
+//! #
+//! pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+//! pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+//! int done = 0;
+//! wasm_module_t* compiled = NULL;
+//!
+//! // Called on another thread once the module is compiled.
+//! void on_compiled(void* env, wasm_module_t* module) {
+//!     pthread_mutex_lock(&lock);
+//!     compiled = module;
+//!     done = 1;
+//!     pthread_cond_signal(&done_cond);
+//!     pthread_mutex_unlock(&lock);
+//! }
+//!
+//! int main() {
+//!     // Create the engine and the store.
+//!     wasm_engine_t* engine = wasm_engine_new();
+//!     wasm_store_t* store = wasm_store_new(engine);
+//!
+//!     // Create a WebAssembly module from a WAT definition.
+//!     wasm_byte_vec_t wat;
+//!     wasmer_byte_vec_new_from_string(&wat, "(module (func (export \"run\")))");
+//!     wasm_byte_vec_t wasm;
+//!     wat2wasm(&wat, &wasm);
+//!
+//!     // Start compiling the module, and wait for it.
+//!     wasmer_module_compilation_t* compilation = wasmer_module_new_async(store, &wasm, on_compiled, NULL);
+//!     assert(compilation);
+//!
+//!     pthread_mutex_lock(&lock);
+//!     while (!done) {
+//!         pthread_cond_wait(&done_cond, &lock);
+//!     }
+//!     pthread_mutex_unlock(&lock);
+//!     assert(compiled);
+//!
+//!     // All the functions of the module have been compiled.
+//!     size_t compiled_functions = 0;
+//!     size_t functions = 0;
+//!     wasmer_module_compilation_progress(compilation, &compiled_functions, &functions);
+//!     assert(compiled_functions == 1);
+//!     assert(functions == 1);
+//!
+//!     // It's too late to cancel the compilation.
+//!     assert(!wasmer_module_compilation_cancel(compilation));
+//!
+//!     // Free everything.
+//!     wasmer_module_compilation_delete(compilation);
+//!     wasm_module_delete(compiled);
+//!     wasm_byte_vec_delete(&wasm);
+//!     wasm_byte_vec_delete(&wat);
+//!     wasm_store_delete(store);
+//!     wasm_engine_delete(engine);
+//!
+//!     return 0;
+//! }
+//! #    })
+//! #    .success();
+//! # }
+//! ```
+
+use super::super::module::wasm_module_t;
+use super::super::store::wasm_store_t;
+use super::super::types::wasm_byte_vec_t;
+use crate::error::update_last_error;
+use lazy_static::lazy_static;
+use std::collections::hash_map::DefaultHasher;
+use std::collections::HashMap;
+use std::ffi::c_void;
+use std::hash::{Hash, Hasher};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use wasmer_api::{CompileError, CompileMonitor, Module, Store};
+
+/// The key of the compilations in progress: the engine, and the hash of
+/// the bytes.
+type CompilationKey = (String, u64);
+
+lazy_static! {
+    /// The asynchronous compilations in progress, which the compilations
+    /// of the same bytes by the same engine join.
+    static ref COMPILATIONS: Mutex<HashMap<CompilationKey, Vec<Arc<SharedCompilation>>>> =
+        Mutex::new(HashMap::new());
+}
+
+/// A compilation, shared by the requests for the same module.
+struct SharedCompilation {
+    bytes: Vec<u8>,
+    monitor: Arc<CompileMonitor>,
+    /// The requests waiting for the module.
+    requests: Mutex<Vec<Arc<Request>>>,
+    /// The number of requests that weren't cancelled. It is only updated
+    /// with the lock of `COMPILATIONS` held, so that a request can't join
+    /// a compilation that was just cancelled.
+    active_requests: Mutex<usize>,
+}
+
+/// A request for a module, see [`wasmer_module_new_async`].
+struct Request {
+    compilation: Arc<SharedCompilation>,
+    store: Store,
+    callback: wasmer_module_new_callback_t,
+    env: CallbackEnv,
+    /// Whether the callback was called, or the request was cancelled.
+    done: AtomicBool,
+}
+
+struct CallbackEnv(*mut c_void);
+
+// The caller of `wasmer_module_new_async` guarantees that the
+// environment can be used from any thread.
+unsafe impl Send for CallbackEnv {}
+unsafe impl Sync for CallbackEnv {}
+
+impl Request {
+    fn complete(&self, result: &Result<Module, CompileError>) {
+        if self.done.swap(true, Ordering::SeqCst) {
+            return;
+        }
+        let module = match result.as_ref().map(|module| module.for_store(&self.store)) {
+            Ok(Some(module)) => Some(module),
+            // The tunables of the store pick other memory or table styles
+            // than the ones compiled into the shared code.
+            Ok(None) => match Module::from_binary(&self.store, &self.compilation.bytes) {
+                Ok(module) => Some(module),
+                Err(error) => {
+                    update_last_error(error);
+                    None
+                }
+            },
+            Err(error) => {
+                update_last_error(error);
+                None
+            }
+        };
+        let module = module.map(|module| {
+            Box::new(wasm_module_t {
+                inner: Arc::new(module),
+            })
+        });
+        unsafe { (self.callback)(self.env.0, module) };
+    }
+}
+
+impl SharedCompilation {
+    fn run(self: Arc<Self>, key: CompilationKey, store: Store) {
+        let result = self
+            .monitor
+            .monitor(|| Module::from_binary(&store, &self.bytes));
+        // No request joins the compilation once it is removed.
+        {
+            let mut compilations = COMPILATIONS.lock().unwrap();
+            if let Some(shared) = compilations.get_mut(&key) {
+                shared.retain(|compilation| !Arc::ptr_eq(compilation, &self));
+                if shared.is_empty() {
+                    compilations.remove(&key);
+                }
+            }
+        }
+        let requests = std::mem::take(&mut *self.requests.lock().unwrap());
+        for request in requests {
+            request.complete(&result);
+        }
+    }
+}
+
+/// Opaque type representing an asynchronous compilation of a module,
+/// see [`wasmer_module_new_async`].
+///
+/// # Example
+///
+/// See the module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_module_compilation_t {
+    request: Arc<Request>,
+}
+
+/// Function type to represent the callback of an asynchronous
+/// compilation, see [`wasmer_module_new_async`].
+///
+/// It is called on another thread with the `env` given to
+/// [`wasmer_module_new_async`] and the compiled module, which it owns,
+/// or `NULL` if the compilation failed, in which case the error can be
+/// read with `wasmer_last_error_message` from the callback.
+#[allow(non_camel_case_types)]
+pub type wasmer_module_new_callback_t =
+    unsafe extern "C" fn(env: *mut c_void, module: Option<Box<wasm_module_t>>);
+
+/// Compiles a module asynchronously, given the configuration in the
+/// store, like `wasm_module_new`.
+///
+/// It returns immediately, and `callback` is called once the module is
+/// compiled, on another thread, unless the compilation is cancelled. If
+/// the same bytes are being compiled asynchronously by the same engine
+/// already, the compilation in progress is joined, and the module is
+/// compiled again once it is done only if the tunables of `store` pick
+/// other memory or table styles.
+///
+/// `env` is not owned by the compilation, it must outlive the call of
+/// `callback`. It can be used from any thread. `bytes` is copied.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_module_new_async(
+    store: Option<&wasm_store_t>,
+    bytes: Option<&wasm_byte_vec_t>,
+    callback: Option<wasmer_module_new_callback_t>,
+    env: *mut c_void,
+) -> Option<Box<wasmer_module_compilation_t>> {
+    let store = store?;
+    let bytes = bytes?.as_slice();
+    let callback = callback?;
+
+    let mut hasher = DefaultHasher::new();
+    bytes.hash(&mut hasher);
+    let key = (store.inner.engine().id().id(), hasher.finish());
+
+    let mut compilations = COMPILATIONS.lock().unwrap();
+    let shared = compilations.entry(key.clone()).or_default();
+    let joined = shared
+        .iter()
+        .find(|compilation| compilation.bytes == bytes && !compilation.monitor.is_cancelled())
+        .cloned();
+    let (compilation, is_new) = match joined {
+        Some(compilation) => (compilation, false),
+        None => {
+            let compilation = Arc::new(SharedCompilation {
+                bytes: bytes.to_vec(),
+                monitor: Arc::new(CompileMonitor::new()),
+                requests: Mutex::new(vec![]),
+                active_requests: Mutex::new(0),
+            });
+            shared.push(compilation.clone());
+            (compilation, true)
+        }
+    };
+
+    let request = Arc::new(Request {
+        compilation: compilation.clone(),
+        store: store.inner.clone(),
+        callback,
+        env: CallbackEnv(env),
+        done: AtomicBool::new(false),
+    });
+    compilation.requests.lock().unwrap().push(request.clone());
+    *compilation.active_requests.lock().unwrap() += 1;
+
+    if is_new {
+        let store = store.inner.clone();
+        let run_key = key.clone();
+        let runner = compilation.clone();
+        let spawned = thread::Builder::new()
+            .name("wasmer-module-new-async".to_string())
+            .spawn(move || runner.run(run_key, store));
+        if let Err(error) = spawned {
+            if let Some(shared) = compilations.get_mut(&key) {
+                shared.retain(|other| !Arc::ptr_eq(other, &compilation));
+                if shared.is_empty() {
+                    compilations.remove(&key);
+                }
+            }
+            update_last_error(error);
+            return None;
+        }
+    }
+
+    Some(Box::new(wasmer_module_compilation_t { request }))
+}
+
+/// Cancels an asynchronous compilation: its callback won't be called.
+///
+/// It returns `false` if it is too late, i.e. if the callback has been
+/// called or is being called. The compilation in progress is stopped
+/// once all the compilations that joined it are cancelled.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_module_compilation_cancel(
+    compilation: Option<&wasmer_module_compilation_t>,
+) -> bool {
+    let request = match compilation {
+        Some(compilation) => &compilation.request,
+        None => return false,
+    };
+    if request.done.swap(true, Ordering::SeqCst) {
+        return false;
+    }
+
+    let compilation = &request.compilation;
+    let _compilations = COMPILATIONS.lock().unwrap();
+    let mut active_requests = compilation.active_requests.lock().unwrap();
+    *active_requests -= 1;
+    if *active_requests == 0 {
+        compilation.monitor.cancel();
+    }
+
+    true
+}
+
+/// Reads the progress of an asynchronous compilation: the number of
+/// functions compiled so far, and the number of functions to compile,
+/// which is only known once the module has been parsed, and is `0`
+/// until then.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_module_compilation_progress(
+    compilation: Option<&wasmer_module_compilation_t>,
+    compiled_functions: &mut usize,
+    functions: &mut usize,
+) {
+    let (compiled, total) = compilation
+        .map(|compilation| compilation.request.compilation.monitor.progress())
+        .unwrap_or_default();
+    *compiled_functions = compiled;
+    *functions = total;
+}
+
+/// Deletes an asynchronous compilation.
+///
+/// This doesn't cancel it: the callback is still called unless
+/// [`wasmer_module_compilation_cancel`] is called first.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_module_compilation_delete(
+    compilation: Option<Box<wasmer_module_compilation_t>>,
+) {
+    // The compilation keeps its own reference to the request until the
+    // callback is called, so this only releases the handle.
+    drop(compilation);
+}
+
+#[cfg(test)]
+mod tests {
+    use inline_c::assert_c;
+
+    #[test]
+    fn test_wasmer_module_compilation_cancel() {
+        (assert_c! {
+            #include "tests/wasmer.h"
+            #include <pthread.h>
+
+            pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+            pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+            typedef struct {
+                int called;
+                wasm_module_t* module;
+            } result_t;
+
+            void on_compiled(void* env, wasm_module_t* module) {
+                result_t* result = (result_t*) env;
+                pthread_mutex_lock(&lock);
+                result->called += 1;
+                result->module = module;
+                pthread_cond_broadcast(&done_cond);
+                pthread_mutex_unlock(&lock);
+            }
+
+            void wait_for(result_t* result) {
+                pthread_mutex_lock(&lock);
+                while (!result->called) {
+                    pthread_cond_wait(&done_cond, &lock);
+                }
+                pthread_mutex_unlock(&lock);
+            }
+
+            int main() {
+                wasm_engine_t* engine = wasm_engine_new();
+                wasm_store_t* store = wasm_store_new(engine);
+
+                wasm_byte_vec_t wat;
+                wasmer_byte_vec_new_from_string(&wat, "(module (func (export \"run\")))");
+                wasm_byte_vec_t wasm;
+                wat2wasm(&wat, &wasm);
+
+                result_t cancelled = { 0, NULL };
+                wasmer_module_compilation_t* compilation = wasmer_module_new_async(store, &wasm, on_compiled, &cancelled);
+                assert(compilation);
+                int was_cancelled = wasmer_module_compilation_cancel(compilation);
+
+                // A cancelled compilation isn't joined: this one runs on
+                // its own.
+                result_t compiled = { 0, NULL };
+                wasmer_module_compilation_t* other = wasmer_module_new_async(store, &wasm, on_compiled, &compiled);
+                assert(other);
+                wait_for(&compiled);
+                assert(compiled.module);
+
+                pthread_mutex_lock(&lock);
+                if (was_cancelled) {
+                    // The callback of a cancelled compilation is never
+                    // called.
+                    assert(cancelled.called == 0);
+                } else {
+                    // It was too late to cancel it.
+                    while (!cancelled.called) {
+                        pthread_cond_wait(&done_cond, &lock);
+                    }
+                    assert(cancelled.called == 1);
+                    wasm_module_delete(cancelled.module);
+                }
+                pthread_mutex_unlock(&lock);
+
+                // It's too late to cancel it twice.
+                assert(!wasmer_module_compilation_cancel(compilation));
+
+                wasmer_module_compilation_delete(other);
+                wasmer_module_compilation_delete(compilation);
+                wasm_module_delete(compiled.module);
+                wasm_byte_vec_delete(&wasm);
+                wasm_byte_vec_delete(&wat);
+                wasm_store_delete(store);
+                wasm_engine_delete(engine);
+
+                return 0;
+            }
+        })
+        .success();
+    }
+
+    #[test]
+    fn test_wasmer_module_new_async_joined() {
+        (assert_c! {
+            #include "tests/wasmer.h"
+            #include <pthread.h>
+            #include <stdlib.h>
+            #include <string.h>
+
+            pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+            pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+            typedef struct {
+                int called;
+                wasm_module_t* module;
+            } result_t;
+
+            void on_compiled(void* env, wasm_module_t* module) {
+                result_t* result = (result_t*) env;
+                pthread_mutex_lock(&lock);
+                result->called += 1;
+                result->module = module;
+                pthread_cond_broadcast(&done_cond);
+                pthread_mutex_unlock(&lock);
+            }
+
+            void wait_for(result_t* result) {
+                pthread_mutex_lock(&lock);
+                while (!result->called) {
+                    pthread_cond_wait(&done_cond, &lock);
+                }
+                pthread_mutex_unlock(&lock);
+            }
+
+            int main() {
+                wasm_engine_t* engine = wasm_engine_new();
+                wasm_store_t* first_store = wasm_store_new(engine);
+                wasm_store_t* second_store = wasm_store_new(engine);
+
+                // Enough functions for the second request to join the
+                // compilation of the first one.
+                const char* function = "(func (param i32) (result i32) local.get 0 i32.const 1 i32.add)";
+                size_t functions = 1000;
+                char* source = malloc(strlen(function) * functions + 16);
+                strcpy(source, "(module");
+                for (size_t i = 0; i < functions; ++i) {
+                    strcat(source, function);
+                }
+                strcat(source, ")");
+
+                wasm_byte_vec_t wat;
+                wasmer_byte_vec_new_from_string(&wat, source);
+                wasm_byte_vec_t wasm;
+                wat2wasm(&wat, &wasm);
+
+                result_t first = { 0, NULL };
+                result_t second = { 0, NULL };
+                wasmer_module_compilation_t* first_compilation = wasmer_module_new_async(first_store, &wasm, on_compiled, &first);
+                wasmer_module_compilation_t* second_compilation = wasmer_module_new_async(second_store, &wasm, on_compiled, &second);
+                assert(first_compilation);
+                assert(second_compilation);
+
+                wait_for(&first);
+                wait_for(&second);
+                assert(first.called == 1);
+                assert(second.called == 1);
+                assert(first.module);
+                assert(second.module);
+
+                // Both requests read the progress of the same compilation.
+                size_t first_compiled = 0;
+                size_t first_functions = 0;
+                size_t second_compiled = 0;
+                size_t second_functions = 0;
+                wasmer_module_compilation_progress(first_compilation, &first_compiled, &first_functions);
+                wasmer_module_compilation_progress(second_compilation, &second_compiled, &second_functions);
+                assert(first_compiled == functions);
+                assert(first_functions == functions);
+                assert(second_compiled == functions);
+                assert(second_functions == functions);
+
+                wasmer_module_compilation_delete(second_compilation);
+                wasmer_module_compilation_delete(first_compilation);
+                wasm_module_delete(second.module);
+                wasm_module_delete(first.module);
+                wasm_byte_vec_delete(&wasm);
+                wasm_byte_vec_delete(&wat);
+                free(source);
+                wasm_store_delete(second_store);
+                wasm_store_delete(first_store);
+                wasm_engine_delete(engine);
+
+                return 0;
+            }
+        })
+        .success();
+    }
+
+    #[test]
+    fn test_wasmer_module_new_async_joined_and_cancelled() {
+        (assert_c! {
+            #include "tests/wasmer.h"
+            #include <pthread.h>
+            #include <stdlib.h>
+            #include <string.h>
+
+            pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+            pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+            typedef struct {
+                int called;
+                wasm_module_t* module;
+            } result_t;
+
+            void on_compiled(void* env, wasm_module_t* module) {
+                result_t* result = (result_t*) env;
+                pthread_mutex_lock(&lock);
+                result->called += 1;
+                result->module = module;
+                pthread_cond_broadcast(&done_cond);
+                pthread_mutex_unlock(&lock);
+            }
+
+            int main() {
+                wasm_engine_t* engine = wasm_engine_new();
+                wasm_store_t* store = wasm_store_new(engine);
+
+                // Enough functions for the second request to join the
+                // compilation of the first one.
+                const char* function = "(func (param i32) (result i32) local.get 0 i32.const 1 i32.add)";
+                size_t functions = 1000;
+                char* source = malloc(strlen(function) * functions + 16);
+                strcpy(source, "(module");
+                for (size_t i = 0; i < functions; ++i) {
+                    strcat(source, function);
+                }
+                strcat(source, ")");
+
+                wasm_byte_vec_t wat;
+                wasmer_byte_vec_new_from_string(&wat, source);
+                wasm_byte_vec_t wasm;
+                wat2wasm(&wat, &wasm);
+
+                result_t cancelled = { 0, NULL };
+                result_t compiled = { 0, NULL };
+                wasmer_module_compilation_t* cancelled_compilation = wasmer_module_new_async(store, &wasm, on_compiled, &cancelled);
+                wasmer_module_compilation_t* compilation = wasmer_module_new_async(store, &wasm, on_compiled, &compiled);
+                assert(cancelled_compilation);
+                assert(compilation);
+                int was_cancelled = wasmer_module_compilation_cancel(cancelled_compilation);
+
+                // The other request keeps the shared compilation going.
+                pthread_mutex_lock(&lock);
+                while (!compiled.called) {
+                    pthread_cond_wait(&done_cond, &lock);
+                }
+                assert(compiled.called == 1);
+                assert(compiled.module);
+                if (was_cancelled) {
+                    assert(cancelled.called == 0);
+                } else {
+                    while (!cancelled.called) {
+                        pthread_cond_wait(&done_cond, &lock);
+                    }
+                    wasm_module_delete(cancelled.module);
+                }
+                pthread_mutex_unlock(&lock);
+
+                wasmer_module_compilation_delete(compilation);
+                wasmer_module_compilation_delete(cancelled_compilation);
+                wasm_module_delete(compiled.module);
+                wasm_byte_vec_delete(&wasm);
+                wasm_byte_vec_delete(&wat);
+                free(source);
+                wasm_store_delete(store);
+                wasm_engine_delete(engine);
+
+                return 0;
+            }
+        })
+        .success();
+    }
+}
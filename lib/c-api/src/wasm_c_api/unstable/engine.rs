@@ -3,10 +3,12 @@
 
 #[cfg(feature = "compiler")]
 use super::super::engine::wasmer_compiler_t;
-use super::super::engine::{wasm_config_t, wasmer_engine_t};
+use super::super::engine::{wasm_config_t, wasm_engine_t, wasmer_engine_t};
 
 use super::features::wasmer_features_t;
 use super::target_lexicon::wasmer_target_t;
+use std::slice;
+use wasmer_api::Engine;
 
 /// Unstable non-standard Wasmer-specific API to update the
 /// configuration to specify a particular target for the engine.
@@ -137,6 +139,104 @@ pub extern "C" fn wasm_config_canonicalize_nans(config: &mut wasm_config_t, enab
     config.nan_canonicalization = enable;
 }
 
+/// Updates the configuration to compile on a pool of `threads` threads
+/// of its own, rather than on as many threads as CPUs shared by all the
+/// engines. `wasm_engine_new_with_config` fails if the threads can't be
+/// spawned.
+///
+/// This is a Wasmer-specific function.
+///
+/// # Example
+///
+/// ```rust
+/// # use inline_c::assert_c;
+/// # fn main() {
+/// #    (assert_c! {
+/// # #include "tests/wasmer.h"
+/// #
+/// int main() {
+///     // Create the configuration.
+///     wasm_config_t* config = wasm_config_new();
+///
+///     // Compile on 2 threads, with a low priority, on the CPUs 0 and 1.
+///     wasm_config_set_compile_threads(config, 2);
+///     wasm_config_set_compile_priority(config, 10);
+///
+///     size_t cpus[] = {0, 1};
+///     wasm_config_set_compile_cpu_affinity(config, cpus, 2);
+///
+///     // Create the engine.
+///     wasm_engine_t* engine = wasm_engine_new_with_config(config);
+///
+///     // Check we have an engine!
+///     assert(engine);
+///
+///     // Free everything.
+///     wasm_engine_delete(engine);
+///
+///     return 0;
+/// }
+/// #    })
+/// #    .success();
+/// # }
+/// ```
+#[no_mangle]
+#[cfg(feature = "compiler")]
+pub extern "C" fn wasm_config_set_compile_threads(config: &mut wasm_config_t, threads: usize) {
+    config.compile_pool.threads(threads);
+}
+
+/// Updates the configuration to compile on threads with the niceness
+/// `nice`, from -20 (highest priority) to 19 (lowest priority).
+///
+/// This is a Wasmer-specific function. It is only supported on Linux
+/// and Android, and ignored elsewhere.
+///
+/// # Example
+///
+/// See [`wasm_config_set_compile_threads`].
+#[no_mangle]
+#[cfg(feature = "compiler")]
+pub extern "C" fn wasm_config_set_compile_priority(config: &mut wasm_config_t, nice: i32) {
+    config.compile_pool.priority(nice);
+}
+
+/// Updates the configuration to compile on threads running on the
+/// `cpus_len` CPUs of `cpus` only.
+///
+/// This is a Wasmer-specific function. It is only supported on Linux
+/// and Android, and ignored elsewhere.
+///
+/// # Example
+///
+/// See [`wasm_config_set_compile_threads`].
+#[no_mangle]
+#[cfg(feature = "compiler")]
+pub unsafe extern "C" fn wasm_config_set_compile_cpu_affinity(
+    config: &mut wasm_config_t,
+    cpus: *const usize,
+    cpus_len: usize,
+) {
+    let cpus = if cpus.is_null() || cpus_len == 0 {
+        vec![]
+    } else {
+        slice::from_raw_parts(cpus, cpus_len).to_vec()
+    };
+    config.compile_pool.cpu_affinity(cpus);
+}
+
+/// Cancels the compilations in progress on the engine, which fail with
+/// an error. The compilations started afterwards are not affected.
+///
+/// This is a Wasmer-specific function. It can be called from any
+/// thread.
+#[no_mangle]
+pub extern "C" fn wasmer_engine_cancel_compilations(engine: Option<&wasm_engine_t>) {
+    if let Some(compile_pool) = engine.and_then(|engine| engine.inner.compile_pool()) {
+        compile_pool.cancel();
+    }
+}
+
 /// Check whether the given compiler is available, i.e. part of this
 /// compiled library.
 #[no_mangle]
@@ -0,0 +1,900 @@
+//! Unstable non-standard Wasmer-specific API to create and call
+//! functions without going through `wasm_val_t`.
+//!
+//! # Host functions
+//!
+//! [`wasm_func_new`](crate::wasm_c_api::externals::wasm_func_new)
+//! wraps the C callback in a dynamic function: each call from
+//! WebAssembly builds a `wasm_val_vec_t` for the arguments and for the
+//! results. [`wasmer_func_new_native`] instead registers a C function
+//! whose signature already follows the native ABI of the WebAssembly
+//! function type, which is then called directly by the WebAssembly
+//! code. See its documentation for an example.
+//!
+//! # Calling functions
+//!
+//! [`wasm_func_call`](crate::wasm_c_api::externals::wasm_func_call)
+//! converts every argument and every result between `wasm_val_t` and
+//! the Rust representation of a value, and allocates while doing so.
+//! This API instead checks the signature of the function once, when a
+//! [`wasmer_func_call_handle_t`] is created, and then passes the
+//! arguments and the results as raw, untyped slots
+//! ([`wasmer_raw_val_t`]) straight to the function's trampoline.
+//! [`wasmer_func_call_batch`] goes one step further and calls the
+//! function many times while entering WebAssembly only once.
+//!
+//! # Example
+//!
+//! ```rust
+//! # use inline_c::assert_c;
+//! # fn main() {
+//! #    (assert_c! {
+//! # #include "tests/wasmer.h"
+//! #
+//! int main() {
+//!     // Create the engine and the store.
+//!     wasm_engine_t* engine = wasm_engine_new();
+//!     wasm_store_t* store = wasm_store_new(engine);
+//!
+//!     // Create a WebAssembly module from a WAT definition.
+//!     wasm_byte_vec_t wat;
+//!     wasmer_byte_vec_new_from_string(
+//!         &wat,
+//!         "(module\n"
+//!         "  (func (export \"sum\") (param i32 i64) (result i64)\n"
+//!         "    local.get 0\n"
+//!         "    i64.extend_i32_s\n"
+//!         "    local.get 1\n"
+//!         "    i64.add))"
+//!     );
+//!     wasm_byte_vec_t wasm;
+//!     wat2wasm(&wat, &wasm);
+//!
+//!     wasm_module_t* module = wasm_module_new(store, &wasm);
+//!     assert(module);
+//!
+//!     // Instantiate the module.
+//!     wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+//!     wasm_trap_t* trap = NULL;
+//!     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+//!     assert(instance);
+//!
+//!     // Get the `sum` exported function.
+//!     wasm_extern_vec_t exports;
+//!     wasm_instance_exports(instance, &exports);
+//!     assert(exports.size == 1);
+//!
+//!     const wasm_func_t* sum = wasm_extern_as_func(exports.data[0]);
+//!     assert(sum);
+//!
+//!     // Create a call handle. The signature is checked here, once
+//!     // and for all.
+//!     wasmer_func_call_handle_t* handle = wasmer_func_call_handle_new(sum, NULL);
+//!     assert(handle);
+//!     assert(wasmer_func_call_handle_slots(handle) == 2);
+//!
+//!     // Call the function, as many times as we want.
+//!     wasmer_raw_val_t slots[2];
+//!
+//!     for (int32_t i = 0; i < 3; ++i) {
+//!         slots[0].i32 = i;
+//!         slots[1].i64 = 40;
+//!
+//!         trap = wasmer_func_call_raw(handle, slots, 2);
+//!         assert(trap == NULL);
+//!
+//!         // The result has been written in the first slot.
+//!         assert(slots[0].i64 == 40 + i);
+//!     }
+//!
+//!     // Free everything.
+//!     wasmer_func_call_handle_delete(handle);
+//!     wasm_extern_vec_delete(&exports);
+//!     wasm_instance_delete(instance);
+//!     wasm_module_delete(module);
+//!     wasm_byte_vec_delete(&wasm);
+//!     wasm_byte_vec_delete(&wat);
+//!     wasm_store_delete(store);
+//!     wasm_engine_delete(engine);
+//!
+//!     return 0;
+//! }
+//! #    })
+//! #    .success();
+//! # }
+//! ```
+
+use super::super::externals::wasm_func_t;
+use super::super::store::wasm_store_t;
+use super::super::trap::wasm_trap_t;
+use super::super::types::wasm_functype_t;
+use crate::error::update_last_error;
+use std::cmp::max;
+use std::ffi::c_void;
+use std::mem::size_of;
+use std::ptr;
+use wasmer_api::{Function, RuntimeError, ValType};
+
+/// A C function that follows the native ABI of a WebAssembly
+/// function type, see [`wasmer_func_new_native`].
+///
+/// The real signature of the function is erased; it must be cast to
+/// this type when given to [`wasmer_func_new_native`].
+#[allow(non_camel_case_types)]
+pub type wasmer_func_native_callback_t = unsafe extern "C" fn();
+
+/// Creates a new host function from a C function that follows the
+/// native ABI of `function_type`.
+///
+/// The C function receives `env` as its first argument, followed by
+/// the parameters of the function type, and returns its result
+/// directly. It is called by the WebAssembly code without any
+/// conversion of the values, which makes it much cheaper than a
+/// function created with `wasm_func_new`. The WebAssembly types map
+/// to C types as follows: `i32` to `int32_t`, `i64` to `int64_t`,
+/// `f32` to `float`, and `f64` to `double`. Only function types with
+/// at most one result, and without references or `v128`, are
+/// supported.
+///
+/// The function runs on the WebAssembly stack, and it can only be
+/// called from WebAssembly, i.e. once imported by an instance. It can
+/// abort the execution with [`wasmer_trap_raise`].
+///
+/// `env` is not owned by the function, it must outlive all the
+/// instances importing it.
+///
+/// It returns `NULL` if the function type is not supported; the
+/// reason can be read with `wasmer_last_error_message`.
+///
+/// # Example
+///
+/// ```rust
+/// # use inline_c::assert_c;
+/// # fn main() {
+/// #    (assert_c! {
+/// # #include "tests/wasmer.h"
+/// #
+/// int32_t multiply(void* env, int32_t x) {
+///     return x * *((int32_t*) env);
+/// }
+///
+/// int main() {
+///     // Create the engine and the store.
+///     wasm_engine_t* engine = wasm_engine_new();
+///     wasm_store_t* store = wasm_store_new(engine);
+///
+///     // Create a WebAssembly module from a WAT definition.
+///     wasm_byte_vec_t wat;
+///     wasmer_byte_vec_new_from_string(
+///         &wat,
+///         "(module\n"
+///         "  (import \"env\" \"multiply\" (func $multiply (param i32) (result i32)))\n"
+///         "  (func (export \"run\") (param i32) (result i32)\n"
+///         "    local.get 0\n"
+///         "    call $multiply\n"
+///         "    i32.const 1\n"
+///         "    i32.add))"
+///     );
+///     wasm_byte_vec_t wasm;
+///     wat2wasm(&wat, &wasm);
+///
+///     wasm_module_t* module = wasm_module_new(store, &wasm);
+///     assert(module);
+///
+///     // Create the native host function.
+///     int32_t factor = 3;
+///     wasm_functype_t* multiply_type = wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+///     wasm_func_t* multiply_func = wasmer_func_new_native(
+///         store,
+///         multiply_type,
+///         (wasmer_func_native_callback_t) multiply,
+///         &factor
+///     );
+///     assert(multiply_func);
+///     wasm_functype_delete(multiply_type);
+///
+///     // Instantiate the module.
+///     wasm_extern_t* externs[] = { wasm_func_as_extern(multiply_func) };
+///     wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+///     wasm_trap_t* trap = NULL;
+///     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+///     assert(instance);
+///
+///     // Call `run`.
+///     wasm_extern_vec_t exports;
+///     wasm_instance_exports(instance, &exports);
+///     const wasm_func_t* run = wasm_extern_as_func(exports.data[0]);
+///
+///     wasm_val_t arguments[1] = { WASM_I32_VAL(14) };
+///     wasm_val_t results[1] = { WASM_INIT_VAL };
+///     wasm_val_vec_t arguments_as_array = WASM_ARRAY_VEC(arguments);
+///     wasm_val_vec_t results_as_array = WASM_ARRAY_VEC(results);
+///
+///     trap = wasm_func_call(run, &arguments_as_array, &results_as_array);
+///     assert(trap == NULL);
+///     assert(results[0].of.i32 == 43);
+///
+///     // Free everything.
+///     wasm_extern_vec_delete(&exports);
+///     wasm_instance_delete(instance);
+///     wasm_func_delete(multiply_func);
+///     wasm_module_delete(module);
+///     wasm_byte_vec_delete(&wasm);
+///     wasm_byte_vec_delete(&wat);
+///     wasm_store_delete(store);
+///     wasm_engine_delete(engine);
+///
+///     return 0;
+/// }
+/// #    })
+/// #    .success();
+/// # }
+/// ```
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_new_native(
+    store: Option<&wasm_store_t>,
+    function_type: Option<&wasm_functype_t>,
+    callback: Option<wasmer_func_native_callback_t>,
+    env: *mut c_void,
+) -> Option<Box<wasm_func_t>> {
+    let store = store?;
+    let function_type = function_type?;
+    let callback = callback?;
+
+    let func_sig = &function_type.inner().function_type;
+
+    if func_sig.results().len() > 1 {
+        update_last_error(format!(
+            "The function type {} has more than one result, which is not supported by native host functions",
+            func_sig
+        ));
+
+        return None;
+    }
+
+    if func_sig
+        .params()
+        .iter()
+        .chain(func_sig.results().iter())
+        .any(|ty| {
+            !matches!(
+                ty,
+                ValType::I32 | ValType::I64 | ValType::F32 | ValType::F64
+            )
+        })
+    {
+        update_last_error(format!(
+            "The function type {} contains types that cannot be passed to a native host function",
+            func_sig
+        ));
+
+        return None;
+    }
+
+    let function = Function::new_native_raw(
+        &store.inner,
+        func_sig.clone(),
+        callback as *const c_void,
+        env,
+    );
+
+    Some(Box::new(wasm_func_t::new(function)))
+}
+
+/// Raises a trap from a native host function, see
+/// [`wasmer_func_new_native`]. This function never returns: the
+/// execution resumes in the host, where the trap is returned by the
+/// function that entered WebAssembly (e.g. `wasm_func_call`).
+///
+/// # Safety
+///
+/// It must only be called from a native host function, while it is
+/// being called by WebAssembly. No C++ destructor on the stack will
+/// run.
+///
+/// # Example
+///
+/// ```rust
+/// # use inline_c::assert_c;
+/// # fn main() {
+/// #    (assert_c! {
+/// # #include "tests/wasmer.h"
+/// #
+/// int32_t fail(void* env, int32_t x) {
+///     if (x < 0) {
+///         wasm_message_t message;
+///         wasm_name_new_from_string_nt(&message, "negative");
+///         wasm_trap_t* trap = wasm_trap_new((wasm_store_t*) env, &message);
+///         wasm_name_delete(&message);
+///
+///         // Doesn't return.
+///         wasmer_trap_raise(trap);
+///     }
+///
+///     return x;
+/// }
+///
+/// int main() {
+///     // Create the engine and the store.
+///     wasm_engine_t* engine = wasm_engine_new();
+///     wasm_store_t* store = wasm_store_new(engine);
+///
+///     // Create a WebAssembly module from a WAT definition.
+///     wasm_byte_vec_t wat;
+///     wasmer_byte_vec_new_from_string(
+///         &wat,
+///         "(module\n"
+///         "  (import \"env\" \"fail\" (func $fail (param i32) (result i32)))\n"
+///         "  (func (export \"run\") (param i32) (result i32)\n"
+///         "    local.get 0\n"
+///         "    call $fail))"
+///     );
+///     wasm_byte_vec_t wasm;
+///     wat2wasm(&wat, &wasm);
+///
+///     wasm_module_t* module = wasm_module_new(store, &wasm);
+///     assert(module);
+///
+///     // Create the native host function, which gets the store to
+///     // create its trap.
+///     wasm_functype_t* fail_type = wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+///     wasm_func_t* fail_func = wasmer_func_new_native(
+///         store,
+///         fail_type,
+///         (wasmer_func_native_callback_t) fail,
+///         store
+///     );
+///     assert(fail_func);
+///     wasm_functype_delete(fail_type);
+///
+///     // Instantiate the module.
+///     wasm_extern_t* externs[] = { wasm_func_as_extern(fail_func) };
+///     wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+///     wasm_trap_t* trap = NULL;
+///     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+///     assert(instance);
+///
+///     wasm_extern_vec_t exports;
+///     wasm_instance_exports(instance, &exports);
+///     const wasm_func_t* run = wasm_extern_as_func(exports.data[0]);
+///
+///     wasm_val_t arguments[1] = { WASM_I32_VAL(7) };
+///     wasm_val_t results[1] = { WASM_INIT_VAL };
+///     wasm_val_vec_t arguments_as_array = WASM_ARRAY_VEC(arguments);
+///     wasm_val_vec_t results_as_array = WASM_ARRAY_VEC(results);
+///
+///     // The function returns normally.
+///     trap = wasm_func_call(run, &arguments_as_array, &results_as_array);
+///     assert(trap == NULL);
+///     assert(results[0].of.i32 == 7);
+///
+///     // The function raises the trap, which `wasm_func_call` returns.
+///     arguments[0].of.i32 = -1;
+///     trap = wasm_func_call(run, &arguments_as_array, &results_as_array);
+///     assert(trap != NULL);
+///
+///     wasm_message_t retrieved_message;
+///     wasm_trap_message(trap, &retrieved_message);
+///     assert(strncmp(retrieved_message.data, "negative", 8) == 0);
+///
+///     // Free everything.
+///     wasm_name_delete(&retrieved_message);
+///     wasm_trap_delete(trap);
+///     wasm_extern_vec_delete(&exports);
+///     wasm_instance_delete(instance);
+///     wasm_func_delete(fail_func);
+///     wasm_module_delete(module);
+///     wasm_byte_vec_delete(&wasm);
+///     wasm_byte_vec_delete(&wat);
+///     wasm_store_delete(store);
+///     wasm_engine_delete(engine);
+///
+///     return 0;
+/// }
+/// #    })
+/// #    .success();
+/// # }
+/// ```
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_trap_raise(trap: Box<wasm_trap_t>) {
+    // Nothing runs after the trap is raised, so the box is freed
+    // before.
+    let error = {
+        let trap = trap;
+        trap.inner
+    };
+    wasmer_api::raise_user_trap(Box::new(error))
+}
+
+/// A raw, untyped, WebAssembly value, as consumed and produced by
+/// [`wasmer_func_call_raw`].
+///
+/// Each slot is 16 bytes long, so that it can hold a `v128`
+/// value. Only the member matching the type of the parameter (or of
+/// the result) must be read or written.
+#[allow(non_camel_case_types)]
+#[derive(Clone, Copy)]
+#[repr(C)]
+pub union wasmer_raw_val_t {
+    pub i32: i32,
+    pub i64: i64,
+    pub f32: f32,
+    pub f64: f64,
+    pub v128: [u8; 16],
+}
+
+/// An opaque handle to call a function with [`wasmer_func_call_raw`].
+///
+/// The handle keeps the function alive, and remembers how many slots
+/// a call needs.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_func_call_handle_t {
+    pub(crate) inner: Function,
+    pub(crate) params: usize,
+    pub(crate) results: usize,
+    pub(crate) slots: usize,
+}
+
+/// Creates a new [`wasmer_func_call_handle_t`] for the given function.
+///
+/// If `expected_type` is not `NULL`, the function type must be
+/// equal to it. Only functions whose parameters and results are
+/// numbers (`i32`, `i64`, `f32`, `f64` or `v128`) can be called
+/// through this API, as references cannot be passed in raw slots.
+///
+/// It returns `NULL` if the signature does not fit; the reason can
+/// be read with `wasmer_last_error_message`.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_func_call_handle_new(
+    func: Option<&wasm_func_t>,
+    expected_type: Option<&wasm_functype_t>,
+) -> Option<Box<wasmer_func_call_handle_t>> {
+    let func = func?;
+    let function_type = func.inner.ty();
+
+    if let Some(expected_type) = expected_type {
+        let expected_type = &expected_type.inner().function_type;
+
+        if expected_type != function_type {
+            update_last_error(format!(
+                "The function has type {}, but {} was expected",
+                function_type, expected_type
+            ));
+
+            return None;
+        }
+    }
+
+    if function_type
+        .params()
+        .iter()
+        .chain(function_type.results().iter())
+        .any(|ty| ty.is_ref())
+    {
+        update_last_error(format!(
+            "The function type {} contains references, which cannot be passed as raw values",
+            function_type
+        ));
+
+        return None;
+    }
+
+    Some(Box::new(wasmer_func_call_handle_t {
+        inner: (*func.inner).clone(),
+        params: function_type.params().len(),
+        results: function_type.results().len(),
+        slots: max(function_type.params().len(), function_type.results().len()),
+    }))
+}
+
+/// Deletes a [`wasmer_func_call_handle_t`].
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_func_call_handle_delete(_handle: Option<Box<wasmer_func_call_handle_t>>) {}
+
+/// Returns the number of [`wasmer_raw_val_t`] slots that must be
+/// given to [`wasmer_func_call_raw`], i.e. the maximum of the number
+/// of parameters and the number of results.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_func_call_handle_slots(handle: &wasmer_func_call_handle_t) -> usize {
+    handle.slots
+}
+
+/// Calls the function behind `handle`.
+///
+/// The arguments are read from `slots`, and the results are written
+/// back into `slots`, starting at the first one. `slots_len` must be
+/// at least [`wasmer_func_call_handle_slots`].
+///
+/// It returns `NULL` on success, or a trap otherwise.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_call_raw(
+    handle: Option<&wasmer_func_call_handle_t>,
+    slots: *mut wasmer_raw_val_t,
+    slots_len: usize,
+) -> Option<Box<wasm_trap_t>> {
+    let handle = handle?;
+
+    if slots_len < handle.slots || (slots.is_null() && handle.slots > 0) {
+        return Some(Box::new(
+            RuntimeError::new(format!(
+                "{} slots were given, but the function needs {}",
+                slots_len, handle.slots
+            ))
+            .into(),
+        ));
+    }
+
+    match handle.inner.call_raw(slots as *mut i128) {
+        Ok(()) => None,
+        Err(e) => Some(Box::new(e.into())),
+    }
+}
+
+/// Calls the function behind `handle` `count` times in a row.
+///
+/// This is equivalent to calling [`wasmer_func_call_raw`] `count`
+/// times, except that WebAssembly is entered only once for the whole
+/// batch. `args` is a matrix of `count` rows, each holding the
+/// arguments of one call (one slot per parameter). `results` is a
+/// matrix of `count` rows, each receiving the results of one call
+/// (one slot per result).
+///
+/// It returns `NULL` on success. If a call traps, the batch stops,
+/// the index of the failing call is written to `failed_index` (if it
+/// is not `NULL`), and the trap is returned. The results of the calls
+/// before the failing one have been written.
+///
+/// # Example
+///
+/// ```rust
+/// # use inline_c::assert_c;
+/// # fn main() {
+/// #    (assert_c! {
+/// # #include "tests/wasmer.h"
+/// #
+/// int main() {
+///     // Create the engine and the store.
+///     wasm_engine_t* engine = wasm_engine_new();
+///     wasm_store_t* store = wasm_store_new(engine);
+///
+///     // Create a WebAssembly module from a WAT definition.
+///     wasm_byte_vec_t wat;
+///     wasmer_byte_vec_new_from_string(
+///         &wat,
+///         "(module\n"
+///         "  (func (export \"div\") (param i32 i32) (result i32)\n"
+///         "    local.get 0\n"
+///         "    local.get 1\n"
+///         "    i32.div_s))"
+///     );
+///     wasm_byte_vec_t wasm;
+///     wat2wasm(&wat, &wasm);
+///
+///     wasm_module_t* module = wasm_module_new(store, &wasm);
+///     assert(module);
+///
+///     // Instantiate the module.
+///     wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+///     wasm_trap_t* trap = NULL;
+///     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+///     assert(instance);
+///
+///     wasm_extern_vec_t exports;
+///     wasm_instance_exports(instance, &exports);
+///     const wasm_func_t* div = wasm_extern_as_func(exports.data[0]);
+///
+///     wasmer_func_call_handle_t* handle = wasmer_func_call_handle_new(div, NULL);
+///     assert(handle);
+///
+///     // Divide 3 numbers by 2, 1 and 0.
+///     wasmer_raw_val_t args[3][2];
+///     wasmer_raw_val_t results[3][1];
+///
+///     for (int32_t i = 0; i < 3; ++i) {
+///         args[i][0].i32 = 42;
+///         args[i][1].i32 = 2 - i;
+///     }
+///
+///     size_t failed_index = 0;
+///     trap = wasmer_func_call_batch(handle, &args[0][0], &results[0][0], 3, &failed_index);
+///
+///     // The last call has failed.
+///     assert(trap != NULL);
+///     assert(failed_index == 2);
+///
+///     // The first calls have succeeded.
+///     assert(results[0][0].i32 == 21);
+///     assert(results[1][0].i32 == 42);
+///
+///     // Free everything.
+///     wasm_trap_delete(trap);
+///     wasmer_func_call_handle_delete(handle);
+///     wasm_extern_vec_delete(&exports);
+///     wasm_instance_delete(instance);
+///     wasm_module_delete(module);
+///     wasm_byte_vec_delete(&wasm);
+///     wasm_byte_vec_delete(&wat);
+///     wasm_store_delete(store);
+///     wasm_engine_delete(engine);
+///
+///     return 0;
+/// }
+/// #    })
+/// #    .success();
+/// # }
+/// ```
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_func_call_batch(
+    handle: Option<&wasmer_func_call_handle_t>,
+    args: *const wasmer_raw_val_t,
+    results: *mut wasmer_raw_val_t,
+    count: usize,
+    failed_index: Option<&mut usize>,
+) -> Option<Box<wasm_trap_t>> {
+    let handle = handle?;
+    let (num_params, num_results) = (handle.params, handle.results);
+
+    if count > 0 && ((args.is_null() && num_params > 0) || (results.is_null() && num_results > 0)) {
+        return Some(Box::new(
+            RuntimeError::new("The arguments or the results are `NULL`").into(),
+        ));
+    }
+
+    let result = handle.inner.call_raw_batch(
+        count,
+        |index, values_vec| {
+            ptr::copy_nonoverlapping(
+                args.add(index * num_params) as *const u8,
+                values_vec as *mut u8,
+                num_params * size_of::<wasmer_raw_val_t>(),
+            )
+        },
+        |index, values_vec| {
+            ptr::copy_nonoverlapping(
+                values_vec as *const u8,
+                results.add(index * num_results) as *mut u8,
+                num_results * size_of::<wasmer_raw_val_t>(),
+            )
+        },
+    );
+
+    match result {
+        Ok(()) => None,
+        Err(e) => {
+            if let Some(failed_index) = failed_index {
+                *failed_index = e.index;
+            }
+
+            Some(Box::new(e.error.into()))
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use inline_c::assert_c;
+
+    #[test]
+    fn raw_val_is_a_trampoline_slot() {
+        assert_eq!(size_of::<wasmer_raw_val_t>(), size_of::<i128>());
+    }
+
+    #[test]
+    fn test_func_new_native_rejects_unsupported_types() {
+        (assert_c! {
+            #include "tests/wasmer.h"
+
+            void noop() {}
+
+            int main() {
+                wasm_engine_t* engine = wasm_engine_new();
+                wasm_store_t* store = wasm_store_new(engine);
+
+                // More than one result.
+                wasm_functype_t* two_results = wasm_functype_new_0_2(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+                assert(!wasmer_func_new_native(store, two_results, (wasmer_func_native_callback_t) noop, NULL));
+                assert(wasmer_last_error_length() > 0);
+                wasm_functype_delete(two_results);
+
+                // A reference.
+                wasm_functype_t* reference = wasm_functype_new_1_0(wasm_valtype_new(WASM_ANYREF));
+                assert(!wasmer_func_new_native(store, reference, (wasmer_func_native_callback_t) noop, NULL));
+                assert(wasmer_last_error_length() > 0);
+                wasm_functype_delete(reference);
+
+                wasm_store_delete(store);
+                wasm_engine_delete(engine);
+
+                return 0;
+            }
+        })
+        .success();
+    }
+
+    #[test]
+    fn test_func_new_native_passes_all_number_types() {
+        (assert_c! {
+            #include "tests/wasmer.h"
+
+            double sum(void* env, int32_t a, int64_t b, float c, double d) {
+                ++*((int32_t*) env);
+
+                return a + b + c + d;
+            }
+
+            int main() {
+                wasm_engine_t* engine = wasm_engine_new();
+                wasm_store_t* store = wasm_store_new(engine);
+
+                wasm_byte_vec_t wat;
+                wasmer_byte_vec_new_from_string(
+                    &wat,
+                    "(module\n"
+                    "  (import \"env\" \"sum\" (func $sum (param i32 i64 f32 f64) (result f64)))\n"
+                    "  (func (export \"run\") (result f64)\n"
+                    "    i32.const 1\n"
+                    "    i64.const 20\n"
+                    "    f32.const 300.5\n"
+                    "    f64.const 4000.25\n"
+                    "    call $sum))"
+                );
+                wasm_byte_vec_t wasm;
+                wat2wasm(&wat, &wasm);
+
+                wasm_module_t* module = wasm_module_new(store, &wasm);
+                assert(module);
+
+                wasm_valtype_t* params[4] = {
+                    wasm_valtype_new_i32(),
+                    wasm_valtype_new_i64(),
+                    wasm_valtype_new_f32(),
+                    wasm_valtype_new_f64(),
+                };
+                wasm_valtype_vec_t params_vec;
+                wasm_valtype_vec_new(&params_vec, 4, params);
+                wasm_valtype_vec_t results_vec;
+                wasm_valtype_vec_new_uninitialized(&results_vec, 1);
+                results_vec.data[0] = wasm_valtype_new_f64();
+                wasm_functype_t* sum_type = wasm_functype_new(&params_vec, &results_vec);
+
+                int32_t calls = 0;
+                wasm_func_t* sum_func = wasmer_func_new_native(store, sum_type, (wasmer_func_native_callback_t) sum, &calls);
+                assert(sum_func);
+                wasm_functype_delete(sum_type);
+
+                wasm_extern_t* externs[] = { wasm_func_as_extern(sum_func) };
+                wasm_extern_vec_t imports = WASM_ARRAY_VEC(externs);
+                wasm_trap_t* trap = NULL;
+                wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+                assert(instance);
+
+                wasm_extern_vec_t exports;
+                wasm_instance_exports(instance, &exports);
+                const wasm_func_t* run = wasm_extern_as_func(exports.data[0]);
+
+                wasm_val_vec_t arguments = WASM_EMPTY_VEC;
+                wasm_val_t results[1] = { WASM_INIT_VAL };
+                wasm_val_vec_t results_as_array = WASM_ARRAY_VEC(results);
+
+                trap = wasm_func_call(run, &arguments, &results_as_array);
+                assert(trap == NULL);
+                assert(results[0].of.f64 == 4321.75);
+                assert(calls == 1);
+
+                wasm_extern_vec_delete(&exports);
+                wasm_instance_delete(instance);
+                wasm_func_delete(sum_func);
+                wasm_module_delete(module);
+                wasm_byte_vec_delete(&wasm);
+                wasm_byte_vec_delete(&wat);
+                wasm_store_delete(store);
+                wasm_engine_delete(engine);
+
+                return 0;
+            }
+        })
+        .success();
+    }
+
+    #[test]
+    fn test_func_call_batch_checks_its_arguments() {
+        (assert_c! {
+            #include "tests/wasmer.h"
+
+            int main() {
+                wasm_engine_t* engine = wasm_engine_new();
+                wasm_store_t* store = wasm_store_new(engine);
+
+                wasm_byte_vec_t wat;
+                wasmer_byte_vec_new_from_string(
+                    &wat,
+                    "(module\n"
+                    "  (func (export \"add\") (param i32 i32) (result i32)\n"
+                    "    local.get 0\n"
+                    "    local.get 1\n"
+                    "    i32.add))"
+                );
+                wasm_byte_vec_t wasm;
+                wat2wasm(&wat, &wasm);
+
+                wasm_module_t* module = wasm_module_new(store, &wasm);
+                assert(module);
+
+                wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+                wasm_trap_t* trap = NULL;
+                wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+                assert(instance);
+
+                wasm_extern_vec_t exports;
+                wasm_instance_exports(instance, &exports);
+                const wasm_func_t* add = wasm_extern_as_func(exports.data[0]);
+
+                // The handle is refused if the function has another type.
+                wasm_functype_t* other_type = wasm_functype_new_1_1(wasm_valtype_new_i32(), wasm_valtype_new_i32());
+                assert(!wasmer_func_call_handle_new(add, other_type));
+                assert(wasmer_last_error_length() > 0);
+                wasm_functype_delete(other_type);
+
+                wasmer_func_call_handle_t* handle = wasmer_func_call_handle_new(add, NULL);
+                assert(handle);
+
+                // Missing arguments or results.
+                wasmer_raw_val_t results[2][1];
+                trap = wasmer_func_call_batch(handle, NULL, &results[0][0], 2, NULL);
+                assert(trap != NULL);
+                wasm_trap_delete(trap);
+
+                // An empty batch.
+                trap = wasmer_func_call_batch(handle, NULL, NULL, 0, NULL);
+                assert(trap == NULL);
+
+                // A batch that succeeds.
+                wasmer_raw_val_t args[2][2];
+                for (int32_t i = 0; i < 2; ++i) {
+                    args[i][0].i32 = i;
+                    args[i][1].i32 = 10;
+                }
+
+                size_t failed_index = 42;
+                trap = wasmer_func_call_batch(handle, &args[0][0], &results[0][0], 2, &failed_index);
+                assert(trap == NULL);
+                assert(failed_index == 42);
+                assert(results[0][0].i32 == 10);
+                assert(results[1][0].i32 == 11);
+
+                wasmer_func_call_handle_delete(handle);
+                wasm_extern_vec_delete(&exports);
+                wasm_instance_delete(instance);
+                wasm_module_delete(module);
+                wasm_byte_vec_delete(&wasm);
+                wasm_byte_vec_delete(&wat);
+                wasm_store_delete(store);
+                wasm_engine_delete(engine);
+
+                return 0;
+            }
+        })
+        .success();
+    }
+}
@@ -0,0 +1,160 @@
+//! Unstable non-standard Wasmer-specific API to snapshot instances,
+//! and to create new instances from a snapshot.
+//!
+//! A snapshot captures the state of the memories, tables and globals
+//! defined by an instance, typically once it has been initialized.
+//! New instances created from the snapshot start in this state without
+//! being initialized again, and without calling their start function.
+//! Their memories map the captured content copy-on-write when the
+//! platform supports it.
+
+use super::super::externals::wasm_extern_vec_t;
+use super::super::instance::{resolver_from_imports, wasm_instance_from_result, wasm_instance_t};
+use super::super::trap::wasm_trap_t;
+use wasmer_api::{Instance, InstanceSnapshot};
+
+/// Opaque type representing a snapshot of the state of an instance.
+///
+/// A snapshot is immutable, and can be used from several threads.
+#[allow(non_camel_case_types)]
+pub struct wasmer_instance_snapshot_t {
+    pub(crate) inner: InstanceSnapshot,
+}
+
+/// Unstable non-standard Wasmer-specific API to capture the state of
+/// the memories, tables and globals defined by `instance`.
+///
+/// The instance must not be running while the snapshot is taken.
+///
+/// It returns `NULL` and sets the last error if a table or a global of
+/// the instance refers to a function that is neither defined nor
+/// imported by the instance.
+///
+/// # Example
+///
+/// ```rust
+/// # use inline_c::assert_c;
+/// # fn main() {
+/// #    (assert_c! {
+/// # #include "tests/wasmer.h"
+/// #
+/// int main() {
+///     // Create the engine and the store.
+///     wasm_engine_t* engine = wasm_engine_new();
+///     wasm_store_t* store = wasm_store_new(engine);
+///
+///     // Create a WebAssembly module from a WAT definition.
+///     wasm_byte_vec_t wat;
+///     wasmer_byte_vec_new_from_string(
+///         &wat,
+///         "(module\n"
+///         "  (global $counter (export \"counter\") (mut i32) (i32.const 0))\n"
+///         "  (func (export \"initialize\")\n"
+///         "    (global.set $counter (i32.const 42))))"
+///     );
+///     wasm_byte_vec_t wasm;
+///     wat2wasm(&wat, &wasm);
+///
+///     wasm_module_t* module = wasm_module_new(store, &wasm);
+///     assert(module);
+///
+///     // Instantiate and initialize the module.
+///     wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+///     wasm_trap_t* trap = NULL;
+///     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+///     assert(instance);
+///
+///     wasm_extern_vec_t exports;
+///     wasm_instance_exports(instance, &exports);
+///     const wasm_func_t* initialize = wasm_extern_as_func(exports.data[1]);
+///
+///     wasm_val_vec_t no_values = WASM_EMPTY_VEC;
+///     trap = wasm_func_call(initialize, &no_values, &no_values);
+///     assert(trap == NULL);
+///
+///     // Take a snapshot, and create a new instance from it.
+///     wasmer_instance_snapshot_t* snapshot = wasmer_instance_snapshot_new(instance);
+///     assert(snapshot);
+///
+///     wasm_instance_t* forked = wasmer_instance_new_from_snapshot(snapshot, &imports, &trap);
+///     assert(forked);
+///
+///     // The new instance is already initialized.
+///     wasm_extern_vec_t forked_exports;
+///     wasm_instance_exports(forked, &forked_exports);
+///     wasm_global_t* counter = wasm_extern_as_global(forked_exports.data[0]);
+///
+///     wasm_val_t value;
+///     wasm_global_get(counter, &value);
+///     assert(value.of.i32 == 42);
+///
+///     // Free everything.
+///     wasm_extern_vec_delete(&forked_exports);
+///     wasm_instance_delete(forked);
+///     wasmer_instance_snapshot_delete(snapshot);
+///     wasm_extern_vec_delete(&exports);
+///     wasm_instance_delete(instance);
+///     wasm_module_delete(module);
+///     wasm_byte_vec_delete(&wasm);
+///     wasm_byte_vec_delete(&wat);
+///     wasm_store_delete(store);
+///     wasm_engine_delete(engine);
+///
+///     return 0;
+/// }
+/// #    })
+/// #    .success();
+/// # }
+/// ```
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_instance_snapshot_new(
+    instance: Option<&wasm_instance_t>,
+) -> Option<Box<wasmer_instance_snapshot_t>> {
+    let instance = instance?;
+
+    match instance.inner.snapshot() {
+        Ok(inner) => Some(Box::new(wasmer_instance_snapshot_t { inner })),
+        Err(error) => {
+            crate::error::update_last_error(error);
+
+            None
+        }
+    }
+}
+
+/// Unstable non-standard Wasmer-specific API to delete a snapshot.
+///
+/// The instances created from the snapshot stay valid.
+///
+/// # Example
+///
+/// See [`wasmer_instance_snapshot_new`].
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_instance_snapshot_delete(
+    _snapshot: Option<Box<wasmer_instance_snapshot_t>>,
+) {
+}
+
+/// Unstable non-standard Wasmer-specific API to create a new instance
+/// of the module `snapshot` was taken from, in the state captured by
+/// the snapshot.
+///
+/// The imports are given as with `wasm_instance_new`, and the errors
+/// are reported the same way.
+///
+/// # Example
+///
+/// See [`wasmer_instance_snapshot_new`].
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_instance_new_from_snapshot(
+    snapshot: Option<&wasmer_instance_snapshot_t>,
+    imports: Option<&wasm_extern_vec_t>,
+    trap: Option<&mut *mut wasm_trap_t>,
+) -> Option<Box<wasm_instance_t>> {
+    let snapshot = &snapshot?.inner;
+    let imports = imports?;
+
+    let resolver = resolver_from_imports(snapshot.module(), imports);
+
+    wasm_instance_from_result(Instance::from_snapshot(snapshot, &resolver), trap)
+}
@@ -0,0 +1,313 @@
+//! Unstable non-standard Wasmer-specific API that contains everything
+//! to create the epoch interruption middleware, and to drive it.
+//!
+//! The epoch interruption middleware is a much cheaper alternative to
+//! the metering middleware to bound the execution time of instances:
+//! the compiled code only checks a per-instance flag at the entry of
+//! each function and at the header of each loop. A
+//! [`wasmer_epoch_t`] is a counter that the host increments at a
+//! regular interval, usually from a dedicated thread. Once it reaches
+//! the deadline of an instance, the instance traps at its next check.
+//!
+//! # Example
+//!
+//! ```rust
+//! # use inline_c::assert_c;
+//! # fn main() {
+//! #    (assert_c! {
+//! # #include "tests/wasmer.h"
+//! #
+//! int main() {
+//!     // Create a new epoch interruption middleware.
+//!     wasmer_epoch_interruption_t* epoch_interruption = wasmer_epoch_interruption_new();
+//!
+//!     // Consume it to produce a generic `wasmer_middleware_t` value.
+//!     wasmer_middleware_t* middleware = wasmer_epoch_interruption_as_middleware(epoch_interruption);
+//!
+//!     // Create a new configuration, and push the middleware in it.
+//!     wasm_config_t* config = wasm_config_new();
+//!     wasm_config_push_middleware(config, middleware);
+//!
+//!     // Create the engine and the store based on the configuration.
+//!     wasm_engine_t* engine = wasm_engine_new_with_config(config);
+//!     wasm_store_t* store = wasm_store_new(engine);
+//!
+//!     // Create the new WebAssembly module.
+//!     wasm_byte_vec_t wat;
+//!     wasmer_byte_vec_new_from_string(
+//!         &wat,
+//!         "(module\n"
+//!         "  (func (export \"add_one\") (param i32) (result i32)\n"
+//!         "    local.get 0\n"
+//!         "    i32.const 1\n"
+//!         "    i32.add))"
+//!     );
+//!     wasm_byte_vec_t wasm;
+//!     wat2wasm(&wat, &wasm);
+//!
+//!     wasm_module_t* module = wasm_module_new(store, &wasm);
+//!     assert(module);
+//!
+//!     // Instantiate the module.
+//!     wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+//!     wasm_trap_t* trap = NULL;
+//!     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+//!     assert(instance);
+//!
+//!     wasm_extern_vec_t exports;
+//!     wasm_instance_exports(instance, &exports);
+//!     const wasm_func_t* add_one = wasm_extern_as_func(exports.data[0]);
+//!     assert(add_one);
+//!
+//!     wasm_val_t arguments[1] = { WASM_I32_VAL(41) };
+//!     wasm_val_t results[1] = { WASM_INIT_VAL };
+//!     wasm_val_vec_t arguments_as_array = WASM_ARRAY_VEC(arguments);
+//!     wasm_val_vec_t results_as_array = WASM_ARRAY_VEC(results);
+//!
+//!     // Give the instance a deadline of 2 ticks.
+//!     wasmer_epoch_t* epoch = wasmer_epoch_new();
+//!     wasmer_epoch_set_deadline(epoch, instance, 2);
+//!
+//!     // The deadline is not reached yet.
+//!     assert(wasmer_epoch_increment(epoch) == 1);
+//!     trap = wasm_func_call(add_one, &arguments_as_array, &results_as_array);
+//!     assert(trap == NULL);
+//!     assert(results[0].of.i32 == 42);
+//!
+//!     // The deadline is reached, the instance is interrupted.
+//!     assert(wasmer_epoch_increment(epoch) == 2);
+//!     assert(wasmer_epoch_is_interrupted(instance));
+//!     trap = wasm_func_call(add_one, &arguments_as_array, &results_as_array);
+//!     assert(trap != NULL);
+//!     wasm_trap_delete(trap);
+//!
+//!     // Let it run again.
+//!     wasmer_epoch_clear_interrupted(instance);
+//!     trap = wasm_func_call(add_one, &arguments_as_array, &results_as_array);
+//!     assert(trap == NULL);
+//!
+//!     wasmer_epoch_delete(epoch);
+//!     wasm_extern_vec_delete(&exports);
+//!     wasm_instance_delete(instance);
+//!     wasm_module_delete(module);
+//!     wasm_byte_vec_delete(&wasm);
+//!     wasm_byte_vec_delete(&wat);
+//!     wasm_store_delete(store);
+//!     wasm_engine_delete(engine);
+//!
+//!     return 0;
+//! }
+//! #    })
+//! #    .success();
+//! # }
+//! ```
+
+use super::super::super::instance::wasm_instance_t;
+use super::wasmer_middleware_t;
+use std::ffi::c_void;
+use std::sync::Arc;
+use wasmer_middlewares::{
+    epoch::{clear_interrupted, is_interrupted, Epoch, EpochDeadlineAction},
+    EpochInterruption,
+};
+
+/// Opaque type representing an epoch interruption middleware.
+///
+/// To transform this specific middleware into a generic one, please
+/// see [`wasmer_epoch_interruption_as_middleware`].
+///
+/// # Example
+///
+/// See module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_epoch_interruption_t {
+    pub(crate) inner: Arc<EpochInterruption>,
+}
+
+/// Creates a new epoch interruption middleware.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_interruption_new() -> Box<wasmer_epoch_interruption_t> {
+    Box::new(wasmer_epoch_interruption_t {
+        inner: Arc::new(EpochInterruption::new()),
+    })
+}
+
+/// Deletes a [`wasmer_epoch_interruption_t`].
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_interruption_delete(
+    _epoch_interruption: Option<Box<wasmer_epoch_interruption_t>>,
+) {
+}
+
+/// Transforms a [`wasmer_epoch_interruption_t`] into a generic
+/// [`wasmer_middleware_t`], to then be pushed in the configuration with
+/// [`wasm_config_push_middleware`][super::wasm_config_push_middleware].
+///
+/// This function takes ownership of `epoch_interruption`.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_interruption_as_middleware(
+    epoch_interruption: Option<Box<wasmer_epoch_interruption_t>>,
+) -> Option<Box<wasmer_middleware_t>> {
+    let epoch_interruption = epoch_interruption?;
+
+    Some(Box::new(wasmer_middleware_t {
+        inner: epoch_interruption.inner,
+    }))
+}
+
+/// Opaque type representing an epoch, i.e. a counter of ticks against
+/// which the deadlines of instances are checked.
+///
+/// It can be used from several threads.
+///
+/// # Example
+///
+/// See module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_epoch_t {
+    pub(crate) inner: Arc<Epoch>,
+}
+
+/// Creates a new epoch, starting at 0.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_new() -> Box<wasmer_epoch_t> {
+    Box::new(wasmer_epoch_t {
+        inner: Arc::new(Epoch::new()),
+    })
+}
+
+/// Deletes a [`wasmer_epoch_t`]. The pending deadlines are dropped.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_delete(_epoch: Option<Box<wasmer_epoch_t>>) {}
+
+/// Returns the current epoch.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_current(epoch: &wasmer_epoch_t) -> u64 {
+    epoch.inner.current()
+}
+
+/// Increments the epoch by one tick, interrupts the instances whose
+/// deadline is reached, and returns the new epoch.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_increment(epoch: &wasmer_epoch_t) -> u64 {
+    epoch.inner.increment()
+}
+
+/// Interrupts `instance` once `epoch` has been incremented `ticks`
+/// times from now. It replaces any pending deadline of the instance.
+///
+/// The instance must have been compiled with the epoch interruption
+/// middleware.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_set_deadline(
+    epoch: &wasmer_epoch_t,
+    instance: &wasm_instance_t,
+    ticks: u64,
+) {
+    epoch.inner.set_deadline(&instance.inner, ticks);
+}
+
+/// Function type to represent a deadline callback implemented in C.
+///
+/// It is called with the `env` given to
+/// [`wasmer_epoch_set_deadline_callback`], on the thread incrementing
+/// the epoch. It returns `0` to interrupt the instance, or the number
+/// of ticks to let it run for.
+#[allow(non_camel_case_types)]
+pub type wasmer_epoch_deadline_callback_t = extern "C" fn(env: *mut c_void) -> u64;
+
+/// The environment of a deadline callback, which is called from the
+/// thread incrementing the epoch.
+struct CallbackEnv(*mut c_void);
+
+/// # Safety
+/// The caller of `wasmer_epoch_set_deadline_callback` guarantees that
+/// the environment can be used from the thread incrementing the epoch.
+unsafe impl Send for CallbackEnv {}
+
+/// Like [`wasmer_epoch_set_deadline`], but calls `callback` when the
+/// deadline is reached, to decide whether the instance is interrupted.
+///
+/// `env` must stay valid until the callback returns `0`, or until the
+/// deadline is cleared or replaced and a callback that may be running
+/// on another thread returns.
+///
+/// The callback is called once the epoch is unlocked, so it may call
+/// the functions of the epoch, e.g. to set another deadline.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_set_deadline_callback(
+    epoch: &wasmer_epoch_t,
+    instance: &wasm_instance_t,
+    ticks: u64,
+    callback: wasmer_epoch_deadline_callback_t,
+    env: *mut c_void,
+) {
+    let env = CallbackEnv(env);
+
+    epoch
+        .inner
+        .set_deadline_callback(&instance.inner, ticks, move || match callback(env.0) {
+            0 => EpochDeadlineAction::Interrupt,
+            ticks => EpochDeadlineAction::Extend(ticks),
+        });
+}
+
+/// Removes the pending deadline of `instance`, if any.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_clear_deadline(epoch: &wasmer_epoch_t, instance: &wasm_instance_t) {
+    epoch.inner.clear_deadline(&instance.inner);
+}
+
+/// Returns whether `instance` has been interrupted because its deadline
+/// was reached.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_is_interrupted(instance: &wasm_instance_t) -> bool {
+    is_interrupted(&instance.inner)
+}
+
+/// Clears the interruption flag of `instance`, so that it can run
+/// again.
+///
+/// # Example
+///
+/// See module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_epoch_clear_interrupted(instance: &wasm_instance_t) {
+    clear_interrupted(&instance.inner);
+}
@@ -1,6 +1,7 @@
 //! Unstable non-standard Wasmer-specific types to manipulate module
 //! middlewares.
 
+pub mod epoch;
 pub mod metering;
 
 use super::super::engine::wasm_config_t;
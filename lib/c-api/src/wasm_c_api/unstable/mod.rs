@@ -1,10 +1,18 @@
+pub mod async_function;
+#[cfg(feature = "compiler")]
+pub mod async_module;
 pub mod engine;
 pub mod features;
+pub mod function;
+pub mod instance;
 #[cfg(feature = "middlewares")]
 pub mod middlewares;
 pub mod module;
 #[cfg(feature = "compiler")]
+pub mod module_stream;
+#[cfg(feature = "compiler")]
 pub mod parser;
+pub mod store;
 pub mod target_lexicon;
 #[cfg(feature = "wasi")]
 pub mod wasi;
@@ -0,0 +1,162 @@
+//! Unstable non-standard Wasmer-specific API to compile modules while
+//! their bytes are received, e.g. from the network.
+//!
+//! The bytes are written to a stream created by
+//! [`wasmer_module_stream_new`] as they are received, and the module is
+//! returned by [`wasmer_module_stream_finish`]. The module is validated
+//! as it is received, and, with the Universal engine, each function is
+//! compiled as soon as its body is received.
+//!
+//! # Example
+//!
+//! ```rust
+//! # use inline_c::assert_c;
+//! # fn main() {
+//! #    (assert_c! {
+//! # #include "tests/wasmer.h"
+//! #
+//! int main() {
+//!     // Create the engine and the store.
+//!     wasm_engine_t* engine = wasm_engine_new();
+//!     wasm_store_t* store = wasm_store_new(engine);
+//!
+//!     // Create a WebAssembly module from a WAT definition.
+//!     wasm_byte_vec_t wat;
+//!     wasmer_byte_vec_new_from_string(&wat, "(module (func (export \"run\")))");
+//!     wasm_byte_vec_t wasm;
+//!     wat2wasm(&wat, &wasm);
+//!
+//!     // Write the bytes of the module in chunks, as if they were
+//!     // received from the network.
+//!     wasmer_module_stream_t* stream = wasmer_module_stream_new(store);
+//!     assert(stream);
+//!
+//!     for (size_t offset = 0; offset < wasm.size; offset += 4) {
+//!         size_t size = wasm.size - offset < 4 ? wasm.size - offset : 4;
+//!         wasm_byte_vec_t chunk = { size, wasm.data + offset };
+//!         assert(wasmer_module_stream_write(stream, &chunk));
+//!     }
+//!
+//!     // Get the module once compiled.
+//!     wasm_module_t* module = wasmer_module_stream_finish(stream);
+//!     assert(module);
+//!
+//!     // Free everything.
+//!     wasm_module_delete(module);
+//!     wasm_byte_vec_delete(&wasm);
+//!     wasm_byte_vec_delete(&wat);
+//!     wasm_store_delete(store);
+//!     wasm_engine_delete(engine);
+//!
+//!     return 0;
+//! }
+//! #    })
+//! #    .success();
+//! # }
+//! ```
+
+use super::super::module::wasm_module_t;
+use super::super::store::wasm_store_t;
+use super::super::types::wasm_byte_vec_t;
+use crate::error::update_last_error;
+use std::sync::Arc;
+use wasmer_api::{Module, ModuleStream};
+
+/// Opaque type representing a module being compiled while its bytes
+/// are received, see [`wasmer_module_stream_new`].
+///
+/// # Example
+///
+/// See the module's documentation.
+#[allow(non_camel_case_types)]
+pub struct wasmer_module_stream_t {
+    inner: ModuleStream,
+}
+
+/// Starts compiling a module whose bytes are written with
+/// [`wasmer_module_stream_write`], given the configuration in the
+/// store, like `wasm_module_new`.
+///
+/// It returns `NULL` if the compilation can't start, in which case the
+/// error can be read with `wasmer_last_error_message`.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_module_stream_new(
+    store: Option<&wasm_store_t>,
+) -> Option<Box<wasmer_module_stream_t>> {
+    let store = store?;
+
+    match Module::streaming(&store.inner) {
+        Ok(inner) => Some(Box::new(wasmer_module_stream_t { inner })),
+        Err(error) => {
+            update_last_error(error);
+            None
+        }
+    }
+}
+
+/// Writes the next bytes of a module. `bytes` is copied.
+///
+/// It returns `false` as soon as the bytes written so far are known to
+/// be an invalid module, in which case the error can be read with
+/// `wasmer_last_error_message`, and the stream can only be deleted.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_module_stream_write(
+    stream: Option<&mut wasmer_module_stream_t>,
+    bytes: Option<&wasm_byte_vec_t>,
+) -> bool {
+    let (stream, bytes) = match (stream, bytes) {
+        (Some(stream), Some(bytes)) => (stream, bytes),
+        _ => return false,
+    };
+
+    match stream.inner.write(bytes.as_slice()) {
+        Ok(()) => true,
+        Err(error) => {
+            update_last_error(error);
+            false
+        }
+    }
+}
+
+/// Ends a module, and returns it once compiled. It takes the ownership
+/// of the stream.
+///
+/// It returns `NULL` if the module is invalid or fails to compile, in
+/// which case the error can be read with `wasmer_last_error_message`.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_module_stream_finish(
+    stream: Option<Box<wasmer_module_stream_t>>,
+) -> Option<Box<wasm_module_t>> {
+    let stream = stream?;
+
+    match stream.inner.finish() {
+        Ok(module) => Some(Box::new(wasm_module_t {
+            inner: Arc::new(module),
+        })),
+        Err(error) => {
+            update_last_error(error);
+            None
+        }
+    }
+}
+
+/// Deletes a stream without finishing it, cancelling the compilation of
+/// its module.
+///
+/// # Example
+///
+/// See the module's documentation.
+#[no_mangle]
+pub extern "C" fn wasmer_module_stream_delete(_stream: Option<Box<wasmer_module_stream_t>>) {}
@@ -0,0 +1,83 @@
+//! Unstable non-standard Wasmer-specific API to configure a
+//! `wasm_store_t`.
+
+use super::super::store::wasm_store_t;
+
+/// Unstable non-standard Wasmer-specific API to set whether the native
+/// backtrace is captured when the WebAssembly code called through
+/// `store` traps. It is captured by default.
+///
+/// The frames of a trap are only symbolicated when `wasm_trap_origin`
+/// or `wasm_trap_trace` is called, but walking the stack still has a
+/// cost. Without it, the traps have no frames: guests which trap often,
+/// for instance to exit, and never look at the trace can turn it off.
+///
+/// # Example
+///
+/// ```rust
+/// # use inline_c::assert_c;
+/// # fn main() {
+/// #    (assert_c! {
+/// # #include "tests/wasmer.h"
+/// #
+/// int main() {
+///     // Create the engine and the store.
+///     wasm_engine_t* engine = wasm_engine_new();
+///     wasm_store_t* store = wasm_store_new(engine);
+///
+///     // Don't capture backtraces.
+///     wasmer_store_set_capture_backtraces(store, false);
+///
+///     // Create a WebAssembly module from a WAT definition.
+///     wasm_byte_vec_t wat;
+///     wasmer_byte_vec_new_from_string(
+///         &wat,
+///         "(module\n"
+///         "  (func (export \"exit\")\n"
+///         "    unreachable))"
+///     );
+///     wasm_byte_vec_t wasm;
+///     wat2wasm(&wat, &wasm);
+///
+///     wasm_module_t* module = wasm_module_new(store, &wasm);
+///     assert(module);
+///
+///     wasm_extern_vec_t imports = WASM_EMPTY_VEC;
+///     wasm_trap_t* trap = NULL;
+///     wasm_instance_t* instance = wasm_instance_new(store, module, &imports, &trap);
+///     assert(instance);
+///
+///     wasm_extern_vec_t exports;
+///     wasm_instance_exports(instance, &exports);
+///     const wasm_func_t* exit = wasm_extern_as_func(exports.data[0]);
+///
+///     // The call traps, and the trap has no frames.
+///     wasm_val_vec_t no_values = WASM_EMPTY_VEC;
+///     trap = wasm_func_call(exit, &no_values, &no_values);
+///     assert(trap);
+///
+///     wasm_frame_vec_t frames;
+///     wasm_trap_trace(trap, &frames);
+///     assert(frames.size == 0);
+///
+///     // Free everything.
+///     wasm_frame_vec_delete(&frames);
+///     wasm_trap_delete(trap);
+///     wasm_extern_vec_delete(&exports);
+///     wasm_instance_delete(instance);
+///     wasm_module_delete(module);
+///     wasm_byte_vec_delete(&wasm);
+///     wasm_byte_vec_delete(&wat);
+///     wasm_store_delete(store);
+///     wasm_engine_delete(engine);
+///
+///     return 0;
+/// }
+/// #    })
+/// #    .success();
+/// # }
+/// ```
+#[no_mangle]
+pub extern "C" fn wasmer_store_set_capture_backtraces(store: &wasm_store_t, capture: bool) {
+    store.inner.set_capture_backtraces(capture);
+}
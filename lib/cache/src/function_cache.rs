@@ -0,0 +1,97 @@
+use std::fs::{self, create_dir_all, File};
+use std::io::{self, Write};
+use std::path::PathBuf;
+use std::process;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use wasmer::{FunctionCache, FunctionCacheKey};
+
+/// Representation of a directory that contains compiled functions.
+///
+/// Unlike [`FileSystemCache`], which stores whole modules, the
+/// `FileSystemFunctionCache` stores each function of a module on its own,
+/// so that recompiling a module after editing some of its functions only
+/// compiles those again.
+///
+/// # Usage
+///
+/// ```
+/// use std::sync::Arc;
+/// use wasmer::CompilerConfig;
+/// use wasmer_cache::FileSystemFunctionCache;
+///
+/// fn enable_function_cache(config: &mut dyn CompilerConfig) -> std::io::Result<()> {
+///     // The directory is only written by this cache.
+///     let cache = unsafe { FileSystemFunctionCache::new("some/directory/goes/here")? };
+///     config.function_cache(Arc::new(cache));
+///     Ok(())
+/// }
+/// ```
+///
+/// [`FileSystemCache`]: crate::FileSystemCache
+#[derive(Debug)]
+pub struct FileSystemFunctionCache {
+    path: PathBuf,
+    /// Distinguishes the temporary files of concurrent stores.
+    next_temp: AtomicUsize,
+}
+
+impl FileSystemFunctionCache {
+    /// Construct a new `FileSystemFunctionCache` around the specified
+    /// directory, creating it if needed.
+    ///
+    /// # Safety
+    ///
+    /// The functions are loaded from the directory without validation,
+    /// like [`Module::deserialize`] loads modules: they are deserialized
+    /// directly into Rust objects, and their code is run. The directory
+    /// must only be written by `FileSystemFunctionCache`s.
+    ///
+    /// [`Module::deserialize`]: wasmer::Module::deserialize
+    pub unsafe fn new<P: Into<PathBuf>>(path: P) -> io::Result<Self> {
+        let path: PathBuf = path.into();
+        if path.exists() && !path.is_dir() {
+            return Err(io::Error::new(
+                io::ErrorKind::PermissionDenied,
+                format!(
+                    "the supplied path already points to a file: {}",
+                    path.display()
+                ),
+            ));
+        }
+        create_dir_all(&path)?;
+        Ok(Self {
+            path,
+            next_temp: AtomicUsize::new(0),
+        })
+    }
+
+    fn write(&self, key: &FunctionCacheKey, bytes: &[u8]) -> io::Result<()> {
+        // The functions of a module are stored concurrently, and other
+        // processes may load them at any time: write to a temporary file
+        // and rename it, so that a function is never read half-written.
+        let temp = self.path.join(format!(
+            "{}.{}.{}.tmp",
+            key,
+            process::id(),
+            self.next_temp.fetch_add(1, Ordering::Relaxed)
+        ));
+        let written = File::create(&temp).and_then(|mut file| file.write_all(bytes));
+        let renamed = written.and_then(|()| fs::rename(&temp, self.path.join(key.to_string())));
+        if renamed.is_err() {
+            let _ = fs::remove_file(&temp);
+        }
+        renamed
+    }
+}
+
+// The functions are stored under their key, and the contract of `new`
+// guarantees that only this cache writes to the directory.
+unsafe impl FunctionCache for FileSystemFunctionCache {
+    fn load(&self, key: &FunctionCacheKey) -> Option<Vec<u8>> {
+        fs::read(self.path.join(key.to_string())).ok()
+    }
+
+    fn store(&self, key: &FunctionCacheKey, bytes: &[u8]) {
+        let _ = self.write(key, bytes);
+    }
+}
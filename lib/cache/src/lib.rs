@@ -20,11 +20,15 @@
 
 mod cache;
 mod filesystem;
+#[cfg(all(feature = "filesystem", feature = "compiler"))]
+mod function_cache;
 mod hash;
 
 pub use crate::cache::Cache;
 #[cfg(feature = "filesystem")]
 pub use crate::filesystem::FileSystemCache;
+#[cfg(all(feature = "filesystem", feature = "compiler"))]
+pub use crate::function_cache::FileSystemFunctionCache;
 pub use crate::hash::Hash;
 
 // We re-export those for convinience of users
@@ -1,6 +1,8 @@
 //! Common module with common used structures across different
 //! commands.
 
+#[cfg(feature = "compiler")]
+use anyhow::Context;
 use anyhow::Result;
 
 #[allow(unused_imports)]
@@ -13,7 +15,7 @@ use std::sync::Arc;
 use structopt::StructOpt;
 use wasmer::*;
 #[cfg(feature = "compiler")]
-use wasmer_compiler::CompilerConfig;
+use wasmer_compiler::{CompilePool, CompilePoolConfig, CompilerConfig};
 
 #[derive(Debug, Clone, StructOpt, Default)]
 /// The compiler and engine options
@@ -72,6 +74,20 @@ pub struct CompilerOptions {
     #[structopt(long, parse(from_os_str))]
     llvm_debug_dir: Option<PathBuf>,
 
+    /// The number of threads to compile on. Defaults to the number of CPUs.
+    #[structopt(long)]
+    compile_threads: Option<usize>,
+
+    /// The niceness of the threads to compile on, from -20 (highest
+    /// priority) to 19 (lowest priority). Only supported on Linux.
+    #[structopt(long, allow_hyphen_values = true)]
+    compile_priority: Option<i32>,
+
+    /// The comma-separated list of the CPUs to compile on. Only supported
+    /// on Linux.
+    #[structopt(long, use_delimiter = true)]
+    compile_cpus: Vec<usize>,
+
     #[structopt(flatten)]
     features: WasmFeatures,
 }
@@ -103,6 +119,21 @@ impl CompilerOptions {
         }
     }
 
+    /// Get the pool of threads to compile on.
+    fn get_compile_pool(&self) -> Result<CompilePool> {
+        let mut config = CompilePoolConfig::new();
+        if let Some(threads) = self.compile_threads {
+            config.threads(threads);
+        }
+        if let Some(nice) = self.compile_priority {
+            config.priority(nice);
+        }
+        if !self.compile_cpus.is_empty() {
+            config.cpu_affinity(self.compile_cpus.clone());
+        }
+        CompilePool::new(config).context("could not create the compile pool")
+    }
+
     /// Get the enaled Wasm features.
     pub fn get_features(&self, mut features: Features) -> Result<Features> {
         if self.features.threads || self.features.all {
@@ -178,7 +209,7 @@ impl CompilerOptions {
     #[allow(unused_variables)]
     pub(crate) fn get_compiler_config(&self) -> Result<(Box<dyn CompilerConfig>, CompilerType)> {
         let compiler = self.get_compiler()?;
-        let compiler_config: Box<dyn CompilerConfig> = match compiler {
+        let mut compiler_config: Box<dyn CompilerConfig> = match compiler {
             CompilerType::Headless => bail!("The headless engine can't be chosen"),
             #[cfg(feature = "singlepass")]
             CompilerType::Singlepass => {
@@ -309,6 +340,8 @@ impl CompilerOptions {
         };
 
         #[allow(unreachable_code)]
+        compiler_config.compile_pool(self.get_compile_pool()?);
+
         Ok((compiler_config, compiler))
     }
 }
@@ -3,7 +3,7 @@
 use crate::address_map::get_function_address_map;
 use crate::config::Cranelift;
 #[cfg(feature = "unwind")]
-use crate::dwarf::WriterRelocate;
+use crate::dwarf::{eh_frame_section, WriterRelocate};
 use crate::func_environ::{get_function_name, FuncEnvironment};
 use crate::trampoline::{
     make_trampoline_dynamic_function, make_trampoline_function_call, FunctionBuilderContext,
@@ -22,13 +22,13 @@ use loupe::MemoryUsage;
 use rayon::prelude::{IntoParallelRefIterator, ParallelIterator};
 use std::sync::Arc;
 use wasmer_compiler::{
-    CallingConvention, ModuleTranslationState, RelocationTarget, Target, TrapInformation,
+    CachedFunction, Compilation, CompileModuleInfo, CompilePool, CompileScope, CompiledFunction,
+    CompiledFunctionFrameInfo, CompiledFunctionUnwindInfo, Compiler, CustomSection, Dwarf,
+    FunctionBinaryReader, FunctionBodies, FunctionBody, FunctionBodyData, FunctionBodyStream,
+    MiddlewareBinaryReader, ModuleMiddleware, ModuleMiddlewareChain, SectionIndex,
 };
 use wasmer_compiler::{
-    Compilation, CompileModuleInfo, CompiledFunction, CompiledFunctionFrameInfo,
-    CompiledFunctionUnwindInfo, Compiler, Dwarf, FunctionBinaryReader, FunctionBody,
-    FunctionBodyData, MiddlewareBinaryReader, ModuleMiddleware, ModuleMiddlewareChain,
-    SectionIndex,
+    CallingConvention, ModuleTranslationState, RelocationTarget, Target, TrapInformation,
 };
 use wasmer_compiler::{CompileError, Relocation};
 use wasmer_types::entity::{EntityRef, PrimaryMap};
@@ -60,6 +60,11 @@ impl Compiler for CraneliftCompiler {
         &self.config.middlewares
     }
 
+    /// Get the pool of threads this compiler compiles on
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        Some(&self.config.compile_pool)
+    }
+
     /// Compile the module using Cranelift, producing a compilation result with
     /// associated relocations.
     fn compile_module(
@@ -68,6 +73,61 @@ impl Compiler for CraneliftCompiler {
         compile_info: &CompileModuleInfo,
         module_translation_state: &ModuleTranslationState,
         function_body_inputs: PrimaryMap<LocalFunctionIndex, FunctionBodyData<'_>>,
+    ) -> Result<Compilation, CompileError> {
+        self.compile_function_bodies(
+            target,
+            compile_info,
+            module_translation_state,
+            FunctionBodies::Received(function_body_inputs),
+        )
+    }
+
+    /// Compile the module using Cranelift, compiling each function as soon
+    /// as its body is received.
+    fn compile_module_streaming(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        module_translation_state: &ModuleTranslationState,
+        function_bodies: FunctionBodyStream,
+    ) -> Result<Compilation, CompileError> {
+        self.compile_function_bodies(
+            target,
+            compile_info,
+            module_translation_state,
+            FunctionBodies::Streamed(function_bodies),
+        )
+    }
+}
+
+impl CraneliftCompiler {
+    fn compile_function_bodies(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        module_translation_state: &ModuleTranslationState,
+        function_bodies: FunctionBodies<'_>,
+    ) -> Result<Compilation, CompileError> {
+        function_bodies.compile_on(&self.config.compile_pool, |scope, function_bodies| {
+            self.compile_on_pool(
+                scope,
+                target,
+                compile_info,
+                module_translation_state,
+                function_bodies,
+            )
+        })
+    }
+
+    /// Compiles the function bodies on the threads of the pool of
+    /// `scope`.
+    fn compile_on_pool(
+        &self,
+        scope: &CompileScope,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        module_translation_state: &ModuleTranslationState,
+        function_bodies: FunctionBodies<'_>,
     ) -> Result<Compilation, CompileError> {
         let isa = self
             .config()
@@ -85,7 +145,7 @@ impl Compiler for CraneliftCompiler {
 
         // Generate the frametable
         #[cfg(feature = "unwind")]
-        let dwarf_frametable = if function_body_inputs.is_empty() {
+        let dwarf_frametable = if function_bodies.is_empty() {
             // If we have no function body inputs, we don't need to
             // construct the `FrameTable`. Constructing it, with empty
             // FDEs will cause some issues in Linux.
@@ -109,12 +169,21 @@ impl Compiler for CraneliftCompiler {
 
         let mut custom_sections = PrimaryMap::new();
 
-        let (functions, fdes): (Vec<CompiledFunction>, Vec<_>) = function_body_inputs
-            .iter()
-            .collect::<Vec<(LocalFunctionIndex, &FunctionBodyData<'_>)>>()
-            .par_iter()
-            .map_init(FuncTranslator::new, |func_translator, (i, input)| {
-                let func_index = module.func_index(*i);
+        let function_cache = self.config.module_function_cache(target, compile_info);
+
+        scope.add_functions(function_bodies.len());
+        let (functions, unwind): (Vec<CompiledFunction>, Vec<_>) = function_bodies
+            .compile_each(scope, FuncTranslator::new, |func_translator, i, input| {
+                scope.check_cancelled()?;
+
+                if let Some(cached) = function_cache
+                    .as_ref()
+                    .and_then(|function_cache| function_cache.load(i, input))
+                {
+                    return Ok(cached_function_parts(cached));
+                }
+
+                let func_index = module.func_index(i);
                 let mut context = Context::new();
                 let mut func_env = FuncEnvironment::new(
                     isa.frontend_config(),
@@ -133,7 +202,7 @@ impl Compiler for CraneliftCompiler {
                 reader.set_middleware_chain(
                     self.config
                         .middlewares
-                        .generate_function_middleware_chain(*i),
+                        .generate_function_middleware_chain_for_module(module, i),
                 );
 
                 func_translator.translate(
@@ -141,7 +210,7 @@ impl Compiler for CraneliftCompiler {
                     &mut reader,
                     &mut context.func,
                     &mut func_env,
-                    *i,
+                    i,
                 )?;
 
                 let mut code_buf: Vec<u8> = Vec::new();
@@ -194,31 +263,56 @@ impl Compiler for CraneliftCompiler {
                 let range = reader.range();
                 let address_map = get_function_address_map(&context, range, code_buf.len());
 
-                Ok((
-                    CompiledFunction {
-                        body: FunctionBody {
-                            body: code_buf,
-                            unwind_info,
-                        },
-                        relocations: func_relocs,
-                        frame_info: CompiledFunctionFrameInfo { address_map, traps },
+                let compiled_function = CompiledFunction {
+                    body: FunctionBody {
+                        body: code_buf,
+                        unwind_info,
                     },
-                    fde,
-                ))
-            })
-            .collect::<Result<Vec<_>, CompileError>>()?
+                    relocations: func_relocs,
+                    frame_info: CompiledFunctionFrameInfo { address_map, traps },
+                };
+
+                if let Some(function_cache) = &function_cache {
+                    // The cached functions have `.eh_frame` entries of
+                    // their own, rather than sharing the CIE of the module.
+                    #[cfg_attr(not(feature = "unwind"), allow(unused_mut))]
+                    let mut custom_sections = PrimaryMap::new();
+                    #[cfg(feature = "unwind")]
+                    if let (Some(fde), Some(cie)) = (fde, isa.create_systemv_cie()) {
+                        custom_sections.push(eh_frame_section(
+                            cie,
+                            fde,
+                            target.triple().endianness().ok(),
+                        ));
+                    }
+                    let cached = CachedFunction {
+                        compiled_function,
+                        eh_frame_sections: custom_sections.keys().collect(),
+                        custom_sections,
+                    };
+                    function_cache.store(i, input, &cached);
+                    return Ok(cached_function_parts(cached));
+                }
+
+                Ok((compiled_function, (fde, None)))
+            })?
             .into_iter()
             .unzip();
 
         #[cfg(feature = "unwind")]
         let dwarf = if let Some((mut dwarf_frametable, cie_id)) = dwarf_frametable {
-            for fde in fdes {
+            let mut eh_frame_sections = vec![];
+            for (fde, eh_frame_section) in unwind {
                 if let Some(fde) = fde {
                     dwarf_frametable.add_fde(cie_id, fde);
                 }
+                eh_frame_sections.extend(eh_frame_section);
             }
             let mut eh_frame = EhFrame(WriterRelocate::new(target.triple().endianness().ok()));
             dwarf_frametable.write_eh_frame(&mut eh_frame).unwrap();
+            for eh_frame_section in &eh_frame_sections {
+                eh_frame.0.append_section(eh_frame_section);
+            }
 
             let eh_frame_section = eh_frame.0.into_section();
             custom_sections.push(eh_frame_section);
@@ -230,29 +324,35 @@ impl Compiler for CraneliftCompiler {
         let dwarf = None;
 
         // function call trampolines (only for local functions, by signature)
-        let function_call_trampolines = module
-            .signatures
-            .values()
-            .collect::<Vec<_>>()
-            .par_iter()
-            .map_init(FunctionBuilderContext::new, |mut cx, sig| {
-                make_trampoline_function_call(&*isa, &mut cx, sig)
-            })
-            .collect::<Result<Vec<FunctionBody>, CompileError>>()?
+        let function_call_trampolines = scope
+            .install(|| {
+                module
+                    .signatures
+                    .values()
+                    .collect::<Vec<_>>()
+                    .par_iter()
+                    .map_init(FunctionBuilderContext::new, |mut cx, sig| {
+                        make_trampoline_function_call(&*isa, &mut cx, sig)
+                    })
+                    .collect::<Result<Vec<FunctionBody>, CompileError>>()
+            })?
             .into_iter()
             .collect::<PrimaryMap<SignatureIndex, FunctionBody>>();
 
         use wasmer_vm::VMOffsets;
         let offsets = VMOffsets::new_for_trampolines(frontend_config.pointer_bytes());
         // dynamic function trampolines (only for imported functions)
-        let dynamic_function_trampolines = module
-            .imported_function_types()
-            .collect::<Vec<_>>()
-            .par_iter()
-            .map_init(FunctionBuilderContext::new, |mut cx, func_type| {
-                make_trampoline_dynamic_function(&*isa, &offsets, &mut cx, &func_type)
-            })
-            .collect::<Result<Vec<_>, CompileError>>()?
+        let dynamic_function_trampolines = scope
+            .install(|| {
+                module
+                    .imported_function_types()
+                    .collect::<Vec<_>>()
+                    .par_iter()
+                    .map_init(FunctionBuilderContext::new, |mut cx, func_type| {
+                        make_trampoline_dynamic_function(&*isa, &offsets, &mut cx, &func_type)
+                    })
+                    .collect::<Result<Vec<_>, CompileError>>()
+            })?
             .into_iter()
             .collect::<PrimaryMap<FunctionIndex, FunctionBody>>();
 
@@ -266,6 +366,20 @@ impl Compiler for CraneliftCompiler {
     }
 }
 
+/// Splits a function of the function cache into the function and its
+/// `.eh_frame` entries, if any.
+fn cached_function_parts<T>(
+    cached: CachedFunction,
+) -> (CompiledFunction, (Option<T>, Option<CustomSection>)) {
+    let eh_frame_sections = cached.eh_frame_sections;
+    let eh_frame_section = cached
+        .custom_sections
+        .into_iter()
+        .find(|(index, _)| eh_frame_sections.contains(index))
+        .map(|(_, section)| section);
+    (cached.compiled_function, (None, eh_frame_section))
+}
+
 fn mach_reloc_to_reloc(module: &ModuleInfo, reloc: &MachReloc) -> Relocation {
     let &MachReloc {
         offset,
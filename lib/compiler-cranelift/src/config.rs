@@ -5,7 +5,8 @@ use cranelift_codegen::CodegenResult;
 use loupe::MemoryUsage;
 use std::sync::Arc;
 use wasmer_compiler::{
-    Architecture, Compiler, CompilerConfig, CpuFeature, ModuleMiddleware, Target,
+    Architecture, CompileModuleInfo, CompilePool, Compiler, CompilerConfig, CpuFeature,
+    FunctionCache, ModuleFunctionCache, ModuleMiddleware, Target,
 };
 
 // Runtime Environment
@@ -37,6 +38,10 @@ pub struct Cranelift {
     opt_level: CraneliftOptLevel,
     /// The middleware chain.
     pub(crate) middlewares: Vec<Arc<dyn ModuleMiddleware>>,
+    #[loupe(skip)]
+    function_cache: Option<Arc<dyn FunctionCache>>,
+    /// The pool of threads to compile on.
+    pub(crate) compile_pool: CompilePool,
 }
 
 impl Cranelift {
@@ -49,6 +54,8 @@ impl Cranelift {
             opt_level: CraneliftOptLevel::Speed,
             enable_pic: false,
             middlewares: vec![],
+            function_cache: None,
+            compile_pool: CompilePool::default(),
         }
     }
 
@@ -67,6 +74,33 @@ impl Cranelift {
         self
     }
 
+    /// The function cache to look the functions of a module up in, if
+    /// any. The cache is not used with middlewares.
+    pub(crate) fn module_function_cache(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+    ) -> Option<ModuleFunctionCache> {
+        if !self.middlewares.is_empty() {
+            return None;
+        }
+        let cache = self.function_cache.as_deref()?;
+        // The settings that change the generated code.
+        let settings = (
+            self.enable_nan_canonicalization,
+            self.enable_pic,
+            &self.opt_level,
+            cfg!(feature = "unwind"),
+        );
+        Some(ModuleFunctionCache::new(
+            cache,
+            "cranelift",
+            &settings,
+            target,
+            compile_info,
+        ))
+    }
+
     /// Generates the ISA for the provided target
     pub fn isa(&self, target: &Target) -> CodegenResult<Box<dyn TargetIsa>> {
         let mut builder =
@@ -209,6 +243,14 @@ impl CompilerConfig for Cranelift {
     fn push_middleware(&mut self, middleware: Arc<dyn ModuleMiddleware>) {
         self.middlewares.push(middleware);
     }
+
+    fn function_cache(&mut self, cache: Arc<dyn FunctionCache>) {
+        self.function_cache = Some(cache);
+    }
+
+    fn compile_pool(&mut self, pool: CompilePool) {
+        self.compile_pool = pool;
+    }
 }
 
 impl Default for Cranelift {
@@ -56,6 +56,10 @@ pub struct FuncEnvironment<'module_environment> {
     /// for locally-defined 32-bit memories.
     memory32_size_sig: Option<ir::SigRef>,
 
+    /// The external function signature for implementing wasm's `memory.size`
+    /// for 64-bit memories.
+    memory64_size_sig: Option<ir::SigRef>,
+
     /// The external function signature for implementing wasm's `table.size`
     /// for locally-defined tables.
     table_size_sig: Option<ir::SigRef>,
@@ -64,6 +68,10 @@ pub struct FuncEnvironment<'module_environment> {
     /// for locally-defined memories.
     memory_grow_sig: Option<ir::SigRef>,
 
+    /// The external function signature for implementing wasm's `memory.grow`
+    /// for 64-bit memories.
+    memory64_grow_sig: Option<ir::SigRef>,
+
     /// The external function signature for implementing wasm's `table.grow`
     /// for locally-defined tables.
     table_grow_sig: Option<ir::SigRef>,
@@ -82,13 +90,40 @@ pub struct FuncEnvironment<'module_environment> {
     /// (it's the same for both local and imported memories).
     memory_copy_sig: Option<ir::SigRef>,
 
+    /// The external function signature for implementing wasm's `memory.copy`
+    /// for 64-bit memories.
+    memory64_copy_sig: Option<ir::SigRef>,
+
     /// The external function signature for implementing wasm's `memory.fill`
     /// (it's the same for both local and imported memories).
     memory_fill_sig: Option<ir::SigRef>,
 
+    /// The external function signature for implementing wasm's `memory.fill`
+    /// for 64-bit memories.
+    memory64_fill_sig: Option<ir::SigRef>,
+
     /// The external function signature for implementing wasm's `memory.init`.
     memory_init_sig: Option<ir::SigRef>,
 
+    /// The external function signature for implementing wasm's `memory.init`
+    /// for 64-bit memories.
+    memory64_init_sig: Option<ir::SigRef>,
+
+    /// The external function signature for implementing wasm's
+    /// `memory.atomic.wait32` (it's the same for both local and imported
+    /// memories).
+    memory_atomic_wait32_sig: Option<ir::SigRef>,
+
+    /// The external function signature for implementing wasm's
+    /// `memory.atomic.wait64` (it's the same for both local and imported
+    /// memories).
+    memory_atomic_wait64_sig: Option<ir::SigRef>,
+
+    /// The external function signature for implementing wasm's
+    /// `memory.atomic.notify` (it's the same for both local and imported
+    /// memories).
+    memory_atomic_notify_sig: Option<ir::SigRef>,
+
     /// The external function signature for implementing wasm's `data.drop`.
     data_drop_sig: Option<ir::SigRef>,
 
@@ -134,15 +169,23 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
             type_stack: vec![],
             vmctx: None,
             memory32_size_sig: None,
+            memory64_size_sig: None,
             table_size_sig: None,
             memory_grow_sig: None,
+            memory64_grow_sig: None,
             table_grow_sig: None,
             table_copy_sig: None,
             table_init_sig: None,
             elem_drop_sig: None,
             memory_copy_sig: None,
+            memory64_copy_sig: None,
             memory_fill_sig: None,
+            memory64_fill_sig: None,
             memory_init_sig: None,
+            memory64_init_sig: None,
+            memory_atomic_wait32_sig: None,
+            memory_atomic_wait64_sig: None,
+            memory_atomic_notify_sig: None,
             table_get_sig: None,
             table_set_sig: None,
             data_drop_sig: None,
@@ -386,19 +429,37 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         }
     }
 
-    fn get_memory_grow_sig(&mut self, func: &mut Function) -> ir::SigRef {
-        let sig = self.memory_grow_sig.unwrap_or_else(|| {
+    /// Return the type of the addresses, sizes and page counts of the given memory.
+    fn memory_index_type(&self, index: MemoryIndex) -> ir::Type {
+        if self.module.memories[index].memory64 {
+            I64
+        } else {
+            I32
+        }
+    }
+
+    fn get_memory_grow_sig(&mut self, func: &mut Function, index_ty: ir::Type) -> ir::SigRef {
+        let cached_sig = if index_ty == I64 {
+            self.memory64_grow_sig
+        } else {
+            self.memory_grow_sig
+        };
+        let sig = cached_sig.unwrap_or_else(|| {
             func.import_signature(Signature {
                 params: vec![
                     AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                     AbiParam::new(I32),
                 ],
-                returns: vec![AbiParam::new(I32)],
+                returns: vec![AbiParam::new(index_ty)],
                 call_conv: self.target_config.default_call_conv,
             })
         });
-        self.memory_grow_sig = Some(sig);
+        if index_ty == I64 {
+            self.memory64_grow_sig = Some(sig);
+        } else {
+            self.memory_grow_sig = Some(sig);
+        }
         sig
     }
 
@@ -409,18 +470,29 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         func: &mut Function,
         index: MemoryIndex,
     ) -> (ir::SigRef, usize, VMBuiltinFunctionIndex) {
-        if self.module.is_imported_memory(index) {
-            (
-                self.get_memory_grow_sig(func),
+        let index_ty = self.memory_index_type(index);
+        let sig = self.get_memory_grow_sig(func, index_ty);
+        match (self.module.local_memory_index(index), index_ty == I64) {
+            (Some(local_memory_index), false) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory32_grow_index(),
+            ),
+            (Some(local_memory_index), true) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory64_grow_index(),
+            ),
+            (None, false) => (
+                sig,
                 index.index(),
                 VMBuiltinFunctionIndex::get_imported_memory32_grow_index(),
-            )
-        } else {
-            (
-                self.get_memory_grow_sig(func),
-                self.module.local_memory_index(index).unwrap().index(),
-                VMBuiltinFunctionIndex::get_memory32_grow_index(),
-            )
+            ),
+            (None, true) => (
+                sig,
+                index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory64_grow_index(),
+            ),
         }
     }
 
@@ -461,18 +533,27 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         }
     }
 
-    fn get_memory32_size_sig(&mut self, func: &mut Function) -> ir::SigRef {
-        let sig = self.memory32_size_sig.unwrap_or_else(|| {
+    fn get_memory_size_sig(&mut self, func: &mut Function, index_ty: ir::Type) -> ir::SigRef {
+        let cached_sig = if index_ty == I64 {
+            self.memory64_size_sig
+        } else {
+            self.memory32_size_sig
+        };
+        let sig = cached_sig.unwrap_or_else(|| {
             func.import_signature(Signature {
                 params: vec![
                     AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
                     AbiParam::new(I32),
                 ],
-                returns: vec![AbiParam::new(I32)],
+                returns: vec![AbiParam::new(index_ty)],
                 call_conv: self.target_config.default_call_conv,
             })
         });
-        self.memory32_size_sig = Some(sig);
+        if index_ty == I64 {
+            self.memory64_size_sig = Some(sig);
+        } else {
+            self.memory32_size_sig = Some(sig);
+        }
         sig
     }
 
@@ -483,18 +564,29 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         func: &mut Function,
         index: MemoryIndex,
     ) -> (ir::SigRef, usize, VMBuiltinFunctionIndex) {
-        if self.module.is_imported_memory(index) {
-            (
-                self.get_memory32_size_sig(func),
+        let index_ty = self.memory_index_type(index);
+        let sig = self.get_memory_size_sig(func, index_ty);
+        match (self.module.local_memory_index(index), index_ty == I64) {
+            (Some(local_memory_index), false) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory32_size_index(),
+            ),
+            (Some(local_memory_index), true) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory64_size_index(),
+            ),
+            (None, false) => (
+                sig,
                 index.index(),
                 VMBuiltinFunctionIndex::get_imported_memory32_size_index(),
-            )
-        } else {
-            (
-                self.get_memory32_size_sig(func),
-                self.module.local_memory_index(index).unwrap().index(),
-                VMBuiltinFunctionIndex::get_memory32_size_index(),
-            )
+            ),
+            (None, true) => (
+                sig,
+                index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory64_size_index(),
+            ),
         }
     }
 
@@ -596,25 +688,34 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         (sig, VMBuiltinFunctionIndex::get_elem_drop_index())
     }
 
-    fn get_memory_copy_sig(&mut self, func: &mut Function) -> ir::SigRef {
-        let sig = self.memory_copy_sig.unwrap_or_else(|| {
+    fn get_memory_copy_sig(&mut self, func: &mut Function, index_ty: ir::Type) -> ir::SigRef {
+        let cached_sig = if index_ty == I64 {
+            self.memory64_copy_sig
+        } else {
+            self.memory_copy_sig
+        };
+        let sig = cached_sig.unwrap_or_else(|| {
             func.import_signature(Signature {
                 params: vec![
                     AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
                     // Memory index.
                     AbiParam::new(I32),
                     // Destination address.
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                     // Source address.
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                     // Length.
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                 ],
                 returns: vec![],
                 call_conv: self.target_config.default_call_conv,
             })
         });
-        self.memory_copy_sig = Some(sig);
+        if index_ty == I64 {
+            self.memory64_copy_sig = Some(sig);
+        } else {
+            self.memory_copy_sig = Some(sig);
+        }
         sig
     }
 
@@ -623,41 +724,63 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         func: &mut Function,
         memory_index: MemoryIndex,
     ) -> (ir::SigRef, usize, VMBuiltinFunctionIndex) {
-        let sig = self.get_memory_copy_sig(func);
-        if let Some(local_memory_index) = self.module.local_memory_index(memory_index) {
-            (
+        let index_ty = self.memory_index_type(memory_index);
+        let sig = self.get_memory_copy_sig(func, index_ty);
+        match (
+            self.module.local_memory_index(memory_index),
+            index_ty == I64,
+        ) {
+            (Some(local_memory_index), false) => (
                 sig,
                 local_memory_index.index(),
                 VMBuiltinFunctionIndex::get_memory_copy_index(),
-            )
-        } else {
-            (
+            ),
+            (Some(local_memory_index), true) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory64_copy_index(),
+            ),
+            (None, false) => (
                 sig,
                 memory_index.index(),
                 VMBuiltinFunctionIndex::get_imported_memory_copy_index(),
-            )
+            ),
+            (None, true) => (
+                sig,
+                memory_index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory64_copy_index(),
+            ),
         }
     }
 
-    fn get_memory_fill_sig(&mut self, func: &mut Function) -> ir::SigRef {
-        let sig = self.memory_fill_sig.unwrap_or_else(|| {
+    fn get_memory_fill_sig(&mut self, func: &mut Function, index_ty: ir::Type) -> ir::SigRef {
+        let cached_sig = if index_ty == I64 {
+            self.memory64_fill_sig
+        } else {
+            self.memory_fill_sig
+        };
+        let sig = cached_sig.unwrap_or_else(|| {
             func.import_signature(Signature {
                 params: vec![
                     AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
                     // Memory index.
                     AbiParam::new(I32),
                     // Destination address.
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                     // Value.
                     AbiParam::new(I32),
                     // Length.
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                 ],
                 returns: vec![],
                 call_conv: self.target_config.default_call_conv,
             })
         });
-        self.memory_fill_sig = Some(sig);
+        if index_ty == I64 {
+            self.memory64_fill_sig = Some(sig);
+        } else {
+            self.memory_fill_sig = Some(sig);
+        }
         sig
     }
 
@@ -666,24 +789,156 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
         func: &mut Function,
         memory_index: MemoryIndex,
     ) -> (ir::SigRef, usize, VMBuiltinFunctionIndex) {
-        let sig = self.get_memory_fill_sig(func);
+        let index_ty = self.memory_index_type(memory_index);
+        let sig = self.get_memory_fill_sig(func, index_ty);
+        match (
+            self.module.local_memory_index(memory_index),
+            index_ty == I64,
+        ) {
+            (Some(local_memory_index), false) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory_fill_index(),
+            ),
+            (Some(local_memory_index), true) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory64_fill_index(),
+            ),
+            (None, false) => (
+                sig,
+                memory_index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory_fill_index(),
+            ),
+            (None, true) => (
+                sig,
+                memory_index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory64_fill_index(),
+            ),
+        }
+    }
+
+    fn get_memory_atomic_wait_sig(
+        &mut self,
+        func: &mut Function,
+        expected_ty: ir::Type,
+    ) -> ir::SigRef {
+        let cached_sig = if expected_ty == I64 {
+            self.memory_atomic_wait64_sig
+        } else {
+            self.memory_atomic_wait32_sig
+        };
+        let sig = cached_sig.unwrap_or_else(|| {
+            func.import_signature(Signature {
+                params: vec![
+                    AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
+                    // Memory index.
+                    AbiParam::new(I32),
+                    // Address.
+                    AbiParam::new(I32),
+                    // Expected value.
+                    AbiParam::new(expected_ty),
+                    // Timeout.
+                    AbiParam::new(I64),
+                ],
+                returns: vec![AbiParam::new(I32)],
+                call_conv: self.target_config.default_call_conv,
+            })
+        });
+        if expected_ty == I64 {
+            self.memory_atomic_wait64_sig = Some(sig);
+        } else {
+            self.memory_atomic_wait32_sig = Some(sig);
+        }
+        sig
+    }
+
+    /// Return the `memory.atomic.wait32` or `memory.atomic.wait64`
+    /// function signature to call for the given index, depending on the
+    /// type of the expected value, along with the translated index value
+    /// to pass to it and its index in `VMBuiltinFunctionsArray`.
+    fn get_memory_atomic_wait_func(
+        &mut self,
+        func: &mut Function,
+        memory_index: MemoryIndex,
+        expected_ty: ir::Type,
+    ) -> (ir::SigRef, usize, VMBuiltinFunctionIndex) {
+        let sig = self.get_memory_atomic_wait_sig(func, expected_ty);
+        match (
+            self.module.local_memory_index(memory_index),
+            expected_ty == I64,
+        ) {
+            (Some(local_memory_index), false) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory_atomic_wait32_index(),
+            ),
+            (Some(local_memory_index), true) => (
+                sig,
+                local_memory_index.index(),
+                VMBuiltinFunctionIndex::get_memory_atomic_wait64_index(),
+            ),
+            (None, false) => (
+                sig,
+                memory_index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory_atomic_wait32_index(),
+            ),
+            (None, true) => (
+                sig,
+                memory_index.index(),
+                VMBuiltinFunctionIndex::get_imported_memory_atomic_wait64_index(),
+            ),
+        }
+    }
+
+    fn get_memory_atomic_notify_sig(&mut self, func: &mut Function) -> ir::SigRef {
+        let sig = self.memory_atomic_notify_sig.unwrap_or_else(|| {
+            func.import_signature(Signature {
+                params: vec![
+                    AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
+                    // Memory index.
+                    AbiParam::new(I32),
+                    // Address.
+                    AbiParam::new(I32),
+                    // Count.
+                    AbiParam::new(I32),
+                ],
+                returns: vec![AbiParam::new(I32)],
+                call_conv: self.target_config.default_call_conv,
+            })
+        });
+        self.memory_atomic_notify_sig = Some(sig);
+        sig
+    }
+
+    fn get_memory_atomic_notify_func(
+        &mut self,
+        func: &mut Function,
+        memory_index: MemoryIndex,
+    ) -> (ir::SigRef, usize, VMBuiltinFunctionIndex) {
+        let sig = self.get_memory_atomic_notify_sig(func);
         if let Some(local_memory_index) = self.module.local_memory_index(memory_index) {
             (
                 sig,
                 local_memory_index.index(),
-                VMBuiltinFunctionIndex::get_memory_fill_index(),
+                VMBuiltinFunctionIndex::get_memory_atomic_notify_index(),
             )
         } else {
             (
                 sig,
                 memory_index.index(),
-                VMBuiltinFunctionIndex::get_imported_memory_fill_index(),
+                VMBuiltinFunctionIndex::get_imported_memory_atomic_notify_index(),
             )
         }
     }
 
-    fn get_memory_init_sig(&mut self, func: &mut Function) -> ir::SigRef {
-        let sig = self.memory_init_sig.unwrap_or_else(|| {
+    fn get_memory_init_sig(&mut self, func: &mut Function, index_ty: ir::Type) -> ir::SigRef {
+        let cached_sig = if index_ty == I64 {
+            self.memory64_init_sig
+        } else {
+            self.memory_init_sig
+        };
+        let sig = cached_sig.unwrap_or_else(|| {
             func.import_signature(Signature {
                 params: vec![
                     AbiParam::special(self.pointer_type(), ArgumentPurpose::VMContext),
@@ -692,7 +947,7 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
                     // Data index.
                     AbiParam::new(I32),
                     // Destination address.
-                    AbiParam::new(I32),
+                    AbiParam::new(index_ty),
                     // Source index within the data segment.
                     AbiParam::new(I32),
                     // Length.
@@ -702,16 +957,26 @@ impl<'module_environment> FuncEnvironment<'module_environment> {
                 call_conv: self.target_config.default_call_conv,
             })
         });
-        self.memory_init_sig = Some(sig);
+        if index_ty == I64 {
+            self.memory64_init_sig = Some(sig);
+        } else {
+            self.memory_init_sig = Some(sig);
+        }
         sig
     }
 
     fn get_memory_init_func(
         &mut self,
         func: &mut Function,
+        memory_index: MemoryIndex,
     ) -> (ir::SigRef, VMBuiltinFunctionIndex) {
-        let sig = self.get_memory_init_sig(func);
-        (sig, VMBuiltinFunctionIndex::get_memory_init_index())
+        let index_ty = self.memory_index_type(memory_index);
+        let sig = self.get_memory_init_sig(func, index_ty);
+        if index_ty == I64 {
+            (sig, VMBuiltinFunctionIndex::get_memory64_init_index())
+        } else {
+            (sig, VMBuiltinFunctionIndex::get_memory_init_index())
+        }
     }
 
     fn get_data_drop_sig(&mut self, func: &mut Function) -> ir::SigRef {
@@ -1078,7 +1343,7 @@ impl<'module_environment> BaseFuncEnvironment for FuncEnvironment<'module_enviro
             min_size: 0.into(),
             offset_guard_size,
             style: heap_style,
-            index_type: I32,
+            index_type: self.memory_index_type(index),
         }))
     }
 
@@ -1355,7 +1620,7 @@ impl<'module_environment> BaseFuncEnvironment for FuncEnvironment<'module_enviro
         src: ir::Value,
         len: ir::Value,
     ) -> WasmResult<()> {
-        let (func_sig, func_idx) = self.get_memory_init_func(&mut pos.func);
+        let (func_sig, func_idx) = self.get_memory_init_func(&mut pos.func, memory_index);
 
         let memory_index_arg = pos.ins().iconst(I32, memory_index.index() as i64);
         let seg_index_arg = pos.ins().iconst(I32, seg_index as i64);
@@ -1472,29 +1737,52 @@ impl<'module_environment> BaseFuncEnvironment for FuncEnvironment<'module_enviro
 
     fn translate_atomic_wait(
         &mut self,
-        _pos: FuncCursor,
-        _index: MemoryIndex,
+        mut pos: FuncCursor,
+        index: MemoryIndex,
         _heap: ir::Heap,
-        _addr: ir::Value,
-        _expected: ir::Value,
-        _timeout: ir::Value,
+        addr: ir::Value,
+        expected: ir::Value,
+        timeout: ir::Value,
     ) -> WasmResult<ir::Value> {
-        Err(WasmError::Unsupported(
-            "wasm atomics (fn translate_atomic_wait)".to_string(),
-        ))
+        if self.module.memories[index].memory64 {
+            return Err(WasmError::Unsupported(
+                "`memory.atomic.wait` on a 64-bit memory".into(),
+            ));
+        }
+        let expected_ty = pos.func.dfg.value_type(expected);
+        let (func_sig, index_arg, func_idx) =
+            self.get_memory_atomic_wait_func(&mut pos.func, index, expected_ty);
+        let memory_index = pos.ins().iconst(I32, index_arg as i64);
+        let (vmctx, func_addr) = self.translate_load_builtin_function_address(&mut pos, func_idx);
+        let call_inst = pos.ins().call_indirect(
+            func_sig,
+            func_addr,
+            &[vmctx, memory_index, addr, expected, timeout],
+        );
+        Ok(*pos.func.dfg.inst_results(call_inst).first().unwrap())
     }
 
     fn translate_atomic_notify(
         &mut self,
-        _pos: FuncCursor,
-        _index: MemoryIndex,
+        mut pos: FuncCursor,
+        index: MemoryIndex,
         _heap: ir::Heap,
-        _addr: ir::Value,
-        _count: ir::Value,
+        addr: ir::Value,
+        count: ir::Value,
     ) -> WasmResult<ir::Value> {
-        Err(WasmError::Unsupported(
-            "wasm atomics (fn translate_atomic_notify)".to_string(),
-        ))
+        if self.module.memories[index].memory64 {
+            return Err(WasmError::Unsupported(
+                "`memory.atomic.notify` on a 64-bit memory".into(),
+            ));
+        }
+        let (func_sig, index_arg, func_idx) =
+            self.get_memory_atomic_notify_func(&mut pos.func, index);
+        let memory_index = pos.ins().iconst(I32, index_arg as i64);
+        let (vmctx, func_addr) = self.translate_load_builtin_function_address(&mut pos, func_idx);
+        let call_inst =
+            pos.ins()
+                .call_indirect(func_sig, func_addr, &[vmctx, memory_index, addr, count]);
+        Ok(*pos.func.dfg.inst_results(call_inst).first().unwrap())
     }
 
     fn get_global_type(&self, global_index: GlobalIndex) -> Option<WasmerType> {
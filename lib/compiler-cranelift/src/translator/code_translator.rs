@@ -192,6 +192,10 @@ pub fn translate_operator<FE: FuncEnvironment + ?Sized>(
                 GlobalVariable::Memory { gv, offset, ty } => {
                     let global_type = environ.get_global_type(global_index).unwrap();
                     let addr = builder.ins().global_value(environ.pointer_type(), gv);
+                    // Not `readonly`: the load is neither hoisted out of
+                    // loops nor merged, so the globals the host writes
+                    // while the function runs, e.g. those in
+                    // `ModuleInfo::volatile_globals`, are read each time.
                     let flags = ir::MemFlags::trusted();
                     let value = builder.ins().load(ty, flags, addr, offset);
                     let ref_counted = global_type == WasmerType::ExternRef;
@@ -2338,6 +2342,30 @@ fn get_heap_addr(
     }
 }
 
+/// Split the static offset of a heap access into the part that `get_heap_addr` can check, and
+/// the part that has to be added to the address up front.
+///
+/// Offsets only exceed 32 bits with 64-bit memories, whose addresses are `I64`: the sum traps if
+/// it overflows, since such an access is always out of bounds.
+fn fold_heap_offset(
+    addr: ir::Value,
+    offset: u64,
+    builder: &mut FunctionBuilder,
+) -> (ir::Value, u32) {
+    match u32::try_from(offset) {
+        Ok(offset) => (addr, offset),
+        Err(_) => {
+            debug_assert!(builder.func.dfg.value_type(addr) == I64);
+            let sum = builder.ins().iadd_imm(addr, offset as i64);
+            let overflow = builder.ins().icmp(IntCC::UnsignedLessThan, sum, addr);
+            builder
+                .ins()
+                .trapnz(overflow, ir::TrapCode::HeapOutOfBounds);
+            (sum, 0)
+        }
+    }
+}
+
 /// Prepare for a load; factors out common functionality between load and load_extend operations.
 fn prepare_load<FE: FuncEnvironment + ?Sized>(
     memarg: &MemoryImmediate,
@@ -2346,13 +2374,14 @@ fn prepare_load<FE: FuncEnvironment + ?Sized>(
     state: &mut FuncTranslationState,
     environ: &mut FE,
 ) -> WasmResult<(MemFlags, Value, Offset32)> {
-    let (addr32, _) = state.pop1();
+    let (addr, _) = state.pop1();
 
     let heap = state.get_heap(builder.func, memarg.memory, environ)?;
+    let (addr, offset) = fold_heap_offset(addr, memarg.offset, builder);
     let (base, offset) = get_heap_addr(
         heap,
-        addr32,
-        memarg.offset as u32,
+        addr,
+        offset,
         loaded_bytes,
         environ.pointer_type(),
         builder,
@@ -2397,14 +2426,15 @@ fn translate_store<FE: FuncEnvironment + ?Sized>(
     state: &mut FuncTranslationState,
     environ: &mut FE,
 ) -> WasmResult<()> {
-    let ((addr32, _), (val, _)) = state.pop2();
+    let ((addr, _), (val, _)) = state.pop2();
     let val_ty = builder.func.dfg.value_type(val);
 
     let heap = state.get_heap(builder.func, memarg.memory, environ)?;
+    let (addr, offset) = fold_heap_offset(addr, memarg.offset, builder);
     let (base, offset) = get_heap_addr(
         heap,
-        addr32,
-        memarg.offset as u32,
+        addr,
+        offset,
         mem_op_size(opcode, val_ty),
         environ.pointer_type(),
         builder,
@@ -2441,7 +2471,19 @@ fn fold_atomic_mem_addr(
     builder: &mut FunctionBuilder,
 ) -> Value {
     let access_ty_bytes = access_ty.bytes();
-    let final_lma = if memarg.offset > 0 {
+    let final_lma = if memarg.offset > 0 && builder.func.dfg.value_type(linear_mem_addr) == I64 {
+        // A 64-bit memory: the sum is out of bounds if it overflows.
+        let a = builder
+            .ins()
+            .iadd_imm(linear_mem_addr, memarg.offset as i64);
+        let overflow = builder
+            .ins()
+            .icmp(IntCC::UnsignedLessThan, a, linear_mem_addr);
+        builder
+            .ins()
+            .trapnz(overflow, ir::TrapCode::HeapOutOfBounds);
+        a
+    } else if memarg.offset > 0 {
         assert!(builder.func.dfg.value_type(linear_mem_addr) == I32);
         let linear_mem_addr = builder.ins().uextend(I64, linear_mem_addr);
         let a = builder
@@ -2482,9 +2524,8 @@ fn finalise_atomic_mem_addr<FE: FuncEnvironment + ?Sized>(
 ) -> WasmResult<Value> {
     // Check the alignment of `linear_mem_addr`.
     let access_ty_bytes = access_ty.bytes();
-    let final_lma = builder
-        .ins()
-        .iadd_imm(linear_mem_addr, memarg.offset as i64);
+    let (linear_mem_addr, offset) = fold_heap_offset(linear_mem_addr, memarg.offset, builder);
+    let final_lma = builder.ins().iadd_imm(linear_mem_addr, i64::from(offset));
     if access_ty_bytes != 1 {
         assert!(access_ty_bytes == 2 || access_ty_bytes == 4 || access_ty_bytes == 8);
         let final_lma_misalignment = builder
@@ -12,9 +12,10 @@ use rayon::iter::ParallelBridge;
 use rayon::prelude::{IntoParallelIterator, IntoParallelRefIterator, ParallelIterator};
 use std::sync::Arc;
 use wasmer_compiler::{
-    Compilation, CompileError, CompileModuleInfo, Compiler, CustomSection, CustomSectionProtection,
-    Dwarf, FunctionBodyData, ModuleMiddleware, ModuleTranslationState, RelocationTarget,
-    SectionBody, SectionIndex, Symbol, SymbolRegistry, Target,
+    CachedFunction, Compilation, CompileError, CompileModuleInfo, CompilePool, CompileScope,
+    Compiler, CustomSection, CustomSectionProtection, Dwarf, FunctionBodies, FunctionBodyData,
+    FunctionBodyStream, ModuleMiddleware, ModuleTranslationState, RelocationTarget, SectionBody,
+    SectionIndex, Symbol, SymbolRegistry, Target,
 };
 use wasmer_types::entity::{EntityRef, PrimaryMap};
 use wasmer_types::{FunctionIndex, LocalFunctionIndex, SignatureIndex};
@@ -194,6 +195,11 @@ impl Compiler for LLVMCompiler {
         &self.config.middlewares
     }
 
+    /// Get the pool of threads this compiler compiles on
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        Some(&self.config.compile_pool)
+    }
+
     fn experimental_native_compile_module<'data, 'module>(
         &self,
         target: &Target,
@@ -205,14 +211,16 @@ impl Compiler for LLVMCompiler {
         // The metadata to inject into the wasmer_metadata section of the object file.
         wasmer_metadata: &[u8],
     ) -> Option<Result<Vec<u8>, CompileError>> {
-        Some(self.compile_native_object(
-            target,
-            compile_info,
-            module_translation,
-            function_body_inputs,
-            symbol_registry,
-            wasmer_metadata,
-        ))
+        Some(self.config.compile_pool.install(|_| {
+            self.compile_native_object(
+                target,
+                compile_info,
+                module_translation,
+                function_body_inputs,
+                symbol_registry,
+                wasmer_metadata,
+            )
+        }))
     }
 
     /// Compile the module using LLVM, producing a compilation result with
@@ -223,6 +231,61 @@ impl Compiler for LLVMCompiler {
         compile_info: &'module CompileModuleInfo,
         module_translation: &ModuleTranslationState,
         function_body_inputs: PrimaryMap<LocalFunctionIndex, FunctionBodyData<'data>>,
+    ) -> Result<Compilation, CompileError> {
+        self.compile_function_bodies(
+            target,
+            compile_info,
+            module_translation,
+            FunctionBodies::Received(function_body_inputs),
+        )
+    }
+
+    /// Compile the module using LLVM, compiling each function as soon as
+    /// its body is received.
+    fn compile_module_streaming(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        module_translation: &ModuleTranslationState,
+        function_bodies: FunctionBodyStream,
+    ) -> Result<Compilation, CompileError> {
+        self.compile_function_bodies(
+            target,
+            compile_info,
+            module_translation,
+            FunctionBodies::Streamed(function_bodies),
+        )
+    }
+}
+
+impl LLVMCompiler {
+    fn compile_function_bodies(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        module_translation: &ModuleTranslationState,
+        function_bodies: FunctionBodies<'_>,
+    ) -> Result<Compilation, CompileError> {
+        function_bodies.compile_on(&self.config.compile_pool, |scope, function_bodies| {
+            self.compile_on_pool(
+                scope,
+                target,
+                compile_info,
+                module_translation,
+                function_bodies,
+            )
+        })
+    }
+
+    /// Compiles the function bodies on the threads of the pool of
+    /// `scope`.
+    fn compile_on_pool(
+        &self,
+        scope: &CompileScope,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        module_translation: &ModuleTranslationState,
+        function_bodies: FunctionBodies<'_>,
     ) -> Result<Compilation, CompileError> {
         //let data = Arc::new(Mutex::new(0));
         let memory_styles = &compile_info.memory_styles;
@@ -235,31 +298,46 @@ impl Compiler for LLVMCompiler {
         let mut module_custom_sections = PrimaryMap::new();
         let mut frame_section_bytes = vec![];
         let mut frame_section_relocations = vec![];
-        let functions = function_body_inputs
-            .iter()
-            .collect::<Vec<(LocalFunctionIndex, &FunctionBodyData<'_>)>>()
-            .par_iter()
-            .map_init(
+        let function_cache = self.config().module_function_cache(target, compile_info);
+        scope.add_functions(function_bodies.len());
+        let functions = function_bodies
+            .compile_each(
+                scope,
                 || {
                     let target_machine = self.config().target_machine(target);
                     FuncTranslator::new(target_machine)
                 },
-                |func_translator, (i, input)| {
+                |func_translator, i, input| {
+                    scope.check_cancelled()?;
+
+                    if let Some(cached) = function_cache
+                        .as_ref()
+                        .and_then(|cache| cache.load(i, input))
+                    {
+                        return Ok(cached.into());
+                    }
                     // TODO: remove (to serialize)
                     //let _data = data.lock().unwrap();
-                    func_translator.translate(
+                    let compiled_function = func_translator.translate(
                         module,
                         module_translation,
-                        i,
+                        &i,
                         input,
                         self.config(),
                         memory_styles,
                         &table_styles,
                         &ShortNames {},
-                    )
+                    )?;
+                    match &function_cache {
+                        Some(cache) => {
+                            let cached = CachedFunction::from(compiled_function);
+                            cache.store(i, input, &cached);
+                            Ok(cached.into())
+                        }
+                        None => Ok(compiled_function),
+                    }
                 },
-            )
-            .collect::<Result<Vec<_>, CompileError>>()?
+            )?
             .into_iter()
             .map(|mut compiled_function| {
                 let first_section = module_custom_sections.len() as u32;
@@ -329,36 +407,41 @@ impl Compiler for LLVMCompiler {
             None
         };
 
-        let function_call_trampolines = module
-            .signatures
-            .values()
-            .collect::<Vec<_>>()
-            .par_iter()
-            .map_init(
-                || {
-                    let target_machine = self.config().target_machine(target);
-                    FuncTrampoline::new(target_machine)
-                },
-                |func_trampoline, sig| func_trampoline.trampoline(sig, self.config(), ""),
-            )
-            .collect::<Vec<_>>()
-            .into_iter()
-            .collect::<Result<PrimaryMap<_, _>, CompileError>>()?;
+        let function_call_trampolines = scope.install(|| {
+            module
+                .signatures
+                .values()
+                .collect::<Vec<_>>()
+                .par_iter()
+                .map_init(
+                    || {
+                        let target_machine = self.config().target_machine(target);
+                        FuncTrampoline::new(target_machine)
+                    },
+                    |func_trampoline, sig| func_trampoline.trampoline(sig, self.config(), ""),
+                )
+                .collect::<Vec<_>>()
+                .into_iter()
+                .collect::<Result<PrimaryMap<_, _>, CompileError>>()
+        })?;
 
-        let dynamic_function_trampolines = module
-            .imported_function_types()
-            .collect::<Vec<_>>()
-            .par_iter()
-            .map_init(
-                || {
-                    let target_machine = self.config().target_machine(target);
-                    FuncTrampoline::new(target_machine)
-                },
-                |func_trampoline, func_type| {
-                    func_trampoline.dynamic_trampoline(&func_type, self.config(), "")
-                },
-            )
-            .collect::<Result<Vec<_>, CompileError>>()?
+        let dynamic_function_trampolines = scope
+            .install(|| {
+                module
+                    .imported_function_types()
+                    .collect::<Vec<_>>()
+                    .par_iter()
+                    .map_init(
+                        || {
+                            let target_machine = self.config().target_machine(target);
+                            FuncTrampoline::new(target_machine)
+                        },
+                        |func_trampoline, func_type| {
+                            func_trampoline.dynamic_trampoline(&func_type, self.config(), "")
+                        },
+                    )
+                    .collect::<Result<Vec<_>, CompileError>>()
+            })?
             .into_iter()
             .collect::<PrimaryMap<_, _>>();
 
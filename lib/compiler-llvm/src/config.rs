@@ -9,7 +9,10 @@ use loupe::MemoryUsage;
 use std::fmt::Debug;
 use std::sync::Arc;
 use target_lexicon::Architecture;
-use wasmer_compiler::{Compiler, CompilerConfig, ModuleMiddleware, Target, Triple};
+use wasmer_compiler::{
+    CompileModuleInfo, CompilePool, Compiler, CompilerConfig, FunctionCache, ModuleFunctionCache,
+    ModuleMiddleware, Target, Triple,
+};
 use wasmer_types::{FunctionType, LocalFunctionIndex};
 
 /// The InkWell ModuleInfo type
@@ -49,6 +52,10 @@ pub struct LLVM {
     pub(crate) callbacks: Option<Arc<dyn LLVMCallbacks>>,
     /// The middleware chain.
     pub(crate) middlewares: Vec<Arc<dyn ModuleMiddleware>>,
+    #[loupe(skip)]
+    function_cache: Option<Arc<dyn FunctionCache>>,
+    /// The pool of threads to compile on.
+    pub(crate) compile_pool: CompilePool,
 }
 
 impl LLVM {
@@ -62,6 +69,8 @@ impl LLVM {
             is_pic: false,
             callbacks: None,
             middlewares: vec![],
+            function_cache: None,
+            compile_pool: CompilePool::default(),
         }
     }
 
@@ -78,6 +87,32 @@ impl LLVM {
         self
     }
 
+    /// The function cache to look the functions of a module up in, if
+    /// any. The cache is not used with middlewares.
+    pub(crate) fn module_function_cache(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+    ) -> Option<ModuleFunctionCache> {
+        if !self.middlewares.is_empty() {
+            return None;
+        }
+        let cache = self.function_cache.as_deref()?;
+        // The settings that change the generated code.
+        let settings = (
+            self.enable_nan_canonicalization,
+            self.is_pic,
+            self.opt_level,
+        );
+        Some(ModuleFunctionCache::new(
+            cache,
+            "llvm",
+            &settings,
+            target,
+            compile_info,
+        ))
+    }
+
     fn reloc_mode(&self) -> RelocMode {
         if self.is_pic {
             RelocMode::PIC
@@ -222,6 +257,14 @@ impl CompilerConfig for LLVM {
     fn push_middleware(&mut self, middleware: Arc<dyn ModuleMiddleware>) {
         self.middlewares.push(middleware);
     }
+
+    fn function_cache(&mut self, cache: Arc<dyn FunctionCache>) {
+        self.function_cache = Some(cache);
+    }
+
+    fn compile_pool(&mut self, pool: CompilePool) {
+        self.compile_pool = pool;
+    }
 }
 
 impl Default for LLVM {
@@ -5,9 +5,10 @@ use std::convert::TryInto;
 use std::num::TryFromIntError;
 
 use wasmer_compiler::{
-    CompileError, CompiledFunctionFrameInfo, CustomSection, CustomSectionProtection,
-    CustomSections, FunctionAddressMap, FunctionBody, InstructionAddressMap, Relocation,
-    RelocationKind, RelocationTarget, SectionBody, SectionIndex, SourceLoc,
+    CachedFunction, CompileError, CompiledFunctionFrameInfo, CustomSection,
+    CustomSectionProtection, CustomSections, FunctionAddressMap, FunctionBody,
+    InstructionAddressMap, Relocation, RelocationKind, RelocationTarget, SectionBody, SectionIndex,
+    SourceLoc,
 };
 use wasmer_types::entity::PrimaryMap;
 use wasmer_vm::libcalls::LibCall;
@@ -26,6 +27,26 @@ pub struct CompiledFunction {
     pub eh_frame_section_indices: Vec<SectionIndex>,
 }
 
+impl From<CachedFunction> for CompiledFunction {
+    fn from(cached: CachedFunction) -> Self {
+        Self {
+            compiled_function: cached.compiled_function,
+            custom_sections: cached.custom_sections,
+            eh_frame_section_indices: cached.eh_frame_sections,
+        }
+    }
+}
+
+impl From<CompiledFunction> for CachedFunction {
+    fn from(compiled: CompiledFunction) -> Self {
+        Self {
+            compiled_function: compiled.compiled_function,
+            custom_sections: compiled.custom_sections,
+            eh_frame_sections: compiled.eh_frame_section_indices,
+        }
+    }
+}
+
 pub fn load_object_file<F>(
     contents: &[u8],
     root_section: &str,
@@ -95,6 +116,22 @@ where
     );
     libcalls.insert("wasmer_vm_memory32_init".to_string(), LibCall::Memory32Init);
     libcalls.insert("wasmer_vm_data_drop".to_string(), LibCall::DataDrop);
+    libcalls.insert("wasmer_vm_memory64_size".to_string(), LibCall::Memory64Size);
+    libcalls.insert(
+        "wasmer_vm_imported_memory64_size".to_string(),
+        LibCall::ImportedMemory64Size,
+    );
+    libcalls.insert("wasmer_vm_memory64_copy".to_string(), LibCall::Memory64Copy);
+    libcalls.insert(
+        "wasmer_vm_imported_memory64_copy".to_string(),
+        LibCall::ImportedMemory64Copy,
+    );
+    libcalls.insert("wasmer_vm_memory64_fill".to_string(), LibCall::Memory64Fill);
+    libcalls.insert(
+        "wasmer_vm_imported_memory64_fill".to_string(),
+        LibCall::ImportedMemory64Fill,
+    );
+    libcalls.insert("wasmer_vm_memory64_init".to_string(), LibCall::Memory64Init);
     libcalls.insert("wasmer_vm_raise_trap".to_string(), LibCall::RaiseTrap);
 
     let elf = object::File::parse(contents).map_err(map_object_err)?;
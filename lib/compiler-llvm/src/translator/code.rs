@@ -139,7 +139,7 @@ impl FuncTranslator {
         reader.set_middleware_chain(
             config
                 .middlewares
-                .generate_function_middleware_chain(*local_func_index),
+                .generate_function_middleware_chain_for_module(wasm_module, *local_func_index),
         );
 
         let mut params = vec![];
@@ -1054,12 +1054,16 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
     ) -> Result<PointerValue<'ctx>, CompileError> {
         let builder = &self.builder;
         let intrinsics = &self.intrinsics;
-        let context = &self.context;
-        let function = &self.function;
+        let memory64 = self.wasm_module.memories[memory_index].memory64;
 
-        // Compute the offset into the storage.
-        let imm_offset = intrinsics.i64_ty.const_int(memarg.offset as u64, false);
-        let var_offset = builder.build_int_z_extend(var_offset, intrinsics.i64_ty, "");
+        // Compute the offset into the storage. The address is an i64
+        // already in a 64-bit memory.
+        let imm_offset = intrinsics.i64_ty.const_int(memarg.offset, false);
+        let var_offset = if memory64 {
+            var_offset
+        } else {
+            builder.build_int_z_extend(var_offset, intrinsics.i64_ty, "")
+        };
         let offset = builder.build_int_add(var_offset, imm_offset, "");
 
         // Look up the memory base (as pointer) and bounds (as unsigned integer).
@@ -1072,28 +1076,16 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
                     ptr_to_base_ptr,
                     ptr_to_current_length,
                 } => {
-                    // Bounds check it.
+                    // Bounds check it, unless the offset is constant and
+                    // below the minimum memory size, which statically shows
+                    // that it's safe.
                     let minimum = self.wasm_module.memories[memory_index].minimum;
-                    let value_size_v = intrinsics.i64_ty.const_int(value_size as u64, false);
-                    let ptr_in_bounds = if offset.is_const() {
-                        // When the offset is constant, if it's below the minimum
-                        // memory size, we've statically shown that it's safe.
-                        let load_offset_end = offset.const_add(value_size_v);
-                        let ptr_in_bounds = load_offset_end.const_int_compare(
-                            IntPredicate::ULE,
-                            intrinsics.i64_ty.const_int(minimum.bytes().0 as u64, false),
-                        );
-                        if ptr_in_bounds.get_zero_extended_constant() == Some(1) {
-                            Some(ptr_in_bounds)
-                        } else {
-                            None
-                        }
-                    } else {
-                        None
-                    }
-                    .unwrap_or_else(|| {
-                        let load_offset_end = builder.build_int_add(offset, value_size_v, "");
-
+                    let statically_in_bounds = var_offset
+                        .get_zero_extended_constant()
+                        .and_then(|var_offset| var_offset.checked_add(memarg.offset))
+                        .and_then(|offset| offset.checked_add(value_size as u64))
+                        .map_or(false, |offset_end| offset_end <= minimum.bytes().0 as u64);
+                    if !statically_in_bounds {
                         let current_length = builder
                             .build_load(ptr_to_current_length, "")
                             .into_int_value();
@@ -1105,55 +1097,18 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
                         );
                         let current_length =
                             builder.build_int_z_extend(current_length, intrinsics.i64_ty, "");
-
-                        builder.build_int_compare(
-                            IntPredicate::ULE,
-                            load_offset_end,
+                        self.trap_if_out_of_bounds(
+                            memarg,
+                            var_offset,
+                            value_size,
                             current_length,
-                            "",
-                        )
-                    });
-                    if !ptr_in_bounds.is_constant_int()
-                        || ptr_in_bounds.get_zero_extended_constant().unwrap() != 1
-                    {
-                        // LLVM may have folded this into 'i1 true' in which case we know
-                        // the pointer is in bounds. LLVM may also have folded it into a
-                        // constant expression, not known to be either true or false yet.
-                        // If it's false, unknown-but-constant, or not-a-constant, emit a
-                        // runtime bounds check. LLVM may yet succeed at optimizing it away.
-                        let ptr_in_bounds = builder
-                            .build_call(
-                                intrinsics.expect_i1,
-                                &[
-                                    ptr_in_bounds.into(),
-                                    intrinsics.i1_ty.const_int(1, true).into(),
-                                ],
-                                "ptr_in_bounds_expect",
-                            )
-                            .try_as_basic_value()
-                            .left()
-                            .unwrap()
-                            .into_int_value();
-
-                        let in_bounds_continue_block =
-                            context.append_basic_block(*function, "in_bounds_continue_block");
-                        let not_in_bounds_block =
-                            context.append_basic_block(*function, "not_in_bounds_block");
-                        builder.build_conditional_branch(
-                            ptr_in_bounds,
-                            in_bounds_continue_block,
-                            not_in_bounds_block,
-                        );
-                        builder.position_at_end(not_in_bounds_block);
-                        builder.build_call(
-                            intrinsics.throw_trap,
-                            &[intrinsics.trap_memory_oob.into()],
-                            "throw",
+                            memory64,
                         );
-                        builder.build_unreachable();
-                        builder.position_at_end(in_bounds_continue_block);
                     }
-                    let ptr_to_base = builder.build_load(ptr_to_base_ptr, "").into_pointer_value();
+                    let ptr_to_base = self
+                        .builder
+                        .build_load(ptr_to_base_ptr, "")
+                        .into_pointer_value();
                     tbaa_label(
                         self.module,
                         self.intrinsics,
@@ -1162,14 +1117,104 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
                     );
                     ptr_to_base
                 }
-                MemoryCache::Static { base_ptr } => base_ptr,
+                MemoryCache::Static { base_ptr } => {
+                    // The guard pages of a static memory only cover the
+                    // 32-bit addresses, the others are checked against its
+                    // bound.
+                    if memory64 {
+                        let bound = match self.memory_styles[memory_index] {
+                            MemoryStyle::Static { bound, .. } => bound.bytes().0 as u64,
+                            MemoryStyle::Dynamic { .. } => unreachable!(),
+                        };
+                        let bound = self.intrinsics.i64_ty.const_int(bound, false);
+                        self.trap_if_out_of_bounds(memarg, var_offset, value_size, bound, true);
+                    }
+                    base_ptr
+                }
             };
-        let value_ptr = unsafe { builder.build_gep(base_ptr, &[offset], "") };
-        Ok(builder
+        let value_ptr = unsafe { self.builder.build_gep(base_ptr, &[offset], "") };
+        Ok(self
+            .builder
             .build_bitcast(value_ptr, ptr_ty, "")
             .into_pointer_value())
     }
 
+    /// Traps unless the `value_size` bytes at `var_offset` plus the offset
+    /// of `memarg` are below `limit`. With `memory64`, the addition may
+    /// wrap around, which is out of bounds too.
+    fn trap_if_out_of_bounds(
+        &self,
+        memarg: &MemoryImmediate,
+        var_offset: IntValue<'ctx>,
+        value_size: usize,
+        limit: IntValue<'ctx>,
+        memory64: bool,
+    ) {
+        let builder = &self.builder;
+        let intrinsics = &self.intrinsics;
+
+        let ptr_in_bounds = match memarg.offset.checked_add(value_size as u64) {
+            Some(offset_end) => {
+                let offset_end = intrinsics.i64_ty.const_int(offset_end, false);
+                let load_offset_end = builder.build_int_add(var_offset, offset_end, "");
+                let ptr_in_bounds =
+                    builder.build_int_compare(IntPredicate::ULE, load_offset_end, limit, "");
+                if memory64 {
+                    let no_wrap = builder.build_int_compare(
+                        IntPredicate::UGE,
+                        load_offset_end,
+                        var_offset,
+                        "",
+                    );
+                    builder.build_and(ptr_in_bounds, no_wrap, "")
+                } else {
+                    ptr_in_bounds
+                }
+            }
+            None => intrinsics.i1_ty.const_zero(),
+        };
+        if ptr_in_bounds.get_zero_extended_constant() == Some(1) {
+            // LLVM may have folded this into 'i1 true' in which case we know
+            // the pointer is in bounds. If it's false, unknown-but-constant,
+            // or not-a-constant, emit a runtime bounds check. LLVM may yet
+            // succeed at optimizing it away.
+            return;
+        }
+        let ptr_in_bounds = builder
+            .build_call(
+                intrinsics.expect_i1,
+                &[
+                    ptr_in_bounds.into(),
+                    intrinsics.i1_ty.const_int(1, true).into(),
+                ],
+                "ptr_in_bounds_expect",
+            )
+            .try_as_basic_value()
+            .left()
+            .unwrap()
+            .into_int_value();
+
+        let in_bounds_continue_block = self
+            .context
+            .append_basic_block(self.function, "in_bounds_continue_block");
+        let not_in_bounds_block = self
+            .context
+            .append_basic_block(self.function, "not_in_bounds_block");
+        builder.build_conditional_branch(
+            ptr_in_bounds,
+            in_bounds_continue_block,
+            not_in_bounds_block,
+        );
+        builder.position_at_end(not_in_bounds_block);
+        builder.build_call(
+            intrinsics.throw_trap,
+            &[intrinsics.trap_memory_oob.into()],
+            "throw",
+        );
+        builder.build_unreachable();
+        builder.position_at_end(in_bounds_continue_block);
+    }
+
     fn trap_if_misaligned(&self, memarg: &MemoryImmediate, ptr: PointerValue<'ctx>) {
         let align = memarg.align;
         let value = self
@@ -2063,12 +2108,19 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
                     }
                     GlobalCache::Mut { ptr_to_value } => {
                         let value = self.builder.build_load(*ptr_to_value, "");
+                        let load = value.as_instruction_value().unwrap();
                         tbaa_label(
                             self.module,
                             self.intrinsics,
                             format!("global {}", global_index.as_u32()),
-                            value.as_instruction_value().unwrap(),
+                            load,
                         );
+                        // The host may write it while the function runs,
+                        // so it must be read again on each `global.get`,
+                        // even in a loop.
+                        if self.wasm_module.volatile_globals.contains(&global_index) {
+                            load.set_volatile(true).unwrap();
+                        }
                         self.state.push1(value);
                     }
                 }
@@ -10945,11 +10997,17 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
                 self.state.push1(size.try_as_basic_value().left().unwrap());
             }
             Operator::MemoryInit { segment, mem } => {
+                let memory_init = if self.wasm_module.memories[MemoryIndex::from_u32(mem)].memory64
+                {
+                    self.intrinsics.memory64_init
+                } else {
+                    self.intrinsics.memory_init
+                };
                 let (dest, src, len) = self.state.pop3()?;
                 let mem = self.intrinsics.i32_ty.const_int(mem.into(), false);
                 let segment = self.intrinsics.i32_ty.const_int(segment.into(), false);
                 self.builder.build_call(
-                    self.intrinsics.memory_init,
+                    memory_init,
                     &[
                         vmctx.as_basic_value_enum().into(),
                         mem.into(),
@@ -10972,13 +11030,20 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
             Operator::MemoryCopy { src, dst } => {
                 // ignored until we support multiple memories
                 let _dst = dst;
-                let (memory_copy, src) = if let Some(local_memory_index) = self
-                    .wasm_module
-                    .local_memory_index(MemoryIndex::from_u32(src))
-                {
-                    (self.intrinsics.memory_copy, local_memory_index.as_u32())
-                } else {
-                    (self.intrinsics.imported_memory_copy, src)
+                let memory64 = self.wasm_module.memories[MemoryIndex::from_u32(src)].memory64;
+                let (memory_copy, src) = match (
+                    self.wasm_module
+                        .local_memory_index(MemoryIndex::from_u32(src)),
+                    memory64,
+                ) {
+                    (Some(local_memory_index), false) => {
+                        (self.intrinsics.memory_copy, local_memory_index.as_u32())
+                    }
+                    (None, false) => (self.intrinsics.imported_memory_copy, src),
+                    (Some(local_memory_index), true) => {
+                        (self.intrinsics.memory64_copy, local_memory_index.as_u32())
+                    }
+                    (None, true) => (self.intrinsics.imported_memory64_copy, src),
                 };
 
                 let (dest_pos, src_pos, len) = self.state.pop3()?;
@@ -10996,13 +11061,20 @@ impl<'ctx, 'a> LLVMFunctionCodeGenerator<'ctx, 'a> {
                 );
             }
             Operator::MemoryFill { mem } => {
-                let (memory_fill, mem) = if let Some(local_memory_index) = self
-                    .wasm_module
-                    .local_memory_index(MemoryIndex::from_u32(mem))
-                {
-                    (self.intrinsics.memory_fill, local_memory_index.as_u32())
-                } else {
-                    (self.intrinsics.imported_memory_fill, mem)
+                let memory64 = self.wasm_module.memories[MemoryIndex::from_u32(mem)].memory64;
+                let (memory_fill, mem) = match (
+                    self.wasm_module
+                        .local_memory_index(MemoryIndex::from_u32(mem)),
+                    memory64,
+                ) {
+                    (Some(local_memory_index), false) => {
+                        (self.intrinsics.memory_fill, local_memory_index.as_u32())
+                    }
+                    (None, false) => (self.intrinsics.imported_memory_fill, mem),
+                    (Some(local_memory_index), true) => {
+                        (self.intrinsics.memory64_fill, local_memory_index.as_u32())
+                    }
+                    (None, true) => (self.intrinsics.imported_memory64_fill, mem),
                 };
 
                 let (dst, val, len) = self.state.pop3()?;
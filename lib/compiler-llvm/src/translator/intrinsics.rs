@@ -241,6 +241,11 @@ pub struct Intrinsics<'ctx> {
     pub imported_memory_copy: FunctionValue<'ctx>,
     pub memory_fill: FunctionValue<'ctx>,
     pub imported_memory_fill: FunctionValue<'ctx>,
+    pub memory64_init: FunctionValue<'ctx>,
+    pub memory64_copy: FunctionValue<'ctx>,
+    pub imported_memory64_copy: FunctionValue<'ctx>,
+    pub memory64_fill: FunctionValue<'ctx>,
+    pub imported_memory64_fill: FunctionValue<'ctx>,
 
     pub throw_trap: FunctionValue<'ctx>,
 
@@ -257,6 +262,10 @@ pub struct Intrinsics<'ctx> {
     pub imported_memory32_grow_ptr_ty: PointerType<'ctx>,
     pub memory32_size_ptr_ty: PointerType<'ctx>,
     pub imported_memory32_size_ptr_ty: PointerType<'ctx>,
+    pub memory64_grow_ptr_ty: PointerType<'ctx>,
+    pub imported_memory64_grow_ptr_ty: PointerType<'ctx>,
+    pub memory64_size_ptr_ty: PointerType<'ctx>,
+    pub imported_memory64_size_ptr_ty: PointerType<'ctx>,
 
     // Pointer to the VM.
     pub ctx_ptr_ty: PointerType<'ctx>,
@@ -988,6 +997,77 @@ impl<'ctx> Intrinsics<'ctx> {
                 ),
                 None,
             ),
+            memory64_init: module.add_function(
+                "wasmer_vm_memory64_init",
+                void_ty.fn_type(
+                    &[
+                        ctx_ptr_ty_basic_md,
+                        i32_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                        i32_ty_basic_md,
+                        i32_ty_basic_md,
+                    ],
+                    false,
+                ),
+                None,
+            ),
+            memory64_copy: module.add_function(
+                "wasmer_vm_memory64_copy",
+                void_ty.fn_type(
+                    &[
+                        ctx_ptr_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                        i64_ty_basic_md,
+                        i64_ty_basic_md,
+                    ],
+                    false,
+                ),
+                None,
+            ),
+            imported_memory64_copy: module.add_function(
+                "wasmer_vm_imported_memory64_copy",
+                void_ty.fn_type(
+                    &[
+                        ctx_ptr_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                        i64_ty_basic_md,
+                        i64_ty_basic_md,
+                    ],
+                    false,
+                ),
+                None,
+            ),
+            memory64_fill: module.add_function(
+                "wasmer_vm_memory64_fill",
+                void_ty.fn_type(
+                    &[
+                        ctx_ptr_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                    ],
+                    false,
+                ),
+                None,
+            ),
+            imported_memory64_fill: module.add_function(
+                "wasmer_vm_imported_memory64_fill",
+                void_ty.fn_type(
+                    &[
+                        ctx_ptr_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                        i32_ty_basic_md,
+                        i64_ty_basic_md,
+                    ],
+                    false,
+                ),
+                None,
+            ),
             data_drop: module.add_function(
                 "wasmer_vm_data_drop",
                 void_ty.fn_type(&[ctx_ptr_ty_basic_md, i32_ty_basic_md], false),
@@ -1039,6 +1119,24 @@ impl<'ctx> Intrinsics<'ctx> {
             imported_memory32_size_ptr_ty: i32_ty
                 .fn_type(&[ctx_ptr_ty_basic_md, i32_ty_basic_md], false)
                 .ptr_type(AddressSpace::Generic),
+            memory64_grow_ptr_ty: i64_ty
+                .fn_type(
+                    &[ctx_ptr_ty_basic_md, i64_ty_basic_md, i32_ty_basic_md],
+                    false,
+                )
+                .ptr_type(AddressSpace::Generic),
+            imported_memory64_grow_ptr_ty: i64_ty
+                .fn_type(
+                    &[ctx_ptr_ty_basic_md, i64_ty_basic_md, i32_ty_basic_md],
+                    false,
+                )
+                .ptr_type(AddressSpace::Generic),
+            memory64_size_ptr_ty: i64_ty
+                .fn_type(&[ctx_ptr_ty_basic_md, i32_ty_basic_md], false)
+                .ptr_type(AddressSpace::Generic),
+            imported_memory64_size_ptr_ty: i64_ty
+                .fn_type(&[ctx_ptr_ty_basic_md, i32_ty_basic_md], false)
+                .ptr_type(AddressSpace::Generic),
 
             ctx_ptr_ty,
         };
@@ -1588,16 +1686,24 @@ impl<'ctx, 'a> CtxType<'ctx, 'a> {
             &self.ctx_ptr_value,
         );
         *cached_memory_grow.entry(memory_index).or_insert_with(|| {
-            let (grow_fn, grow_fn_ty) = if wasm_module.local_memory_index(memory_index).is_some() {
-                (
+            let local = wasm_module.local_memory_index(memory_index).is_some();
+            let (grow_fn, grow_fn_ty) = match (local, wasm_module.memories[memory_index].memory64) {
+                (true, false) => (
                     VMBuiltinFunctionIndex::get_memory32_grow_index(),
                     intrinsics.memory32_grow_ptr_ty,
-                )
-            } else {
-                (
+                ),
+                (false, false) => (
                     VMBuiltinFunctionIndex::get_imported_memory32_grow_index(),
                     intrinsics.imported_memory32_grow_ptr_ty,
-                )
+                ),
+                (true, true) => (
+                    VMBuiltinFunctionIndex::get_memory64_grow_index(),
+                    intrinsics.memory64_grow_ptr_ty,
+                ),
+                (false, true) => (
+                    VMBuiltinFunctionIndex::get_imported_memory64_grow_index(),
+                    intrinsics.imported_memory64_grow_ptr_ty,
+                ),
             };
             let offset = offsets.vmctx_builtin_function(grow_fn);
             let offset = intrinsics.i32_ty.const_int(offset.into(), false);
@@ -1629,16 +1735,24 @@ impl<'ctx, 'a> CtxType<'ctx, 'a> {
             &self.ctx_ptr_value,
         );
         *cached_memory_size.entry(memory_index).or_insert_with(|| {
-            let (size_fn, size_fn_ty) = if wasm_module.local_memory_index(memory_index).is_some() {
-                (
+            let local = wasm_module.local_memory_index(memory_index).is_some();
+            let (size_fn, size_fn_ty) = match (local, wasm_module.memories[memory_index].memory64) {
+                (true, false) => (
                     VMBuiltinFunctionIndex::get_memory32_size_index(),
                     intrinsics.memory32_size_ptr_ty,
-                )
-            } else {
-                (
+                ),
+                (false, false) => (
                     VMBuiltinFunctionIndex::get_imported_memory32_size_index(),
                     intrinsics.imported_memory32_size_ptr_ty,
-                )
+                ),
+                (true, true) => (
+                    VMBuiltinFunctionIndex::get_memory64_size_index(),
+                    intrinsics.memory64_size_ptr_ty,
+                ),
+                (false, true) => (
+                    VMBuiltinFunctionIndex::get_imported_memory64_size_index(),
+                    intrinsics.imported_memory64_size_ptr_ty,
+                ),
             };
             let offset = offsets.vmctx_builtin_function(size_fn);
             let offset = intrinsics.i32_ty.const_int(offset.into(), false);
@@ -959,9 +959,12 @@ impl<'a, M: Machine> FuncGen<'a, M> {
     }
 
     /// Emits a memory operation.
-    fn op_memory<F: FnOnce(&mut Self, bool, bool, i32, Label)>(&mut self, cb: F) {
+    fn op_memory<F: FnOnce(&mut Self, bool, bool, bool, i32, Label)>(&mut self, cb: F) {
+        // The guard pages of a static memory only cover the 32-bit
+        // addresses: the accesses to a 64-bit memory are always checked.
+        let memory64 = self.module.memories[MemoryIndex::new(0)].memory64;
         let need_check = match self.memory_styles[MemoryIndex::new(0)] {
-            MemoryStyle::Static { .. } => false,
+            MemoryStyle::Static { .. } => memory64,
             MemoryStyle::Dynamic { .. } => true,
         };
 
@@ -976,6 +979,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
             self,
             need_check,
             self.module.num_imported_memories != 0,
+            memory64,
             offset as i32,
             self.special_labels.heap_access_oob,
         );
@@ -3054,17 +3058,20 @@ impl<'a, M: Machine> FuncGen<'a, M> {
             Operator::Nop => {}
             Operator::MemorySize { mem, mem_byte: _ } => {
                 let memory_index = MemoryIndex::new(mem as usize);
+                let size_index = match (
+                    self.module.local_memory_index(memory_index).is_some(),
+                    self.module.memories[memory_index].memory64,
+                ) {
+                    (true, false) => VMBuiltinFunctionIndex::get_memory32_size_index(),
+                    (false, false) => VMBuiltinFunctionIndex::get_imported_memory32_size_index(),
+                    (true, true) => VMBuiltinFunctionIndex::get_memory64_size_index(),
+                    (false, true) => VMBuiltinFunctionIndex::get_imported_memory64_size_index(),
+                };
                 self.machine.move_location(
                     Size::S64,
                     Location::Memory(
                         self.machine.get_vmctx_reg(),
-                        self.vmoffsets.vmctx_builtin_function(
-                            if self.module.local_memory_index(memory_index).is_some() {
-                                VMBuiltinFunctionIndex::get_memory32_size_index()
-                            } else {
-                                VMBuiltinFunctionIndex::get_imported_memory32_size_index()
-                            },
-                        ) as i32,
+                        self.vmoffsets.vmctx_builtin_function(size_index) as i32,
                     ),
                     Location::GPR(self.machine.get_grp_for_call()),
                 );
@@ -3094,13 +3101,17 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let dst = self.value_stack.pop().unwrap();
                 self.release_locations_only_regs(&[len, src, dst]);
 
+                let memory_init_index =
+                    if self.module.memories[MemoryIndex::new(mem as usize)].memory64 {
+                        VMBuiltinFunctionIndex::get_memory64_init_index()
+                    } else {
+                        VMBuiltinFunctionIndex::get_memory_init_index()
+                    };
                 self.machine.move_location(
                     Size::S64,
                     Location::Memory(
                         self.machine.get_vmctx_reg(),
-                        self.vmoffsets
-                            .vmctx_builtin_function(VMBuiltinFunctionIndex::get_memory_init_index())
-                            as i32,
+                        self.vmoffsets.vmctx_builtin_function(memory_init_index) as i32,
                     ),
                     Location::GPR(self.machine.get_grp_for_call()),
                 );
@@ -3166,18 +3177,15 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 self.release_locations_only_regs(&[len, src_pos, dst_pos]);
 
                 let memory_index = MemoryIndex::new(src as usize);
-                let (memory_copy_index, memory_index) =
-                    if self.module.local_memory_index(memory_index).is_some() {
-                        (
-                            VMBuiltinFunctionIndex::get_memory_copy_index(),
-                            memory_index,
-                        )
-                    } else {
-                        (
-                            VMBuiltinFunctionIndex::get_imported_memory_copy_index(),
-                            memory_index,
-                        )
-                    };
+                let memory_copy_index = match (
+                    self.module.local_memory_index(memory_index).is_some(),
+                    self.module.memories[memory_index].memory64,
+                ) {
+                    (true, false) => VMBuiltinFunctionIndex::get_memory_copy_index(),
+                    (false, false) => VMBuiltinFunctionIndex::get_imported_memory_copy_index(),
+                    (true, true) => VMBuiltinFunctionIndex::get_memory64_copy_index(),
+                    (false, true) => VMBuiltinFunctionIndex::get_imported_memory64_copy_index(),
+                };
 
                 self.machine.move_location(
                     Size::S64,
@@ -3218,18 +3226,15 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 self.release_locations_only_regs(&[len, val, dst]);
 
                 let memory_index = MemoryIndex::new(mem as usize);
-                let (memory_fill_index, memory_index) =
-                    if self.module.local_memory_index(memory_index).is_some() {
-                        (
-                            VMBuiltinFunctionIndex::get_memory_fill_index(),
-                            memory_index,
-                        )
-                    } else {
-                        (
-                            VMBuiltinFunctionIndex::get_imported_memory_fill_index(),
-                            memory_index,
-                        )
-                    };
+                let memory_fill_index = match (
+                    self.module.local_memory_index(memory_index).is_some(),
+                    self.module.memories[memory_index].memory64,
+                ) {
+                    (true, false) => VMBuiltinFunctionIndex::get_memory_fill_index(),
+                    (false, false) => VMBuiltinFunctionIndex::get_imported_memory_fill_index(),
+                    (true, true) => VMBuiltinFunctionIndex::get_memory64_fill_index(),
+                    (false, true) => VMBuiltinFunctionIndex::get_imported_memory64_fill_index(),
+                };
 
                 self.machine.move_location(
                     Size::S64,
@@ -3264,17 +3269,20 @@ impl<'a, M: Machine> FuncGen<'a, M> {
 
                 self.release_locations_only_regs(&[param_pages]);
 
+                let grow_index = match (
+                    self.module.local_memory_index(memory_index).is_some(),
+                    self.module.memories[memory_index].memory64,
+                ) {
+                    (true, false) => VMBuiltinFunctionIndex::get_memory32_grow_index(),
+                    (false, false) => VMBuiltinFunctionIndex::get_imported_memory32_grow_index(),
+                    (true, true) => VMBuiltinFunctionIndex::get_memory64_grow_index(),
+                    (false, true) => VMBuiltinFunctionIndex::get_imported_memory64_grow_index(),
+                };
                 self.machine.move_location(
                     Size::S64,
                     Location::Memory(
                         self.machine.get_vmctx_reg(),
-                        self.vmoffsets.vmctx_builtin_function(
-                            if self.module.local_memory_index(memory_index).is_some() {
-                                VMBuiltinFunctionIndex::get_memory32_grow_index()
-                            } else {
-                                VMBuiltinFunctionIndex::get_imported_memory32_grow_index()
-                            },
-                        ) as i32,
+                        self.vmoffsets.vmctx_builtin_function(grow_index) as i32,
                     ),
                     Location::GPR(self.machine.get_grp_for_call()),
                 );
@@ -3313,13 +3321,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_load(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3336,13 +3345,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 self.fp_stack
                     .push(FloatValue::new(self.value_stack.len() - 1));
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.f32_load(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3357,13 +3367,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_load_8u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3378,13 +3389,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_load_8s(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3399,13 +3411,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_load_16u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3420,13 +3433,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_load_16s(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3437,13 +3451,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_save(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3456,7 +3471,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let fp = self.fp_stack.pop1()?;
                 let config_nan_canonicalization = self.config.enable_nan_canonicalization;
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.f32_save(
                             target_value,
                             memarg,
@@ -3464,6 +3479,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             config_nan_canonicalization && !fp.canonicalization.is_none(),
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3474,13 +3490,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_save_8(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3491,13 +3508,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_save_16(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3512,13 +3530,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3535,13 +3554,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 self.fp_stack
                     .push(FloatValue::new(self.value_stack.len() - 1));
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.f64_load(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3556,13 +3576,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load_8u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3577,13 +3598,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load_8s(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3598,13 +3620,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load_16u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3619,13 +3642,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load_16s(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3640,13 +3664,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load_32u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3661,13 +3686,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_load_32s(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3679,13 +3705,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_addr = self.pop_value_released();
 
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_save(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3698,7 +3725,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let fp = self.fp_stack.pop1()?;
                 let config_nan_canonicalization = self.config.enable_nan_canonicalization;
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.f64_save(
                             target_value,
                             memarg,
@@ -3706,6 +3733,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             config_nan_canonicalization && !fp.canonicalization.is_none(),
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3716,13 +3744,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_save_8(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3733,13 +3762,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_save_16(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -3750,13 +3780,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_save_32(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4059,13 +4090,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_load(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4080,13 +4112,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_load_8u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4101,13 +4134,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_load_16u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4118,13 +4152,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_save(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4135,13 +4170,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_save_8(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4152,13 +4188,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_save_16(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4173,13 +4210,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_load(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4194,13 +4232,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_load_8u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4215,13 +4254,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_load_16u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4236,13 +4276,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_load_32u(
                             target,
                             memarg,
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4253,13 +4294,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_save(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4270,13 +4312,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_save_8(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4287,13 +4330,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_save_16(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4304,13 +4348,14 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 let target_value = self.pop_value_released();
                 let target_addr = self.pop_value_released();
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_save_32(
                             target_value,
                             memarg,
                             target_addr,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4326,7 +4371,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_add(
                             loc,
                             target,
@@ -4334,6 +4379,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4349,7 +4395,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_add(
                             loc,
                             target,
@@ -4357,6 +4403,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4372,7 +4419,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_add_8u(
                             loc,
                             target,
@@ -4380,6 +4427,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4395,7 +4443,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_add_16u(
                             loc,
                             target,
@@ -4403,6 +4451,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4418,7 +4467,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_add_8u(
                             loc,
                             target,
@@ -4426,6 +4475,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4441,7 +4491,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_add_16u(
                             loc,
                             target,
@@ -4449,6 +4499,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4464,7 +4515,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_add_32u(
                             loc,
                             target,
@@ -4472,6 +4523,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4487,7 +4539,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_sub(
                             loc,
                             target,
@@ -4495,6 +4547,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4510,7 +4563,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_sub(
                             loc,
                             target,
@@ -4518,6 +4571,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4533,7 +4587,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_sub_8u(
                             loc,
                             target,
@@ -4541,6 +4595,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4556,7 +4611,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_sub_16u(
                             loc,
                             target,
@@ -4564,6 +4619,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4579,7 +4635,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_sub_8u(
                             loc,
                             target,
@@ -4587,6 +4643,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4602,7 +4659,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_sub_16u(
                             loc,
                             target,
@@ -4610,6 +4667,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4625,7 +4683,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_sub_32u(
                             loc,
                             target,
@@ -4633,6 +4691,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4648,7 +4707,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_and(
                             loc,
                             target,
@@ -4656,6 +4715,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4671,7 +4731,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_and(
                             loc,
                             target,
@@ -4679,6 +4739,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4694,7 +4755,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_and_8u(
                             loc,
                             target,
@@ -4702,6 +4763,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4717,7 +4779,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_and_16u(
                             loc,
                             target,
@@ -4725,6 +4787,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4740,7 +4803,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_and_8u(
                             loc,
                             target,
@@ -4748,6 +4811,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4763,7 +4827,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_and_16u(
                             loc,
                             target,
@@ -4771,6 +4835,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4786,7 +4851,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_and_32u(
                             loc,
                             target,
@@ -4794,6 +4859,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4809,7 +4875,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_or(
                             loc,
                             target,
@@ -4817,6 +4883,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4832,7 +4899,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_or(
                             loc,
                             target,
@@ -4840,6 +4907,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4855,7 +4923,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_or_8u(
                             loc,
                             target,
@@ -4863,6 +4931,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4878,7 +4947,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_or_16u(
                             loc,
                             target,
@@ -4886,6 +4955,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4901,7 +4971,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_or_8u(
                             loc,
                             target,
@@ -4909,6 +4979,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4924,7 +4995,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_or_16u(
                             loc,
                             target,
@@ -4932,6 +5003,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4947,7 +5019,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_or_32u(
                             loc,
                             target,
@@ -4955,6 +5027,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4970,7 +5043,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_xor(
                             loc,
                             target,
@@ -4978,6 +5051,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -4993,7 +5067,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xor(
                             loc,
                             target,
@@ -5001,6 +5075,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5016,7 +5091,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_xor_8u(
                             loc,
                             target,
@@ -5024,6 +5099,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5039,7 +5115,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_xor_16u(
                             loc,
                             target,
@@ -5047,6 +5123,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5062,7 +5139,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xor_8u(
                             loc,
                             target,
@@ -5070,6 +5147,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5085,7 +5163,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xor_16u(
                             loc,
                             target,
@@ -5093,6 +5171,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5108,7 +5187,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xor_32u(
                             loc,
                             target,
@@ -5116,6 +5195,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5131,7 +5211,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_xchg(
                             loc,
                             target,
@@ -5139,6 +5219,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5154,7 +5235,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xchg(
                             loc,
                             target,
@@ -5162,6 +5243,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5177,7 +5259,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_xchg_8u(
                             loc,
                             target,
@@ -5185,6 +5267,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5200,7 +5283,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_xchg_16u(
                             loc,
                             target,
@@ -5208,6 +5291,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5223,7 +5307,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xchg_8u(
                             loc,
                             target,
@@ -5231,6 +5315,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5246,7 +5331,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xchg_16u(
                             loc,
                             target,
@@ -5254,6 +5339,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5269,7 +5355,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_xchg_32u(
                             loc,
                             target,
@@ -5277,6 +5363,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5293,7 +5380,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_cmpxchg(
                             new,
                             cmp,
@@ -5302,6 +5389,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5318,7 +5406,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_cmpxchg(
                             new,
                             cmp,
@@ -5327,6 +5415,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5343,7 +5432,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_cmpxchg_8u(
                             new,
                             cmp,
@@ -5352,6 +5441,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5368,7 +5458,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i32_atomic_cmpxchg_16u(
                             new,
                             cmp,
@@ -5377,6 +5467,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5393,7 +5484,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_cmpxchg_8u(
                             new,
                             cmp,
@@ -5402,6 +5493,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5418,7 +5510,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_cmpxchg_16u(
                             new,
                             cmp,
@@ -5427,6 +5519,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5443,7 +5536,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                 )[0];
                 self.value_stack.push(ret);
                 self.op_memory(
-                    |this, need_check, imported_memories, offset, heap_access_oob| {
+                    |this, need_check, imported_memories, memory64, offset, heap_access_oob| {
                         this.machine.i64_atomic_cmpxchg_32u(
                             new,
                             cmp,
@@ -5452,6 +5545,7 @@ impl<'a, M: Machine> FuncGen<'a, M> {
                             ret,
                             need_check,
                             imported_memories,
+                            memory64,
                             offset,
                             heap_access_oob,
                         );
@@ -5,7 +5,7 @@
 use crate::codegen::FuncGen;
 use crate::config::Singlepass;
 #[cfg(feature = "unwind")]
-use crate::dwarf::WriterRelocate;
+use crate::dwarf::{eh_frame_section, WriterRelocate};
 use crate::machine::Machine;
 use crate::machine::{
     gen_import_call_trampoline, gen_std_dynamic_import_trampoline, gen_std_trampoline, CodegenError,
@@ -21,11 +21,11 @@ use loupe::MemoryUsage;
 use rayon::prelude::{IntoParallelIterator, ParallelIterator};
 use std::sync::Arc;
 use wasmer_compiler::{
-    Architecture, CallingConvention, Compilation, CompileError, CompileModuleInfo,
-    CompiledFunction, Compiler, CompilerConfig, CpuFeature, Dwarf, FunctionBinaryReader,
-    FunctionBody, FunctionBodyData, MiddlewareBinaryReader, ModuleMiddleware,
-    ModuleMiddlewareChain, ModuleTranslationState, OperatingSystem, SectionIndex, Target,
-    TrapInformation,
+    Architecture, CachedFunction, CallingConvention, Compilation, CompileError, CompileModuleInfo,
+    CompilePool, CompileScope, CompiledFunction, Compiler, CompilerConfig, CpuFeature,
+    CustomSection, Dwarf, FunctionBinaryReader, FunctionBodies, FunctionBody, FunctionBodyData,
+    FunctionBodyStream, MiddlewareBinaryReader, ModuleMiddleware, ModuleMiddlewareChain,
+    ModuleTranslationState, OperatingSystem, SectionIndex, Target, TrapInformation,
 };
 use wasmer_types::entity::{EntityRef, PrimaryMap};
 use wasmer_types::{
@@ -58,6 +58,11 @@ impl Compiler for SinglepassCompiler {
         &self.config.middlewares
     }
 
+    /// Get the pool of threads this compiler compiles on
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        Some(&self.config.compile_pool)
+    }
+
     /// Compile the module using Singlepass, producing a compilation result with
     /// associated relocations.
     fn compile_module(
@@ -66,6 +71,51 @@ impl Compiler for SinglepassCompiler {
         compile_info: &CompileModuleInfo,
         _module_translation: &ModuleTranslationState,
         function_body_inputs: PrimaryMap<LocalFunctionIndex, FunctionBodyData<'_>>,
+    ) -> Result<Compilation, CompileError> {
+        self.compile_function_bodies(
+            target,
+            compile_info,
+            FunctionBodies::Received(function_body_inputs),
+        )
+    }
+
+    /// Compile the module using Singlepass, compiling each function as soon
+    /// as its body is received.
+    fn compile_module_streaming(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        _module_translation: &ModuleTranslationState,
+        function_bodies: FunctionBodyStream,
+    ) -> Result<Compilation, CompileError> {
+        self.compile_function_bodies(
+            target,
+            compile_info,
+            FunctionBodies::Streamed(function_bodies),
+        )
+    }
+}
+
+impl SinglepassCompiler {
+    fn compile_function_bodies(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        function_bodies: FunctionBodies<'_>,
+    ) -> Result<Compilation, CompileError> {
+        function_bodies.compile_on(&self.config.compile_pool, |scope, function_bodies| {
+            self.compile_on_pool(scope, target, compile_info, function_bodies)
+        })
+    }
+
+    /// Compiles the function bodies on the threads of the pool of
+    /// `scope`.
+    fn compile_on_pool(
+        &self,
+        scope: &CompileScope,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+        function_bodies: FunctionBodies<'_>,
     ) -> Result<Compilation, CompileError> {
         match target.triple().architecture {
             Architecture::X86_64 => {}
@@ -103,7 +153,7 @@ impl Compiler for SinglepassCompiler {
 
         // Generate the frametable
         #[cfg(feature = "unwind")]
-        let dwarf_frametable = if function_body_inputs.is_empty() {
+        let dwarf_frametable = if function_bodies.is_empty() {
             // If we have no function body inputs, we don't need to
             // construct the `FrameTable`. Constructing it, with empty
             // FDEs will cause some issues in Linux.
@@ -128,31 +178,44 @@ impl Compiler for SinglepassCompiler {
         let table_styles = &compile_info.table_styles;
         let vmoffsets = VMOffsets::new(8, &compile_info.module);
         let module = &compile_info.module;
-        let mut custom_sections: PrimaryMap<SectionIndex, _> = (0..module.num_imported_functions)
-            .map(FunctionIndex::new)
-            .collect::<Vec<_>>()
-            .into_par_iter_if_rayon()
-            .map(|i| {
-                gen_import_call_trampoline(
-                    &vmoffsets,
-                    i,
-                    &module.signatures[module.functions[i]],
-                    target,
-                    calling_convention,
-                )
+        let mut custom_sections: PrimaryMap<SectionIndex, _> = scope
+            .install(|| {
+                (0..module.num_imported_functions)
+                    .map(FunctionIndex::new)
+                    .collect::<Vec<_>>()
+                    .into_par_iter_if_rayon()
+                    .map(|i| {
+                        gen_import_call_trampoline(
+                            &vmoffsets,
+                            i,
+                            &module.signatures[module.functions[i]],
+                            target,
+                            calling_convention,
+                        )
+                    })
+                    .collect::<Vec<_>>()
             })
-            .collect::<Vec<_>>()
             .into_iter()
             .collect();
-        let (functions, fdes): (Vec<CompiledFunction>, Vec<_>) = function_body_inputs
-            .iter()
-            .collect::<Vec<(LocalFunctionIndex, &FunctionBodyData<'_>)>>()
-            .into_par_iter_if_rayon()
-            .map(|(i, input)| {
+        let function_cache = self.config.module_function_cache(target, compile_info);
+
+        scope.add_functions(function_bodies.len());
+        let (functions, unwind): (Vec<CompiledFunction>, Vec<_>) = function_bodies
+            // Singlepass keeps no state per thread.
+            .compile_each(scope, <()>::default, |_, i, input| {
+                scope.check_cancelled()?;
+
+                if let Some(cached) = function_cache
+                    .as_ref()
+                    .and_then(|function_cache| function_cache.load(i, input))
+                {
+                    return Ok(cached_function_parts(cached));
+                }
+
                 let middleware_chain = self
                     .config
                     .middlewares
-                    .generate_function_middleware_chain(i);
+                    .generate_function_middleware_chain_for_module(module, i);
                 let mut reader =
                     MiddlewareBinaryReader::new_with_offset(input.data, input.module_offset);
                 reader.set_middleware_chain(middleware_chain);
@@ -167,7 +230,7 @@ impl Compiler for SinglepassCompiler {
                     }
                 }
 
-                match target.triple().architecture {
+                let (compiled_function, fde) = match target.triple().architecture {
                     Architecture::X86_64 => {
                         let machine = MachineX86_64::new(simd_arch);
                         let mut generator = FuncGen::new(
@@ -188,7 +251,7 @@ impl Compiler for SinglepassCompiler {
                             generator.feed_operator(op).map_err(to_compile_error)?;
                         }
 
-                        Ok(generator.finalize(&input))
+                        generator.finalize(&input)
                     }
                     Architecture::Aarch64(_) => {
                         let machine = MachineARM64::new();
@@ -210,52 +273,88 @@ impl Compiler for SinglepassCompiler {
                             generator.feed_operator(op).map_err(to_compile_error)?;
                         }
 
-                        Ok(generator.finalize(&input))
+                        generator.finalize(&input)
                     }
                     _ => unimplemented!(),
+                };
+
+                if let Some(function_cache) = &function_cache {
+                    // The cached functions have `.eh_frame` entries of
+                    // their own, rather than sharing the CIE of the module.
+                    #[cfg_attr(not(feature = "unwind"), allow(unused_mut))]
+                    let mut custom_sections = PrimaryMap::new();
+                    #[cfg(feature = "unwind")]
+                    if let (Some(UnwindFrame::SystemV(fde)), Some(cie)) =
+                        (fde, create_systemv_cie(target.triple().architecture))
+                    {
+                        custom_sections.push(eh_frame_section(
+                            cie,
+                            fde,
+                            target.triple().endianness().ok(),
+                        ));
+                    }
+                    let cached = CachedFunction {
+                        compiled_function,
+                        eh_frame_sections: custom_sections.keys().collect(),
+                        custom_sections,
+                    };
+                    function_cache.store(i, input, &cached);
+                    return Ok(cached_function_parts(cached));
                 }
-            })
-            .collect::<Result<Vec<_>, CompileError>>()?
+
+                Ok((compiled_function, (fde, None)))
+            })?
             .into_iter()
             .unzip();
 
-        let function_call_trampolines = module
-            .signatures
-            .values()
-            .collect::<Vec<_>>()
-            .into_par_iter_if_rayon()
-            .map(|func_type| gen_std_trampoline(&func_type, target, calling_convention))
-            .collect::<Vec<_>>()
+        let function_call_trampolines = scope
+            .install(|| {
+                module
+                    .signatures
+                    .values()
+                    .collect::<Vec<_>>()
+                    .into_par_iter_if_rayon()
+                    .map(|func_type| gen_std_trampoline(&func_type, target, calling_convention))
+                    .collect::<Vec<_>>()
+            })
             .into_iter()
             .collect::<PrimaryMap<_, _>>();
 
-        let dynamic_function_trampolines = module
-            .imported_function_types()
-            .collect::<Vec<_>>()
-            .into_par_iter_if_rayon()
-            .map(|func_type| {
-                gen_std_dynamic_import_trampoline(
-                    &vmoffsets,
-                    &func_type,
-                    target,
-                    calling_convention,
-                )
+        let dynamic_function_trampolines = scope
+            .install(|| {
+                module
+                    .imported_function_types()
+                    .collect::<Vec<_>>()
+                    .into_par_iter_if_rayon()
+                    .map(|func_type| {
+                        gen_std_dynamic_import_trampoline(
+                            &vmoffsets,
+                            &func_type,
+                            target,
+                            calling_convention,
+                        )
+                    })
+                    .collect::<Vec<_>>()
             })
-            .collect::<Vec<_>>()
             .into_iter()
             .collect::<PrimaryMap<FunctionIndex, FunctionBody>>();
 
         #[cfg(feature = "unwind")]
         let dwarf = if let Some((mut dwarf_frametable, cie_id)) = dwarf_frametable {
-            for fde in fdes {
+            let mut eh_frame_sections = vec![];
+            for (fde, eh_frame_section) in unwind {
                 if let Some(fde) = fde {
                     match fde {
                         UnwindFrame::SystemV(fde) => dwarf_frametable.add_fde(cie_id, fde),
                     }
                 }
+                eh_frame_sections.extend(eh_frame_section);
             }
             let mut eh_frame = EhFrame(WriterRelocate::new(target.triple().endianness().ok()));
             dwarf_frametable.write_eh_frame(&mut eh_frame).unwrap();
+            for eh_frame_section in &eh_frame_sections {
+                eh_frame.0.append_section(eh_frame_section);
+            }
 
             let eh_frame_section = eh_frame.0.into_section();
             custom_sections.push(eh_frame_section);
@@ -276,6 +375,20 @@ impl Compiler for SinglepassCompiler {
     }
 }
 
+/// Splits a function of the function cache into the function and its
+/// `.eh_frame` entries, if any.
+fn cached_function_parts<T>(
+    cached: CachedFunction,
+) -> (CompiledFunction, (Option<T>, Option<CustomSection>)) {
+    let eh_frame_sections = cached.eh_frame_sections;
+    let eh_frame_section = cached
+        .custom_sections
+        .into_iter()
+        .find(|(index, _)| eh_frame_sections.contains(index))
+        .map(|(_, section)| section);
+    (cached.compiled_function, (None, eh_frame_section))
+}
+
 trait ToCompileError {
     fn to_compile_error(self) -> CompileError;
 }
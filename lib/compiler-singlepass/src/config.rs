@@ -4,7 +4,10 @@
 use crate::compiler::SinglepassCompiler;
 use loupe::MemoryUsage;
 use std::sync::Arc;
-use wasmer_compiler::{Compiler, CompilerConfig, CpuFeature, ModuleMiddleware, Target};
+use wasmer_compiler::{
+    CompileModuleInfo, CompilePool, Compiler, CompilerConfig, CpuFeature, FunctionCache,
+    ModuleFunctionCache, ModuleMiddleware, Target,
+};
 use wasmer_types::Features;
 
 #[derive(Debug, Clone, MemoryUsage)]
@@ -12,6 +15,10 @@ pub struct Singlepass {
     pub(crate) enable_nan_canonicalization: bool,
     /// The middleware chain.
     pub(crate) middlewares: Vec<Arc<dyn ModuleMiddleware>>,
+    #[loupe(skip)]
+    function_cache: Option<Arc<dyn FunctionCache>>,
+    /// The pool of threads to compile on.
+    pub(crate) compile_pool: CompilePool,
 }
 
 impl Singlepass {
@@ -21,6 +28,8 @@ impl Singlepass {
         Self {
             enable_nan_canonicalization: true,
             middlewares: vec![],
+            function_cache: None,
+            compile_pool: CompilePool::default(),
         }
     }
 
@@ -32,6 +41,33 @@ impl Singlepass {
         self.enable_nan_canonicalization = enable;
         self
     }
+
+    /// The function cache to look the functions of a module up in, if
+    /// any. The cache is not used with middlewares.
+    pub(crate) fn module_function_cache(
+        &self,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+    ) -> Option<ModuleFunctionCache> {
+        if !self.middlewares.is_empty() {
+            return None;
+        }
+        let cache = self.function_cache.as_deref()?;
+        // The settings that change the generated code.
+        let settings = (
+            self.enable_nan_canonicalization,
+            cfg!(feature = "unwind"),
+            cfg!(feature = "avx"),
+            cfg!(feature = "sse"),
+        );
+        Some(ModuleFunctionCache::new(
+            cache,
+            "singlepass",
+            &settings,
+            target,
+            compile_info,
+        ))
+    }
 }
 
 impl CompilerConfig for Singlepass {
@@ -56,6 +92,14 @@ impl CompilerConfig for Singlepass {
     fn push_middleware(&mut self, middleware: Arc<dyn ModuleMiddleware>) {
         self.middlewares.push(middleware);
     }
+
+    fn function_cache(&mut self, cache: Arc<dyn FunctionCache>) {
+        self.function_cache = Some(cache);
+    }
+
+    fn compile_pool(&mut self, pool: CompilePool) {
+        self.compile_pool = pool;
+    }
 }
 
 impl Default for Singlepass {
@@ -1,4 +1,7 @@
-use gimli::write::{Address, EndianVec, Result, Writer};
+use gimli::write::{
+    Address, CommonInformationEntry, EhFrame, EndianVec, FrameDescriptionEntry, FrameTable, Result,
+    Writer,
+};
 use gimli::{RunTimeEndian, SectionId};
 use wasmer_compiler::{CustomSection, CustomSectionProtection, SectionBody};
 use wasmer_compiler::{Endianness, Relocation, RelocationKind, RelocationTarget};
@@ -36,6 +39,38 @@ impl WriterRelocate {
             relocations: self.relocs,
         }
     }
+
+    /// Appends the entries of another `.eh_frame` section, which has no
+    /// terminating entry.
+    pub fn append_section(&mut self, section: &CustomSection) {
+        let offset = self.len() as u32;
+        self.writer.write(section.bytes.as_slice()).unwrap();
+        self.relocs
+            .extend(section.relocations.iter().map(|reloc| Relocation {
+                offset: reloc.offset + offset,
+                ..reloc.clone()
+            }));
+    }
+}
+
+/// Writes the `.eh_frame` entries of a single function, with a CIE of its
+/// own, into a section to append to the `.eh_frame` of a module.
+pub fn eh_frame_section(
+    cie: CommonInformationEntry,
+    fde: FrameDescriptionEntry,
+    endianness: Option<Endianness>,
+) -> CustomSection {
+    let mut frame_table = FrameTable::default();
+    let cie_id = frame_table.add_cie(cie);
+    frame_table.add_fde(cie_id, fde);
+    let mut eh_frame = EhFrame(WriterRelocate::new(endianness));
+    frame_table.write_eh_frame(&mut eh_frame).unwrap();
+    let writer = eh_frame.0;
+    CustomSection {
+        protection: CustomSectionProtection::Read,
+        bytes: SectionBody::new_with_vec(writer.writer.into_vec()),
+        relocations: writer.relocs,
+    }
 }
 
 impl Writer for WriterRelocate {
@@ -635,6 +635,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -646,6 +647,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -657,6 +659,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -668,6 +671,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -679,6 +683,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -690,6 +695,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -701,6 +707,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -712,6 +719,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -723,6 +731,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -734,6 +743,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -745,6 +755,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -756,6 +767,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -767,6 +779,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -778,6 +791,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -790,6 +804,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -802,6 +817,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -814,6 +830,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -826,6 +843,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -838,6 +856,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -850,6 +869,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -862,6 +882,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -874,6 +895,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -886,6 +908,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -898,6 +921,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -910,6 +934,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -922,6 +947,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -934,6 +960,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -946,6 +973,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -958,6 +986,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -970,6 +999,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -982,6 +1012,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -994,6 +1025,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1007,6 +1039,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1020,6 +1053,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1033,6 +1067,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1252,6 +1287,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1263,6 +1299,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1274,6 +1311,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1285,6 +1323,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1296,6 +1335,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1307,6 +1347,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1318,6 +1359,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1329,6 +1371,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1340,6 +1383,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1351,6 +1395,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1362,6 +1407,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1373,6 +1419,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1384,6 +1431,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1395,6 +1443,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1406,6 +1455,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1417,6 +1467,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1428,6 +1479,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1439,6 +1491,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1450,6 +1503,7 @@ pub trait Machine {
         addr: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1462,6 +1516,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1474,6 +1529,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1486,6 +1542,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1498,6 +1555,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1510,6 +1568,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1522,6 +1581,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1534,6 +1594,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1546,6 +1607,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1558,6 +1620,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1570,6 +1633,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1582,6 +1646,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1594,6 +1659,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1606,6 +1672,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1618,6 +1685,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1630,6 +1698,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1642,6 +1711,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1654,6 +1724,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1666,6 +1737,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1678,6 +1750,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1690,6 +1763,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1702,6 +1776,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1714,6 +1789,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1726,6 +1802,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1738,6 +1815,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1751,6 +1829,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1764,6 +1843,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1777,6 +1857,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1790,6 +1871,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1802,6 +1884,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1814,6 +1897,7 @@ pub trait Machine {
         canonicalize: bool,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1825,6 +1909,7 @@ pub trait Machine {
         ret: Location<Self::GPR, Self::SIMD>,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -1837,6 +1922,7 @@ pub trait Machine {
         canonicalize: bool,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     );
@@ -860,6 +860,7 @@ impl MachineARM64 {
         value_size: usize,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
         cb: F,
@@ -927,13 +928,14 @@ impl MachineARM64 {
         // Load effective address.
         // `base_loc` and `bound_loc` becomes INVALID after this line, because `tmp_addr`
         // might be reused.
-        self.move_location(Size::S32, addr, Location::GPR(tmp_addr));
+        let addr_size = if memory64 { Size::S64 } else { Size::S32 };
+        self.move_location(addr_size, addr, Location::GPR(tmp_addr));
 
         // Add offset to memory address.
         if memarg.offset != 0 {
             if self.compatible_imm(memarg.offset as _, ImmType::Bits12) {
                 self.assembler.emit_adds(
-                    Size::S32,
+                    addr_size,
                     Location::Imm32(memarg.offset as u32),
                     Location::GPR(tmp_addr),
                     Location::GPR(tmp_addr),
@@ -943,7 +945,7 @@ impl MachineARM64 {
                 self.assembler
                     .emit_mov_imm(Location::GPR(tmp), memarg.offset as _);
                 self.assembler.emit_adds(
-                    Size::S32,
+                    addr_size,
                     Location::GPR(tmp_addr),
                     Location::GPR(tmp),
                     Location::GPR(tmp_addr),
@@ -957,12 +959,24 @@ impl MachineARM64 {
         }
 
         // Wasm linear memory -> real memory
-        self.assembler.emit_add(
-            Size::S64,
-            Location::GPR(tmp_base),
-            Location::GPR(tmp_addr),
-            Location::GPR(tmp_addr),
-        );
+        if memory64 {
+            // A 64-bit address may wrap around past the base too.
+            self.assembler.emit_adds(
+                Size::S64,
+                Location::GPR(tmp_base),
+                Location::GPR(tmp_addr),
+                Location::GPR(tmp_addr),
+            );
+            self.assembler
+                .emit_bcond_label_far(Condition::Cs, heap_access_oob);
+        } else {
+            self.assembler.emit_add(
+                Size::S64,
+                Location::GPR(tmp_base),
+                Location::GPR(tmp_addr),
+                Location::GPR(tmp_addr),
+            );
+        }
 
         if need_check {
             // Trap if the end address of the requested area is above that of the linear memory.
@@ -1006,6 +1020,7 @@ impl MachineARM64 {
         _stack_sz: Size,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
         _cb: F,
@@ -2780,6 +2795,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2790,6 +2806,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2804,6 +2821,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2814,6 +2832,7 @@ impl Machine for MachineARM64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2828,6 +2847,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2838,6 +2858,7 @@ impl Machine for MachineARM64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2852,6 +2873,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2862,6 +2884,7 @@ impl Machine for MachineARM64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2876,6 +2899,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2886,6 +2910,7 @@ impl Machine for MachineARM64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2900,6 +2925,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -2912,6 +2938,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -2924,6 +2951,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -2936,6 +2964,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2946,6 +2975,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2960,6 +2990,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2970,6 +3001,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2984,6 +3016,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2994,6 +3027,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3008,6 +3042,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3020,6 +3055,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3032,6 +3068,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3046,6 +3083,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3060,6 +3098,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3074,6 +3113,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3088,6 +3128,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3102,6 +3143,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3116,6 +3158,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3130,6 +3173,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3144,6 +3188,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3158,6 +3203,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3172,6 +3218,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3186,6 +3233,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3200,6 +3248,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3214,6 +3263,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3228,6 +3278,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3242,6 +3293,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3256,6 +3308,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3270,6 +3323,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3284,6 +3338,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3299,6 +3354,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3314,6 +3370,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3329,6 +3386,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3714,6 +3772,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3724,6 +3783,7 @@ impl Machine for MachineARM64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3738,6 +3798,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3748,6 +3809,7 @@ impl Machine for MachineARM64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3762,6 +3824,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3772,6 +3835,7 @@ impl Machine for MachineARM64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3786,6 +3850,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3796,6 +3861,7 @@ impl Machine for MachineARM64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3810,6 +3876,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3820,6 +3887,7 @@ impl Machine for MachineARM64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3834,6 +3902,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3844,6 +3913,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3858,6 +3928,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3868,6 +3939,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3882,6 +3954,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3894,6 +3967,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3906,6 +3980,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3918,6 +3993,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -3930,6 +4006,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3940,6 +4017,7 @@ impl Machine for MachineARM64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3954,6 +4032,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3964,6 +4043,7 @@ impl Machine for MachineARM64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3978,6 +4058,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3988,6 +4069,7 @@ impl Machine for MachineARM64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4002,6 +4084,7 @@ impl Machine for MachineARM64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4012,6 +4095,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4026,6 +4110,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4038,6 +4123,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4050,6 +4136,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4062,6 +4149,7 @@ impl Machine for MachineARM64 {
         _target_addr: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4076,6 +4164,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4090,6 +4179,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4104,6 +4194,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4118,6 +4209,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4132,6 +4224,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4146,6 +4239,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4160,6 +4254,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4174,6 +4269,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4188,6 +4284,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4202,6 +4299,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4216,6 +4314,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4230,6 +4329,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4244,6 +4344,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4258,6 +4359,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4272,6 +4374,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4286,6 +4389,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4300,6 +4404,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4314,6 +4419,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4328,6 +4434,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4342,6 +4449,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4356,6 +4464,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4370,6 +4479,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4384,6 +4494,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4398,6 +4509,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4413,6 +4525,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4428,6 +4541,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4443,6 +4557,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4458,6 +4573,7 @@ impl Machine for MachineARM64 {
         _ret: Location,
         _need_check: bool,
         _imported_memories: bool,
+        _memory64: bool,
         _offset: i32,
         _heap_access_oob: Label,
     ) {
@@ -4471,6 +4587,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4481,6 +4598,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4496,6 +4614,7 @@ impl Machine for MachineARM64 {
         canonicalize: bool,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4507,6 +4626,7 @@ impl Machine for MachineARM64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4525,6 +4645,7 @@ impl Machine for MachineARM64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4535,6 +4656,7 @@ impl Machine for MachineARM64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4550,6 +4672,7 @@ impl Machine for MachineARM64 {
         canonicalize: bool,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4561,6 +4684,7 @@ impl Machine for MachineARM64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
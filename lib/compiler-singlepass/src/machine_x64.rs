@@ -439,6 +439,7 @@ impl MachineX86_64 {
         value_size: usize,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
         cb: F,
@@ -492,16 +493,38 @@ impl MachineX86_64 {
         // Load effective address.
         // `base_loc` and `bound_loc` becomes INVALID after this line, because `tmp_addr`
         // might be reused.
-        self.assembler
-            .emit_mov(Size::S32, addr, Location::GPR(tmp_addr));
+        if memory64 {
+            self.move_location(Size::S64, addr, Location::GPR(tmp_addr));
+        } else {
+            self.assembler
+                .emit_mov(Size::S32, addr, Location::GPR(tmp_addr));
+        }
 
         // Add offset to memory address.
         if memarg.offset != 0 {
-            self.assembler.emit_add(
-                Size::S32,
-                Location::Imm32(memarg.offset as u32),
-                Location::GPR(tmp_addr),
-            );
+            if !memory64 {
+                self.assembler.emit_add(
+                    Size::S32,
+                    Location::Imm32(memarg.offset as u32),
+                    Location::GPR(tmp_addr),
+                );
+            } else if memarg.offset <= i32::MAX as u64 {
+                self.assembler.emit_add(
+                    Size::S64,
+                    Location::Imm32(memarg.offset as u32),
+                    Location::GPR(tmp_addr),
+                );
+            } else {
+                let tmp = self.acquire_temp_gpr().unwrap();
+                self.assembler.emit_mov(
+                    Size::S64,
+                    Location::Imm64(memarg.offset),
+                    Location::GPR(tmp),
+                );
+                self.assembler
+                    .emit_add(Size::S64, Location::GPR(tmp), Location::GPR(tmp_addr));
+                self.release_gpr(tmp);
+            }
 
             // Trap if offset calculation overflowed.
             self.assembler.emit_jmp(Condition::Carry, heap_access_oob);
@@ -511,6 +534,11 @@ impl MachineX86_64 {
         self.assembler
             .emit_add(Size::S64, Location::GPR(tmp_base), Location::GPR(tmp_addr));
 
+        if memory64 {
+            // A 64-bit address may wrap around past the base too.
+            self.assembler.emit_jmp(Condition::Carry, heap_access_oob);
+        }
+
         if need_check {
             // Trap if the end address of the requested area is above that of the linear memory.
             self.assembler
@@ -559,6 +587,7 @@ impl MachineX86_64 {
         stack_sz: Size,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
         cb: F,
@@ -587,6 +616,7 @@ impl MachineX86_64 {
             value_size,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2828,6 +2858,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2838,6 +2869,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2857,6 +2889,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2867,6 +2900,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2887,6 +2921,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2897,6 +2932,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2917,6 +2953,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2927,6 +2964,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2947,6 +2985,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2957,6 +2996,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -2977,6 +3017,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -2987,6 +3028,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3001,6 +3043,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3011,6 +3054,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3030,6 +3074,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3040,6 +3085,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3059,6 +3105,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3069,6 +3116,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3088,6 +3136,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3098,6 +3147,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3117,6 +3167,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3127,6 +3178,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3146,6 +3198,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3156,6 +3209,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3170,6 +3224,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3180,6 +3235,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3194,6 +3250,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3204,6 +3261,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3220,6 +3278,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3232,6 +3291,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3254,6 +3314,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3266,6 +3327,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3288,6 +3350,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3300,6 +3363,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3322,6 +3386,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3334,6 +3399,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3356,6 +3422,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3368,6 +3435,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3390,6 +3458,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3402,6 +3471,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3424,6 +3494,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3437,6 +3508,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3454,6 +3526,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3467,6 +3540,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3484,6 +3558,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3497,6 +3572,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3514,6 +3590,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3527,6 +3604,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3544,6 +3622,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3557,6 +3636,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3574,6 +3654,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3587,6 +3668,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3604,6 +3686,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3617,6 +3700,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3634,6 +3718,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3647,6 +3732,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3664,6 +3750,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3677,6 +3764,7 @@ impl Machine for MachineX86_64 {
             Size::S32,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -3694,6 +3782,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3706,6 +3795,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3728,6 +3818,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3741,6 +3832,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3760,6 +3852,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3773,6 +3866,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3796,6 +3890,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3822,6 +3917,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3847,6 +3943,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3873,6 +3970,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -3898,6 +3996,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -3924,6 +4023,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4265,6 +4365,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4275,6 +4376,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4294,6 +4396,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4304,6 +4407,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4324,6 +4428,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4334,6 +4439,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4354,6 +4460,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4364,6 +4471,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4384,6 +4492,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4394,6 +4503,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4414,6 +4524,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4424,6 +4535,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4456,6 +4568,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4466,6 +4579,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4486,6 +4600,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4496,6 +4611,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4510,6 +4626,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4520,6 +4637,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4539,6 +4657,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4549,6 +4668,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4568,6 +4688,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4578,6 +4699,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4610,6 +4732,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4620,6 +4743,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4639,6 +4763,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4649,6 +4774,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4668,6 +4794,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4678,6 +4805,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4697,6 +4825,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4707,6 +4836,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4726,6 +4856,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4736,6 +4867,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4750,6 +4882,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4760,6 +4893,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4774,6 +4908,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4784,6 +4919,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4798,6 +4934,7 @@ impl Machine for MachineX86_64 {
         target_addr: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4808,6 +4945,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4824,6 +4962,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4836,6 +4975,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4858,6 +4998,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4870,6 +5011,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4892,6 +5034,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4904,6 +5047,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4926,6 +5070,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4938,6 +5083,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4960,6 +5106,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -4972,6 +5119,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -4994,6 +5142,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5006,6 +5155,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5028,6 +5178,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5040,6 +5191,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5062,6 +5214,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5074,6 +5227,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5096,6 +5250,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5109,6 +5264,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5126,6 +5282,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5139,6 +5296,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5156,6 +5314,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5169,6 +5328,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5186,6 +5346,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5199,6 +5360,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5216,6 +5378,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5229,6 +5392,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5245,6 +5409,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5258,6 +5423,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5274,6 +5440,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5287,6 +5454,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5303,6 +5471,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5316,6 +5485,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5332,6 +5502,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5345,6 +5516,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5361,6 +5533,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5374,6 +5547,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5390,6 +5564,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5403,6 +5578,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5419,6 +5595,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5432,6 +5609,7 @@ impl Machine for MachineX86_64 {
             Size::S64,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, src, dst| {
@@ -5448,6 +5626,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5460,6 +5639,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5482,6 +5662,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5495,6 +5676,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5514,6 +5696,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5527,6 +5710,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5549,6 +5733,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5562,6 +5747,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5585,6 +5771,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5611,6 +5798,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5636,6 +5824,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5662,6 +5851,7 @@ impl Machine for MachineX86_64 {
             1,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5687,6 +5877,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5713,6 +5904,7 @@ impl Machine for MachineX86_64 {
             2,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5738,6 +5930,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5764,6 +5957,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5787,6 +5981,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5797,6 +5992,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5817,6 +6013,7 @@ impl Machine for MachineX86_64 {
         canonicalize: bool,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5828,6 +6025,7 @@ impl Machine for MachineX86_64 {
             4,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5851,6 +6049,7 @@ impl Machine for MachineX86_64 {
         ret: Location,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5861,6 +6060,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -5881,6 +6081,7 @@ impl Machine for MachineX86_64 {
         canonicalize: bool,
         need_check: bool,
         imported_memories: bool,
+        memory64: bool,
         offset: i32,
         heap_access_oob: Label,
     ) {
@@ -5892,6 +6093,7 @@ impl Machine for MachineX86_64 {
             8,
             need_check,
             imported_memories,
+            memory64,
             offset,
             heap_access_oob,
             |this, addr| {
@@ -0,0 +1,513 @@
+//! The threads the functions of a module are compiled on.
+
+use crate::error::CompileError;
+use crate::lib::std::fmt;
+use crate::lib::std::sync::Arc;
+use crate::lib::std::vec::Vec;
+use core::sync::atomic::{AtomicU64, Ordering};
+use loupe::MemoryUsage;
+#[cfg(feature = "compile-pool")]
+use std::any::Any;
+#[cfg(feature = "std")]
+use std::cell::RefCell;
+#[cfg(feature = "compile-pool")]
+use std::mem;
+#[cfg(feature = "compile-pool")]
+use std::panic::{self, AssertUnwindSafe};
+#[cfg(feature = "std")]
+use std::sync::atomic::{AtomicBool, AtomicUsize};
+#[cfg(feature = "compile-pool")]
+use std::sync::{Condvar, Mutex};
+
+/// The settings of a [`CompilePool`].
+///
+/// A setting left unset keeps the behavior of the global `rayon` pool:
+/// as many threads as CPUs, with the priority and CPU affinity of the
+/// process.
+#[derive(Debug, Clone, Default, PartialEq, Eq, MemoryUsage)]
+pub struct CompilePoolConfig {
+    threads: Option<usize>,
+    priority: Option<i32>,
+    cpu_affinity: Option<Vec<usize>>,
+}
+
+impl CompilePoolConfig {
+    /// Creates the settings of a pool behaving like the global `rayon`
+    /// pool.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// The number of threads of the pool.
+    pub fn threads(&mut self, threads: usize) -> &mut Self {
+        self.threads = Some(threads.max(1));
+        self
+    }
+
+    /// The niceness of the threads of the pool, from -20 (highest
+    /// priority) to 19 (lowest priority).
+    ///
+    /// Only supported on Linux and Android, ignored elsewhere.
+    pub fn priority(&mut self, nice: i32) -> &mut Self {
+        self.priority = Some(nice);
+        self
+    }
+
+    /// The CPUs the threads of the pool may run on.
+    ///
+    /// Only supported on Linux and Android, ignored elsewhere.
+    pub fn cpu_affinity(&mut self, cpus: Vec<usize>) -> &mut Self {
+        self.cpu_affinity = Some(cpus);
+        self
+    }
+
+    #[cfg(feature = "compile-pool")]
+    fn is_default(&self) -> bool {
+        *self == Self::default()
+    }
+}
+
+/// The pool of threads a compiler compiles the functions of a module on,
+/// and through which the compilations in progress can be cancelled.
+///
+/// Set it with [`CompilerConfig::compile_pool`]. Cloning a pool gives
+/// another handle to the same threads.
+///
+/// [`CompilerConfig::compile_pool`]: crate::CompilerConfig::compile_pool
+#[derive(Clone, Default, MemoryUsage)]
+pub struct CompilePool {
+    #[loupe(skip)]
+    inner: Arc<CompilePoolInner>,
+}
+
+#[derive(Default)]
+struct CompilePoolInner {
+    config: CompilePoolConfig,
+    /// Bumped by `cancel`, which cancels the compilations started before.
+    generation: AtomicU64,
+    /// The threads of the pool, or `None` to run on the global pool.
+    #[cfg(feature = "compile-pool")]
+    threads: Option<rayon::ThreadPool>,
+}
+
+impl CompilePool {
+    /// Creates a pool with the given settings.
+    ///
+    /// The threads are spawned right away, unless all the settings are
+    /// left unset, in which case the compilations run on the global
+    /// `rayon` pool. It fails with [`CompileError::Resource`] if the
+    /// threads can't be spawned.
+    pub fn new(config: CompilePoolConfig) -> Result<Self, CompileError> {
+        #[cfg(feature = "compile-pool")]
+        let threads = if config.is_default() {
+            None
+        } else {
+            Some(
+                build_thread_pool(&config)
+                    .map_err(|error| CompileError::Resource(error.to_string()))?,
+            )
+        };
+        Ok(Self {
+            inner: Arc::new(CompilePoolInner {
+                config,
+                generation: AtomicU64::new(0),
+                #[cfg(feature = "compile-pool")]
+                threads,
+            }),
+        })
+    }
+
+    /// The settings of this pool.
+    pub fn config(&self) -> &CompilePoolConfig {
+        &self.inner.config
+    }
+
+    /// Cancels the compilations in progress on this pool: they stop at
+    /// the next function and fail with [`CompileError::Cancelled`]. The
+    /// compilations started afterwards are not affected.
+    pub fn cancel(&self) {
+        self.inner.generation.fetch_add(1, Ordering::SeqCst);
+    }
+
+    /// Runs the compilation `op` on the threads of this pool, so that the
+    /// parallel iterators it uses run on them too.
+    pub fn install<R, OP>(&self, op: OP) -> R
+    where
+        OP: FnOnce(&CompileScope) -> R + Send,
+        R: Send,
+    {
+        let scope = self.scope();
+        #[cfg(feature = "compile-pool")]
+        if let Some(threads) = &self.inner.threads {
+            return threads.install(|| op(&scope));
+        }
+        op(&scope)
+    }
+
+    /// Runs the compilation `op` on the current thread, e.g. to wait for
+    /// the functions to compile there and spawn each of them on the
+    /// threads of this pool with [`CompileScope::spawn_each`].
+    pub fn enter<R, OP>(&self, op: OP) -> R
+    where
+        OP: FnOnce(&CompileScope) -> R,
+    {
+        op(&self.scope())
+    }
+
+    fn scope(&self) -> CompileScope<'_> {
+        CompileScope {
+            pool: &self.inner,
+            generation: self.inner.generation.load(Ordering::SeqCst),
+            #[cfg(feature = "std")]
+            monitor: CURRENT_MONITOR.with(|monitor| monitor.borrow().clone()),
+        }
+    }
+}
+
+impl fmt::Debug for CompilePool {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("CompilePool")
+            .field("config", &self.inner.config)
+            .finish()
+    }
+}
+
+/// A compilation in progress on a [`CompilePool`].
+pub struct CompileScope<'a> {
+    pool: &'a CompilePoolInner,
+    generation: u64,
+    /// The monitor of the thread that started the compilation, if any.
+    #[cfg(feature = "std")]
+    monitor: Option<Arc<CompileMonitor>>,
+}
+
+impl CompileScope<'_> {
+    /// Fails with [`CompileError::Cancelled`] if the compilation was
+    /// cancelled. Compilers check it before compiling each function.
+    pub fn check_cancelled(&self) -> Result<(), CompileError> {
+        if self.pool.generation.load(Ordering::Relaxed) != self.generation {
+            return Err(CompileError::Cancelled);
+        }
+        #[cfg(feature = "std")]
+        if let Some(monitor) = &self.monitor {
+            if monitor.is_cancelled() {
+                return Err(CompileError::Cancelled);
+            }
+        }
+        Ok(())
+    }
+
+    /// Records that the compilation has `count` more functions to
+    /// compile.
+    pub fn add_functions(&self, count: usize) {
+        #[cfg(feature = "std")]
+        if let Some(monitor) = &self.monitor {
+            monitor.functions.fetch_add(count, Ordering::Relaxed);
+        }
+        #[cfg(not(feature = "std"))]
+        let _ = count;
+    }
+
+    /// Records that the compilation compiled a function.
+    pub fn function_compiled(&self) {
+        #[cfg(feature = "std")]
+        if let Some(monitor) = &self.monitor {
+            monitor.compiled_functions.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    /// Runs `op` on the threads of the pool, so that the parallel
+    /// iterators it uses run on them too. It runs `op` right away when
+    /// already on one of them.
+    pub fn install<R, OP>(&self, op: OP) -> R
+    where
+        OP: FnOnce() -> R + Send,
+        R: Send,
+    {
+        #[cfg(feature = "compile-pool")]
+        if let Some(threads) = &self.pool.threads {
+            return threads.install(op);
+        }
+        op()
+    }
+
+    /// Runs `f` on each item on the threads of the pool, as soon as
+    /// `items` yields it, and returns once all of them are done.
+    ///
+    /// The items are waited for on the current thread rather than on
+    /// the threads of the pool, which keep compiling the other modules
+    /// meanwhile, so this must not be called from one of them. A panic
+    /// of `f` is resumed here once all the items are done.
+    #[cfg(feature = "compile-pool")]
+    pub fn spawn_each<T, I, F>(&self, items: I, f: F)
+    where
+        I: IntoIterator<Item = T>,
+        T: Send,
+        F: Fn(T) + Sync,
+    {
+        let jobs = Arc::new(SpawnedJobs::default());
+        let wait = WaitForJobs(&jobs);
+        let f = &f;
+        for item in items {
+            *jobs.pending.lock().unwrap() += 1;
+            let job_jobs = jobs.clone();
+            let job: Box<dyn FnOnce() + Send + '_> = Box::new(move || {
+                let result = panic::catch_unwind(AssertUnwindSafe(|| f(item)));
+                job_jobs.done(result.err());
+            });
+            // SAFETY: `wait` waits for every job spawned, even when
+            // unwinding, before `f` and the items go out of scope.
+            let job: Box<dyn FnOnce() + Send + 'static> = unsafe { mem::transmute(job) };
+            match &self.pool.threads {
+                Some(threads) => threads.spawn(job),
+                None => rayon::spawn(job),
+            }
+        }
+        drop(wait);
+        if let Some(payload) = jobs.panic.lock().unwrap().take() {
+            panic::resume_unwind(payload);
+        }
+    }
+}
+
+/// The jobs spawned by [`CompileScope::spawn_each`].
+#[cfg(feature = "compile-pool")]
+#[derive(Default)]
+struct SpawnedJobs {
+    pending: Mutex<usize>,
+    done: Condvar,
+    /// The payload of the first job that panicked.
+    panic: Mutex<Option<Box<dyn Any + Send>>>,
+}
+
+#[cfg(feature = "compile-pool")]
+impl SpawnedJobs {
+    fn done(&self, panic: Option<Box<dyn Any + Send>>) {
+        if let Some(payload) = panic {
+            self.panic.lock().unwrap().get_or_insert(payload);
+        }
+        let mut pending = self.pending.lock().unwrap();
+        *pending -= 1;
+        if *pending == 0 {
+            self.done.notify_all();
+        }
+    }
+}
+
+/// Waits for the jobs spawned by [`CompileScope::spawn_each`] once
+/// dropped.
+#[cfg(feature = "compile-pool")]
+struct WaitForJobs<'a>(&'a SpawnedJobs);
+
+#[cfg(feature = "compile-pool")]
+impl Drop for WaitForJobs<'_> {
+    fn drop(&mut self) {
+        let mut pending = self.0.pending.lock().unwrap();
+        while *pending > 0 {
+            pending = self.0.done.wait(pending).unwrap();
+        }
+    }
+}
+
+#[cfg(feature = "std")]
+std::thread_local! {
+    static CURRENT_MONITOR: RefCell<Option<Arc<CompileMonitor>>> = RefCell::new(None);
+}
+
+/// Follows the compilations started on a thread, to report their
+/// progress or to cancel them without cancelling the other compilations
+/// of their pool.
+#[cfg(feature = "std")]
+#[derive(Debug, Default)]
+pub struct CompileMonitor {
+    cancelled: AtomicBool,
+    functions: AtomicUsize,
+    compiled_functions: AtomicUsize,
+}
+
+#[cfg(feature = "std")]
+impl CompileMonitor {
+    /// Creates a monitor, following no compilation yet.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Runs `f`, following the compilations it starts on the current
+    /// thread.
+    pub fn monitor<R>(self: &Arc<Self>, f: impl FnOnce() -> R) -> R {
+        struct Restore(Option<Arc<CompileMonitor>>);
+
+        impl Drop for Restore {
+            fn drop(&mut self) {
+                CURRENT_MONITOR.with(|monitor| *monitor.borrow_mut() = self.0.take());
+            }
+        }
+
+        let previous = CURRENT_MONITOR.with(|monitor| monitor.replace(Some(self.clone())));
+        let _restore = Restore(previous);
+        f()
+    }
+
+    /// Cancels the compilations followed by this monitor: they stop at
+    /// the next function and fail with [`CompileError::Cancelled`].
+    pub fn cancel(&self) {
+        self.cancelled.store(true, Ordering::Relaxed);
+    }
+
+    /// Whether the compilations followed by this monitor were cancelled.
+    pub fn is_cancelled(&self) -> bool {
+        self.cancelled.load(Ordering::Relaxed)
+    }
+
+    /// The number of functions compiled so far, and the number of
+    /// functions to compile, by the compilations followed by this
+    /// monitor.
+    pub fn progress(&self) -> (usize, usize) {
+        (
+            self.compiled_functions.load(Ordering::Relaxed),
+            self.functions.load(Ordering::Relaxed),
+        )
+    }
+}
+
+#[cfg(feature = "compile-pool")]
+fn build_thread_pool(
+    config: &CompilePoolConfig,
+) -> Result<rayon::ThreadPool, rayon::ThreadPoolBuildError> {
+    let mut builder =
+        rayon::ThreadPoolBuilder::new().thread_name(|index| format!("wasmer-compile-{}", index));
+    if let Some(threads) = config.threads {
+        builder = builder.num_threads(threads);
+    }
+    let priority = config.priority;
+    let cpu_affinity = config.cpu_affinity.clone();
+    builder = builder.start_handler(move |_| {
+        // Tuning the threads is best-effort: a thread that can't be
+        // tuned still compiles.
+        if let Some(nice) = priority {
+            set_thread_priority(nice);
+        }
+        if let Some(cpus) = &cpu_affinity {
+            set_thread_cpu_affinity(cpus);
+        }
+    });
+    builder.build()
+}
+
+#[cfg(all(
+    feature = "compile-pool",
+    any(target_os = "linux", target_os = "android")
+))]
+fn set_thread_priority(nice: i32) {
+    // On Linux, the niceness is a property of the thread rather than of
+    // the process, so this only changes the calling thread.
+    unsafe {
+        libc::setpriority(libc::PRIO_PROCESS, 0, nice);
+    }
+}
+
+#[cfg(all(
+    feature = "compile-pool",
+    not(any(target_os = "linux", target_os = "android"))
+))]
+fn set_thread_priority(_nice: i32) {}
+
+#[cfg(all(
+    feature = "compile-pool",
+    any(target_os = "linux", target_os = "android")
+))]
+fn set_thread_cpu_affinity(cpus: &[usize]) {
+    unsafe {
+        let mut set: libc::cpu_set_t = core::mem::zeroed();
+        for &cpu in cpus {
+            if cpu < libc::CPU_SETSIZE as usize {
+                libc::CPU_SET(cpu, &mut set);
+            }
+        }
+        libc::sched_setaffinity(0, core::mem::size_of::<libc::cpu_set_t>(), &set);
+    }
+}
+
+#[cfg(all(
+    feature = "compile-pool",
+    not(any(target_os = "linux", target_os = "android"))
+))]
+fn set_thread_cpu_affinity(_cpus: &[usize]) {}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn cancel_stops_the_compilations_in_progress() {
+        let pool = CompilePool::new(CompilePoolConfig::default()).unwrap();
+        pool.install(|scope| {
+            assert!(scope.check_cancelled().is_ok());
+            pool.cancel();
+            assert!(matches!(
+                scope.check_cancelled(),
+                Err(CompileError::Cancelled)
+            ));
+        });
+        pool.install(|scope| assert!(scope.check_cancelled().is_ok()));
+    }
+
+    #[test]
+    fn monitors_the_compilations_of_the_thread() {
+        let pool = CompilePool::default();
+        let monitor = Arc::new(CompileMonitor::new());
+        monitor.monitor(|| {
+            pool.install(|scope| {
+                scope.add_functions(2);
+                scope.function_compiled();
+                assert!(scope.check_cancelled().is_ok());
+                monitor.cancel();
+                assert!(scope.check_cancelled().is_err());
+            })
+        });
+        assert_eq!(monitor.progress(), (1, 2));
+
+        // The compilations started outside of `monitor` aren't followed.
+        pool.install(|scope| {
+            scope.add_functions(1);
+            assert!(scope.check_cancelled().is_ok());
+        });
+        assert_eq!(monitor.progress(), (1, 2));
+    }
+
+    #[cfg(feature = "compile-pool")]
+    #[test]
+    fn runs_on_the_threads_of_the_pool() {
+        let mut config = CompilePoolConfig::new();
+        config.threads(2);
+        let pool = CompilePool::new(config).unwrap();
+        let thread_name = pool.install(|_| std::thread::current().name().map(String::from));
+        assert_eq!(
+            thread_name
+                .as_deref()
+                .map(|name| name.starts_with("wasmer-compile-")),
+            Some(true)
+        );
+        assert_eq!(pool.install(|_| rayon::current_num_threads()), 2);
+    }
+
+    #[cfg(feature = "compile-pool")]
+    #[test]
+    fn spawns_each_item_on_the_threads_of_the_pool() {
+        let mut config = CompilePoolConfig::new();
+        config.threads(2);
+        let pool = CompilePool::new(config).unwrap();
+        let thread_names = Mutex::new(Vec::new());
+        pool.enter(|scope| {
+            scope.spawn_each(0..4, |_| {
+                let thread_name = std::thread::current().name().map(String::from);
+                thread_names.lock().unwrap().push(thread_name);
+            })
+        });
+        let thread_names = thread_names.into_inner().unwrap();
+        assert_eq!(thread_names.len(), 4);
+        assert!(thread_names.iter().all(|thread_name| thread_name
+            .as_deref()
+            .map_or(false, |name| name.starts_with("wasmer-compile-"))));
+    }
+}
@@ -1,13 +1,16 @@
 //! This module mainly outputs the `Compiler` trait that custom
 //! compilers will need to implement.
 
+use crate::compile_pool::CompilePool;
 use crate::error::CompileError;
 use crate::function::Compilation;
+use crate::function_cache::FunctionCache;
 use crate::lib::std::boxed::Box;
 use crate::lib::std::sync::Arc;
 use crate::module::CompileModuleInfo;
 use crate::target::Target;
 use crate::translator::ModuleMiddleware;
+use crate::translator::{FunctionBodyStream, StreamedFunctionBody};
 use crate::FunctionBodyData;
 use crate::ModuleTranslationState;
 use crate::SectionIndex;
@@ -66,6 +69,20 @@ pub trait CompilerConfig {
 
     /// Pushes a middleware onto the back of the middleware chain.
     fn push_middleware(&mut self, middleware: Arc<dyn ModuleMiddleware>);
+
+    /// Sets the cache to reuse the compiled functions of previously
+    /// compiled modules from, see [`FunctionCache`].
+    fn function_cache(&mut self, _cache: Arc<dyn FunctionCache>) {
+        // By default we do nothing, each backend will need to customize this
+        // in case it can reuse compiled functions.
+    }
+
+    /// Sets the pool of threads to compile the functions of a module on,
+    /// see [`CompilePool`].
+    fn compile_pool(&mut self, _pool: CompilePool) {
+        // By default we do nothing, each backend will need to customize this
+        // in case it compiles functions in parallel.
+    }
 }
 
 impl<T> From<T> for Box<dyn CompilerConfig + 'static>
@@ -78,7 +95,10 @@ where
 }
 
 /// An implementation of a Compiler from parsed WebAssembly module to Compiled native code.
-pub trait Compiler: Send + MemoryUsage {
+///
+/// A compiler is shared by the compilations running concurrently, such
+/// as a streaming compilation waiting for the rest of its module.
+pub trait Compiler: Send + Sync + MemoryUsage {
     /// Validates a module.
     ///
     /// It returns the a succesful Result in case is valid, `CompileError` in case is not.
@@ -88,25 +108,7 @@ pub trait Compiler: Send + MemoryUsage {
         data: &'data [u8],
     ) -> Result<(), CompileError> {
         let mut validator = Validator::new();
-        let wasm_features = WasmFeatures {
-            bulk_memory: features.bulk_memory,
-            threads: features.threads,
-            reference_types: features.reference_types,
-            multi_value: features.multi_value,
-            simd: features.simd,
-            tail_call: features.tail_call,
-            module_linking: features.module_linking,
-            multi_memory: features.multi_memory,
-            memory64: features.memory64,
-            exceptions: features.exceptions,
-            deterministic_only: false,
-            extended_const: features.extended_const,
-            relaxed_simd: features.relaxed_simd,
-            mutable_global: true,
-            saturating_float_to_int: true,
-            sign_extension: true,
-        };
-        validator.wasm_features(wasm_features);
+        validator.wasm_features(wasm_features(features));
         validator
             .validate_all(data)
             .map_err(|e| CompileError::Validate(format!("{}", e)))?;
@@ -125,6 +127,29 @@ pub trait Compiler: Send + MemoryUsage {
         function_body_inputs: PrimaryMap<LocalFunctionIndex, FunctionBodyData<'data>>,
     ) -> Result<Compilation, CompileError>;
 
+    /// Compiles a parsed module whose function bodies are still being
+    /// received, e.g. from the network, so that compiling them overlaps
+    /// receiving the rest of the module.
+    ///
+    /// By default, this waits for all the function bodies and compiles
+    /// them with [`Compiler::compile_module`]. Compilers that compile the
+    /// functions in parallel should rather compile each body as soon as
+    /// it is received.
+    fn compile_module_streaming(
+        &self,
+        target: &Target,
+        module: &CompileModuleInfo,
+        module_translation: &ModuleTranslationState,
+        function_bodies: FunctionBodyStream,
+    ) -> Result<Compilation, CompileError> {
+        let function_bodies = function_bodies.wait()?;
+        let function_body_inputs = function_bodies
+            .values()
+            .map(StreamedFunctionBody::as_function_body_data)
+            .collect();
+        self.compile_module(target, module, module_translation, function_body_inputs)
+    }
+
     /// Compiles a module into a native object file.
     ///
     /// It returns the bytes as a `&[u8]` or a [`CompileError`].
@@ -144,6 +169,33 @@ pub trait Compiler: Send + MemoryUsage {
 
     /// Get the middlewares for this compiler
     fn get_middlewares(&self) -> &[Arc<dyn ModuleMiddleware>];
+
+    /// Get the pool of threads this compiler compiles on, if any.
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        None
+    }
+}
+
+/// The `wasmparser` features matching the given WebAssembly features.
+pub(crate) fn wasm_features(features: &Features) -> WasmFeatures {
+    WasmFeatures {
+        bulk_memory: features.bulk_memory,
+        threads: features.threads,
+        reference_types: features.reference_types,
+        multi_value: features.multi_value,
+        simd: features.simd,
+        tail_call: features.tail_call,
+        module_linking: features.module_linking,
+        multi_memory: features.multi_memory,
+        memory64: features.memory64,
+        exceptions: features.exceptions,
+        deterministic_only: false,
+        extended_const: features.extended_const,
+        relaxed_simd: features.relaxed_simd,
+        mutable_global: true,
+        saturating_float_to_int: true,
+        sign_extension: true,
+    }
 }
 
 /// The kinds of wasmer_types objects that might be found in a native object file.
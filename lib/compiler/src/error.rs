@@ -40,6 +40,10 @@ pub enum CompileError {
     /// Insufficient resources available for execution.
     #[cfg_attr(feature = "std", error("Insufficient resources: {0}"))]
     Resource(String),
+
+    /// The compilation was cancelled, see `CompilePool::cancel`.
+    #[cfg_attr(feature = "std", error("The compilation was cancelled"))]
+    Cancelled,
 }
 
 impl From<WasmError> for CompileError {
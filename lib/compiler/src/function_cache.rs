@@ -0,0 +1,331 @@
+//! A cache of compiled functions, so that recompiling a module whose
+//! code barely changed only compiles the functions that did.
+
+use crate::function::CompiledFunction;
+use crate::lib::std::fmt;
+use crate::lib::std::vec::Vec;
+use crate::module::CompileModuleInfo;
+use crate::section::{CustomSection, SectionIndex};
+use crate::sourceloc::SourceLoc;
+use crate::target::Target;
+use crate::FunctionBodyData;
+use rkyv::{
+    archived_value, de::deserializers::SharedDeserializeMap, ser::serializers::AllocSerializer,
+    ser::Serializer as RkyvSerializer, AlignedVec, Archive, Deserialize as RkyvDeserialize,
+    Serialize as RkyvSerialize,
+};
+use wasmer_types::entity::PrimaryMap;
+use wasmer_types::LocalFunctionIndex;
+
+/// The key of a compiled function in a [`FunctionCache`].
+///
+/// It hashes the body of the function together with everything else its
+/// code depends on: the compiler and its configuration, the target, the
+/// enabled features, and the declarations of the module, that is its
+/// types, imports, functions, tables, memories and globals. Editing the
+/// body of a function only changes its own key, while changing the
+/// declarations of the module changes the keys of all its functions.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct FunctionCacheKey([u8; 32]);
+
+impl FunctionCacheKey {
+    /// The raw bytes of the key.
+    pub fn as_bytes(&self) -> &[u8; 32] {
+        &self.0
+    }
+}
+
+impl fmt::Display for FunctionCacheKey {
+    /// The hexadecimal representation of the key.
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        for byte in self.0.iter() {
+            write!(f, "{:02x}", byte)?;
+        }
+        Ok(())
+    }
+}
+
+/// A store of compiled functions, which the compilers look the
+/// functions of a module up in before compiling them, and store the
+/// functions they compiled to.
+///
+/// Set it with [`CompilerConfig::function_cache`]. It is not used when
+/// the compiler has middlewares, since they may change the code in ways
+/// the key doesn't capture.
+///
+/// # Safety
+///
+/// `load` must return either `None` or bytes given to `store` with the
+/// same key: the compiled functions are deserialized without validation.
+///
+/// [`CompilerConfig::function_cache`]: crate::CompilerConfig::function_cache
+pub unsafe trait FunctionCache: fmt::Debug + Send + Sync {
+    /// Loads the compiled function stored with `key`, if any.
+    fn load(&self, key: &FunctionCacheKey) -> Option<Vec<u8>>;
+
+    /// Stores a compiled function with `key`. Failing to store it is not
+    /// an error, the function is compiled again next time.
+    fn store(&self, key: &FunctionCacheKey, bytes: &[u8]);
+}
+
+/// A compiled function as stored in a [`FunctionCache`], along with the
+/// custom sections compiled for it. How the relocations of the function
+/// refer to these sections is up to the compiler.
+#[derive(RkyvSerialize, RkyvDeserialize, Archive, Debug, Clone)]
+pub struct CachedFunction {
+    /// The compiled function.
+    pub compiled_function: CompiledFunction,
+    /// The custom sections compiled for the function.
+    pub custom_sections: PrimaryMap<SectionIndex, CustomSection>,
+    /// The custom sections holding the `.eh_frame` entries of the
+    /// function, to concatenate to the `.eh_frame` of the module.
+    pub eh_frame_sections: Vec<SectionIndex>,
+}
+
+impl CachedFunction {
+    /// Offsets the source locations of the function by `delta` bytes.
+    ///
+    /// They are stored relative to the start of the body of the function,
+    /// since the same body may start anywhere in another module.
+    fn offset_source_locations(&mut self, delta: i64) {
+        let offset = |srcloc: &mut SourceLoc| {
+            if !srcloc.is_default() {
+                *srcloc = SourceLoc::new((srcloc.bits() as i64 + delta) as u32);
+            }
+        };
+        let address_map = &mut self.compiled_function.frame_info.address_map;
+        for instruction in address_map.instructions.iter_mut() {
+            offset(&mut instruction.srcloc);
+        }
+        offset(&mut address_map.start_srcloc);
+        offset(&mut address_map.end_srcloc);
+    }
+
+    fn serialize(&self) -> Option<Vec<u8>> {
+        let mut serializer = AllocSerializer::<4096>::default();
+        let pos = serializer.serialize_value(self).ok()? as u64;
+        let mut serialized_data = serializer.into_serializer().into_inner();
+        serialized_data.extend_from_slice(&pos.to_le_bytes());
+        Some(serialized_data.to_vec())
+    }
+
+    /// # Safety
+    ///
+    /// `bytes` must have been returned by `serialize`.
+    unsafe fn deserialize(bytes: &[u8]) -> Option<Self> {
+        if bytes.len() < 8 {
+            return None;
+        }
+        let (data, pos) = bytes.split_at(bytes.len() - 8);
+        let mut pos_bytes: [u8; 8] = Default::default();
+        pos_bytes.copy_from_slice(pos);
+        let pos = u64::from_le_bytes(pos_bytes) as usize;
+        // The archive is only valid if aligned.
+        let mut aligned = AlignedVec::with_capacity(data.len());
+        aligned.extend_from_slice(data);
+        let archived = archived_value::<Self>(&aligned, pos);
+        RkyvDeserialize::deserialize(archived, &mut SharedDeserializeMap::new()).ok()
+    }
+}
+
+/// A [`FunctionCache`] as used to compile a module, which computes the
+/// keys of its functions.
+pub struct ModuleFunctionCache<'a> {
+    cache: &'a dyn FunctionCache,
+    /// The hash of everything the keys of the functions of the module
+    /// share.
+    module_hasher: blake3::Hasher,
+}
+
+impl<'a> ModuleFunctionCache<'a> {
+    /// Prepares to look the functions of a module up in `cache`.
+    ///
+    /// `compiler` names the compiler, and `config` lists all its settings
+    /// that change the code it generates.
+    pub fn new(
+        cache: &'a dyn FunctionCache,
+        compiler: &str,
+        config: &dyn fmt::Debug,
+        target: &Target,
+        compile_info: &CompileModuleInfo,
+    ) -> Self {
+        let module = &compile_info.module;
+        let mut module_hasher = blake3::Hasher::new();
+        // The `Debug` representations are only stable for a given version,
+        // which the key includes.
+        fmt::write(
+            &mut HashWriter(&mut module_hasher),
+            format_args!(
+                "{}\0{}\0{:?}\0{:?}\0{:?}\0{:?}\0{:?}\0",
+                crate::VERSION,
+                compiler,
+                config,
+                target,
+                compile_info.features,
+                compile_info.memory_styles,
+                compile_info.table_styles,
+            ),
+        )
+        .unwrap();
+        fmt::write(
+            &mut HashWriter(&mut module_hasher),
+            format_args!(
+                "{:?}\0{:?}\0{:?}\0{:?}\0{:?}\0{:?}\0{:?}\0{:?}\0",
+                module.imports,
+                module.signatures,
+                module.functions,
+                module.tables,
+                module.memories,
+                module.globals,
+                module.global_initializers,
+                (
+                    module.num_imported_functions,
+                    module.num_imported_tables,
+                    module.num_imported_memories,
+                    module.num_imported_globals,
+                ),
+            ),
+        )
+        .unwrap();
+        Self {
+            cache,
+            module_hasher,
+        }
+    }
+
+    /// The key of the local function `index` of the module.
+    pub fn key(&self, index: LocalFunctionIndex, body: &FunctionBodyData) -> FunctionCacheKey {
+        let mut hasher = self.module_hasher.clone();
+        hasher.update(&index.as_u32().to_le_bytes());
+        hasher.update(body.data);
+        FunctionCacheKey(hasher.finalize().into())
+    }
+
+    /// Loads the local function `index` of the module from the cache.
+    pub fn load(
+        &self,
+        index: LocalFunctionIndex,
+        body: &FunctionBodyData,
+    ) -> Option<CachedFunction> {
+        let bytes = self.cache.load(&self.key(index, body))?;
+        // The contract of `FunctionCache` guarantees that the bytes were
+        // serialized by `CachedFunction::serialize`.
+        let mut function = unsafe { CachedFunction::deserialize(&bytes) }?;
+        function.offset_source_locations(body.module_offset as i64);
+        Some(function)
+    }
+
+    /// Stores the local function `index` of the module to the cache.
+    pub fn store(
+        &self,
+        index: LocalFunctionIndex,
+        body: &FunctionBodyData,
+        function: &CachedFunction,
+    ) {
+        let mut function = function.clone();
+        function.offset_source_locations(-(body.module_offset as i64));
+        if let Some(bytes) = function.serialize() {
+            self.cache.store(&self.key(index, body), &bytes);
+        }
+    }
+}
+
+/// Feeds formatted text to a hasher.
+struct HashWriter<'a>(&'a mut blake3::Hasher);
+
+impl fmt::Write for HashWriter<'_> {
+    fn write_str(&mut self, s: &str) -> fmt::Result {
+        self.0.update(s.as_bytes());
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::address_map::{FunctionAddressMap, InstructionAddressMap};
+    use crate::function::{CompiledFunctionFrameInfo, FunctionBody};
+    use crate::lib::std::collections::HashMap;
+    use crate::lib::std::sync::Mutex;
+
+    #[derive(Debug, Default)]
+    struct MemoryCache(Mutex<HashMap<FunctionCacheKey, Vec<u8>>>);
+
+    unsafe impl FunctionCache for MemoryCache {
+        fn load(&self, key: &FunctionCacheKey) -> Option<Vec<u8>> {
+            self.0.lock().unwrap().get(key).cloned()
+        }
+
+        fn store(&self, key: &FunctionCacheKey, bytes: &[u8]) {
+            self.0.lock().unwrap().insert(*key, bytes.to_vec());
+        }
+    }
+
+    fn compiled(body: &FunctionBodyData, code: u8) -> CachedFunction {
+        let srcloc = SourceLoc::new(body.module_offset as u32 + 2);
+        CachedFunction {
+            compiled_function: CompiledFunction {
+                body: FunctionBody {
+                    body: vec![code; 4],
+                    unwind_info: None,
+                },
+                relocations: vec![],
+                frame_info: CompiledFunctionFrameInfo {
+                    traps: vec![],
+                    address_map: FunctionAddressMap {
+                        instructions: vec![InstructionAddressMap {
+                            srcloc,
+                            code_offset: 0,
+                            code_len: 4,
+                        }],
+                        start_srcloc: srcloc,
+                        end_srcloc: SourceLoc::default(),
+                        body_offset: 0,
+                        body_len: 4,
+                    },
+                },
+            },
+            custom_sections: PrimaryMap::new(),
+            eh_frame_sections: vec![],
+        }
+    }
+
+    #[test]
+    fn reuses_unchanged_functions() {
+        let cache = MemoryCache::default();
+        let compile_info = CompileModuleInfo {
+            features: Default::default(),
+            module: Default::default(),
+            memory_styles: PrimaryMap::new(),
+            table_styles: PrimaryMap::new(),
+        };
+        let cache =
+            ModuleFunctionCache::new(&cache, "test", &(), &Target::default(), &compile_info);
+        let index = LocalFunctionIndex::from_u32(0);
+        let body = FunctionBodyData {
+            data: &[0, 0x0b],
+            module_offset: 100,
+        };
+        assert!(cache.load(index, &body).is_none());
+        cache.store(index, &body, &compiled(&body, 1));
+
+        // The same body, elsewhere in the module.
+        let moved = FunctionBodyData {
+            data: &[0, 0x0b],
+            module_offset: 300,
+        };
+        let function = cache.load(index, &moved).unwrap();
+        assert_eq!(function.compiled_function.body.body, vec![1; 4]);
+        let address_map = &function.compiled_function.frame_info.address_map;
+        assert_eq!(address_map.instructions[0].srcloc, SourceLoc::new(302));
+        assert_eq!(address_map.start_srcloc, SourceLoc::new(302));
+        assert!(address_map.end_srcloc.is_default());
+
+        // Another body.
+        let changed = FunctionBodyData {
+            data: &[0, 0x01, 0x0b],
+            module_offset: 100,
+        };
+        assert!(cache.load(index, &changed).is_none());
+    }
+}
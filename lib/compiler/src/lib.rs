@@ -49,10 +49,13 @@ mod lib {
 }
 
 mod address_map;
+mod compile_pool;
 #[cfg(feature = "translator")]
 mod compiler;
 mod error;
 mod function;
+#[cfg(feature = "translator")]
+mod function_cache;
 mod module;
 mod relocation;
 mod target;
@@ -65,17 +68,28 @@ mod section;
 mod sourceloc;
 
 pub use crate::address_map::{FunctionAddressMap, InstructionAddressMap};
+#[cfg(feature = "std")]
+pub use crate::compile_pool::CompileMonitor;
+pub use crate::compile_pool::{CompilePool, CompilePoolConfig, CompileScope};
 #[cfg(feature = "translator")]
 pub use crate::compiler::{Compiler, CompilerConfig, Symbol, SymbolRegistry};
 pub use crate::error::{
     CompileError, MiddlewareError, ParseCpuFeatureError, WasmError, WasmResult,
 };
+#[cfg(feature = "enable-rkyv")]
+pub use crate::function::ArchivedFunctionBody;
 pub use crate::function::{
     Compilation, CompiledFunction, CompiledFunctionFrameInfo, CustomSections, Dwarf, FunctionBody,
     Functions,
 };
+#[cfg(feature = "translator")]
+pub use crate::function_cache::{
+    CachedFunction, FunctionCache, FunctionCacheKey, ModuleFunctionCache,
+};
 pub use crate::module::CompileModuleInfo;
 pub use crate::relocation::{Relocation, RelocationKind, RelocationTarget, Relocations};
+#[cfg(feature = "enable-rkyv")]
+pub use crate::section::{ArchivedCustomSection, ArchivedSectionBody};
 pub use crate::section::{CustomSection, CustomSectionProtection, SectionBody, SectionIndex};
 pub use crate::sourceloc::SourceLoc;
 pub use crate::target::{
@@ -84,9 +98,10 @@ pub use crate::target::{
 };
 #[cfg(feature = "translator")]
 pub use crate::translator::{
-    translate_module, wptype_to_type, FunctionBinaryReader, FunctionBodyData, FunctionMiddleware,
-    MiddlewareBinaryReader, MiddlewareReaderState, ModuleEnvironment, ModuleMiddleware,
-    ModuleMiddlewareChain, ModuleTranslationState,
+    translate_module, wptype_to_type, FunctionBinaryReader, FunctionBodies, FunctionBodyData,
+    FunctionBodyStream, FunctionMiddleware, MiddlewareBinaryReader, MiddlewareReaderState,
+    ModuleDeclarations, ModuleEnvironment, ModuleMiddleware, ModuleMiddlewareChain,
+    ModuleStreamParser, ModuleTranslationState, ReceivedModule, StreamedFunctionBody,
 };
 pub use crate::trap::TrapInformation;
 pub use crate::unwind::CompiledFunctionUnwindInfo;
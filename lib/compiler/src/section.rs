@@ -110,3 +110,11 @@ impl SectionBody {
         self.0.is_empty()
     }
 }
+
+#[cfg(feature = "enable-rkyv")]
+impl ArchivedSectionBody {
+    /// Dereferences into the archived section's buffer, in place.
+    pub fn as_slice(&self) -> &[u8] {
+        self.0.as_slice()
+    }
+}
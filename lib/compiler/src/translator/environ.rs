@@ -6,7 +6,7 @@ use crate::lib::std::string::ToString;
 use crate::lib::std::{boxed::Box, string::String, vec::Vec};
 use crate::translate_module;
 use crate::wasmparser::{Operator, Range, Type};
-use crate::{WasmError, WasmResult};
+use crate::WasmResult;
 use std::convert::{TryFrom, TryInto};
 use std::sync::Arc;
 use wasmer_types::entity::PrimaryMap;
@@ -254,11 +254,6 @@ impl<'data> ModuleEnvironment<'data> {
     }
 
     pub(crate) fn declare_memory(&mut self, memory: MemoryType) -> WasmResult<()> {
-        if memory.shared {
-            return Err(WasmError::Unsupported(
-                "shared memories are not supported yet".to_owned(),
-            ));
-        }
         self.module.memories.push(memory);
         Ok(())
     }
@@ -24,6 +24,20 @@ pub trait ModuleMiddleware: Debug + Send + Sync + MemoryUsage {
         local_function_index: LocalFunctionIndex,
     ) -> Box<dyn FunctionMiddleware>;
 
+    /// Generates a `FunctionMiddleware` for a given function of a given module, whose `ModuleInfo`
+    /// has been transformed by `transform_module_info`.
+    ///
+    /// Middlewares that depend on their changes to the `ModuleInfo` override this one rather than
+    /// keeping them in `self`, so that they can be shared by several modules. By default, it calls
+    /// `generate_function_middleware`.
+    fn generate_function_middleware_for_module(
+        &self,
+        _module_info: &ModuleInfo,
+        local_function_index: LocalFunctionIndex,
+    ) -> Box<dyn FunctionMiddleware> {
+        self.generate_function_middleware(local_function_index)
+    }
+
     /// Transforms a `ModuleInfo` struct in-place. This is called before application on functions begins.
     fn transform_module_info(&self, _: &mut ModuleInfo) {}
 }
@@ -69,6 +83,14 @@ pub trait ModuleMiddlewareChain {
         local_function_index: LocalFunctionIndex,
     ) -> Vec<Box<dyn FunctionMiddleware>>;
 
+    /// Generates a function middleware chain for a function of a module, whose `ModuleInfo` has
+    /// been transformed by `apply_on_module_info`.
+    fn generate_function_middleware_chain_for_module(
+        &self,
+        module_info: &ModuleInfo,
+        local_function_index: LocalFunctionIndex,
+    ) -> Vec<Box<dyn FunctionMiddleware>>;
+
     /// Applies the chain on a `ModuleInfo` struct.
     fn apply_on_module_info(&self, module_info: &mut ModuleInfo);
 }
@@ -84,6 +106,17 @@ impl<T: Deref<Target = dyn ModuleMiddleware>> ModuleMiddlewareChain for [T] {
             .collect()
     }
 
+    /// Generates a function middleware chain for a function of a module.
+    fn generate_function_middleware_chain_for_module(
+        &self,
+        module_info: &ModuleInfo,
+        local_function_index: LocalFunctionIndex,
+    ) -> Vec<Box<dyn FunctionMiddleware>> {
+        self.iter()
+            .map(|x| x.generate_function_middleware_for_module(module_info, local_function_index))
+            .collect()
+    }
+
     /// Applies the chain on a `ModuleInfo` struct.
     fn apply_on_module_info(&self, module_info: &mut ModuleInfo) {
         for item in self {
@@ -9,6 +9,7 @@ mod environ;
 mod middleware;
 mod module;
 mod state;
+mod stream;
 #[macro_use]
 mod error;
 mod sections;
@@ -21,3 +22,7 @@ pub use self::middleware::{
 pub use self::module::translate_module;
 pub use self::sections::wptype_to_type;
 pub use self::state::ModuleTranslationState;
+pub use self::stream::{
+    FunctionBodies, FunctionBodyStream, ModuleDeclarations, ModuleStreamParser, ReceivedModule,
+    StreamedFunctionBody,
+};
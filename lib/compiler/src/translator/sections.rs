@@ -111,21 +111,9 @@ pub fn parse_import_section<'data>(
             ImportSectionEntryType::Tag(_) => {
                 unimplemented!("exception handling not implemented yet")
             }
-            ImportSectionEntryType::Memory(WPMemoryType {
-                shared,
-                memory64,
-                initial,
-                maximum,
-            }) => {
-                if memory64 {
-                    unimplemented!("64bit memory not implemented yet");
-                }
+            ImportSectionEntryType::Memory(memory) => {
                 environ.declare_memory_import(
-                    MemoryType {
-                        minimum: Pages(initial as u32),
-                        maximum: maximum.map(|p| Pages(p as u32)),
-                        shared,
-                    },
+                    memory_type(memory)?,
                     module_name,
                     field_name.unwrap_or_default(),
                 )?;
@@ -206,25 +194,35 @@ pub fn parse_memory_section(
     environ.reserve_memories(memories.get_count())?;
 
     for entry in memories {
-        let WPMemoryType {
-            shared,
-            memory64,
-            initial,
-            maximum,
-        } = entry?;
-        if memory64 {
-            unimplemented!("64bit memory not implemented yet");
-        }
-        environ.declare_memory(MemoryType {
-            minimum: Pages(initial as u32),
-            maximum: maximum.map(|p| Pages(p as u32)),
-            shared,
-        })?;
+        environ.declare_memory(memory_type(entry?)?)?;
     }
 
     Ok(())
 }
 
+/// Converts a memory type read by `wasmparser`, whose limits are 64-bit
+/// for memory64.
+fn memory_type(memory: WPMemoryType) -> WasmResult<MemoryType> {
+    let WPMemoryType {
+        shared,
+        memory64,
+        initial,
+        maximum,
+    } = memory;
+    let pages = |count: u64| {
+        u32::try_from(count)
+            .map(Pages)
+            .map_err(|_| wasm_unsupported!("memory with {} pages", count))
+    };
+
+    Ok(MemoryType {
+        minimum: pages(initial)?,
+        maximum: maximum.map(pages).transpose()?,
+        shared,
+        memory64,
+    })
+}
+
 /// Parses the Global section of the wasm module.
 pub fn parse_global_section(
     globals: GlobalSectionReader,
@@ -418,6 +416,13 @@ pub fn parse_data_section<'data>(
                 let mut init_expr_reader = init_expr.get_binary_reader();
                 let (base, offset) = match init_expr_reader.read_operator()? {
                     Operator::I32Const { value } => (None, value as u32 as usize),
+                    // The offset of a 64-bit memory.
+                    Operator::I64Const { value } => (
+                        None,
+                        usize::try_from(value as u64).map_err(|_| {
+                            wasm_unsupported!("data segment at offset {}", value as u64)
+                        })?,
+                    ),
                     Operator::GlobalGet { global_index } => {
                         (Some(GlobalIndex::from_u32(global_index)), 0)
                     }
@@ -0,0 +1,546 @@
+//! Translation of a module whose bytes are received in chunks, e.g.
+//! from the network, so that its functions are compiled while the rest
+//! of the module is still being received.
+//!
+//! Each section is translated once received. The sections that declare
+//! the entities of a module all come before its code section, so once
+//! the code section starts, the compiler can start compiling each
+//! function body as soon as it is received, see
+//! [`Compiler::compile_module_streaming`]. The sections after the code
+//! section, such as the names, complete the module once all of it is
+//! received, see [`ReceivedModule::complete`].
+//!
+//! [`Compiler::compile_module_streaming`]: crate::Compiler::compile_module_streaming
+
+use super::environ::{FunctionBodyData, ModuleEnvironment};
+use super::module::translate_payload;
+use super::state::ModuleTranslationState;
+use crate::compile_pool::{CompilePool, CompileScope};
+use crate::compiler::wasm_features;
+use crate::error::CompileError;
+#[cfg(feature = "compile-pool")]
+use rayon::iter::{IntoParallelIterator, ParallelIterator};
+use std::mem;
+#[cfg(feature = "compile-pool")]
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::mpsc::{channel, Receiver, Sender};
+#[cfg(feature = "compile-pool")]
+use std::sync::Mutex;
+use wasmer_types::entity::PrimaryMap;
+use wasmer_types::{Features, LocalFunctionIndex, ModuleInfo, OwnedDataInitializer};
+use wasmparser::{Chunk, Parser, Payload, ValidPayload, Validator};
+
+/// The body of a function of a module received in chunks.
+pub struct StreamedFunctionBody {
+    index: LocalFunctionIndex,
+    data: Box<[u8]>,
+    module_offset: usize,
+}
+
+impl StreamedFunctionBody {
+    /// The function this is the body of.
+    pub fn index(&self) -> LocalFunctionIndex {
+        self.index
+    }
+
+    /// The body, as given to [`Compiler::compile_module`].
+    ///
+    /// [`Compiler::compile_module`]: crate::Compiler::compile_module
+    pub fn as_function_body_data(&self) -> FunctionBodyData<'_> {
+        FunctionBodyData {
+            data: &self.data,
+            module_offset: self.module_offset,
+        }
+    }
+}
+
+/// The bodies of the functions of a module, in order, as they are
+/// received.
+pub struct FunctionBodyStream {
+    len: usize,
+    receiver: Receiver<StreamedFunctionBody>,
+}
+
+impl FunctionBodyStream {
+    /// Creates a stream of `len` function bodies, along with the sender
+    /// to send them to it.
+    pub fn new(len: usize) -> (Sender<StreamedFunctionBody>, Self) {
+        let (sender, receiver) = channel();
+        (sender, Self { len, receiver })
+    }
+
+    /// The number of function bodies of the module.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Whether the module has no function bodies.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Waits for all the function bodies.
+    ///
+    /// It fails with [`CompileError::Cancelled`] if the sender is dropped
+    /// before all of them are sent.
+    pub fn wait(
+        self,
+    ) -> Result<PrimaryMap<LocalFunctionIndex, StreamedFunctionBody>, CompileError> {
+        let function_bodies = self
+            .receiver
+            .into_iter()
+            .collect::<PrimaryMap<LocalFunctionIndex, _>>();
+        if function_bodies.len() != self.len {
+            return Err(CompileError::Cancelled);
+        }
+        Ok(function_bodies)
+    }
+}
+
+/// The bodies of the functions of a module to compile.
+pub enum FunctionBodies<'data> {
+    /// All the function bodies, received up front.
+    Received(PrimaryMap<LocalFunctionIndex, FunctionBodyData<'data>>),
+    /// The function bodies, as they are received.
+    Streamed(FunctionBodyStream),
+}
+
+impl FunctionBodies<'_> {
+    /// Runs the compilation `op` of these function bodies with `pool`.
+    ///
+    /// The bodies received up front are compiled from a thread of the
+    /// pool, see [`CompilePool::install`]. The streamed ones are waited
+    /// for on the current thread, see [`CompilePool::enter`], so that the
+    /// threads of the pool don't wait for them.
+    pub fn compile_on<R, OP>(self, pool: &CompilePool, op: OP) -> R
+    where
+        OP: FnOnce(&CompileScope, Self) -> R + Send,
+        R: Send,
+    {
+        match self {
+            Self::Received(_) => pool.install(|scope| op(scope, self)),
+            Self::Streamed(_) => pool.enter(|scope| op(scope, self)),
+        }
+    }
+
+    /// The number of function bodies.
+    pub fn len(&self) -> usize {
+        match self {
+            Self::Received(function_bodies) => function_bodies.len(),
+            Self::Streamed(function_bodies) => function_bodies.len(),
+        }
+    }
+
+    /// Whether there are no function bodies.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Compiles each function body with `compile`, as soon as it is
+    /// received, in the order of the functions.
+    ///
+    /// The bodies are compiled in parallel with the `compile-pool`
+    /// feature, and one after the other otherwise. The bodies received up
+    /// front are compiled on the current `rayon` pool, with a state per
+    /// thread created by `init`. The streamed bodies are each spawned on
+    /// the pool of `scope` as soon as it is received, with a state of its
+    /// own, see [`CompileScope::spawn_each`]. Their compilation fails with
+    /// [`CompileError::Cancelled`] if the stream ends before all of them
+    /// are received.
+    pub fn compile_each<T, R, INIT, F>(
+        self,
+        scope: &CompileScope,
+        init: INIT,
+        compile: F,
+    ) -> Result<Vec<R>, CompileError>
+    where
+        INIT: Fn() -> T + Sync + Send,
+        F: Fn(&mut T, LocalFunctionIndex, &FunctionBodyData<'_>) -> Result<R, CompileError>
+            + Sync
+            + Send,
+        R: Send,
+    {
+        let compile = |state: &mut T, index, function_body: &FunctionBodyData<'_>| {
+            let result = compile(state, index, function_body);
+            scope.function_compiled();
+            result
+        };
+        match self {
+            Self::Received(function_bodies) => {
+                let function_bodies = function_bodies.iter().collect::<Vec<_>>();
+                #[cfg(feature = "compile-pool")]
+                let results = function_bodies
+                    .into_par_iter()
+                    .map_init(init, |state, (index, function_body)| {
+                        compile(state, index, function_body)
+                    })
+                    .collect();
+                #[cfg(not(feature = "compile-pool"))]
+                let results = {
+                    let mut state = init();
+                    function_bodies
+                        .into_iter()
+                        .map(|(index, function_body)| compile(&mut state, index, function_body))
+                        .collect()
+                };
+                results
+            }
+            Self::Streamed(function_bodies) => {
+                let len = function_bodies.len;
+                // The bodies are received in order, but compiled in any.
+                #[cfg(feature = "compile-pool")]
+                let compiled = {
+                    let compiled = Mutex::new(Vec::with_capacity(len));
+                    let failed = AtomicBool::new(false);
+                    scope.spawn_each(
+                        function_bodies
+                            .receiver
+                            .into_iter()
+                            .take_while(|_| !failed.load(Ordering::Relaxed)),
+                        |function_body| {
+                            let index = function_body.index;
+                            let result =
+                                compile(&mut init(), index, &function_body.as_function_body_data());
+                            if result.is_err() {
+                                failed.store(true, Ordering::Relaxed);
+                            }
+                            compiled
+                                .lock()
+                                .unwrap()
+                                .push(result.map(|result| (index, result)));
+                        },
+                    );
+                    compiled
+                        .into_inner()
+                        .unwrap()
+                        .into_iter()
+                        .collect::<Result<Vec<_>, CompileError>>()
+                };
+                #[cfg(not(feature = "compile-pool"))]
+                let compiled = {
+                    let mut state = init();
+                    function_bodies
+                        .receiver
+                        .into_iter()
+                        .map(|function_body| {
+                            let index = function_body.index;
+                            compile(&mut state, index, &function_body.as_function_body_data())
+                                .map(|result| (index, result))
+                        })
+                        .collect::<Result<Vec<_>, CompileError>>()
+                };
+                let mut compiled = compiled?;
+                if compiled.len() != len {
+                    return Err(CompileError::Cancelled);
+                }
+                compiled.sort_unstable_by_key(|(index, _)| *index);
+                Ok(compiled.into_iter().map(|(_, result)| result).collect())
+            }
+        }
+    }
+}
+
+/// The declarations of a module received in chunks, translated once its
+/// code section starts.
+pub struct ModuleDeclarations {
+    /// The module, without the function names and the passive data,
+    /// which are declared after the code section.
+    pub module: ModuleInfo,
+    /// The decoded Wasm types of the module.
+    pub module_translation_state: ModuleTranslationState,
+    /// The bodies of the functions of the module, as they are received.
+    pub function_bodies: FunctionBodyStream,
+}
+
+/// A module received in chunks, once all of it is received.
+pub struct ReceivedModule {
+    /// All the bytes of the module.
+    pub data: Vec<u8>,
+    /// The declarations of the module, if its code section started in
+    /// the last chunk, or if it has no code section.
+    pub declarations: Option<ModuleDeclarations>,
+    /// The data initializers of the module.
+    pub data_initializers: Vec<OwnedDataInitializer>,
+    /// The whole module, including the sections after the code section.
+    module: ModuleInfo,
+}
+
+impl ReceivedModule {
+    /// Fills in `module`, translated from the declarations of this
+    /// module, with the names, the custom sections and the passive data
+    /// declared after them.
+    pub fn complete(&mut self, module: &mut ModuleInfo) {
+        module.name = self.module.name.take();
+        module.function_names = mem::take(&mut self.module.function_names);
+        module.custom_sections = mem::take(&mut self.module.custom_sections);
+        module.custom_sections_data = mem::take(&mut self.module.custom_sections_data);
+        module.passive_data = mem::take(&mut self.module.passive_data);
+    }
+}
+
+/// Parses and validates a module whose bytes are received in chunks.
+pub struct ModuleStreamParser {
+    /// The bytes received so far.
+    data: Vec<u8>,
+    /// The number of bytes of `data` parsed so far.
+    parsed: usize,
+    parser: Parser,
+    validator: Validator,
+    translation: SectionTranslation,
+    /// The sender of the function bodies, once the code section started.
+    function_bodies: Option<Sender<StreamedFunctionBody>>,
+    /// The number of function bodies received so far.
+    received_functions: u32,
+}
+
+/// The translation of the sections of a module, each once received.
+struct SectionTranslation {
+    module: ModuleInfo,
+    /// The decoded Wasm types of the module, until its code section
+    /// starts.
+    module_translation_state: ModuleTranslationState,
+    data_initializers: Vec<OwnedDataInitializer>,
+}
+
+impl ModuleStreamParser {
+    /// Creates a parser for a module using the given features.
+    pub fn new(features: &Features) -> Self {
+        let mut validator = Validator::new();
+        validator.wasm_features(wasm_features(features));
+        Self {
+            data: Vec::new(),
+            parsed: 0,
+            parser: Parser::new(0),
+            validator,
+            translation: SectionTranslation {
+                module: ModuleInfo::new(),
+                module_translation_state: ModuleTranslationState::new(),
+                data_initializers: Vec::new(),
+            },
+            function_bodies: None,
+            received_functions: 0,
+        }
+    }
+
+    /// Parses the next chunk of the module.
+    ///
+    /// It returns the declarations of the module once its code section
+    /// starts, after which the bodies of its functions are sent to their
+    /// stream as soon as they are received.
+    pub fn write(&mut self, bytes: &[u8]) -> Result<Option<ModuleDeclarations>, CompileError> {
+        self.data.extend_from_slice(bytes);
+        self.parse(false)
+    }
+
+    /// Parses the end of the module, and returns all of it.
+    pub fn finish(mut self) -> Result<ReceivedModule, CompileError> {
+        let declarations = self.parse(true)?;
+        Ok(ReceivedModule {
+            data: self.data,
+            declarations,
+            data_initializers: self.translation.data_initializers,
+            module: self.translation.module,
+        })
+    }
+
+    fn parse(&mut self, eof: bool) -> Result<Option<ModuleDeclarations>, CompileError> {
+        let mut declarations = None;
+        loop {
+            let (consumed, payload) = match self
+                .parser
+                .parse(&self.data[self.parsed..], eof)
+                .map_err(validate_error)?
+            {
+                Chunk::NeedMoreData(_) => return Ok(declarations),
+                Chunk::Parsed { consumed, payload } => (consumed, payload),
+            };
+            if let ValidPayload::Func(mut validator, body) =
+                self.validator.payload(&payload).map_err(validate_error)?
+            {
+                validator.validate(&body).map_err(validate_error)?;
+            }
+            match payload {
+                Payload::CodeSectionStart { count, .. } => {
+                    let (sender, function_bodies) = FunctionBodyStream::new(count as usize);
+                    self.function_bodies = Some(sender);
+                    declarations = Some(self.translation.declarations(function_bodies));
+                }
+                Payload::CodeSectionEntry(body) => {
+                    let mut reader = body.get_binary_reader();
+                    let size = reader.bytes_remaining();
+                    let module_offset = reader.original_position();
+                    let data = reader.read_bytes(size)?;
+                    let function_body = StreamedFunctionBody {
+                        index: LocalFunctionIndex::from_u32(self.received_functions),
+                        data: data.into(),
+                        module_offset,
+                    };
+                    self.received_functions += 1;
+                    if let Some(sender) = &self.function_bodies {
+                        // The compilation may have stopped already.
+                        let _ = sender.send(function_body);
+                    }
+                }
+                Payload::End => {
+                    self.parsed += consumed;
+                    // A module without functions has no code section.
+                    if self.function_bodies.is_none() {
+                        let (_, function_bodies) = FunctionBodyStream::new(0);
+                        declarations = Some(self.translation.declarations(function_bodies));
+                    }
+                    return Ok(declarations);
+                }
+                payload => self.translation.translate(payload)?,
+            }
+            self.parsed += consumed;
+        }
+    }
+}
+
+impl SectionTranslation {
+    fn translate(&mut self, payload: Payload<'_>) -> Result<(), CompileError> {
+        let mut environ = ModuleEnvironment::new();
+        environ.module = mem::take(&mut self.module);
+        let result = translate_payload(payload, &mut self.module_translation_state, &mut environ);
+        self.module = environ.module;
+        // The data is copied as the rest of the section is dropped.
+        self.data_initializers.extend(
+            environ
+                .data_initializers
+                .iter()
+                .map(OwnedDataInitializer::new),
+        );
+        result.map_err(CompileError::Wasm)
+    }
+
+    /// The declarations translated so far, which are all of them once
+    /// the code section starts.
+    fn declarations(&mut self, function_bodies: FunctionBodyStream) -> ModuleDeclarations {
+        ModuleDeclarations {
+            module: self.module.clone(),
+            module_translation_state: mem::replace(
+                &mut self.module_translation_state,
+                ModuleTranslationState::new(),
+            ),
+            function_bodies,
+        }
+    }
+}
+
+fn validate_error(error: wasmparser::BinaryReaderError) -> CompileError {
+    CompileError::Validate(format!("{}", error))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::compile_pool::CompilePool;
+
+    /// `(module (func (result i32) i32.const 1) (func) (data "x"))`
+    const MODULE: &[u8] = &[
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, // header
+        0x01, 0x08, 0x02, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x00, 0x00, // types
+        0x03, 0x03, 0x02, 0x00, 0x01, // functions
+        0x05, 0x03, 0x01, 0x00, 0x01, // memory
+        0x0a, 0x09, 0x02, 0x04, 0x00, 0x41, 0x01, 0x0b, 0x02, 0x00, 0x0b, // code
+        0x0b, 0x07, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x01, 0x78, // data
+    ];
+
+    #[test]
+    fn streams_the_function_bodies_as_they_are_received() {
+        let mut parser = ModuleStreamParser::new(&Features::default());
+        let mut declarations = None;
+        // The declarations and the first function body, byte by byte.
+        for byte in &MODULE[..36] {
+            if let Some(received) = parser.write(&[*byte]).unwrap() {
+                assert!(declarations.is_none());
+                declarations = Some(received);
+            }
+        }
+        let declarations = declarations.unwrap();
+        assert_eq!(declarations.module.functions.len(), 2);
+        assert_eq!(declarations.module.memories.len(), 1);
+        let function_bodies = declarations.function_bodies;
+        assert_eq!(function_bodies.len(), 2);
+        let first = function_bodies.receiver.try_recv().unwrap();
+        assert_eq!(first.index(), LocalFunctionIndex::from_u32(0));
+        assert_eq!(
+            first.as_function_body_data().data,
+            &[0x00, 0x41, 0x01, 0x0b]
+        );
+        assert_eq!(first.as_function_body_data().module_offset, 32);
+        assert!(function_bodies.receiver.try_recv().is_err());
+
+        assert!(parser.write(&MODULE[36..]).unwrap().is_none());
+        let received = parser.finish().unwrap();
+        assert!(received.declarations.is_none());
+        assert_eq!(received.data, MODULE);
+        assert_eq!(received.data_initializers.len(), 1);
+        assert_eq!(&*received.data_initializers[0].data, b"x");
+        let second = function_bodies.receiver.try_recv().unwrap();
+        assert_eq!(second.index(), LocalFunctionIndex::from_u32(1));
+        assert_eq!(second.as_function_body_data().data, &[0x00, 0x0b]);
+    }
+
+    #[test]
+    fn compiles_the_streamed_function_bodies_in_order() {
+        let (sender, function_bodies) = FunctionBodyStream::new(3);
+        let compiled = std::thread::spawn(move || {
+            CompilePool::default().enter(|scope| {
+                FunctionBodies::Streamed(function_bodies).compile_each(
+                    scope,
+                    || (),
+                    |_, index, function_body| Ok((index, function_body.module_offset)),
+                )
+            })
+        });
+        for index in 0..3 {
+            sender
+                .send(StreamedFunctionBody {
+                    index: LocalFunctionIndex::from_u32(index),
+                    data: Box::new([0x00, 0x0b]),
+                    module_offset: 10 * index as usize,
+                })
+                .unwrap();
+        }
+        drop(sender);
+        assert_eq!(
+            compiled.join().unwrap().unwrap(),
+            vec![
+                (LocalFunctionIndex::from_u32(0), 0),
+                (LocalFunctionIndex::from_u32(1), 10),
+                (LocalFunctionIndex::from_u32(2), 20),
+            ]
+        );
+    }
+
+    #[test]
+    fn validates_the_module_as_it_is_received() {
+        let mut parser = ModuleStreamParser::new(&Features::default());
+        let mut invalid = MODULE[..36].to_vec();
+        // The first function returns an `i64` rather than an `i32`.
+        invalid[33] = 0x42;
+        assert!(parser.write(&invalid[..34]).unwrap().is_some());
+        assert!(matches!(
+            parser.write(&invalid[34..]),
+            Err(CompileError::Validate(_))
+        ));
+    }
+
+    #[test]
+    fn fails_when_the_stream_ends_early() {
+        let (sender, function_bodies) = FunctionBodyStream::new(2);
+        sender
+            .send(StreamedFunctionBody {
+                index: LocalFunctionIndex::from_u32(0),
+                data: Box::new([0x00, 0x0b]),
+                module_offset: 0,
+            })
+            .unwrap();
+        drop(sender);
+        assert!(matches!(
+            function_bodies.wait(),
+            Err(CompileError::Cancelled)
+        ));
+    }
+}
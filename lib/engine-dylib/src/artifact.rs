@@ -902,7 +902,7 @@ impl Artifact for DylibArtifact {
         &self.signatures
     }
 
-    fn func_data_registry(&self) -> &FuncDataRegistry {
+    fn func_data_registry(&self) -> &Arc<FuncDataRegistry> {
         &self.func_data_registry
     }
 
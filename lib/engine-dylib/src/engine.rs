@@ -6,7 +6,7 @@ use loupe::MemoryUsage;
 use std::path::Path;
 use std::sync::Arc;
 use std::sync::Mutex;
-use wasmer_compiler::{CompileError, Target};
+use wasmer_compiler::{CompileError, CompilePool, Target};
 #[cfg(feature = "compiler")]
 use wasmer_compiler::{Compiler, Triple};
 use wasmer_engine::{Artifact, DeserializeError, Engine, EngineId, Tunables};
@@ -24,6 +24,8 @@ pub struct DylibEngine {
     /// The target for the compiler
     target: Arc<Target>,
     engine_id: EngineId,
+    /// The pool of threads the compiler compiles on.
+    compile_pool: Option<CompilePool>,
 }
 
 impl DylibEngine {
@@ -32,6 +34,7 @@ impl DylibEngine {
     pub fn new(compiler: Box<dyn Compiler>, target: Target, features: Features) -> Self {
         let is_cross_compiling = *target.triple() != Triple::host();
         let linker = Linker::find_linker(is_cross_compiling);
+        let compile_pool = compiler.compile_pool().cloned();
 
         Self {
             inner: Arc::new(Mutex::new(DylibEngineInner {
@@ -46,6 +49,7 @@ impl DylibEngine {
             })),
             target: Arc::new(target),
             engine_id: EngineId::default(),
+            compile_pool,
         }
     }
 
@@ -78,6 +82,7 @@ impl DylibEngine {
             })),
             target: Arc::new(Target::default()),
             engine_id: EngineId::default(),
+            compile_pool: None,
         }
     }
 
@@ -179,6 +184,10 @@ impl Engine for DylibEngine {
         &self.engine_id
     }
 
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        self.compile_pool.as_ref()
+    }
+
     fn cloned(&self) -> Arc<dyn Engine + Send + Sync> {
         Arc::new(self.clone())
     }
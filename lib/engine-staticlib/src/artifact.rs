@@ -496,7 +496,7 @@ impl Artifact for StaticlibArtifact {
         &self.signatures
     }
 
-    fn func_data_registry(&self) -> &FuncDataRegistry {
+    fn func_data_registry(&self) -> &Arc<FuncDataRegistry> {
         &self.func_data_registry
     }
     fn preinstantiate(&self) -> Result<(), InstantiationError> {
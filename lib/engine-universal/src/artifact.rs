@@ -1,30 +1,36 @@
 //! Define `UniversalArtifact`, based on `UniversalArtifactBuild`
 //! to allow compiling and instantiating to be done as separate steps.
 
-use crate::engine::{UniversalEngine, UniversalEngineInner};
-use crate::link::link_module;
+use crate::engine::{allocate, UniversalEngine};
+use crate::link::link_module_through;
+use crate::tier_up::{entry_stub, FunctionEntry, TierUpState};
+use crate::{CodeMemory, CustomSectionRef, FunctionBodyRef};
 use enumset::EnumSet;
 use loupe::MemoryUsage;
+use memmap2::Mmap;
+use std::any::Any;
+use std::fs::File;
+use std::path::Path;
 use std::sync::{Arc, Mutex};
 #[cfg(feature = "compiler")]
 use wasmer_compiler::ModuleEnvironment;
 use wasmer_compiler::{CompileError, CpuFeature, Features, Triple};
+#[cfg(feature = "compiler")]
+use wasmer_engine::Tunables;
 use wasmer_engine::{
-    register_frame_info, Artifact, DeserializeError, FunctionExtent, GlobalFrameInfoRegistration,
-    MetadataHeader, SerializeError,
+    register_frame_info, Artifact, DeserializeError, Engine, FunctionExtent,
+    GlobalFrameInfoRegistration, MetadataHeader, SerializeError,
 };
-#[cfg(feature = "compiler")]
-use wasmer_engine::{Engine, Tunables};
 use wasmer_engine_universal_artifact::ArtifactCreate;
 use wasmer_engine_universal_artifact::{SerializableModule, UniversalArtifactBuild};
-use wasmer_types::entity::{BoxedSlice, PrimaryMap};
+use wasmer_types::entity::{BoxedSlice, EntityRef, PrimaryMap};
 use wasmer_types::{
     FunctionIndex, LocalFunctionIndex, MemoryIndex, ModuleInfo, OwnedDataInitializer,
     SignatureIndex, TableIndex,
 };
 use wasmer_vm::{
-    FuncDataRegistry, FunctionBodyPtr, MemoryStyle, TableStyle, VMSharedSignatureIndex,
-    VMTrampoline,
+    FuncDataRegistry, FunctionBodyPtr, MemoryImage, MemoryImages, MemoryStyle, SignatureRegistry,
+    TableStyle, VMSharedSignatureIndex, VMTrampoline,
 };
 
 /// A compiled wasm module, ready to be instantiated.
@@ -32,13 +38,58 @@ use wasmer_vm::{
 pub struct UniversalArtifact {
     artifact: UniversalArtifactBuild,
     finished_functions: BoxedSlice<LocalFunctionIndex, FunctionBodyPtr>,
+    /// The entry stubs of the functions, through which the functions are
+    /// called if they are tiered, see [`crate::tier_up`].
+    #[loupe(skip)]
+    function_entries: Option<BoxedSlice<LocalFunctionIndex, FunctionBodyPtr>>,
     #[loupe(skip)]
     finished_function_call_trampolines: BoxedSlice<SignatureIndex, VMTrampoline>,
     finished_dynamic_function_trampolines: BoxedSlice<FunctionIndex, FunctionBodyPtr>,
-    signatures: BoxedSlice<SignatureIndex, VMSharedSignatureIndex>,
     func_data_registry: Arc<FuncDataRegistry>,
     frame_info_registration: Mutex<Option<GlobalFrameInfoRegistration>>,
     finished_function_lengths: BoxedSlice<LocalFunctionIndex, usize>,
+    /// The memory images, built on the first instantiation.
+    #[loupe(skip)]
+    memory_images: Mutex<Option<Arc<MemoryImages>>>,
+    /// The code above and its signatures, which the instances also hold.
+    code: Arc<LoadedCode>,
+    /// The file this artifact was deserialized from in place, if any,
+    /// which holds its function bodies and custom sections.
+    #[loupe(skip)]
+    serialized: Option<Mmap>,
+}
+
+/// The code of an artifact, and the shared signature indices it checks
+/// indirect calls against. The instances of the artifact hold it, so that
+/// the indices aren't reused for other signatures while a function of the
+/// artifact can still be called.
+#[derive(MemoryUsage)]
+struct LoadedCode {
+    code_memory: CodeMemory,
+    signatures: BoxedSlice<SignatureIndex, VMSharedSignatureIndex>,
+    #[loupe(skip)]
+    signature_registry: Arc<SignatureRegistry>,
+    /// The entries the stubs of a tiered artifact jump through, and the
+    /// optimized code they point into.
+    #[loupe(skip)]
+    tier_up: Option<Arc<TierUpState>>,
+}
+
+impl Drop for LoadedCode {
+    fn drop(&mut self) {
+        for index in self.signatures.values() {
+            self.signature_registry.unregister(*index);
+        }
+    }
+}
+
+/// The code of an artifact, published in its own code memory.
+struct PublishedCode {
+    code_memory: CodeMemory,
+    finished_functions: PrimaryMap<LocalFunctionIndex, FunctionExtent>,
+    function_entries: Option<PrimaryMap<LocalFunctionIndex, FunctionBodyPtr>>,
+    finished_function_call_trampolines: PrimaryMap<SignatureIndex, VMTrampoline>,
+    finished_dynamic_function_trampolines: PrimaryMap<FunctionIndex, FunctionBodyPtr>,
 }
 
 impl UniversalArtifact {
@@ -50,7 +101,6 @@ impl UniversalArtifact {
         tunables: &dyn Tunables,
     ) -> Result<Self, CompileError> {
         let environ = ModuleEnvironment::new();
-        let mut inner_engine = engine.inner_mut();
         let translation = environ.translate(data).map_err(CompileError::Wasm)?;
         let module = translation.module;
         let memory_styles: PrimaryMap<MemoryIndex, MemoryStyle> = module
@@ -64,15 +114,45 @@ impl UniversalArtifact {
             .map(|table_type| tunables.table_style(table_type))
             .collect();
 
+        // Only one module compiles at a time, apart from the streaming
+        // compilations; loading the result doesn't hold the lock.
         let artifact = UniversalArtifactBuild::new(
-            inner_engine.builder_mut(),
+            engine.inner_mut().builder_mut(),
             data,
             engine.target(),
             memory_styles,
             table_styles,
         )?;
 
-        Self::from_parts(&mut inner_engine, artifact)
+        Self::from_compiled(engine, data, artifact)
+    }
+
+    /// Loads an artifact compiled from `data`, whose hot functions the
+    /// optimizing tier of the engine recompiles if it has one.
+    #[cfg(feature = "compiler")]
+    pub(crate) fn from_compiled(
+        engine: &UniversalEngine,
+        data: &[u8],
+        artifact: UniversalArtifactBuild,
+    ) -> Result<Self, CompileError> {
+        let tier_up = match TierUpState::new(engine, data, &artifact) {
+            Some(tier_up) => Arc::new(tier_up),
+            None => return Self::from_parts(engine, artifact),
+        };
+        let artifact = Self::load(engine, artifact, Some(tier_up.entries()), Some(&tier_up))?;
+        tier_up.start(&artifact.finished_functions);
+        Ok(artifact)
+    }
+
+    /// Loads an artifact compiled by the optimizing tier, whose calls go
+    /// through the stubs of `entries`, the entries of the artifact of the
+    /// first tier.
+    pub(crate) fn from_optimized(
+        engine: &UniversalEngine,
+        artifact: UniversalArtifactBuild,
+        entries: &[FunctionEntry],
+    ) -> Result<Self, CompileError> {
+        Self::load(engine, artifact, Some(entries), None)
     }
 
     /// Compile a data buffer into a `UniversalArtifactBuild`, which may then be instantiated.
@@ -102,31 +182,185 @@ impl UniversalArtifact {
         let metadata_slice: &[u8] = &bytes[MetadataHeader::LEN..][..metadata_len];
         let serializable = SerializableModule::deserialize(metadata_slice)?;
         let artifact = UniversalArtifactBuild::from_serializable(serializable);
-        let mut inner_engine = engine.inner_mut();
-        Self::from_parts(&mut inner_engine, artifact).map_err(DeserializeError::Compiler)
+        Self::from_parts(engine, artifact).map_err(DeserializeError::Compiler)
+    }
+
+    /// Deserialize a UniversalArtifactBuild from a file, which is mapped
+    /// in memory and read in place. Only the metadata of the artifact is
+    /// deserialized: the code and the custom sections are copied straight
+    /// from the mapping into executable memory.
+    ///
+    /// # Safety
+    /// This function is unsafe because rkyv reads directly without validating
+    /// the data, and the file must not be modified while it is mapped.
+    pub unsafe fn deserialize_from_file_mmap(
+        engine: &UniversalEngine,
+        path: &Path,
+    ) -> Result<Self, DeserializeError> {
+        let file = File::open(path)?;
+        let mmap = Mmap::map(&file)?;
+        if !UniversalArtifactBuild::is_deserializable(&mmap) {
+            return Err(DeserializeError::Incompatible(
+                "The provided bytes are not wasmer-universal".to_string(),
+            ));
+        }
+        let bytes = &mmap[UniversalArtifactBuild::MAGIC_HEADER.len()..];
+        let metadata_len = MetadataHeader::parse(bytes)?;
+        let metadata_slice: &[u8] = &bytes[MetadataHeader::LEN..][..metadata_len];
+        let archived = SerializableModule::archive_from_slice(metadata_slice)?;
+        let serializable = SerializableModule::deserialize_metadata_from_archive(archived)?;
+        let artifact = UniversalArtifactBuild::from_serializable(serializable);
+
+        let compilation = &archived.compilation;
+        let code = Self::publish_code(
+            engine,
+            &artifact,
+            compilation
+                .function_bodies
+                .values()
+                .map(FunctionBodyRef::from)
+                .collect(),
+            compilation
+                .function_call_trampolines
+                .values()
+                .map(FunctionBodyRef::from)
+                .collect(),
+            compilation
+                .dynamic_function_trampolines
+                .values()
+                .map(FunctionBodyRef::from)
+                .collect(),
+            compilation
+                .custom_sections
+                .values()
+                .map(CustomSectionRef::from)
+                .collect(),
+            None,
+        )
+        .map_err(DeserializeError::Compiler)?;
+
+        Ok(Self::from_published(
+            engine,
+            artifact,
+            code,
+            Some(mmap),
+            None,
+        ))
     }
 
     /// Construct a `UniversalArtifactBuild` from component parts.
+    ///
+    /// The code is allocated, linked and published in a code memory of
+    /// its own, so that several artifacts can be loaded concurrently. It
+    /// is reclaimed once the artifact and all its instances are dropped.
     pub fn from_parts(
-        engine_inner: &mut UniversalEngineInner,
+        engine: &UniversalEngine,
         artifact: UniversalArtifactBuild,
     ) -> Result<Self, CompileError> {
+        Self::load(engine, artifact, None, None)
+    }
+
+    /// Loads `artifact`, whose functions are entered through the stubs of
+    /// `entries` if given, and which holds `tier_up` if it's tiered.
+    fn load(
+        engine: &UniversalEngine,
+        artifact: UniversalArtifactBuild,
+        entries: Option<&[FunctionEntry]>,
+        tier_up: Option<&Arc<TierUpState>>,
+    ) -> Result<Self, CompileError> {
+        let code = Self::publish_code(
+            engine,
+            &artifact,
+            artifact
+                .get_function_bodies_ref()
+                .values()
+                .map(FunctionBodyRef::from)
+                .collect(),
+            artifact
+                .get_function_call_trampolines_ref()
+                .values()
+                .map(FunctionBodyRef::from)
+                .collect(),
+            artifact
+                .get_dynamic_function_trampolines_ref()
+                .values()
+                .map(FunctionBodyRef::from)
+                .collect(),
+            artifact
+                .get_custom_sections_ref()
+                .values()
+                .map(CustomSectionRef::from)
+                .collect(),
+            entries,
+        )?;
+        Ok(Self::from_published(
+            engine,
+            artifact,
+            code,
+            None,
+            tier_up.cloned(),
+        ))
+    }
+
+    /// Copy the code of an artifact into a new code memory, link it and
+    /// make it executable. With `entries`, an entry stub is added for
+    /// each function, and the calls to the functions are linked to it.
+    fn publish_code(
+        engine: &UniversalEngine,
+        artifact: &UniversalArtifactBuild,
+        functions: Vec<FunctionBodyRef>,
+        function_call_trampolines: Vec<FunctionBodyRef>,
+        dynamic_function_trampolines: Vec<FunctionBodyRef>,
+        custom_sections: Vec<CustomSectionRef>,
+        entries: Option<&[FunctionEntry]>,
+    ) -> Result<PublishedCode, CompileError> {
+        let eh_frame_section_size = artifact
+            .get_debug_ref()
+            .as_ref()
+            .map(|debug| custom_sections[debug.eh_frame.index()].bytes.len());
+
+        let architecture = engine.target().triple().architecture;
+        let stubs = entries
+            .unwrap_or_default()
+            .iter()
+            .map(|entry| entry_stub(architecture, entry).expect("the target has entry stubs"))
+            .collect::<Vec<_>>();
+        let functions_len = functions.len();
+        let mut functions: Vec<FunctionBodyRef> = functions;
+        functions.extend(stubs.iter().map(|stub| FunctionBodyRef {
+            body: stub,
+            unwind_info: None,
+        }));
+
+        let mut code_memory = engine.new_code_memory();
         let (
-            finished_functions,
+            allocated_functions,
             finished_function_call_trampolines,
             finished_dynamic_function_trampolines,
             custom_sections,
-        ) = engine_inner.allocate(
-            artifact.module_ref(),
-            artifact.get_function_bodies_ref(),
-            artifact.get_function_call_trampolines_ref(),
-            artifact.get_dynamic_function_trampolines_ref(),
-            artifact.get_custom_sections_ref(),
+        ) = allocate(
+            &mut code_memory,
+            functions,
+            function_call_trampolines,
+            dynamic_function_trampolines,
+            custom_sections,
         )?;
+        let mut allocated_functions = allocated_functions.into_iter().map(|(_, extent)| extent);
+        let finished_functions = allocated_functions
+            .by_ref()
+            .take(functions_len)
+            .collect::<PrimaryMap<LocalFunctionIndex, _>>();
+        let entry_stubs = allocated_functions.collect::<PrimaryMap<LocalFunctionIndex, _>>();
+        let call_targets = if entries.is_some() {
+            &entry_stubs
+        } else {
+            &finished_functions
+        };
 
-        link_module(
+        link_module_through(
             artifact.module_ref(),
             &finished_functions,
+            call_targets,
             artifact.get_function_relocations().clone(),
             &custom_sections,
             artifact.get_custom_section_relocations_ref(),
@@ -134,34 +368,71 @@ impl UniversalArtifact {
             artifact.get_libcall_trampoline_len(),
         );
 
-        // Compute indices into the shared signature table.
-        let signatures = {
-            let signature_registry = engine_inner.signatures();
-            artifact
-                .module()
-                .signatures
-                .values()
-                .map(|sig| signature_registry.register(sig))
-                .collect::<PrimaryMap<_, _>>()
-        };
-
-        let eh_frame = match artifact.get_debug_ref() {
-            Some(debug) => {
-                let eh_frame_section_size = artifact.get_custom_sections_ref()[debug.eh_frame]
-                    .bytes
-                    .len();
+        let eh_frame = match (artifact.get_debug_ref(), eh_frame_section_size) {
+            (Some(debug), Some(eh_frame_section_size)) => {
                 let eh_frame_section_pointer = custom_sections[debug.eh_frame];
                 Some(unsafe {
                     std::slice::from_raw_parts(*eh_frame_section_pointer, eh_frame_section_size)
                 })
             }
-            None => None,
+            _ => None,
         };
 
-        // Make all code compiled thus far executable.
-        engine_inner.publish_compiled_code();
+        // Make the code executable.
+        code_memory.publish();
+
+        // Register DWARF-type exception handling information associated
+        // with the code.
+        code_memory
+            .unwind_registry_mut()
+            .publish(eh_frame)
+            .map_err(|e| {
+                CompileError::Resource(format!("Error while publishing the unwind code: {}", e))
+            })?;
 
-        engine_inner.publish_eh_frame(eh_frame)?;
+        let function_entries = entries.map(|_| {
+            entry_stubs
+                .values()
+                .map(|extent| extent.ptr)
+                .collect::<PrimaryMap<LocalFunctionIndex, _>>()
+        });
+
+        Ok(PublishedCode {
+            code_memory,
+            finished_functions,
+            function_entries,
+            finished_function_call_trampolines,
+            finished_dynamic_function_trampolines,
+        })
+    }
+
+    /// Construct a `UniversalArtifactBuild` from its published code.
+    fn from_published(
+        engine: &UniversalEngine,
+        artifact: UniversalArtifactBuild,
+        code: PublishedCode,
+        serialized: Option<Mmap>,
+        tier_up: Option<Arc<TierUpState>>,
+    ) -> Self {
+        let PublishedCode {
+            code_memory,
+            finished_functions,
+            function_entries,
+            finished_function_call_trampolines,
+            finished_dynamic_function_trampolines,
+        } = code;
+
+        // Compute indices into the shared signature table. This is done
+        // last so that no reference is leaked if the code can't be loaded;
+        // they are released with the code, once the artifact and all its
+        // instances are dropped.
+        let signature_registry = engine.signatures().clone();
+        let signatures = artifact
+            .module()
+            .signatures
+            .values()
+            .map(|sig| signature_registry.register(sig))
+            .collect::<PrimaryMap<_, _>>();
 
         let finished_function_lengths = finished_functions
             .values()
@@ -173,24 +444,39 @@ impl UniversalArtifact {
             .map(|extent| extent.ptr)
             .collect::<PrimaryMap<LocalFunctionIndex, FunctionBodyPtr>>()
             .into_boxed_slice();
+        let function_entries = function_entries.map(PrimaryMap::into_boxed_slice);
         let finished_function_call_trampolines =
             finished_function_call_trampolines.into_boxed_slice();
         let finished_dynamic_function_trampolines =
             finished_dynamic_function_trampolines.into_boxed_slice();
         let signatures = signatures.into_boxed_slice();
-        let func_data_registry = engine_inner.func_data().clone();
+        let func_data_registry = engine.func_data().clone();
 
-        Ok(Self {
+        Self {
             artifact,
             finished_functions,
+            function_entries,
             finished_function_call_trampolines,
             finished_dynamic_function_trampolines,
-            signatures,
             frame_info_registration: Mutex::new(None),
             finished_function_lengths,
             func_data_registry,
-        })
+            memory_images: Mutex::new(None),
+            code: Arc::new(LoadedCode {
+                code_memory,
+                signatures,
+                signature_registry,
+                tier_up,
+            }),
+            serialized,
+        }
+    }
+    /// The code of the functions, which may be called through their entry
+    /// stubs instead, see [`Artifact::finished_functions`].
+    pub(crate) fn function_bodies(&self) -> &BoxedSlice<LocalFunctionIndex, FunctionBodyPtr> {
+        &self.finished_functions
     }
+
     /// Get the default extension when serializing this artifact
     pub fn get_default_extension(triple: &Triple) -> &'static str {
         UniversalArtifactBuild::get_default_extension(triple)
@@ -235,7 +521,10 @@ impl ArtifactCreate for UniversalArtifact {
     }
 
     fn serialize(&self) -> Result<Vec<u8>, SerializeError> {
-        self.artifact.serialize()
+        match &self.serialized {
+            Some(serialized) => Ok(serialized.to_vec()),
+            None => self.artifact.serialize(),
+        }
     }
 }
 
@@ -265,7 +554,10 @@ impl Artifact for UniversalArtifact {
     }
 
     fn finished_functions(&self) -> &BoxedSlice<LocalFunctionIndex, FunctionBodyPtr> {
-        &self.finished_functions
+        // The instances call the functions through their entry stubs.
+        self.function_entries
+            .as_ref()
+            .unwrap_or(&self.finished_functions)
     }
 
     fn finished_function_call_trampolines(&self) -> &BoxedSlice<SignatureIndex, VMTrampoline> {
@@ -277,10 +569,27 @@ impl Artifact for UniversalArtifact {
     }
 
     fn signatures(&self) -> &BoxedSlice<SignatureIndex, VMSharedSignatureIndex> {
-        &self.signatures
+        &self.code.signatures
     }
 
-    fn func_data_registry(&self) -> &FuncDataRegistry {
+    fn func_data_registry(&self) -> &Arc<FuncDataRegistry> {
         &self.func_data_registry
     }
+
+    fn memory_images(&self) -> Option<Arc<MemoryImages>> {
+        let mut memory_images = self.memory_images.lock().unwrap();
+
+        let memory_images = memory_images.get_or_insert_with(|| {
+            Arc::new(MemoryImage::build_all(
+                self.module_ref(),
+                self.data_initializers(),
+            ))
+        });
+
+        Some(memory_images.clone())
+    }
+
+    fn code_handle(&self) -> Option<Arc<dyn Any + Send + Sync>> {
+        Some(self.code.clone())
+    }
 }
@@ -1,5 +1,6 @@
 use crate::UniversalEngine;
 use wasmer_compiler::{CompilerConfig, Features, Target};
+use wasmer_vm::PageBacking;
 
 /// The Universal builder
 pub struct Universal {
@@ -7,6 +8,9 @@ pub struct Universal {
     compiler_config: Option<Box<dyn CompilerConfig>>,
     target: Option<Target>,
     features: Option<Features>,
+    code_page_backing: PageBacking,
+    #[cfg(feature = "compiler")]
+    tier_up: Option<(Box<dyn CompilerConfig>, u64)>,
 }
 
 impl Universal {
@@ -19,6 +23,9 @@ impl Universal {
             compiler_config: Some(compiler_config.into()),
             target: None,
             features: None,
+            code_page_backing: PageBacking::Base,
+            #[cfg(feature = "compiler")]
+            tier_up: None,
         }
     }
 
@@ -28,6 +35,9 @@ impl Universal {
             compiler_config: None,
             target: None,
             features: None,
+            code_page_backing: PageBacking::Base,
+            #[cfg(feature = "compiler")]
+            tier_up: None,
         }
     }
 
@@ -43,24 +53,53 @@ impl Universal {
         self
     }
 
+    /// Set the kind of pages to place the compiled code in, see
+    /// [`UniversalEngine::set_code_page_backing`].
+    pub fn code_page_backing(mut self, backing: PageBacking) -> Self {
+        self.code_page_backing = backing;
+        self
+    }
+
+    /// Recompile the hot functions with `compiler_config` in the
+    /// background once they have been called `calls` times, see
+    /// [`UniversalEngine::with_tier_up`].
+    #[cfg(feature = "compiler")]
+    pub fn tier_up<T>(mut self, compiler_config: T, calls: u64) -> Self
+    where
+        T: Into<Box<dyn CompilerConfig>>,
+    {
+        self.tier_up = Some((compiler_config.into(), calls));
+        self
+    }
+
     /// Build the `UniversalEngine` for this configuration
     #[cfg(feature = "compiler")]
     pub fn engine(self) -> UniversalEngine {
         let target = self.target.unwrap_or_default();
-        if let Some(compiler_config) = self.compiler_config {
+        let engine = if let Some(compiler_config) = self.compiler_config {
             let features = self
                 .features
                 .unwrap_or_else(|| compiler_config.default_features_for_target(&target));
             let compiler = compiler_config.compiler();
-            UniversalEngine::new(compiler, target, features)
+            let engine = UniversalEngine::new(compiler, target, features);
+            match self.tier_up {
+                Some((compiler_config, calls)) => {
+                    engine.with_tier_up(compiler_config.compiler(), calls)
+                }
+                None => engine,
+            }
         } else {
             UniversalEngine::headless()
-        }
+        };
+        engine.set_code_page_backing(self.code_page_backing);
+        engine
     }
 
     /// Build the `UniversalEngine` for this configuration
     #[cfg(not(feature = "compiler"))]
     pub fn engine(self) -> UniversalEngine {
-        UniversalEngine::headless()
+        let engine = UniversalEngine::headless();
+        engine.set_code_page_backing(self.code_page_backing);
+        engine
     }
 }
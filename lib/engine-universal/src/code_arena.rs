@@ -0,0 +1,415 @@
+//! An arena for the executable memory of many small artifacts.
+//!
+//! Giving each artifact a mapping of its own costs an `mmap` and an
+//! `munmap`, plus two mappings in the kernel (the code and the data
+//! have different permissions), even for a module of a few hundred
+//! bytes of code. Loading thousands of small modules then spends its
+//! time in system calls, and can hit the limit on the number of
+//! mappings of the process.
+//!
+//! The arena instead carves the memory of small artifacts out of large
+//! slabs, in slots of a power of two number of pages. The code of a
+//! published artifact is executable and can't be written, so slots are
+//! never smaller than a page: a page can't both run published code and
+//! receive code being loaded. Neighbouring slots with the same
+//! permissions are merged by the kernel into a single mapping.
+//!
+//! A slot is reclaimed as soon as the artifact and all the instances
+//! using its code are dropped: its pages are made writable again and
+//! their content is discarded, so they stop counting as resident.
+
+use loupe::{MemoryUsage, MemoryUsageTracker};
+use std::collections::BTreeMap;
+use std::sync::{Arc, Mutex};
+use wasmer_vm::{Mmap, PageBacking};
+
+/// The number of pages of the slots of the smallest size class.
+const MIN_SLOT_PAGES: usize = 1;
+
+/// The number of pages of the slots of the largest size class. Larger
+/// allocations get a mapping of their own.
+const MAX_SLOT_PAGES: usize = 16;
+
+/// The number of pages of a slab.
+const SLAB_PAGES: usize = 256;
+
+/// A slab of slots of the same size.
+struct Slab {
+    mmap: Mmap,
+    /// The slots that have been released, and can be handed out again.
+    free: Vec<usize>,
+    /// The slots from this one onwards have never been handed out.
+    next: usize,
+    /// The number of slots handed out and not released.
+    live: usize,
+}
+
+impl Slab {
+    fn slots(&self, slot_len: usize) -> usize {
+        self.mmap.len() / slot_len
+    }
+
+    fn take_slot(&mut self, slot_len: usize) -> Option<usize> {
+        let slot = match self.free.pop() {
+            Some(slot) => slot,
+            None if self.next < self.slots(slot_len) => {
+                self.next += 1;
+                self.next - 1
+            }
+            None => return None,
+        };
+        self.live += 1;
+        Some(slot)
+    }
+}
+
+/// The slabs of a size class, by their start address.
+#[derive(Default)]
+struct SizeClass {
+    slabs: BTreeMap<usize, Slab>,
+}
+
+#[derive(Default)]
+struct ArenaState {
+    /// The size classes, the one of slots of `MIN_SLOT_PAGES << i`
+    /// pages at index `i`.
+    classes: Vec<SizeClass>,
+    /// The number of live regions by kind of pages backing them.
+    backings: BTreeMap<PageBacking, usize>,
+    stats: CodeArenaStats,
+}
+
+/// Statistics about a [`CodeArena`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct CodeArenaStats {
+    /// The number of live regions, in slabs or not.
+    pub live_regions: usize,
+    /// The number of regions released so far.
+    pub released_regions: usize,
+    /// The number of slabs currently mapped.
+    pub slabs: usize,
+    /// The bytes of all the slabs currently mapped.
+    pub slab_bytes: usize,
+    /// The bytes of the slots of the slabs that are in use.
+    pub slot_bytes: usize,
+    /// The bytes of the regions too large for a slab, or backed by huge
+    /// pages, which have a mapping of their own.
+    pub dedicated_bytes: usize,
+    /// The bytes of code and data actually requested by the live
+    /// regions, without the padding to pages and slot sizes.
+    pub requested_bytes: usize,
+}
+
+impl CodeArenaStats {
+    /// The bytes of the memory holding live code and data.
+    pub fn resident_bytes(&self) -> usize {
+        self.slot_bytes + self.dedicated_bytes
+    }
+
+    /// The bytes of the live regions that are padding: this is the
+    /// internal fragmentation of the arena.
+    pub fn padding_bytes(&self) -> usize {
+        self.resident_bytes() - self.requested_bytes
+    }
+
+    /// The bytes of the slabs in no slot in use: this is the external
+    /// fragmentation of the arena. Most of it is not resident.
+    pub fn free_slab_bytes(&self) -> usize {
+        self.slab_bytes - self.slot_bytes
+    }
+}
+
+/// An allocator of executable memory shared by the artifacts of an
+/// engine. See the module documentation.
+pub struct CodeArena {
+    state: Mutex<ArenaState>,
+}
+
+impl CodeArena {
+    /// Create a new, empty, `CodeArena`.
+    pub fn new() -> Self {
+        Self {
+            state: Mutex::new(ArenaState {
+                classes: (0..=Self::class_of(MAX_SLOT_PAGES))
+                    .map(|_| SizeClass::default())
+                    .collect(),
+                ..ArenaState::default()
+            }),
+        }
+    }
+
+    fn class_of(pages: usize) -> usize {
+        (pages.max(MIN_SLOT_PAGES) / MIN_SLOT_PAGES)
+            .next_power_of_two()
+            .trailing_zeros() as usize
+    }
+
+    /// Allocate `len` bytes of read-write memory, backed by pages of the
+    /// kind requested by `backing` if possible. `len` must be a multiple
+    /// of the native page size, and `requested` the number of these
+    /// bytes that are actually used, which only matters to statistics.
+    pub fn allocate(
+        self: &Arc<Self>,
+        len: usize,
+        requested: usize,
+        backing: PageBacking,
+    ) -> Result<CodeRegion, String> {
+        let page_size = region::page::size();
+        assert_eq!(len % page_size, 0);
+        let pages = len / page_size;
+
+        let kind = if pages == 0 {
+            RegionKind::Dedicated(Mmap::new())
+        } else if backing != PageBacking::Base || pages > MAX_SLOT_PAGES {
+            let mmap = Mmap::accessible_reserved_with_backing(len, len, backing)?;
+            RegionKind::Dedicated(mmap)
+        } else {
+            self.allocate_slot(pages)?
+        };
+        let code = CodeRegion {
+            arena: self.clone(),
+            kind,
+            requested,
+        };
+
+        let mut state = self.state.lock().unwrap();
+        if code.len() != 0 {
+            *state.backings.entry(code.backing()).or_insert(0) += 1;
+        }
+        state.stats.live_regions += 1;
+        state.stats.requested_bytes += requested;
+        if let RegionKind::Dedicated(mmap) = &code.kind {
+            state.stats.dedicated_bytes += mmap.len();
+        }
+        Ok(code)
+    }
+
+    fn allocate_slot(&self, pages: usize) -> Result<RegionKind, String> {
+        let class = Self::class_of(pages);
+        let slot_len = (MIN_SLOT_PAGES << class) * region::page::size();
+
+        let mut state = self.state.lock().unwrap();
+        let found = state.classes[class]
+            .slabs
+            .iter_mut()
+            .find_map(|(&start, slab)| Some((start, slab.take_slot(slot_len)?)));
+        let (slab, slot) = match found {
+            Some(found) => found,
+            None => {
+                let len = SLAB_PAGES * region::page::size();
+                let mut slab = Slab {
+                    mmap: Mmap::accessible_reserved(len, len)?,
+                    free: Vec::new(),
+                    next: 0,
+                    live: 0,
+                };
+                let start = slab.mmap.as_ptr() as usize;
+                let slot = slab.take_slot(slot_len).unwrap();
+                state.classes[class].slabs.insert(start, slab);
+                state.stats.slabs += 1;
+                state.stats.slab_bytes += len;
+                (start, slot)
+            }
+        };
+        state.stats.slot_bytes += slot_len;
+
+        Ok(RegionKind::Slot {
+            class,
+            slab,
+            start: slab + slot * slot_len,
+            len: slot_len,
+        })
+    }
+
+    fn release(&self, code: &CodeRegion) {
+        let mut guard = self.state.lock().unwrap();
+        let state = &mut *guard;
+        if code.len() != 0 {
+            let backing = code.backing();
+            let live = state.backings.get_mut(&backing).unwrap();
+            *live -= 1;
+            if *live == 0 {
+                state.backings.remove(&backing);
+            }
+        }
+        state.stats.live_regions -= 1;
+        state.stats.released_regions += 1;
+        state.stats.requested_bytes -= code.requested;
+
+        match code.kind {
+            RegionKind::Dedicated(ref mmap) => {
+                state.stats.dedicated_bytes -= mmap.len();
+            }
+            RegionKind::Slot {
+                class,
+                slab: slab_start,
+                start,
+                len,
+            } => {
+                state.stats.slot_bytes -= len;
+                let slabs = &mut state.classes[class].slabs;
+                let slab = slabs.get_mut(&slab_start).unwrap();
+                let offset = start - slab_start;
+                // Make the pages writable for the next artifact, and let
+                // the system reclaim them until then.
+                unsafe {
+                    region::protect(start as *const u8, len, region::Protection::READ_WRITE)
+                        .expect("unable to make code memory writable");
+                    slab.mmap.discard(offset, len);
+                }
+                slab.free.push(offset / len);
+                slab.live -= 1;
+
+                // Unmap the slab once empty, unless it's the last one of
+                // its class, which is kept for the next allocation.
+                if slab.live == 0 && slabs.len() > 1 {
+                    let slab = slabs.remove(&slab_start).unwrap();
+                    state.stats.slabs -= 1;
+                    state.stats.slab_bytes -= slab.mmap.len();
+                }
+            }
+        }
+    }
+
+    /// Returns the least efficient kind of pages backing the live
+    /// regions, or `None` if there is none.
+    pub fn page_backing(&self) -> Option<PageBacking> {
+        self.state.lock().unwrap().backings.keys().next().copied()
+    }
+
+    /// Returns statistics about the memory of this arena.
+    pub fn stats(&self) -> CodeArenaStats {
+        self.state.lock().unwrap().stats
+    }
+}
+
+impl MemoryUsage for CodeArena {
+    fn size_of_val(&self, _: &mut dyn MemoryUsageTracker) -> usize {
+        std::mem::size_of_val(self) + self.stats().slab_bytes
+    }
+}
+
+enum RegionKind {
+    /// A mapping of its own.
+    Dedicated(Mmap),
+    /// A slot of the slab starting at `slab`, in the given size class.
+    Slot {
+        class: usize,
+        slab: usize,
+        start: usize,
+        len: usize,
+    },
+}
+
+/// Read-write memory allocated by a [`CodeArena`], which is given back
+/// to the arena when dropped.
+pub struct CodeRegion {
+    arena: Arc<CodeArena>,
+    kind: RegionKind,
+    requested: usize,
+}
+
+impl CodeRegion {
+    /// Return the memory as a mutable slice of u8.
+    pub fn as_mut_slice(&mut self) -> &mut [u8] {
+        unsafe { std::slice::from_raw_parts_mut(self.as_mut_ptr(), self.len()) }
+    }
+
+    /// Return the memory as a mutable pointer to u8.
+    pub fn as_mut_ptr(&mut self) -> *mut u8 {
+        match &mut self.kind {
+            RegionKind::Dedicated(mmap) => mmap.as_mut_ptr(),
+            RegionKind::Slot { start, .. } => *start as *mut u8,
+        }
+    }
+
+    /// Return the length of the memory.
+    pub fn len(&self) -> usize {
+        match &self.kind {
+            RegionKind::Dedicated(mmap) => mmap.len(),
+            RegionKind::Slot { len, .. } => *len,
+        }
+    }
+
+    /// Return the kind of pages backing the memory.
+    pub fn backing(&self) -> PageBacking {
+        match &self.kind {
+            RegionKind::Dedicated(mmap) => mmap.backing(),
+            RegionKind::Slot { .. } => PageBacking::Base,
+        }
+    }
+}
+
+impl Drop for CodeRegion {
+    fn drop(&mut self) {
+        self.arena.release(self);
+    }
+}
+
+impl MemoryUsage for CodeRegion {
+    fn size_of_val(&self, _: &mut dyn MemoryUsageTracker) -> usize {
+        std::mem::size_of_val(self) + self.len()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn small_regions_share_a_slab() {
+        let arena = Arc::new(CodeArena::new());
+        let page_size = region::page::size();
+
+        let mut a = arena.allocate(page_size, 100, PageBacking::Base).unwrap();
+        let mut b = arena.allocate(page_size, 200, PageBacking::Base).unwrap();
+        assert_eq!(b.as_mut_ptr() as usize - a.as_mut_ptr() as usize, page_size);
+        a.as_mut_slice()[0] = 1;
+        b.as_mut_slice()[page_size - 1] = 1;
+
+        let stats = arena.stats();
+        assert_eq!(stats.live_regions, 2);
+        assert_eq!(stats.slabs, 1);
+        assert_eq!(stats.slot_bytes, 2 * page_size);
+        assert_eq!(stats.requested_bytes, 300);
+        assert_eq!(stats.padding_bytes(), 2 * page_size - 300);
+        assert_eq!(arena.page_backing(), Some(PageBacking::Base));
+    }
+
+    #[test]
+    fn slots_are_reused() {
+        let arena = Arc::new(CodeArena::new());
+        let page_size = region::page::size();
+
+        let mut a = arena.allocate(3 * page_size, 1, PageBacking::Base).unwrap();
+        assert_eq!(a.len(), 4 * page_size);
+        let start = a.as_mut_ptr();
+        a.as_mut_slice()[0] = 1;
+        drop(a);
+
+        let stats = arena.stats();
+        assert_eq!(stats.live_regions, 0);
+        assert_eq!(stats.released_regions, 1);
+        assert_eq!(stats.resident_bytes(), 0);
+        assert_eq!(arena.page_backing(), None);
+
+        let mut b = arena.allocate(4 * page_size, 1, PageBacking::Base).unwrap();
+        assert_eq!(b.as_mut_ptr(), start);
+        #[cfg(target_os = "linux")]
+        assert_eq!(b.as_mut_slice()[0], 0);
+    }
+
+    #[test]
+    fn large_regions_are_dedicated() {
+        let arena = Arc::new(CodeArena::new());
+        let len = (MAX_SLOT_PAGES + 1) * region::page::size();
+
+        let region = arena.allocate(len, len, PageBacking::Base).unwrap();
+        let stats = arena.stats();
+        assert_eq!(stats.slabs, 0);
+        assert_eq!(stats.dedicated_bytes, len);
+
+        drop(region);
+        assert_eq!(arena.stats().dedicated_bytes, 0);
+    }
+}
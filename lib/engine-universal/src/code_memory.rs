@@ -2,10 +2,16 @@
 // Attributions: https://github.com/wasmerio/wasmer/blob/master/ATTRIBUTIONS.md
 
 //! Memory management for executable code.
+use crate::code_arena::{CodeArena, CodeRegion};
 use crate::unwind::UnwindRegistry;
 use loupe::MemoryUsage;
-use wasmer_compiler::{CompiledFunctionUnwindInfo, CustomSection, FunctionBody};
-use wasmer_vm::{Mmap, VMFunctionBody};
+use rkyv::{Deserialize, Infallible};
+use std::sync::Arc;
+use wasmer_compiler::{
+    ArchivedCustomSection, ArchivedFunctionBody, CompiledFunctionUnwindInfo, CustomSection,
+    CustomSectionProtection, FunctionBody,
+};
+use wasmer_vm::{huge_page_size, PageBacking, VMFunctionBody};
 
 /// The optimal alignment for functions.
 ///
@@ -18,24 +24,105 @@ const ARCH_FUNCTION_ALIGNMENT: usize = 16;
 ///
 const DATA_SECTION_ALIGNMENT: usize = 64;
 
+/// A function body to copy into a [`CodeMemory`], borrowed either from a
+/// [`FunctionBody`] or straight from a serialized artifact.
+pub struct FunctionBodyRef<'a> {
+    /// The machine code of the function.
+    pub body: &'a [u8],
+    /// The unwind information of the function.
+    pub unwind_info: Option<CompiledFunctionUnwindInfo>,
+}
+
+impl<'a> From<&'a FunctionBody> for FunctionBodyRef<'a> {
+    fn from(func: &'a FunctionBody) -> Self {
+        Self {
+            body: &func.body,
+            unwind_info: func.unwind_info.clone(),
+        }
+    }
+}
+
+impl<'a> From<&'a ArchivedFunctionBody> for FunctionBodyRef<'a> {
+    fn from(func: &'a ArchivedFunctionBody) -> Self {
+        Self {
+            body: func.body.as_slice(),
+            unwind_info: func.unwind_info.deserialize(&mut Infallible).unwrap(),
+        }
+    }
+}
+
+/// A custom section to copy into a [`CodeMemory`], borrowed either from a
+/// [`CustomSection`] or straight from a serialized artifact.
+pub struct CustomSectionRef<'a> {
+    /// Memory protection that applies to this section.
+    pub protection: CustomSectionProtection,
+    /// The bytes of the section.
+    pub bytes: &'a [u8],
+}
+
+impl<'a> From<&'a CustomSection> for CustomSectionRef<'a> {
+    fn from(section: &'a CustomSection) -> Self {
+        Self {
+            protection: section.protection.clone(),
+            bytes: section.bytes.as_slice(),
+        }
+    }
+}
+
+impl<'a> From<&'a ArchivedCustomSection> for CustomSectionRef<'a> {
+    fn from(section: &'a ArchivedCustomSection) -> Self {
+        Self {
+            protection: section.protection.deserialize(&mut Infallible).unwrap(),
+            bytes: section.bytes.as_slice(),
+        }
+    }
+}
+
 /// Memory manager for executable code.
 #[derive(MemoryUsage)]
 pub struct CodeMemory {
     unwind_registry: UnwindRegistry,
-    mmap: Mmap,
+    region: Option<CodeRegion>,
+    #[loupe(skip)]
+    arena: Arc<CodeArena>,
     start_of_nonexecutable_pages: usize,
+    requested_backing: PageBacking,
 }
 
 impl CodeMemory {
     /// Create a new `CodeMemory` instance.
     pub fn new() -> Self {
+        Self::with_page_backing(PageBacking::Base)
+    }
+
+    /// Create a new `CodeMemory` instance whose code is placed in huge
+    /// pages of the kind requested by `backing`, if the system provides
+    /// them. The code and the data then start on huge page boundaries.
+    pub fn with_page_backing(backing: PageBacking) -> Self {
+        Self::in_arena(Arc::new(CodeArena::new()), backing)
+    }
+
+    /// Create a new `CodeMemory` instance whose memory is allocated from
+    /// `arena`, in pages of the kind requested by `backing`.
+    pub fn in_arena(arena: Arc<CodeArena>, backing: PageBacking) -> Self {
         Self {
             unwind_registry: UnwindRegistry::new(),
-            mmap: Mmap::new(),
+            region: None,
+            arena,
             start_of_nonexecutable_pages: 0,
+            requested_backing: backing,
         }
     }
 
+    /// Returns the kind of pages backing the code, which may be less than
+    /// what was requested, or `None` if no code has been allocated.
+    pub fn page_backing(&self) -> Option<PageBacking> {
+        self.region
+            .as_ref()
+            .filter(|code| code.len() != 0)
+            .map(CodeRegion::backing)
+    }
+
     /// Mutably get the UnwindRegistry.
     pub fn unwind_registry_mut(&mut self) -> &mut UnwindRegistry {
         &mut self.unwind_registry
@@ -44,15 +131,21 @@ impl CodeMemory {
     /// Allocate a single contiguous block of memory for the functions and custom sections, and copy the data in place.
     pub fn allocate(
         &mut self,
-        functions: &[&FunctionBody],
-        executable_sections: &[&CustomSection],
-        data_sections: &[&CustomSection],
+        functions: &[FunctionBodyRef],
+        executable_sections: &[CustomSectionRef],
+        data_sections: &[CustomSectionRef],
     ) -> Result<(Vec<&mut [VMFunctionBody]>, Vec<&mut [u8]>, Vec<&mut [u8]>), String> {
         let mut function_result = vec![];
         let mut data_section_result = vec![];
         let mut executable_section_result = vec![];
 
-        let page_size = region::page::size();
+        // With huge pages, the page permissions can only change on huge
+        // page boundaries.
+        let page_size = if self.requested_backing == PageBacking::Base {
+            region::page::size()
+        } else {
+            huge_page_size()
+        };
 
         // 1. Calculate the total size, that is:
         // - function body size, including all trampolines
@@ -64,29 +157,32 @@ impl CodeMemory {
         // - data section body size
         // -- padding between data sections
 
-        let total_len = round_up(
-            functions.iter().fold(0, |acc, func| {
-                round_up(
-                    acc + Self::function_allocation_size(func),
-                    ARCH_FUNCTION_ALIGNMENT,
-                )
-            }) + executable_sections.iter().fold(0, |acc, exec| {
-                round_up(acc + exec.bytes.len(), ARCH_FUNCTION_ALIGNMENT)
-            }),
-            page_size,
-        ) + data_sections.iter().fold(0, |acc, data| {
+        let code_len = functions.iter().fold(0, |acc, func| {
+            round_up(
+                acc + Self::function_allocation_size(func),
+                ARCH_FUNCTION_ALIGNMENT,
+            )
+        }) + executable_sections.iter().fold(0, |acc, exec| {
+            round_up(acc + exec.bytes.len(), ARCH_FUNCTION_ALIGNMENT)
+        });
+        let data_len = data_sections.iter().fold(0, |acc, data| {
             round_up(acc + data.bytes.len(), DATA_SECTION_ALIGNMENT)
         });
+        let total_len = round_up(round_up(code_len, page_size) + data_len, page_size);
 
         // 2. Allocate the pages. Mark them all read-write.
 
-        self.mmap = Mmap::with_at_least(total_len)?;
+        let code = self.region.insert(self.arena.allocate(
+            total_len,
+            code_len + data_len,
+            self.requested_backing,
+        )?);
 
         // 3. Determine where the pointers to each function, executable section
         // or data section are. Copy the functions. Collect the addresses of each and return them.
 
         let mut bytes = 0;
-        let mut buf = self.mmap.as_mut_slice();
+        let mut buf = code.as_mut_slice();
         for func in functions {
             let len = round_up(
                 Self::function_allocation_size(func),
@@ -101,17 +197,21 @@ impl CodeMemory {
             function_result.push(vmfunc);
         }
         for section in executable_sections {
-            let section = &section.bytes;
+            let section = section.bytes;
             assert_eq!(buf.as_mut_ptr() as usize % ARCH_FUNCTION_ALIGNMENT, 0);
             let len = round_up(section.len(), ARCH_FUNCTION_ALIGNMENT);
             let (s, next_buf) = buf.split_at_mut(len);
             buf = next_buf;
             bytes += len;
-            s[..section.len()].copy_from_slice(section.as_slice());
+            s[..section.len()].copy_from_slice(section);
             executable_section_result.push(s);
         }
 
-        self.start_of_nonexecutable_pages = bytes;
+        self.start_of_nonexecutable_pages = if self.requested_backing == PageBacking::Base {
+            bytes
+        } else {
+            round_up(bytes, page_size)
+        };
 
         if !data_sections.is_empty() {
             // Data sections have different page permissions from the executable
@@ -120,12 +220,12 @@ impl CodeMemory {
             buf = buf.split_at_mut(padding).1;
 
             for section in data_sections {
-                let section = &section.bytes;
+                let section = section.bytes;
                 assert_eq!(buf.as_mut_ptr() as usize % DATA_SECTION_ALIGNMENT, 0);
                 let len = round_up(section.len(), DATA_SECTION_ALIGNMENT);
                 let (s, next_buf) = buf.split_at_mut(len);
                 buf = next_buf;
-                s[..section.len()].copy_from_slice(section.as_slice());
+                s[..section.len()].copy_from_slice(section);
                 data_section_result.push(s);
             }
         }
@@ -139,13 +239,14 @@ impl CodeMemory {
 
     /// Apply the page permissions.
     pub fn publish(&mut self) {
-        if self.mmap.is_empty() || self.start_of_nonexecutable_pages == 0 {
-            return;
-        }
-        assert!(self.mmap.len() >= self.start_of_nonexecutable_pages);
+        let code = match &mut self.region {
+            Some(code) if self.start_of_nonexecutable_pages != 0 => code,
+            _ => return,
+        };
+        assert!(code.len() >= self.start_of_nonexecutable_pages);
         unsafe {
             region::protect(
-                self.mmap.as_mut_ptr(),
+                code.as_mut_ptr(),
                 self.start_of_nonexecutable_pages,
                 region::Protection::READ_EXECUTE,
             )
@@ -154,7 +255,7 @@ impl CodeMemory {
     }
 
     /// Calculates the allocation size of the given compiled function.
-    fn function_allocation_size(func: &FunctionBody) -> usize {
+    fn function_allocation_size(func: &FunctionBodyRef) -> usize {
         match &func.unwind_info {
             Some(CompiledFunctionUnwindInfo::WindowsX64(info)) => {
                 // Windows unwind information is required to be emitted into code memory
@@ -171,7 +272,7 @@ impl CodeMemory {
     /// This will also add the function to the current function table.
     fn copy_function<'a>(
         registry: &mut UnwindRegistry,
-        func: &FunctionBody,
+        func: &FunctionBodyRef,
         buf: &'a mut [u8],
     ) -> &'a mut [VMFunctionBody] {
         assert_eq!(buf.as_ptr() as usize % ARCH_FUNCTION_ALIGNMENT, 0);
@@ -179,7 +280,7 @@ impl CodeMemory {
         let func_len = func.body.len();
 
         let (body, remainder) = buf.split_at_mut(func_len);
-        body.copy_from_slice(&func.body);
+        body.copy_from_slice(func.body);
         let vmfunc = Self::view_as_mut_vmfunc_slice(body);
 
         if let Some(CompiledFunctionUnwindInfo::WindowsX64(info)) = &func.unwind_info {
@@ -1,47 +1,111 @@
 //! Universal compilation.
 
-use crate::CodeMemory;
+use crate::code_arena::{CodeArena, CodeArenaStats};
+#[cfg(feature = "compiler")]
+use crate::stream::UniversalArtifactStream;
+use crate::tier_up::TierUp;
 use crate::UniversalArtifact;
+use crate::{CodeMemory, CustomSectionRef, FunctionBodyRef};
 use loupe::MemoryUsage;
+use std::path::Path;
 use std::sync::{Arc, Mutex};
 #[cfg(feature = "compiler")]
 use wasmer_compiler::Compiler;
-use wasmer_compiler::{
-    CompileError, CustomSection, CustomSectionProtection, FunctionBody, SectionIndex, Target,
+use wasmer_compiler::{CompileError, CompilePool, CustomSectionProtection, SectionIndex, Target};
+use wasmer_engine::{
+    Artifact, ArtifactStream, DeserializeError, Engine, EngineId, FunctionExtent, Tunables,
 };
-use wasmer_engine::{Artifact, DeserializeError, Engine, EngineId, FunctionExtent, Tunables};
 use wasmer_engine_universal_artifact::UniversalEngineBuilder;
 use wasmer_types::entity::PrimaryMap;
-use wasmer_types::{
-    Features, FunctionIndex, FunctionType, LocalFunctionIndex, ModuleInfo, SignatureIndex,
-};
+use wasmer_types::{Features, FunctionIndex, FunctionType, LocalFunctionIndex, SignatureIndex};
 use wasmer_vm::{
-    FuncDataRegistry, FunctionBodyPtr, SectionBodyPtr, SignatureRegistry, VMCallerCheckedAnyfunc,
-    VMFuncRef, VMFunctionBody, VMSharedSignatureIndex, VMTrampoline,
+    FuncDataRegistry, FuncDataRegistryStats, FunctionBodyPtr, PageBacking, SectionBodyPtr,
+    SignatureRegistry, VMCallerCheckedAnyfunc, VMFuncRef, VMFunctionBody, VMSharedSignatureIndex,
+    VMTrampoline,
 };
 
 /// A WebAssembly `Universal` Engine.
+///
+/// Only compiling takes the lock of the inner engine, except for the
+/// streaming compilations, which share the compiler rather than hold
+/// the lock while waiting for their bytes. The state that loading an artifact updates
+/// has finer-grained locks of its own, so that artifacts can be
+/// deserialized, linked and published concurrently.
 #[derive(Clone, MemoryUsage)]
 pub struct UniversalEngine {
     inner: Arc<Mutex<UniversalEngineInner>>,
+    /// The arena the code memory of every artifact loaded by this engine
+    /// is allocated from. Each artifact allocates and publishes its own
+    /// code memory, which is given back once the artifact and all its
+    /// instances are dropped.
+    #[loupe(skip)]
+    code_arena: Arc<CodeArena>,
+    /// The kind of pages requested for the code memory.
+    code_page_backing: Arc<Mutex<PageBacking>>,
+    /// The signature registry is used mainly to operate with trampolines
+    /// performantly.
+    signatures: Arc<SignatureRegistry>,
+    /// The backing storage of `VMFuncRef`s. This centralized store ensures that 2
+    /// functions with the same `VMCallerCheckedAnyfunc` will have the same `VMFuncRef`.
+    /// It also guarantees that the `VMFuncRef`s stay valid until the instance
+    /// they refer to is freed.
+    func_data: Arc<FuncDataRegistry>,
     /// The target for the compiler
     target: Arc<Target>,
     engine_id: EngineId,
+    /// The pool of threads the compiler compiles on.
+    compile_pool: Option<CompilePool>,
+    /// The optimizing tier the modules compiled by this engine are
+    /// recompiled by once hot, if any.
+    #[loupe(skip)]
+    tier_up: Option<Arc<TierUp>>,
 }
 
 impl UniversalEngine {
     /// Create a new `UniversalEngine` with the given config
     #[cfg(feature = "compiler")]
     pub fn new(compiler: Box<dyn Compiler>, target: Target, features: Features) -> Self {
+        let compile_pool = compiler.compile_pool().cloned();
         Self {
             inner: Arc::new(Mutex::new(UniversalEngineInner {
                 builder: UniversalEngineBuilder::new(Some(compiler), features),
-                code_memory: vec![],
-                signatures: SignatureRegistry::new(),
-                func_data: Arc::new(FuncDataRegistry::new()),
             })),
+            code_arena: Arc::new(CodeArena::new()),
+            code_page_backing: Arc::new(Mutex::new(PageBacking::Base)),
+            signatures: Arc::new(SignatureRegistry::new()),
+            func_data: Arc::new(FuncDataRegistry::new()),
             target: Arc::new(target),
             engine_id: EngineId::default(),
+            compile_pool,
+            tier_up: None,
+        }
+    }
+
+    /// Recompiles the hot functions of the modules compiled by this
+    /// engine with `compiler` on a background thread, once they have been
+    /// called `calls` times, and swaps them in: the instances, including
+    /// the existing ones, run the code of `compiler` from the next call
+    /// of a recompiled function on.
+    ///
+    /// This is meant to pair a compiler that compiles fast with one that
+    /// generates fast code, e.g. Singlepass with Cranelift or LLVM. The
+    /// calls to the functions of a tiered module go through a stub that
+    /// counts them, and jumps to the code of the current tier of the
+    /// function. Only the modules compiled for x86-64 and AArch64 are
+    /// tiered.
+    #[cfg(feature = "compiler")]
+    pub fn with_tier_up(mut self, compiler: Box<dyn Compiler>, calls: u64) -> Self {
+        let features = self.inner().features().clone();
+        self.tier_up = Some(Arc::new(TierUp::new(compiler, features, calls)));
+        self
+    }
+
+    /// Blocks until the functions that are hot by now have been
+    /// recompiled and swapped in by the optimizing tier, or have failed
+    /// to. It returns immediately without an optimizing tier.
+    pub fn wait_for_tier_up(&self) {
+        if let Some(tier_up) = &self.tier_up {
+            tier_up.wait();
         }
     }
 
@@ -62,12 +126,15 @@ impl UniversalEngine {
         Self {
             inner: Arc::new(Mutex::new(UniversalEngineInner {
                 builder: UniversalEngineBuilder::new(None, Features::default()),
-                code_memory: vec![],
-                signatures: SignatureRegistry::new(),
-                func_data: Arc::new(FuncDataRegistry::new()),
             })),
+            code_arena: Arc::new(CodeArena::new()),
+            code_page_backing: Arc::new(Mutex::new(PageBacking::Base)),
+            signatures: Arc::new(SignatureRegistry::new()),
+            func_data: Arc::new(FuncDataRegistry::new()),
             target: Arc::new(Target::default()),
             engine_id: EngineId::default(),
+            compile_pool: None,
+            tier_up: None,
         }
     }
 
@@ -78,6 +145,55 @@ impl UniversalEngine {
     pub(crate) fn inner_mut(&self) -> std::sync::MutexGuard<'_, UniversalEngineInner> {
         self.inner.lock().unwrap()
     }
+
+    /// The optimizing tier of this engine, if any.
+    pub(crate) fn tier_up(&self) -> Option<&Arc<TierUp>> {
+        self.tier_up.as_ref()
+    }
+
+    /// Sets the kind of pages to place the code compiled or deserialized
+    /// from now on in. With huge pages, the code of each module starts on
+    /// a huge page boundary, which trades memory for fewer iTLB misses.
+    pub fn set_code_page_backing(&self, backing: PageBacking) {
+        *self.code_page_backing.lock().unwrap() = backing;
+    }
+
+    /// Returns the least efficient kind of pages obtained for the code
+    /// currently loaded, or `None` if no code is loaded.
+    pub fn code_page_backing(&self) -> Option<PageBacking> {
+        self.code_arena.page_backing()
+    }
+
+    /// Returns statistics about the memory holding the code loaded by
+    /// this engine, such as how much of it is resident and padding.
+    pub fn code_stats(&self) -> CodeArenaStats {
+        self.code_arena.stats()
+    }
+
+    /// Creates an empty code memory for an artifact, backed by the kind
+    /// of pages currently requested.
+    pub(crate) fn new_code_memory(&self) -> CodeMemory {
+        CodeMemory::in_arena(
+            self.code_arena.clone(),
+            *self.code_page_backing.lock().unwrap(),
+        )
+    }
+
+    /// Shared signature registry.
+    pub fn signatures(&self) -> &Arc<SignatureRegistry> {
+        &self.signatures
+    }
+
+    /// Shared func metadata registry.
+    pub(crate) fn func_data(&self) -> &Arc<FuncDataRegistry> {
+        &self.func_data
+    }
+
+    /// Returns statistics about the registry of the `VMFuncRef`s handed
+    /// out by this engine.
+    pub fn func_data_stats(&self) -> FuncDataRegistryStats {
+        self.func_data.stats()
+    }
 }
 
 impl Engine for UniversalEngine {
@@ -88,19 +204,16 @@ impl Engine for UniversalEngine {
 
     /// Register a signature
     fn register_signature(&self, func_type: &FunctionType) -> VMSharedSignatureIndex {
-        let compiler = self.inner();
-        compiler.signatures().register(func_type)
+        self.signatures.register(func_type)
     }
 
     fn register_function_metadata(&self, func_data: VMCallerCheckedAnyfunc) -> VMFuncRef {
-        let compiler = self.inner();
-        compiler.func_data().register(func_data)
+        self.func_data.register(func_data)
     }
 
     /// Lookup a signature
     fn lookup_signature(&self, sig: VMSharedSignatureIndex) -> Option<FunctionType> {
-        let compiler = self.inner();
-        compiler.signatures().lookup(sig)
+        self.signatures.lookup(sig)
     }
 
     /// Validates a WebAssembly module
@@ -131,15 +244,38 @@ impl Engine for UniversalEngine {
         ))
     }
 
+    /// Compile a WebAssembly binary as its bytes are received
+    #[cfg(feature = "compiler")]
+    fn compile_streaming(
+        &self,
+        tunables: Arc<dyn Tunables + Send + Sync>,
+    ) -> Result<Box<dyn ArtifactStream>, CompileError> {
+        Ok(Box::new(UniversalArtifactStream::new(self, tunables)?))
+    }
+
     /// Deserializes a WebAssembly module
     unsafe fn deserialize(&self, bytes: &[u8]) -> Result<Arc<dyn Artifact>, DeserializeError> {
         Ok(Arc::new(UniversalArtifact::deserialize(&self, &bytes)?))
     }
 
+    /// Deserializes a WebAssembly module from a file, in place
+    unsafe fn deserialize_from_file_mmap(
+        &self,
+        file_ref: &Path,
+    ) -> Result<Arc<dyn Artifact>, DeserializeError> {
+        Ok(Arc::new(UniversalArtifact::deserialize_from_file_mmap(
+            &self, file_ref,
+        )?))
+    }
+
     fn id(&self) -> &EngineId {
         &self.engine_id
     }
 
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        self.compile_pool.as_ref()
+    }
+
     fn cloned(&self) -> Arc<dyn Engine + Send + Sync> {
         Arc::new(self.clone())
     }
@@ -150,16 +286,6 @@ impl Engine for UniversalEngine {
 pub struct UniversalEngineInner {
     /// The builder (include compiler and cpu features)
     builder: UniversalEngineBuilder,
-    /// The code memory is responsible of publishing the compiled
-    /// functions to memory.
-    code_memory: Vec<CodeMemory>,
-    /// The signature registry is used mainly to operate with trampolines
-    /// performantly.
-    signatures: SignatureRegistry,
-    /// The backing storage of `VMFuncRef`s. This centralized store ensures that 2
-    /// functions with the same `VMCallerCheckedAnyfunc` will have the same `VMFuncRef`.
-    /// It also guarantees that the `VMFuncRef`s stay valid until the engine is dropped.
-    func_data: Arc<FuncDataRegistry>,
 }
 
 impl UniversalEngineInner {
@@ -168,6 +294,13 @@ impl UniversalEngineInner {
         self.builder.compiler()
     }
 
+    /// Gets the compiler associated to this engine, to compile with it
+    /// without holding the lock of the engine.
+    #[cfg(feature = "compiler")]
+    pub fn shared_compiler(&self) -> Result<Arc<dyn Compiler>, CompileError> {
+        self.builder.shared_compiler()
+    }
+
     /// Validate the module
     pub fn validate<'data>(&self, data: &'data [u8]) -> Result<(), CompileError> {
         self.builder.validate(data)
@@ -181,125 +314,97 @@ impl UniversalEngineInner {
     pub fn builder_mut(&mut self) -> &mut UniversalEngineBuilder {
         &mut self.builder
     }
+}
 
-    /// Allocate compiled functions into memory
-    #[allow(clippy::type_complexity)]
-    pub(crate) fn allocate(
-        &mut self,
-        _module: &ModuleInfo,
-        functions: &PrimaryMap<LocalFunctionIndex, FunctionBody>,
-        function_call_trampolines: &PrimaryMap<SignatureIndex, FunctionBody>,
-        dynamic_function_trampolines: &PrimaryMap<FunctionIndex, FunctionBody>,
-        custom_sections: &PrimaryMap<SectionIndex, CustomSection>,
-    ) -> Result<
-        (
-            PrimaryMap<LocalFunctionIndex, FunctionExtent>,
-            PrimaryMap<SignatureIndex, VMTrampoline>,
-            PrimaryMap<FunctionIndex, FunctionBodyPtr>,
-            PrimaryMap<SectionIndex, SectionBodyPtr>,
-        ),
-        CompileError,
-    > {
-        let function_bodies = functions
-            .values()
-            .chain(function_call_trampolines.values())
-            .chain(dynamic_function_trampolines.values())
-            .collect::<Vec<_>>();
-        let (executable_sections, data_sections): (Vec<_>, _) = custom_sections
-            .values()
-            .partition(|section| section.protection == CustomSectionProtection::ReadExecute);
-        self.code_memory.push(CodeMemory::new());
-
-        let (mut allocated_functions, allocated_executable_sections, allocated_data_sections) =
-            self.code_memory
-                .last_mut()
-                .unwrap()
-                .allocate(
-                    function_bodies.as_slice(),
-                    executable_sections.as_slice(),
-                    data_sections.as_slice(),
-                )
-                .map_err(|message| {
-                    CompileError::Resource(format!(
-                        "failed to allocate memory for functions: {}",
-                        message
-                    ))
-                })?;
-
-        let allocated_functions_result = allocated_functions
-            .drain(0..functions.len())
-            .map(|slice| FunctionExtent {
-                ptr: FunctionBodyPtr(slice.as_ptr()),
-                length: slice.len(),
-            })
-            .collect::<PrimaryMap<LocalFunctionIndex, _>>();
-
-        let mut allocated_function_call_trampolines: PrimaryMap<SignatureIndex, VMTrampoline> =
-            PrimaryMap::new();
-        for ptr in allocated_functions
-            .drain(0..function_call_trampolines.len())
-            .map(|slice| slice.as_ptr())
-        {
-            let trampoline =
-                unsafe { std::mem::transmute::<*const VMFunctionBody, VMTrampoline>(ptr) };
-            allocated_function_call_trampolines.push(trampoline);
-        }
-
-        let allocated_dynamic_function_trampolines = allocated_functions
-            .drain(..)
-            .map(|slice| FunctionBodyPtr(slice.as_ptr()))
-            .collect::<PrimaryMap<FunctionIndex, _>>();
-
-        let mut exec_iter = allocated_executable_sections.iter();
-        let mut data_iter = allocated_data_sections.iter();
-        let allocated_custom_sections = custom_sections
-            .iter()
-            .map(|(_, section)| {
-                SectionBodyPtr(
-                    if section.protection == CustomSectionProtection::ReadExecute {
-                        exec_iter.next()
-                    } else {
-                        data_iter.next()
-                    }
-                    .unwrap()
-                    .as_ptr(),
-                )
-            })
-            .collect::<PrimaryMap<SectionIndex, _>>();
-
-        Ok((
-            allocated_functions_result,
-            allocated_function_call_trampolines,
-            allocated_dynamic_function_trampolines,
-            allocated_custom_sections,
-        ))
-    }
-
-    /// Make memory containing compiled code executable.
-    pub(crate) fn publish_compiled_code(&mut self) {
-        self.code_memory.last_mut().unwrap().publish();
-    }
-
-    /// Register DWARF-type exception handling information associated with the code.
-    pub(crate) fn publish_eh_frame(&mut self, eh_frame: Option<&[u8]>) -> Result<(), CompileError> {
-        self.code_memory
-            .last_mut()
-            .unwrap()
-            .unwind_registry_mut()
-            .publish(eh_frame)
-            .map_err(|e| {
-                CompileError::Resource(format!("Error while publishing the unwind code: {}", e))
+/// Allocate compiled functions into the code memory of an artifact
+#[allow(clippy::type_complexity)]
+pub(crate) fn allocate(
+    code_memory: &mut CodeMemory,
+    functions: Vec<FunctionBodyRef>,
+    function_call_trampolines: Vec<FunctionBodyRef>,
+    dynamic_function_trampolines: Vec<FunctionBodyRef>,
+    custom_sections: Vec<CustomSectionRef>,
+) -> Result<
+    (
+        PrimaryMap<LocalFunctionIndex, FunctionExtent>,
+        PrimaryMap<SignatureIndex, VMTrampoline>,
+        PrimaryMap<FunctionIndex, FunctionBodyPtr>,
+        PrimaryMap<SectionIndex, SectionBodyPtr>,
+    ),
+    CompileError,
+> {
+    let functions_len = functions.len();
+    let function_call_trampolines_len = function_call_trampolines.len();
+    let function_bodies = functions
+        .into_iter()
+        .chain(function_call_trampolines)
+        .chain(dynamic_function_trampolines)
+        .collect::<Vec<_>>();
+    let executable = custom_sections
+        .iter()
+        .map(|section| section.protection == CustomSectionProtection::ReadExecute)
+        .collect::<Vec<_>>();
+    let (executable_sections, data_sections): (Vec<_>, _) = custom_sections
+        .into_iter()
+        .partition(|section| section.protection == CustomSectionProtection::ReadExecute);
+    let (mut allocated_functions, allocated_executable_sections, allocated_data_sections) =
+        code_memory
+            .allocate(
+                function_bodies.as_slice(),
+                executable_sections.as_slice(),
+                data_sections.as_slice(),
+            )
+            .map_err(|message| {
+                CompileError::Resource(format!(
+                    "failed to allocate memory for functions: {}",
+                    message
+                ))
             })?;
-        Ok(())
-    }
 
-    /// Shared signature registry.
-    pub fn signatures(&self) -> &SignatureRegistry {
-        &self.signatures
+    let allocated_functions_result = allocated_functions
+        .drain(0..functions_len)
+        .map(|slice| FunctionExtent {
+            ptr: FunctionBodyPtr(slice.as_ptr()),
+            length: slice.len(),
+        })
+        .collect::<PrimaryMap<LocalFunctionIndex, _>>();
+
+    let mut allocated_function_call_trampolines: PrimaryMap<SignatureIndex, VMTrampoline> =
+        PrimaryMap::new();
+    for ptr in allocated_functions
+        .drain(0..function_call_trampolines_len)
+        .map(|slice| slice.as_ptr())
+    {
+        let trampoline = unsafe { std::mem::transmute::<*const VMFunctionBody, VMTrampoline>(ptr) };
+        allocated_function_call_trampolines.push(trampoline);
     }
 
-    /// Shared func metadata registry.
-    pub(crate) fn func_data(&self) -> &Arc<FuncDataRegistry> {
-        &self.func_data
-    }
+    let allocated_dynamic_function_trampolines = allocated_functions
+        .drain(..)
+        .map(|slice| FunctionBodyPtr(slice.as_ptr()))
+        .collect::<PrimaryMap<FunctionIndex, _>>();
+
+    let mut exec_iter = allocated_executable_sections.iter();
+    let mut data_iter = allocated_data_sections.iter();
+    let allocated_custom_sections = executable
+        .into_iter()
+        .map(|executable| {
+            SectionBodyPtr(
+                if executable {
+                    exec_iter.next()
+                } else {
+                    data_iter.next()
+                }
+                .unwrap()
+                .as_ptr(),
+            )
+        })
+        .collect::<PrimaryMap<SectionIndex, _>>();
+
+    Ok((
+        allocated_functions_result,
+        allocated_function_call_trampolines,
+        allocated_dynamic_function_trampolines,
+        allocated_custom_sections,
+    ))
 }
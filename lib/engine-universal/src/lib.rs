@@ -25,14 +25,19 @@
 
 mod artifact;
 mod builder;
+mod code_arena;
 mod code_memory;
 mod engine;
 mod link;
+#[cfg(feature = "compiler")]
+mod stream;
+mod tier_up;
 mod unwind;
 
 pub use crate::artifact::UniversalArtifact;
 pub use crate::builder::Universal;
-pub use crate::code_memory::CodeMemory;
+pub use crate::code_arena::{CodeArena, CodeArenaStats, CodeRegion};
+pub use crate::code_memory::{CodeMemory, CustomSectionRef, FunctionBodyRef};
 pub use crate::engine::UniversalEngine;
 pub use crate::link::link_module;
 
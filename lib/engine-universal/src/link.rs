@@ -12,13 +12,13 @@ use wasmer_vm::SectionBodyPtr;
 fn apply_relocation(
     body: usize,
     r: &Relocation,
-    allocated_functions: &PrimaryMap<LocalFunctionIndex, FunctionExtent>,
+    call_targets: &PrimaryMap<LocalFunctionIndex, FunctionExtent>,
     allocated_sections: &PrimaryMap<SectionIndex, SectionBodyPtr>,
     libcall_trampolines: SectionIndex,
     libcall_trampoline_len: usize,
 ) {
     let target_func_address: usize = match r.reloc_target {
-        RelocationTarget::LocalFunc(index) => *allocated_functions[index].ptr as usize,
+        RelocationTarget::LocalFunc(index) => *call_targets[index].ptr as usize,
         RelocationTarget::LibCall(libcall) => {
             // Use the direct target of the libcall if the relocation supports
             // a full 64-bit address. Otherwise use a trampoline.
@@ -79,8 +79,34 @@ fn apply_relocation(
 /// Links a module, patching the allocated functions with the
 /// required relocations and jump tables.
 pub fn link_module(
+    module: &ModuleInfo,
+    allocated_functions: &PrimaryMap<LocalFunctionIndex, FunctionExtent>,
+    function_relocations: Relocations,
+    allocated_sections: &PrimaryMap<SectionIndex, SectionBodyPtr>,
+    section_relocations: &PrimaryMap<SectionIndex, Vec<Relocation>>,
+    libcall_trampolines: SectionIndex,
+    trampoline_len: usize,
+) {
+    link_module_through(
+        module,
+        allocated_functions,
+        allocated_functions,
+        function_relocations,
+        allocated_sections,
+        section_relocations,
+        libcall_trampolines,
+        trampoline_len,
+    )
+}
+
+/// Links a module like [`link_module`], except that the calls of the
+/// functions to the local functions are linked to `call_targets`, e.g.
+/// their entry stubs when they are tiered.
+#[allow(clippy::too_many_arguments)]
+pub(crate) fn link_module_through(
     _module: &ModuleInfo,
     allocated_functions: &PrimaryMap<LocalFunctionIndex, FunctionExtent>,
+    call_targets: &PrimaryMap<LocalFunctionIndex, FunctionExtent>,
     function_relocations: Relocations,
     allocated_sections: &PrimaryMap<SectionIndex, SectionBodyPtr>,
     section_relocations: &PrimaryMap<SectionIndex, Vec<Relocation>>,
@@ -90,6 +116,8 @@ pub fn link_module(
     for (i, section_relocs) in section_relocations.iter() {
         let body = *allocated_sections[i] as usize;
         for r in section_relocs {
+            // The sections, e.g. the unwind information, refer to the
+            // code of the functions rather than to the calls to them.
             apply_relocation(
                 body,
                 r,
@@ -106,7 +134,7 @@ pub fn link_module(
             apply_relocation(
                 body,
                 r,
-                allocated_functions,
+                call_targets,
                 allocated_sections,
                 libcall_trampolines,
                 trampoline_len,
@@ -0,0 +1,198 @@
+//! Streaming compilation.
+//!
+//! The declarations of a module are parsed as its bytes are received,
+//! and once its code section starts, the bodies of its functions are
+//! compiled on the compile pool of the engine as soon as each of them
+//! is received, so that compiling the module overlaps receiving it.
+
+use crate::{UniversalArtifact, UniversalEngine};
+use std::panic;
+use std::sync::Arc;
+use std::thread::{self, JoinHandle};
+use wasmer_compiler::{
+    Compilation, CompileError, CompileModuleInfo, CompileMonitor, Compiler, ModuleDeclarations,
+    ModuleMiddlewareChain, ModuleStreamParser,
+};
+use wasmer_engine::{Artifact, ArtifactStream, Engine, Tunables};
+use wasmer_engine_universal_artifact::UniversalArtifactBuild;
+use wasmer_types::entity::PrimaryMap;
+use wasmer_types::{Features, MemoryIndex, ModuleInfo, TableIndex};
+use wasmer_vm::{MemoryStyle, TableStyle};
+
+/// A module being compiled by a [`UniversalEngine`] while its bytes are
+/// received.
+///
+/// The compiler and the features of the engine are taken once, so that
+/// the engine isn't locked while waiting for the bytes: it compiles the
+/// other modules meanwhile, including from the thread writing them.
+pub(crate) struct UniversalArtifactStream {
+    engine: UniversalEngine,
+    tunables: Arc<dyn Tunables + Send + Sync>,
+    compiler: Arc<dyn Compiler>,
+    features: Features,
+    /// The parser, until the stream fails. Dropping it ends the stream of
+    /// function bodies, so it is dropped before the compilation.
+    parser: Option<ModuleStreamParser>,
+    /// The compilation of the functions, once the code section started.
+    compilation: Option<StreamingCompilation>,
+}
+
+/// The compilation of the functions of a module on a thread of its own,
+/// which waits for their bodies.
+struct StreamingCompilation {
+    thread: Option<JoinHandle<Result<Compilation, CompileError>>>,
+    monitor: Arc<CompileMonitor>,
+    /// The module the functions are compiled for, as transformed by the
+    /// middlewares.
+    module: Arc<ModuleInfo>,
+    memory_styles: PrimaryMap<MemoryIndex, MemoryStyle>,
+    table_styles: PrimaryMap<TableIndex, TableStyle>,
+}
+
+impl UniversalArtifactStream {
+    pub(crate) fn new(
+        engine: &UniversalEngine,
+        tunables: Arc<dyn Tunables + Send + Sync>,
+    ) -> Result<Self, CompileError> {
+        let (compiler, features) = {
+            let inner = engine.inner();
+            (inner.shared_compiler()?, inner.features().clone())
+        };
+        let parser = ModuleStreamParser::new(&features);
+        Ok(Self {
+            engine: engine.clone(),
+            tunables,
+            compiler,
+            features,
+            parser: Some(parser),
+            compilation: None,
+        })
+    }
+
+    fn start(&mut self, declarations: ModuleDeclarations) -> Result<(), CompileError> {
+        let ModuleDeclarations {
+            mut module,
+            module_translation_state,
+            function_bodies,
+        } = declarations;
+        self.compiler
+            .get_middlewares()
+            .apply_on_module_info(&mut module);
+        let memory_styles: PrimaryMap<MemoryIndex, MemoryStyle> = module
+            .memories
+            .values()
+            .map(|memory_type| self.tunables.memory_style(memory_type))
+            .collect();
+        let table_styles: PrimaryMap<TableIndex, TableStyle> = module
+            .tables
+            .values()
+            .map(|table_type| self.tunables.table_style(table_type))
+            .collect();
+        let module = Arc::new(module);
+
+        let engine = self.engine.clone();
+        let compiler = self.compiler.clone();
+        let compile_info = CompileModuleInfo {
+            module: module.clone(),
+            features: self.features.clone(),
+            memory_styles: memory_styles.clone(),
+            table_styles: table_styles.clone(),
+        };
+        let monitor = Arc::new(CompileMonitor::new());
+        let thread_monitor = monitor.clone();
+        let thread = thread::Builder::new()
+            .name("wasmer-compile-stream".to_string())
+            .spawn(move || {
+                thread_monitor.monitor(|| {
+                    compiler.compile_module_streaming(
+                        engine.target(),
+                        &compile_info,
+                        &module_translation_state,
+                        function_bodies,
+                    )
+                })
+            })
+            .map_err(|error| CompileError::Resource(error.to_string()))?;
+        self.compilation = Some(StreamingCompilation {
+            thread: Some(thread),
+            monitor,
+            module,
+            memory_styles,
+            table_styles,
+        });
+        Ok(())
+    }
+
+    fn fail(&mut self, error: CompileError) -> CompileError {
+        self.parser = None;
+        self.compilation = None;
+        error
+    }
+}
+
+impl ArtifactStream for UniversalArtifactStream {
+    fn write(&mut self, bytes: &[u8]) -> Result<(), CompileError> {
+        let parser = self.parser.as_mut().ok_or(CompileError::Cancelled)?;
+        match parser.write(bytes) {
+            Ok(Some(declarations)) => match self.start(declarations) {
+                Ok(()) => Ok(()),
+                Err(error) => Err(self.fail(error)),
+            },
+            Ok(None) => Ok(()),
+            Err(error) => Err(self.fail(error)),
+        }
+    }
+
+    fn finish(mut self: Box<Self>) -> Result<Arc<dyn Artifact>, CompileError> {
+        let parser = self.parser.take().ok_or(CompileError::Cancelled)?;
+        let mut received = parser.finish()?;
+        if let Some(declarations) = received.declarations.take() {
+            self.start(declarations)?;
+        }
+        let mut compilation = self.compilation.take().ok_or(CompileError::Cancelled)?;
+        let functions = compilation.join()?;
+        let mut compile_info = CompileModuleInfo {
+            module: compilation.module.clone(),
+            features: self.features.clone(),
+            memory_styles: compilation.memory_styles.clone(),
+            table_styles: compilation.table_styles.clone(),
+        };
+        // The module is no longer shared once the compilation is dropped,
+        // so it is completed in place.
+        drop(compilation);
+        received.complete(Arc::make_mut(&mut compile_info.module));
+
+        let data_initializers = received.data_initializers.into_boxed_slice();
+        let artifact = UniversalArtifactBuild::from_compilation(
+            functions,
+            compile_info,
+            data_initializers,
+            self.engine.target(),
+        );
+        Ok(Arc::new(UniversalArtifact::from_compiled(
+            &self.engine,
+            &received.data,
+            artifact,
+        )?))
+    }
+}
+
+impl StreamingCompilation {
+    fn join(&mut self) -> Result<Compilation, CompileError> {
+        let thread = self.thread.take().ok_or(CompileError::Cancelled)?;
+        match thread.join() {
+            Ok(result) => result,
+            Err(payload) => panic::resume_unwind(payload),
+        }
+    }
+}
+
+impl Drop for StreamingCompilation {
+    fn drop(&mut self) {
+        // A compilation that is not joined is abandoned: it stops at the
+        // next function rather than waiting for all of them.
+        if self.thread.is_some() {
+            self.monitor.cancel();
+        }
+    }
+}
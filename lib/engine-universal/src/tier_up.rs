@@ -0,0 +1,462 @@
+//! Tiered compilation.
+//!
+//! An engine with an optimizing tier compiles modules with its own
+//! compiler, which is meant to be a fast one such as Singlepass, and
+//! recompiles their hot functions with the optimizing compiler on a
+//! background thread.
+//!
+//! Each local function of a tiered module is entered through a stub,
+//! which counts the call in the [`FunctionEntry`] of the function and
+//! jumps to the code the entry points to. All the calls go through the
+//! stubs: the direct calls between the functions of the module are
+//! linked to them, and the instances hand them out as the addresses of
+//! the functions, in their `VMCallerCheckedAnyfunc`s, tables and exports.
+//! The background thread samples the call counters, recompiles the
+//! functions called often enough, and swaps the code their entries point
+//! to atomically: the running instances, including the long-lived ones,
+//! run the optimized code from the next call of the function on.
+//!
+//! The hot functions are recompiled in batches. The module is recompiled
+//! with the bodies of the other functions replaced by `unreachable`, and
+//! the direct calls of the optimized code go through the stubs too, so
+//! that they reach the current code of the callee whatever its tier.
+//! Only the non-custom sections of a module are kept to recompile it:
+//! the names and the other custom sections are read from the module
+//! information of the first tier, which the optimized artifacts share.
+//!
+//! The stubs are implemented for x86-64 and AArch64 only; the modules
+//! compiled for other architectures aren't tiered.
+
+use crate::{UniversalArtifact, UniversalEngine};
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Condvar, Mutex, Weak};
+use std::thread;
+use std::time::Duration;
+use wasmer_compiler::{Architecture, CompileError, Compiler};
+use wasmer_engine::{Artifact, Engine};
+use wasmer_engine_universal_artifact::UniversalEngineBuilder;
+use wasmer_engine_universal_artifact::{ArtifactCreate, UniversalArtifactBuild};
+use wasmer_types::entity::{BoxedSlice, PrimaryMap};
+use wasmer_types::{Features, LocalFunctionIndex, MemoryIndex, ModuleInfo, TableIndex};
+use wasmer_vm::{FunctionBodyPtr, MemoryStyle, TableStyle};
+
+/// How often the call counters are sampled.
+const SAMPLING_INTERVAL: Duration = Duration::from_millis(10);
+
+/// The id of the code section of a Wasm module.
+const CODE_SECTION: u8 = 10;
+
+/// The optimizing tier of an engine.
+///
+/// The tiered artifacts are sampled, and their hot functions recompiled,
+/// on a thread of its own, spawned when the first artifact is tiered.
+/// The optimizing compiler parallelizes the compilation of the functions
+/// of a batch itself.
+pub(crate) struct TierUp {
+    /// The number of calls after which a function is hot.
+    calls: u64,
+    shared: Arc<Shared>,
+}
+
+/// The state of the thread of the optimizing tier.
+struct Shared {
+    state: Mutex<WorkerState>,
+    /// Wakes the thread up before the end of the sampling interval.
+    wake: Condvar,
+    /// Notified whenever a sampling is done.
+    sampled: Condvar,
+}
+
+struct WorkerState {
+    /// The builder of the optimizing compiler, until the thread is spawned.
+    builder: Option<UniversalEngineBuilder>,
+    /// The tiered artifacts, sampled until they and their instances are
+    /// dropped.
+    artifacts: Vec<Weak<TierUpState>>,
+    /// The number of samplings requested by [`TierUp::wait`], and the
+    /// number of them done.
+    requested: u64,
+    done: u64,
+    running: bool,
+    /// Whether the engine has been dropped, which stops the thread.
+    stopped: bool,
+}
+
+impl TierUp {
+    /// Creates the optimizing tier of an engine, recompiling the functions
+    /// called `calls` times with `compiler`.
+    pub(crate) fn new(compiler: Box<dyn Compiler>, features: Features, calls: u64) -> Self {
+        Self {
+            calls: calls.max(1),
+            shared: Arc::new(Shared {
+                state: Mutex::new(WorkerState {
+                    builder: Some(UniversalEngineBuilder::new(Some(compiler), features)),
+                    artifacts: vec![],
+                    requested: 0,
+                    done: 0,
+                    running: false,
+                    stopped: false,
+                }),
+                wake: Condvar::new(),
+                sampled: Condvar::new(),
+            }),
+        }
+    }
+
+    /// Blocks until the functions that are hot by now have been
+    /// recompiled and swapped in, or have failed to.
+    pub(crate) fn wait(&self) {
+        let mut state = self.shared.state.lock().unwrap();
+        state.requested += 1;
+        let requested = state.requested;
+        self.shared.wake.notify_all();
+        while state.running && state.done < requested {
+            state = self.shared.sampled.wait(state).unwrap();
+        }
+    }
+
+    /// Samples `artifact` from now on, spawning the thread if needed. The
+    /// artifacts keep running the code of the first tier if the thread
+    /// can't be spawned.
+    fn register(&self, artifact: &Arc<TierUpState>) {
+        let mut state = self.shared.state.lock().unwrap();
+        state.artifacts.push(Arc::downgrade(artifact));
+        if state.running {
+            self.shared.wake.notify_all();
+            return;
+        }
+        let builder = match state.builder.take() {
+            Some(builder) => builder,
+            None => return,
+        };
+        let shared = self.shared.clone();
+        let calls = self.calls;
+        let spawned = thread::Builder::new()
+            .name("wasmer-tier-up".to_string())
+            .spawn(move || shared.run(builder, calls));
+        state.running = spawned.is_ok();
+    }
+}
+
+impl Drop for TierUp {
+    fn drop(&mut self) {
+        // The engine and all the artifacts it tiered are gone.
+        self.shared.state.lock().unwrap().stopped = true;
+        self.shared.wake.notify_all();
+    }
+}
+
+impl Shared {
+    /// Samples the tiered artifacts until the engine is dropped.
+    fn run(&self, mut builder: UniversalEngineBuilder, calls: u64) {
+        let mut state = self.state.lock().unwrap();
+        loop {
+            let requested = state.requested;
+            state
+                .artifacts
+                .retain(|artifact| artifact.strong_count() > 0);
+            let artifacts = state.artifacts.clone();
+            drop(state);
+
+            for artifact in artifacts.iter().filter_map(Weak::upgrade) {
+                artifact.recompile_hot_functions(&mut builder, calls);
+            }
+
+            state = self.state.lock().unwrap();
+            state.done = requested;
+            self.sampled.notify_all();
+            while !state.stopped && state.requested == state.done {
+                if state.artifacts.is_empty() {
+                    state = self.wake.wait(state).unwrap();
+                } else {
+                    let (guard, timeout) =
+                        self.wake.wait_timeout(state, SAMPLING_INTERVAL).unwrap();
+                    state = guard;
+                    if timeout.timed_out() {
+                        break;
+                    }
+                }
+            }
+            if state.stopped {
+                break;
+            }
+        }
+        state.running = false;
+        self.sampled.notify_all();
+    }
+}
+
+/// The entry of a local function of a tiered artifact, read and written
+/// by the entry stub of the function.
+#[repr(C)]
+pub(crate) struct FunctionEntry {
+    /// The code the stub jumps to.
+    code: AtomicUsize,
+    /// The number of calls of the function. The stub increments it
+    /// without synchronization, so it misses some of the concurrent
+    /// calls.
+    calls: AtomicU64,
+}
+
+/// Returns the machine code of the entry stub of `entry`, or `None` if
+/// there are no stubs for `architecture`.
+///
+/// The stub only uses registers that the calling conventions leave to
+/// the callee on entry, and jumps to the code of the function with the
+/// arguments and the return address of the call untouched.
+pub(crate) fn entry_stub(
+    architecture: Architecture,
+    entry: *const FunctionEntry,
+) -> Option<Vec<u8>> {
+    let entry = (entry as u64).to_le_bytes();
+    let mut stub = vec![];
+    match architecture {
+        Architecture::X86_64 => {
+            // movabs r11, entry
+            stub.extend_from_slice(&[0x49, 0xbb]);
+            stub.extend_from_slice(&entry);
+            // inc qword ptr [r11 + 8]
+            stub.extend_from_slice(&[0x49, 0xff, 0x43, 0x08]);
+            // jmp qword ptr [r11]
+            stub.extend_from_slice(&[0x41, 0xff, 0x23]);
+        }
+        Architecture::Aarch64(_) => {
+            let instructions: [u32; 6] = [
+                0x5800_00d0, // ldr x16, #24
+                0xf940_0611, // ldr x17, [x16, #8]
+                0x9100_0631, // add x17, x17, #1
+                0xf900_0611, // str x17, [x16, #8]
+                0xf940_0210, // ldr x16, [x16]
+                0xd61f_0200, // br x16
+            ];
+            for instruction in instructions.iter() {
+                stub.extend_from_slice(&instruction.to_le_bytes());
+            }
+            stub.extend_from_slice(&entry);
+        }
+        _ => return None,
+    }
+    Some(stub)
+}
+
+/// The tiering state of an artifact compiled by the first tier, which
+/// its instances hold.
+pub(crate) struct TierUpState {
+    engine: UniversalEngine,
+    /// The module information of the first tier, which the optimized
+    /// artifacts share.
+    module: Arc<ModuleInfo>,
+    source: TierUpSource,
+    entries: Box<[FunctionEntry]>,
+    /// Whether each local function has been recompiled, or has failed to.
+    recompiled: Mutex<Vec<bool>>,
+    /// The artifacts compiled by the optimizing tier, which the entries
+    /// point into.
+    optimized: Mutex<Vec<Arc<UniversalArtifact>>>,
+}
+
+/// What a module is recompiled from.
+struct TierUpSource {
+    wasm: Box<[u8]>,
+    memory_styles: PrimaryMap<MemoryIndex, MemoryStyle>,
+    table_styles: PrimaryMap<TableIndex, TableStyle>,
+}
+
+impl TierUpState {
+    /// Creates the tiering state of `artifact`, compiled from `wasm`, or
+    /// returns `None` if the engine has no optimizing tier or no entry
+    /// stubs for its target.
+    pub(crate) fn new(
+        engine: &UniversalEngine,
+        wasm: &[u8],
+        artifact: &UniversalArtifactBuild,
+    ) -> Option<Self> {
+        engine.tier_up()?;
+        entry_stub(engine.target().triple().architecture, std::ptr::null())?;
+
+        let module = artifact.module();
+        let functions = module.functions.len() - module.num_imported_functions;
+        Some(Self {
+            engine: engine.clone(),
+            module,
+            source: TierUpSource {
+                wasm: sections_to_recompile(wasm),
+                memory_styles: artifact.memory_styles().clone(),
+                table_styles: artifact.table_styles().clone(),
+            },
+            entries: (0..functions)
+                .map(|_| FunctionEntry {
+                    code: AtomicUsize::new(0),
+                    calls: AtomicU64::new(0),
+                })
+                .collect(),
+            recompiled: Mutex::new(vec![false; functions]),
+            optimized: Mutex::new(vec![]),
+        })
+    }
+
+    /// The entries of the local functions.
+    pub(crate) fn entries(&self) -> &[FunctionEntry] {
+        &self.entries
+    }
+
+    /// Points the entries to `bodies`, the code of the first tier, and
+    /// starts sampling the calls.
+    pub(crate) fn start(
+        self: &Arc<Self>,
+        bodies: &BoxedSlice<LocalFunctionIndex, FunctionBodyPtr>,
+    ) {
+        for (entry, body) in self.entries.iter().zip(bodies.values()) {
+            entry.code.store(**body as usize, Ordering::Release);
+        }
+        if let Some(tier_up) = self.engine.tier_up() {
+            tier_up.register(self);
+        }
+    }
+
+    /// Recompiles the functions called `calls` times that haven't been
+    /// recompiled yet, and swaps them in.
+    fn recompile_hot_functions(&self, builder: &mut UniversalEngineBuilder, calls: u64) {
+        let hot = {
+            let mut recompiled = self.recompiled.lock().unwrap();
+            let hot = self
+                .entries
+                .iter()
+                .zip(recompiled.iter())
+                .map(|(entry, &recompiled)| {
+                    !recompiled && entry.calls.load(Ordering::Relaxed) >= calls
+                })
+                .collect::<Vec<_>>();
+            if !hot.contains(&true) {
+                return;
+            }
+            for (recompiled, &hot) in recompiled.iter_mut().zip(&hot) {
+                *recompiled |= hot;
+            }
+            hot
+        };
+
+        // The functions the optimizing tier fails to compile keep running
+        // the code of the first tier.
+        let optimized = match self.compile(builder, &hot) {
+            Ok(optimized) => Arc::new(optimized),
+            Err(_) => return,
+        };
+        optimized.register_frame_info();
+        self.optimized.lock().unwrap().push(optimized.clone());
+        for ((entry, &hot), body) in self
+            .entries
+            .iter()
+            .zip(&hot)
+            .zip(optimized.function_bodies().values())
+        {
+            if hot {
+                entry.code.store(**body as usize, Ordering::Release);
+            }
+        }
+    }
+
+    fn compile(
+        &self,
+        builder: &mut UniversalEngineBuilder,
+        hot: &[bool],
+    ) -> Result<UniversalArtifact, CompileError> {
+        let mut artifact = UniversalArtifactBuild::new(
+            builder,
+            &with_hot_bodies_only(&self.source.wasm, hot),
+            self.engine.target(),
+            self.source.memory_styles.clone(),
+            self.source.table_styles.clone(),
+        )?;
+        // The middlewares of the two compilers may transform the module
+        // differently, in which case the functions of the two tiers
+        // aren't interchangeable.
+        if !is_same_module(artifact.module_ref(), &self.module) {
+            return Err(CompileError::Codegen(
+                "the optimizing compiler transformed the module differently".to_string(),
+            ));
+        }
+        artifact.share_module(self.module.clone());
+        UniversalArtifact::from_optimized(&self.engine, artifact, &self.entries)
+    }
+}
+
+/// Copies the sections of the valid Wasm module `wasm` but the custom
+/// ones, which the optimizing tier doesn't need.
+fn sections_to_recompile(wasm: &[u8]) -> Box<[u8]> {
+    // The magic number and the version.
+    let mut sections = wasm[..8].to_vec();
+    let mut rest = &wasm[8..];
+    while let Some(&id) = rest.first() {
+        let mut reader = &rest[1..];
+        let size = leb128::read::unsigned(&mut reader).expect("the module is valid") as usize;
+        let length = rest.len() - reader.len() + size;
+        if id != 0 {
+            sections.extend_from_slice(&rest[..length]);
+        }
+        rest = &rest[length..];
+    }
+    sections.into_boxed_slice()
+}
+
+/// Copies the valid Wasm module `wasm`, replacing the bodies of the
+/// local functions that aren't `hot` with `unreachable`, which the
+/// optimizing tier compiles in no time.
+fn with_hot_bodies_only(wasm: &[u8], hot: &[bool]) -> Vec<u8> {
+    let mut module = wasm[..8].to_vec();
+    let mut rest = &wasm[8..];
+    while let Some(&id) = rest.first() {
+        let mut reader = &rest[1..];
+        let size = leb128::read::unsigned(&mut reader).expect("the module is valid") as usize;
+        let length = rest.len() - reader.len() + size;
+        if id != CODE_SECTION {
+            module.extend_from_slice(&rest[..length]);
+            rest = &rest[length..];
+            continue;
+        }
+
+        let mut bodies = &reader[..size];
+        let count = leb128::read::unsigned(&mut bodies).expect("the module is valid");
+        let mut section = vec![];
+        write_unsigned(&mut section, count);
+        for &hot in hot {
+            let body_size =
+                leb128::read::unsigned(&mut bodies).expect("the module is valid") as usize;
+            if hot {
+                write_unsigned(&mut section, body_size as u64);
+                section.extend_from_slice(&bodies[..body_size]);
+            } else {
+                // No locals, `unreachable` and `end`.
+                section.extend_from_slice(&[3, 0x00, 0x00, 0x0b]);
+            }
+            bodies = &bodies[body_size..];
+        }
+        module.push(id);
+        write_unsigned(&mut module, section.len() as u64);
+        module.extend_from_slice(&section);
+        rest = &rest[length..];
+    }
+    module
+}
+
+fn write_unsigned(bytes: &mut Vec<u8>, value: u64) {
+    leb128::write::unsigned(bytes, value).expect("writing to a vector");
+}
+
+/// Whether two compilations of the same Wasm module describe the same
+/// entities, so that their code is laid out against the same `VMContext`.
+fn is_same_module(a: &ModuleInfo, b: &ModuleInfo) -> bool {
+    a.imports == b.imports
+        && a.exports == b.exports
+        && a.start_function == b.start_function
+        && a.global_initializers == b.global_initializers
+        && a.signatures == b.signatures
+        && a.functions == b.functions
+        && a.tables == b.tables
+        && a.memories == b.memories
+        && a.globals == b.globals
+        && a.num_imported_functions == b.num_imported_functions
+        && a.num_imported_tables == b.num_imported_tables
+        && a.num_imported_memories == b.num_imported_memories
+        && a.num_imported_globals == b.num_imported_globals
+}
@@ -88,9 +88,11 @@ impl UnwindRegistry {
             while current < end {
                 let len = std::ptr::read::<u32>(current as *const u32) as usize;
 
-                // Skip over the CIE and zero-length FDEs.
-                // LLVM's libunwind emits a warning on zero-length FDEs.
-                if current != start && len != 0 {
+                // Skip over the CIEs, whose CIE id is 0, and zero-length
+                // FDEs. There may be a CIE per function rather than only
+                // one at the start. LLVM's libunwind emits a warning on
+                // zero-length FDEs.
+                if len != 0 && std::ptr::read::<u32>(current.add(4) as *const u32) != 0 {
                     __register_frame(current);
                     self.registrations.push(current as usize);
                 }
@@ -1,13 +1,14 @@
 use crate::{resolve_imports, InstantiationError, Resolver, RuntimeError, Tunables};
 use loupe::MemoryUsage;
 use std::any::Any;
+use std::sync::Arc;
 pub use wasmer_artifact::MetadataHeader;
 use wasmer_artifact::{ArtifactCreate, Upcastable};
 use wasmer_compiler::CpuFeature;
 use wasmer_types::entity::BoxedSlice;
 use wasmer_types::{DataInitializer, FunctionIndex, LocalFunctionIndex, SignatureIndex};
 use wasmer_vm::{
-    FuncDataRegistry, FunctionBodyPtr, InstanceAllocator, InstanceHandle, TrapHandler,
+    FuncDataRegistry, FunctionBodyPtr, InstanceHandle, MemoryImages, TrapHandler,
     VMSharedSignatureIndex, VMTrampoline,
 };
 
@@ -42,7 +43,22 @@ pub trait Artifact: Send + Sync + Upcastable + MemoryUsage + ArtifactCreate {
     fn signatures(&self) -> &BoxedSlice<SignatureIndex, VMSharedSignatureIndex>;
 
     /// Get the func data registry
-    fn func_data_registry(&self) -> &FuncDataRegistry;
+    fn func_data_registry(&self) -> &Arc<FuncDataRegistry>;
+
+    /// Returns the copy-on-write images of the local memories of this
+    /// `Artifact`, if the engine supports them, see [`MemoryImage`].
+    ///
+    /// [`MemoryImage`]: wasmer_vm::MemoryImage
+    fn memory_images(&self) -> Option<Arc<MemoryImages>> {
+        None
+    }
+
+    /// Returns a handle keeping the executable memory of this `Artifact`
+    /// alive, if the engine reclaims it once unused. Each instance holds
+    /// a clone of it, since instances may outlive their `Artifact`.
+    fn code_handle(&self) -> Option<Arc<dyn Any + Send + Sync>> {
+        None
+    }
 
     /// Do preinstantiation logic that is executed before instantiating
     fn preinstantiate(&self) -> Result<(), InstantiationError> {
@@ -93,7 +109,7 @@ pub trait Artifact: Send + Sync + Upcastable + MemoryUsage + ArtifactCreate {
         // Get pointers to where metadata about local tables should live in VM memory.
 
         let (allocator, memory_definition_locations, table_definition_locations) =
-            InstanceAllocator::new(&*module);
+            tunables.allocate_instance(&*module);
         let finished_memories = tunables
             .create_memories(&module, self.memory_styles(), &memory_definition_locations)
             .map_err(InstantiationError::Link)?
@@ -119,6 +135,8 @@ pub trait Artifact: Send + Sync + Upcastable + MemoryUsage + ArtifactCreate {
             finished_globals,
             imports,
             self.signatures().clone(),
+            self.func_data_registry().clone(),
+            self.code_handle(),
             host_state,
             import_function_envs,
         )
@@ -143,8 +161,9 @@ pub trait Artifact: Send + Sync + Upcastable + MemoryUsage + ArtifactCreate {
                 data: &*init.data,
             })
             .collect::<Vec<_>>();
+        let memory_images = self.memory_images();
         handle
-            .finish_instantiation(trap_handler, &data_initializers)
+            .finish_instantiation(trap_handler, &data_initializers, memory_images.as_deref())
             .map_err(|trap| InstantiationError::Start(RuntimeError::from_trap(trap)))
     }
 }
@@ -7,7 +7,7 @@ use memmap2::Mmap;
 use std::path::Path;
 use std::sync::atomic::{AtomicUsize, Ordering::SeqCst};
 use std::sync::Arc;
-use wasmer_compiler::{CompileError, Target};
+use wasmer_compiler::{CompileError, CompilePool, Target};
 use wasmer_types::FunctionType;
 use wasmer_vm::{VMCallerCheckedAnyfunc, VMFuncRef, VMSharedSignatureIndex};
 
@@ -40,6 +40,22 @@ pub trait Engine: MemoryUsage {
         tunables: &dyn Tunables,
     ) -> Result<Arc<dyn Artifact>, CompileError>;
 
+    /// Starts compiling a WebAssembly binary whose bytes are written to
+    /// the returned stream as they are received, see [`ArtifactStream`].
+    ///
+    /// By default, the binary is validated and compiled once all of it
+    /// has been received.
+    fn compile_streaming(
+        &self,
+        tunables: Arc<dyn Tunables + Send + Sync>,
+    ) -> Result<Box<dyn ArtifactStream>, CompileError> {
+        Ok(Box::new(BufferedArtifactStream {
+            engine: self.cloned(),
+            tunables,
+            binary: Vec::new(),
+        }))
+    }
+
     /// Deserializes a WebAssembly module
     ///
     /// # Safety
@@ -61,6 +77,21 @@ pub trait Engine: MemoryUsage {
         self.deserialize(&mmap)
     }
 
+    /// Deserializes a WebAssembly module from a path, reading it in
+    /// place from a mapping of the file where the engine supports it,
+    /// rather than deserializing all of it first.
+    ///
+    /// # Safety
+    ///
+    /// The file's content must represent a serialized WebAssembly module,
+    /// and the file must not be modified while the module is alive.
+    unsafe fn deserialize_from_file_mmap(
+        &self,
+        file_ref: &Path,
+    ) -> Result<Arc<dyn Artifact>, DeserializeError> {
+        self.deserialize_from_file(file_ref)
+    }
+
     /// A unique identifier for this object.
     ///
     /// This exists to allow us to compare two Engines for equality. Otherwise,
@@ -68,10 +99,49 @@ pub trait Engine: MemoryUsage {
     /// of trait representation.
     fn id(&self) -> &EngineId;
 
+    /// The pool of threads this engine compiles on, through which its
+    /// compilations in progress can be cancelled, if it has a compiler.
+    fn compile_pool(&self) -> Option<&CompilePool> {
+        None
+    }
+
     /// Clone the engine
     fn cloned(&self) -> Arc<dyn Engine + Send + Sync>;
 }
 
+/// A WebAssembly binary being compiled while its bytes are received,
+/// e.g. from the network, see [`Engine::compile_streaming`].
+pub trait ArtifactStream: Send {
+    /// Writes the next bytes of the binary.
+    ///
+    /// It fails as soon as the bytes received so far are known to be an
+    /// invalid binary, in which case the compilation is cancelled.
+    fn write(&mut self, bytes: &[u8]) -> Result<(), CompileError>;
+
+    /// Ends the binary, and returns its artifact once compiled.
+    fn finish(self: Box<Self>) -> Result<Arc<dyn Artifact>, CompileError>;
+}
+
+/// An [`ArtifactStream`] compiling the binary once all of it has been
+/// received.
+struct BufferedArtifactStream {
+    engine: Arc<dyn Engine + Send + Sync>,
+    tunables: Arc<dyn Tunables + Send + Sync>,
+    binary: Vec<u8>,
+}
+
+impl ArtifactStream for BufferedArtifactStream {
+    fn write(&mut self, bytes: &[u8]) -> Result<(), CompileError> {
+        self.binary.extend_from_slice(bytes);
+        Ok(())
+    }
+
+    fn finish(self: Box<Self>) -> Result<Arc<dyn Artifact>, CompileError> {
+        self.engine.validate(&self.binary)?;
+        self.engine.compile(&self.binary, self.tunables.as_ref())
+    }
+}
+
 #[derive(Debug, PartialEq, Eq, PartialOrd, Ord, MemoryUsage)]
 #[repr(transparent)]
 /// A unique identifier for an Engine.
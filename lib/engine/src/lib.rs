@@ -32,7 +32,7 @@ mod trap;
 mod tunables;
 
 pub use crate::artifact::Artifact;
-pub use crate::engine::{Engine, EngineId};
+pub use crate::engine::{ArtifactStream, Engine, EngineId};
 pub use crate::error::{InstantiationError, LinkError};
 pub use crate::export::{Export, ExportFunction, ExportFunctionMetadata};
 pub use crate::resolver::{
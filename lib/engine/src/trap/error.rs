@@ -1,9 +1,10 @@
-use super::frame_info::{FrameInfo, GlobalFrameInfo, FRAME_INFO};
+use super::frame_info::{FrameInfo, GlobalFrameInfo, UnresolvedFrame, FRAME_INFO};
 use backtrace::Backtrace;
+use once_cell::sync::OnceCell;
 use std::error::Error;
 use std::fmt;
 use std::sync::Arc;
-use wasmer_vm::{raise_user_trap, Trap, TrapCode};
+use wasmer_vm::{capture_backtrace, raise_user_trap, Trap, TrapCode};
 
 /// A struct representing an aborted instruction execution, with a message
 /// indicating the cause.
@@ -35,8 +36,11 @@ impl fmt::Display for RuntimeErrorSource {
 struct RuntimeErrorInner {
     /// The source error (this can be a custom user `Error` or a [`TrapCode`])
     source: RuntimeErrorSource,
-    /// The reconstructed Wasm trace (from the native trace and the `GlobalFrameInfo`).
-    wasm_trace: Vec<FrameInfo>,
+    /// The Wasm frames of the native trace, symbolicated on demand.
+    frames: Vec<UnresolvedFrame>,
+    /// The reconstructed Wasm trace (from the native trace and the `GlobalFrameInfo`),
+    /// built by the first call to `trace`.
+    wasm_trace: OnceCell<Vec<FrameInfo>>,
     /// The native backtrace
     native_trace: Backtrace,
 }
@@ -54,19 +58,19 @@ impl RuntimeError {
     /// assert_eq!("unexpected error", trap.message());
     /// ```
     pub fn new<I: Into<String>>(message: I) -> Self {
-        let info = FRAME_INFO.read().unwrap();
+        let info = FRAME_INFO.read();
         let msg = message.into();
         Self::new_with_trace(
             &info,
             None,
             RuntimeErrorSource::Generic(msg),
-            Backtrace::new_unresolved(),
+            capture_backtrace(),
         )
     }
 
     /// Create a new RuntimeError from a Trap.
     pub fn from_trap(trap: Trap) -> Self {
-        let info = FRAME_INFO.read().unwrap();
+        let info = FRAME_INFO.read();
         match trap {
             // A user error
             Trap::User(error) => {
@@ -77,7 +81,7 @@ impl RuntimeError {
                         &info,
                         None,
                         RuntimeErrorSource::User(e),
-                        Backtrace::new_unresolved(),
+                        capture_backtrace(),
                     ),
                 }
             }
@@ -121,12 +125,12 @@ impl RuntimeError {
             // The error is already a RuntimeError, we return it directly
             Ok(runtime_error) => *runtime_error,
             Err(error) => {
-                let info = FRAME_INFO.read().unwrap();
+                let info = FRAME_INFO.read();
                 Self::new_with_trace(
                     &info,
                     None,
                     RuntimeErrorSource::User(error),
-                    Backtrace::new_unresolved(),
+                    capture_backtrace(),
                 )
             }
         }
@@ -138,7 +142,9 @@ impl RuntimeError {
         source: RuntimeErrorSource,
         native_trace: Backtrace,
     ) -> Self {
-        let frames: Vec<usize> = native_trace
+        // Only find the module of each Wasm frame: symbolicating the frames
+        // is deferred until `trace` is called, which most callers never do.
+        let frames = native_trace
             .frames()
             .iter()
             .filter_map(|frame| {
@@ -157,21 +163,16 @@ impl RuntimeError {
                     // previous instruction (the call instruction) so we subtract one as
                     // the lookup.
                     let pc_to_lookup = if Some(pc) == trap_pc { pc } else { pc - 1 };
-                    Some(pc_to_lookup)
+                    info.lookup_unresolved_frame(pc_to_lookup)
                 }
             })
             .collect();
 
-        // Let's construct the trace
-        let wasm_trace = frames
-            .into_iter()
-            .filter_map(|pc| info.lookup_frame_info(pc))
-            .collect::<Vec<_>>();
-
         Self {
             inner: Arc::new(RuntimeErrorInner {
                 source,
-                wasm_trace,
+                frames,
+                wasm_trace: OnceCell::new(),
                 native_trace,
             }),
         }
@@ -184,8 +185,16 @@ impl RuntimeError {
 
     /// Returns a list of function frames in WebAssembly code that led to this
     /// trap happening.
+    ///
+    /// The frames are symbolicated by the first call.
     pub fn trace(&self) -> &[FrameInfo] {
-        &self.inner.wasm_trace
+        self.inner.wasm_trace.get_or_init(|| {
+            self.inner
+                .frames
+                .iter()
+                .filter_map(UnresolvedFrame::resolve)
+                .collect()
+        })
     }
 
     /// Attempts to downcast the `RuntimeError` to a concrete type.
@@ -225,7 +234,7 @@ impl fmt::Debug for RuntimeError {
     fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
         f.debug_struct("RuntimeError")
             .field("source", &self.inner.source)
-            .field("wasm_trace", &self.inner.wasm_trace)
+            .field("wasm_trace", &self.trace())
             .field("native_trace", &self.inner.native_trace)
             .finish()
     }
@@ -12,9 +12,14 @@
 //! FRAME_INFO.register(module, compiled_functions);
 //! ```
 use loupe::MemoryUsage;
+use std::cell::Cell;
 use std::cmp;
 use std::collections::BTreeMap;
-use std::sync::{Arc, RwLock};
+use std::ops::Deref;
+use std::ptr;
+use std::sync::atomic::{AtomicPtr, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
 use wasmer_compiler::{CompiledFunctionFrameInfo, SourceLoc, TrapInformation};
 use wasmer_types::entity::{BoxedSlice, EntityRef, PrimaryMap};
 use wasmer_types::{LocalFunctionIndex, ModuleInfo};
@@ -26,35 +31,155 @@ lazy_static::lazy_static! {
     /// This global cache is used during `Trap` creation to symbolicate frames.
     /// This is populated on module compilation, and it is cleared out whenever
     /// all references to a module are dropped.
-    pub static ref FRAME_INFO: RwLock<GlobalFrameInfo> = Default::default();
+    pub static ref FRAME_INFO: SharedFrameInfo = Default::default();
 }
 
+thread_local! {
+    /// The number of `FrameInfoGuard`s held by the current thread.
+    static HELD_GUARDS: Cell<usize> = Cell::new(0);
+}
+
+/// An immutable snapshot of the frame information of all the registered
+/// modules.
 #[derive(Default)]
 pub struct GlobalFrameInfo {
-    /// An internal map that keeps track of backtrace frame information for
-    /// each module.
+    /// The backtrace frame information of each module, sorted by address.
     ///
-    /// This map is morally a map of ranges to a map of information for that
-    /// module. Each module is expected to reside in a disjoint section of
+    /// Each module is expected to reside in a disjoint section of
     /// contiguous memory. No modules can overlap.
-    ///
-    /// The key of this map is the highest address in the module and the value
-    /// is the module's information, which also contains the start address.
-    ranges: BTreeMap<usize, ModuleInfoFrameInfo>,
+    ranges: Vec<Arc<ModuleInfoFrameInfo>>,
+}
+
+/// The current `GlobalFrameInfo`, which is replaced as a whole when a
+/// module is registered or unregistered.
+///
+/// Reading it takes no lock: readers announce themselves in the counter
+/// of the current epoch, and a writer that replaced the snapshot waits
+/// for the readers of the previous epoch to leave before freeing the
+/// previous snapshot. Writers are serialized with each other, but never
+/// block readers.
+///
+/// A writer would therefore wait forever for the guards held by its own
+/// thread: registering or unregistering a module, i.e. dropping a
+/// `GlobalFrameInfoRegistration`, while the current thread holds a
+/// [`FrameInfoGuard`] panics instead.
+pub struct SharedFrameInfo {
+    current: AtomicPtr<GlobalFrameInfo>,
+    epoch: AtomicUsize,
+    readers: [AtomicUsize; 2],
+    writer: Mutex<()>,
+}
+
+impl Default for SharedFrameInfo {
+    fn default() -> Self {
+        Self {
+            current: AtomicPtr::new(Box::into_raw(Box::new(GlobalFrameInfo::default()))),
+            epoch: AtomicUsize::new(0),
+            readers: [AtomicUsize::new(0), AtomicUsize::new(0)],
+            writer: Mutex::new(()),
+        }
+    }
+}
+
+impl SharedFrameInfo {
+    /// Returns the current snapshot, which stays valid until the guard is
+    /// dropped.
+    pub fn read(&self) -> FrameInfoGuard<'_> {
+        let parity = loop {
+            let epoch = self.epoch.load(Ordering::SeqCst);
+            let parity = epoch & 1;
+            self.readers[parity].fetch_add(1, Ordering::SeqCst);
+
+            // If a writer moved to the next epoch in the meantime, it may
+            // not have seen us: announce ourselves in the new epoch.
+            if self.epoch.load(Ordering::SeqCst) == epoch {
+                break parity;
+            }
+            self.readers[parity].fetch_sub(1, Ordering::SeqCst);
+        };
+        HELD_GUARDS.with(|held| held.set(held.get() + 1));
+
+        FrameInfoGuard {
+            shared: self,
+            parity,
+            info: self.current.load(Ordering::SeqCst),
+        }
+    }
+
+    /// Replaces the current snapshot with the one returned by `update`.
+    fn update<F>(&self, update: F)
+    where
+        F: FnOnce(&GlobalFrameInfo) -> GlobalFrameInfo,
+    {
+        assert_eq!(
+            HELD_GUARDS.with(Cell::get),
+            0,
+            "the frame information can't be updated while the current thread holds a `FrameInfoGuard`"
+        );
+        let _writer = self.writer.lock().unwrap_or_else(|e| e.into_inner());
+
+        // Only writers replace `current`, and we are the only writer.
+        let previous = self.current.load(Ordering::SeqCst);
+        let next = Box::into_raw(Box::new(update(unsafe { &*previous })));
+        self.current.store(next, Ordering::SeqCst);
+
+        // The readers that may still see `previous` all announced
+        // themselves in the previous epoch.
+        let epoch = self.epoch.fetch_add(1, Ordering::SeqCst);
+        while self.readers[epoch & 1].load(Ordering::SeqCst) != 0 {
+            thread::yield_now();
+        }
+
+        drop(unsafe { Box::from_raw(previous) });
+    }
+}
+
+impl Drop for SharedFrameInfo {
+    fn drop(&mut self) {
+        let current = std::mem::replace(self.current.get_mut(), ptr::null_mut());
+        drop(unsafe { Box::from_raw(current) });
+    }
+}
+
+/// A snapshot of the `GlobalFrameInfo`, returned by [`SharedFrameInfo::read`].
+pub struct FrameInfoGuard<'a> {
+    shared: &'a SharedFrameInfo,
+    parity: usize,
+    info: *const GlobalFrameInfo,
+}
+
+impl Deref for FrameInfoGuard<'_> {
+    type Target = GlobalFrameInfo;
+
+    fn deref(&self) -> &GlobalFrameInfo {
+        // The snapshot isn't freed while we are announced as a reader.
+        unsafe { &*self.info }
+    }
+}
+
+impl Drop for FrameInfoGuard<'_> {
+    fn drop(&mut self) {
+        self.shared.readers[self.parity].fetch_sub(1, Ordering::SeqCst);
+        HELD_GUARDS.with(|held| held.set(held.get() - 1));
+    }
 }
 
 /// An RAII structure used to unregister a module's frame information when the
 /// module is destroyed.
+///
+/// It must not be dropped on a thread that holds a [`FrameInfoGuard`], see
+/// [`SharedFrameInfo`].
 #[derive(MemoryUsage)]
 pub struct GlobalFrameInfoRegistration {
-    /// The key that will be removed from the global `ranges` map when this is
-    /// dropped.
+    /// The highest address of the module, which identifies it in the
+    /// `ranges` of the global frame information.
     key: usize,
 }
 
 #[derive(Debug)]
 struct ModuleInfoFrameInfo {
     start: usize,
+    end: usize,
     functions: BTreeMap<usize, FunctionInfo>,
     module: Arc<ModuleInfo>,
     frame_infos: PrimaryMap<LocalFunctionIndex, CompiledFunctionFrameInfo>,
@@ -74,28 +199,17 @@ impl ModuleInfoFrameInfo {
             None
         }
     }
-}
 
-#[derive(Debug)]
-struct FunctionInfo {
-    start: usize,
-    local_index: LocalFunctionIndex,
-}
-
-impl GlobalFrameInfo {
-    /// Fetches frame information about a program counter in a backtrace.
-    ///
-    /// Returns an object if this `pc` is known to some previously registered
-    /// module, or returns `None` if no information can be found.
-    pub fn lookup_frame_info(&self, pc: usize) -> Option<FrameInfo> {
-        let module = self.module_info(pc)?;
-        let func = module.function_info(pc)?;
+    /// Fetches frame information about a program counter in the code of
+    /// this module.
+    fn lookup_frame_info(&self, pc: usize) -> Option<FrameInfo> {
+        let func = self.function_info(pc)?;
 
         // Use our relative position from the start of the function to find the
         // machine instruction that corresponds to `pc`, which then allows us to
         // map that to a wasm original source location.
         let rel_pos = pc - func.start;
-        let instr_map = &module.function_debug_info(func.local_index).address_map;
+        let instr_map = &self.function_debug_info(func.local_index).address_map;
         let pos = match instr_map
             .instructions
             .binary_search_by_key(&rel_pos, |map| map.code_offset)
@@ -130,15 +244,55 @@ impl GlobalFrameInfo {
             // start offset of the function.
             None => instr_map.start_srcloc,
         };
-        let func_index = module.module.func_index(func.local_index);
+        let func_index = self.module.func_index(func.local_index);
         Some(FrameInfo {
-            module_name: module.module.name(),
+            module_name: self.module.name(),
             func_index: func_index.index() as u32,
-            function_name: module.module.function_names.get(&func_index).cloned(),
+            function_name: self.module.function_names.get(&func_index).cloned(),
             instr,
             func_start: instr_map.start_srcloc,
         })
     }
+}
+
+/// A program counter in the code of a registered module, which can be
+/// symbolicated later, even once the module has been unregistered.
+#[derive(Debug, Clone)]
+pub struct UnresolvedFrame {
+    module: Arc<ModuleInfoFrameInfo>,
+    pc: usize,
+}
+
+impl UnresolvedFrame {
+    /// Symbolicates this frame, see [`GlobalFrameInfo::lookup_frame_info`].
+    pub fn resolve(&self) -> Option<FrameInfo> {
+        self.module.lookup_frame_info(self.pc)
+    }
+}
+
+#[derive(Debug)]
+struct FunctionInfo {
+    start: usize,
+    local_index: LocalFunctionIndex,
+}
+
+impl GlobalFrameInfo {
+    /// Fetches frame information about a program counter in a backtrace.
+    ///
+    /// Returns an object if this `pc` is known to some previously registered
+    /// module, or returns `None` if no information can be found.
+    pub fn lookup_frame_info(&self, pc: usize) -> Option<FrameInfo> {
+        self.module_info(pc)?.lookup_frame_info(pc)
+    }
+
+    /// Finds the module whose code contains a program counter in a
+    /// backtrace, so that the frame can be symbolicated later.
+    pub fn lookup_unresolved_frame(&self, pc: usize) -> Option<UnresolvedFrame> {
+        Some(UnresolvedFrame {
+            module: self.module_info(pc)?.clone(),
+            pc,
+        })
+    }
 
     /// Fetches trap information about a program counter in a backtrace.
     pub fn lookup_trap_info(&self, pc: usize) -> Option<&TrapInformation> {
@@ -152,21 +306,32 @@ impl GlobalFrameInfo {
     }
 
     /// Gets a module given a pc
-    fn module_info(&self, pc: usize) -> Option<&ModuleInfoFrameInfo> {
-        let (end, module_info) = self.ranges.range(pc..).next()?;
-        if module_info.start <= pc && pc <= *end {
+    fn module_info(&self, pc: usize) -> Option<&Arc<ModuleInfoFrameInfo>> {
+        let module_info = self.ranges.get(self.position(pc))?;
+        if module_info.start <= pc && pc <= module_info.end {
             Some(module_info)
         } else {
             None
         }
     }
+
+    /// Returns the position of the first module that ends at or after `pc`.
+    fn position(&self, pc: usize) -> usize {
+        self.ranges
+            .partition_point(|module_info| module_info.end < pc)
+    }
 }
 
 impl Drop for GlobalFrameInfoRegistration {
     fn drop(&mut self) {
-        if let Ok(mut info) = FRAME_INFO.write() {
-            info.ranges.remove(&self.key);
-        }
+        FRAME_INFO.update(|info| GlobalFrameInfo {
+            ranges: info
+                .ranges
+                .iter()
+                .filter(|module_info| module_info.end != self.key)
+                .cloned()
+                .collect(),
+        });
     }
 }
 
@@ -218,27 +383,30 @@ pub fn register(
         return None;
     }
 
-    let mut info = FRAME_INFO.write().unwrap();
-    // First up assert that our chunk of jit functions doesn't collide with
-    // any other known chunks of jit functions...
-    if let Some((_, prev)) = info.ranges.range(max..).next() {
-        assert!(prev.start > max);
-    }
-    if let Some((prev_end, _)) = info.ranges.range(..=min).next_back() {
-        assert!(*prev_end < min);
-    }
+    let module_info = Arc::new(ModuleInfoFrameInfo {
+        start: min,
+        end: max,
+        functions,
+        module,
+        frame_infos,
+    });
+
+    FRAME_INFO.update(|info| {
+        // First up assert that our chunk of jit functions doesn't collide with
+        // any other known chunks of jit functions...
+        let position = info.position(min);
+        if let Some(next) = info.ranges.get(position) {
+            assert!(next.start > max);
+        }
+
+        // ... then insert our range
+        let mut ranges = Vec::with_capacity(info.ranges.len() + 1);
+        ranges.extend_from_slice(&info.ranges[..position]);
+        ranges.push(module_info);
+        ranges.extend_from_slice(&info.ranges[position..]);
+        GlobalFrameInfo { ranges }
+    });
 
-    // ... then insert our range and assert nothing was there previously
-    let prev = info.ranges.insert(
-        max,
-        ModuleInfoFrameInfo {
-            start: min,
-            functions,
-            module,
-            frame_infos,
-        },
-    );
-    assert!(prev.is_none());
     Some(GlobalFrameInfoRegistration { key: max })
 }
 
@@ -318,3 +486,84 @@ impl FrameInfo {
         (self.instr.bits() - self.func_start.bits()) as usize
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::AtomicBool;
+    use wasmer_types::SignatureIndex;
+    use wasmer_vm::VMFunctionBody;
+
+    /// Registers a module whose only function is `0x100` bytes long at
+    /// `start`, and returns a program counter in it.
+    fn register_at(start: usize) -> (GlobalFrameInfoRegistration, usize) {
+        let mut module = ModuleInfo::new();
+        module.functions.push(SignatureIndex::new(0));
+        let mut finished_functions = PrimaryMap::new();
+        finished_functions.push(FunctionExtent {
+            ptr: FunctionBodyPtr(start as *const VMFunctionBody),
+            length: 0x100,
+        });
+        let mut frame_infos = PrimaryMap::new();
+        frame_infos.push(CompiledFunctionFrameInfo::default());
+
+        let registration = register(
+            Arc::new(module),
+            &finished_functions.into_boxed_slice(),
+            frame_infos,
+        )
+        .unwrap();
+
+        (registration, start + 0x10)
+    }
+
+    #[test]
+    fn concurrent_lookups_and_registrations() {
+        // A module that stays registered, which the readers must always
+        // find while the others come and go around it.
+        let (_registration, pc) = register_at(0x4000_0000);
+        let stop = Arc::new(AtomicBool::new(false));
+
+        let readers = (0..4)
+            .map(|_| {
+                let stop = stop.clone();
+                thread::spawn(move || {
+                    while !stop.load(Ordering::SeqCst) {
+                        let info = FRAME_INFO.read();
+                        let frame = info.lookup_frame_info(pc).unwrap();
+                        assert_eq!(frame.func_index(), 0);
+                        assert!(info.lookup_unresolved_frame(pc).is_some());
+                    }
+                })
+            })
+            .collect::<Vec<_>>();
+
+        let writers = (1..=4)
+            .map(|writer| {
+                thread::spawn(move || {
+                    for _ in 0..200 {
+                        let (registration, pc) = register_at(0x4000_0000 + writer * 0x10_0000);
+                        assert!(FRAME_INFO.read().lookup_frame_info(pc).is_some());
+                        drop(registration);
+                        assert!(FRAME_INFO.read().lookup_frame_info(pc).is_none());
+                    }
+                })
+            })
+            .collect::<Vec<_>>();
+
+        for writer in writers {
+            writer.join().unwrap();
+        }
+        stop.store(true, Ordering::SeqCst);
+        for reader in readers {
+            reader.join().unwrap();
+        }
+    }
+
+    #[test]
+    #[should_panic(expected = "holds a `FrameInfoGuard`")]
+    fn update_while_reading_panics() {
+        let _info = FRAME_INFO.read();
+        register_at(0x3000_0000);
+    }
+}
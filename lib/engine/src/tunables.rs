@@ -8,7 +8,7 @@ use wasmer_types::{
     ModuleInfo, TableIndex, TableType,
 };
 use wasmer_vm::MemoryError;
-use wasmer_vm::{Global, Memory, Table};
+use wasmer_vm::{Global, InstanceAllocator, Memory, Table};
 use wasmer_vm::{MemoryStyle, TableStyle};
 use wasmer_vm::{VMMemoryDefinition, VMTableDefinition};
 
@@ -62,6 +62,22 @@ pub trait Tunables: MemoryUsage {
         Ok(Arc::new(Global::new(ty)))
     }
 
+    /// Allocate the instance data of the current module, see
+    /// [`InstanceAllocator::new`].
+    ///
+    /// Override it to allocate instances from a pool, e.g. with a
+    /// [`PoolingAllocator`](wasmer_vm::PoolingAllocator).
+    fn allocate_instance(
+        &self,
+        module: &ModuleInfo,
+    ) -> (
+        InstanceAllocator,
+        Vec<NonNull<VMMemoryDefinition>>,
+        Vec<NonNull<VMTableDefinition>>,
+    ) {
+        InstanceAllocator::new(module)
+    }
+
     /// Allocate memory for just the memories of the current module.
     unsafe fn create_memories(
         &self,
@@ -0,0 +1,677 @@
+//! `epoch` is a middleware for interrupting long-running WebAssembly
+//! code at a much lower cost than [`Metering`][crate::Metering].
+//!
+//! Instead of counting operators, the compiled code only checks a
+//! per-instance flag, with a single load and branch, at the entry of
+//! each function and at the header of each loop. An [`Epoch`] is a
+//! counter, typically shared by all the instances of an engine, that
+//! a host thread increments at a regular interval (a "tick"). Each
+//! instance can be given a deadline, as a number of ticks: once the
+//! epoch reaches it, the flag of the instance is raised and its
+//! execution traps at the next check, or a host callback decides
+//! whether to let it run a bit longer.
+//!
+//! # Example
+//!
+//! ```rust
+//! use std::sync::Arc;
+//! use std::thread;
+//! use std::time::Duration;
+//! use wasmer::{imports, wat2wasm, CompilerConfig, Cranelift, Instance, Module, Store, Universal};
+//! use wasmer_middlewares::epoch::{is_interrupted, Epoch};
+//! use wasmer_middlewares::EpochInterruption;
+//!
+//! let mut compiler_config = Cranelift::default();
+//! compiler_config.push_middleware(Arc::new(EpochInterruption::new()));
+//! let store = Store::new(&Universal::new(compiler_config).engine());
+//!
+//! let module = Module::new(&store, "(module (func (export \"spin\") (loop (br 0))))").unwrap();
+//! let instance = Instance::new(&module, &imports! {}).unwrap();
+//!
+//! // Interrupt `spin` after 10 ticks of 1ms.
+//! let epoch = Arc::new(Epoch::new());
+//! epoch.set_deadline(&instance, 10);
+//!
+//! let ticker = {
+//!     let epoch = epoch.clone();
+//!     thread::spawn(move || {
+//!         for _ in 0..10 {
+//!             thread::sleep(Duration::from_millis(1));
+//!             epoch.increment();
+//!         }
+//!     })
+//! };
+//!
+//! let spin = instance.exports.get_function("spin").unwrap();
+//! assert!(spin.call(&[]).is_err());
+//! assert!(is_interrupted(&instance));
+//! # ticker.join().unwrap();
+//! ```
+
+use loupe::{MemoryUsage, MemoryUsageTracker};
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, HashMap};
+use std::convert::TryInto;
+use std::fmt;
+use std::mem;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+use wasmer::wasmparser::{Operator, Type as WpType, TypeOrFuncType as WpTypeOrFuncType};
+use wasmer::{
+    ExportIndex, Exportable, FunctionMiddleware, Global, GlobalInit, GlobalType, Instance,
+    LocalFunctionIndex, MiddlewareError, MiddlewareReaderState, ModuleMiddleware, Mutability, Type,
+};
+use wasmer_types::{GlobalIndex, ModuleInfo};
+
+/// The name of the exported global holding the interruption flag.
+const INTERRUPTED_GLOBAL: &str = "wasmer_epoch_interrupted";
+
+/// The module-level epoch interruption middleware.
+///
+/// It keeps no state of its own: the global index of the interruption
+/// flag is read back from the `ModuleInfo` of each module, so an
+/// instance of `EpochInterruption` can be shared among different
+/// modules.
+///
+/// # Example
+///
+/// ```rust
+/// use std::sync::Arc;
+/// use wasmer::CompilerConfig;
+/// use wasmer_middlewares::EpochInterruption;
+///
+/// fn create_epoch_interruption_middleware(compiler_config: &mut dyn CompilerConfig) {
+///     compiler_config.push_middleware(Arc::new(EpochInterruption::new()));
+/// }
+/// ```
+#[derive(Debug, Default)]
+pub struct EpochInterruption {}
+
+/// The function-level epoch interruption middleware.
+pub struct FunctionEpochInterruption {
+    /// The global index of the interruption flag, if the module is
+    /// known.
+    global_index: Option<GlobalIndex>,
+
+    /// Whether the check at the entry of the function has been
+    /// inserted.
+    entered: bool,
+}
+
+impl EpochInterruption {
+    /// Creates an `EpochInterruption` middleware.
+    pub fn new() -> Self {
+        Self::default()
+    }
+}
+
+impl ModuleMiddleware for EpochInterruption {
+    /// Generates a `FunctionMiddleware` for a given function.
+    ///
+    /// Without the `ModuleInfo`, the interruption flag can't be found:
+    /// the function middleware fails on the first operator.
+    fn generate_function_middleware(&self, _: LocalFunctionIndex) -> Box<dyn FunctionMiddleware> {
+        Box::new(FunctionEpochInterruption {
+            global_index: None,
+            entered: false,
+        })
+    }
+
+    /// Generates a `FunctionMiddleware` for a given function of a given
+    /// module.
+    fn generate_function_middleware_for_module(
+        &self,
+        module_info: &ModuleInfo,
+        _: LocalFunctionIndex,
+    ) -> Box<dyn FunctionMiddleware> {
+        let global_index = match module_info.exports.get(INTERRUPTED_GLOBAL) {
+            Some(ExportIndex::Global(global_index)) => Some(*global_index),
+            _ => None,
+        };
+
+        Box::new(FunctionEpochInterruption {
+            global_index,
+            entered: false,
+        })
+    }
+
+    /// Transforms a `ModuleInfo` struct in-place. This is called before application on functions begins.
+    fn transform_module_info(&self, module_info: &mut ModuleInfo) {
+        // Append a global for the interruption flag and initialize it.
+        let interrupted_global_index = module_info
+            .globals
+            .push(GlobalType::new(Type::I32, Mutability::Var));
+
+        module_info
+            .global_initializers
+            .push(GlobalInit::I32Const(0));
+
+        module_info.exports.insert(
+            INTERRUPTED_GLOBAL.to_string(),
+            ExportIndex::Global(interrupted_global_index),
+        );
+
+        // The flag is raised by the host while the functions run, so
+        // the compilers must read it at each check, even in a loop.
+        module_info
+            .volatile_globals
+            .insert(interrupted_global_index);
+    }
+}
+
+impl MemoryUsage for EpochInterruption {
+    fn size_of_val(&self, _: &mut dyn MemoryUsageTracker) -> usize {
+        mem::size_of_val(self)
+    }
+}
+
+impl fmt::Debug for FunctionEpochInterruption {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("FunctionEpochInterruption")
+            .field("global_index", &self.global_index)
+            .finish()
+    }
+}
+
+impl FunctionEpochInterruption {
+    /// if globals[interrupted_index] != 0 { throw(); }
+    fn check<'a>(global_index: GlobalIndex) -> [Operator<'a>; 4] {
+        [
+            Operator::GlobalGet {
+                global_index: global_index.as_u32(),
+            },
+            Operator::If {
+                ty: WpTypeOrFuncType::Type(WpType::EmptyBlockType),
+            },
+            Operator::Unreachable,
+            Operator::End,
+        ]
+    }
+}
+
+impl FunctionMiddleware for FunctionEpochInterruption {
+    fn feed<'a>(
+        &mut self,
+        operator: Operator<'a>,
+        state: &mut MiddlewareReaderState<'a>,
+    ) -> Result<(), MiddlewareError> {
+        let global_index = self.global_index.ok_or_else(|| {
+            MiddlewareError::new(
+                "EpochInterruption",
+                "the interruption flag is missing from the module",
+            )
+        })?;
+
+        if !self.entered {
+            state.extend(Self::check(global_index).iter());
+            self.entered = true;
+        }
+
+        // The check goes inside the loop, so that it runs on every
+        // iteration.
+        let is_loop = matches!(operator, Operator::Loop { .. });
+        state.push_operator(operator);
+
+        if is_loop {
+            state.extend(Self::check(global_index).iter());
+        }
+
+        Ok(())
+    }
+}
+
+/// What to do with an instance when its deadline is reached, as
+/// decided by the callback given to [`Epoch::set_deadline_callback`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EpochDeadlineAction {
+    /// Interrupt the instance: its execution traps at the next check.
+    Interrupt,
+    /// Let the instance run for the given number of ticks more.
+    Extend(u64),
+}
+
+type DeadlineCallback = Box<dyn FnMut() -> EpochDeadlineAction + Send>;
+
+struct Deadline {
+    /// The epoch at which the deadline is reached.
+    epoch: u64,
+    /// The interruption flag of the instance, which only holds a weak
+    /// reference to the instance.
+    interrupted: Global,
+    /// The callback deciding what to do once the deadline is reached.
+    /// It is taken out while it runs.
+    callback: Option<DeadlineCallback>,
+    /// Whether the callback is running, in which case the deadline is
+    /// not queued.
+    running: bool,
+}
+
+struct EpochState {
+    /// The pending deadlines, by the sequence number given when they
+    /// were set.
+    deadlines: HashMap<u64, Deadline>,
+    /// The epochs of the pending deadlines, earliest first, with their
+    /// sequence number. The entries of deadlines that have been
+    /// cleared, replaced or extended since are skipped.
+    queue: BinaryHeap<Reverse<(u64, u64)>>,
+    next_sequence: u64,
+}
+
+/// A counter of ticks, incremented by the host, against which the
+/// deadlines of instances are checked. See the module documentation.
+///
+/// An `Epoch` only keeps the interruption flags of the instances that
+/// have a pending deadline, not the instances themselves. The flag of
+/// a dropped instance stays allocated until its deadline is reached
+/// or cleared with [`Epoch::clear_deadline`].
+pub struct Epoch {
+    current: AtomicU64,
+    /// The earliest epoch at which a deadline may be reached, so that
+    /// most ticks don't need to lock `state`.
+    next_deadline: AtomicU64,
+    state: Mutex<EpochState>,
+}
+
+impl Epoch {
+    /// Creates a new epoch, starting at 0.
+    pub fn new() -> Self {
+        Self {
+            current: AtomicU64::new(0),
+            next_deadline: AtomicU64::new(u64::MAX),
+            state: Mutex::new(EpochState {
+                deadlines: HashMap::new(),
+                queue: BinaryHeap::new(),
+                next_sequence: 0,
+            }),
+        }
+    }
+
+    /// Returns the current epoch.
+    pub fn current(&self) -> u64 {
+        self.current.load(Ordering::SeqCst)
+    }
+
+    /// Increments the epoch by one tick, and interrupts the instances
+    /// whose deadline is reached. Returns the new epoch.
+    ///
+    /// Unless a deadline is reached, a tick costs a single atomic
+    /// increment, whatever the number of instances.
+    ///
+    /// The deadline callbacks are called on the current thread, once
+    /// the epoch is unlocked, so they may call the methods of this
+    /// epoch, e.g. to set another deadline.
+    pub fn increment(&self) -> u64 {
+        let current = self.current.fetch_add(1, Ordering::SeqCst) + 1;
+
+        if current < self.next_deadline.load(Ordering::SeqCst) {
+            return current;
+        }
+
+        for (sequence, mut callback) in self.expire(current) {
+            let action = callback();
+            self.resume(sequence, callback, action);
+        }
+
+        current
+    }
+
+    /// Interrupts `instance` once the epoch has been incremented
+    /// `ticks` times from now. It replaces any pending deadline of the
+    /// instance, and clears its interruption flag.
+    ///
+    /// # Panic
+    ///
+    /// The given [`Instance`][wasmer::Instance] must have been processed
+    /// with the [`EpochInterruption`] middleware at compile time,
+    /// otherwise this will panic.
+    pub fn set_deadline(&self, instance: &Instance, ticks: u64) {
+        self.insert_deadline(instance, ticks, None);
+    }
+
+    /// Like [`Epoch::set_deadline`], but calls `callback`, on the
+    /// thread incrementing the epoch, when the deadline is reached.
+    /// The callback decides whether the instance is interrupted or gets
+    /// more time.
+    pub fn set_deadline_callback<F>(&self, instance: &Instance, ticks: u64, callback: F)
+    where
+        F: FnMut() -> EpochDeadlineAction + Send + 'static,
+    {
+        self.insert_deadline(instance, ticks, Some(Box::new(callback)));
+    }
+
+    /// Removes the pending deadline of `instance`, if any.
+    ///
+    /// A callback that is running on another thread is not waited for,
+    /// but its decision is ignored.
+    pub fn clear_deadline(&self, instance: &Instance) {
+        let interrupted = interrupted_global(instance);
+        let mut state = self.state.lock().unwrap();
+
+        Self::remove_deadline(&mut state, &interrupted);
+    }
+
+    fn insert_deadline(&self, instance: &Instance, ticks: u64, callback: Option<DeadlineCallback>) {
+        // The flag outlives the instance, which a pending deadline must
+        // not keep alive.
+        let mut interrupted = interrupted_global(instance);
+        Exportable::into_weak_instance_ref(&mut interrupted);
+
+        let mut state = self.state.lock().unwrap();
+        Self::remove_deadline(&mut state, &interrupted);
+        set_interrupted(&interrupted, false);
+
+        let epoch = self.current().saturating_add(ticks);
+        let sequence = state.next_sequence;
+        state.next_sequence += 1;
+        state.deadlines.insert(
+            sequence,
+            Deadline {
+                epoch,
+                interrupted,
+                callback,
+                running: false,
+            },
+        );
+        state.queue.push(Reverse((epoch, sequence)));
+        self.update_next_deadline(&state);
+    }
+
+    fn remove_deadline(state: &mut EpochState, interrupted: &Global) {
+        state
+            .deadlines
+            .retain(|_, deadline| !deadline.interrupted.same(interrupted));
+
+        // Deadlines that are replaced before they are reached leave
+        // their entry in the queue: drop them once they are the
+        // majority, so that the queue doesn't grow without bound.
+        if state.queue.len() > 2 * state.deadlines.len() + 16 {
+            state.queue = state
+                .deadlines
+                .iter()
+                .filter(|(_, deadline)| !deadline.running)
+                .map(|(sequence, deadline)| Reverse((deadline.epoch, *sequence)))
+                .collect();
+        }
+    }
+
+    /// Interrupts the instances whose deadline is reached at `current`
+    /// and has no callback, and returns the callbacks of the others,
+    /// to be called once the state is unlocked.
+    fn expire(&self, current: u64) -> Vec<(u64, DeadlineCallback)> {
+        let mut state = self.state.lock().unwrap();
+        let state = &mut *state;
+        let mut callbacks = vec![];
+
+        while let Some(&Reverse((epoch, sequence))) = state.queue.peek() {
+            if epoch > current {
+                break;
+            }
+
+            state.queue.pop();
+
+            let deadline = match state.deadlines.get_mut(&sequence) {
+                Some(deadline) if deadline.epoch == epoch && !deadline.running => deadline,
+                _ => continue,
+            };
+
+            match deadline.callback.take() {
+                Some(callback) => {
+                    deadline.running = true;
+                    callbacks.push((sequence, callback));
+                }
+                None => {
+                    let deadline = state.deadlines.remove(&sequence).unwrap();
+                    set_interrupted(&deadline.interrupted, true);
+                }
+            }
+        }
+
+        self.update_next_deadline(state);
+
+        callbacks
+    }
+
+    /// Applies the decision of the callback of a deadline, unless the
+    /// deadline has been cleared or replaced while the callback ran.
+    fn resume(&self, sequence: u64, callback: DeadlineCallback, action: EpochDeadlineAction) {
+        let mut state = self.state.lock().unwrap();
+        let state = &mut *state;
+
+        let deadline = match state.deadlines.get_mut(&sequence) {
+            Some(deadline) => deadline,
+            None => return,
+        };
+
+        match action {
+            EpochDeadlineAction::Interrupt => {
+                let deadline = state.deadlines.remove(&sequence).unwrap();
+                set_interrupted(&deadline.interrupted, true);
+            }
+            EpochDeadlineAction::Extend(ticks) => {
+                let epoch = self.current().saturating_add(ticks.max(1));
+                deadline.epoch = epoch;
+                deadline.callback = Some(callback);
+                deadline.running = false;
+                state.queue.push(Reverse((epoch, sequence)));
+                self.update_next_deadline(state);
+            }
+        }
+    }
+
+    fn update_next_deadline(&self, state: &EpochState) {
+        let next_deadline = state
+            .queue
+            .peek()
+            .map_or(u64::MAX, |Reverse((epoch, _))| *epoch);
+
+        self.next_deadline.store(next_deadline, Ordering::SeqCst);
+    }
+}
+
+impl Default for Epoch {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl fmt::Debug for Epoch {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let state = self.state.lock().unwrap();
+
+        f.debug_struct("Epoch")
+            .field("current", &self.current())
+            .field("deadlines", &state.deadlines.len())
+            .finish()
+    }
+}
+
+fn interrupted_global(instance: &Instance) -> Global {
+    instance
+        .exports
+        .get_global(INTERRUPTED_GLOBAL)
+        .expect("Can't get `wasmer_epoch_interrupted` from Instance")
+        .clone()
+}
+
+fn set_interrupted(global: &Global, interrupted: bool) {
+    global
+        .set((interrupted as i32).into())
+        .expect("Can't set `wasmer_epoch_interrupted` in Instance");
+}
+
+/// Checks whether an [`Instance`][wasmer::Instance] has been
+/// interrupted because its deadline was reached.
+///
+/// # Panic
+///
+/// The given [`Instance`][wasmer::Instance] must have been processed
+/// with the [`EpochInterruption`] middleware at compile time,
+/// otherwise this will panic.
+pub fn is_interrupted(instance: &Instance) -> bool {
+    let interrupted: i32 = interrupted_global(instance)
+        .get()
+        .try_into()
+        .expect("`wasmer_epoch_interrupted` from Instance has wrong type");
+
+    interrupted != 0
+}
+
+/// Clears the interruption flag of an [`Instance`][wasmer::Instance],
+/// so that it can run again, without any deadline.
+///
+/// # Panic
+///
+/// The given [`Instance`][wasmer::Instance] must have been processed
+/// with the [`EpochInterruption`] middleware at compile time,
+/// otherwise this will panic.
+pub fn clear_interrupted(instance: &Instance) {
+    set_interrupted(&interrupted_global(instance), false);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    use std::sync::Arc;
+    use wasmer::{imports, wat2wasm, CompilerConfig, Cranelift, Module, Store, Universal};
+
+    fn store() -> Store {
+        let mut compiler_config = Cranelift::default();
+        compiler_config.push_middleware(Arc::new(EpochInterruption::new()));
+        Store::new(&Universal::new(compiler_config).engine())
+    }
+
+    fn instance() -> Instance {
+        instance_in(&store())
+    }
+
+    fn instance_in(store: &Store) -> Instance {
+        let module = Module::new(
+            store,
+            wat2wasm(
+                br#"
+                (module
+                (func (export "add_one") (param i32) (result i32)
+                    local.get 0
+                    i32.const 1
+                    i32.add))
+                "#,
+            )
+            .unwrap(),
+        )
+        .unwrap();
+
+        Instance::new(&module, &imports! {}).unwrap()
+    }
+
+    #[test]
+    fn deadline_interrupts() {
+        let instance = instance();
+        let add_one = instance
+            .exports
+            .get_function("add_one")
+            .unwrap()
+            .native::<i32, i32>()
+            .unwrap();
+
+        let epoch = Epoch::new();
+        epoch.set_deadline(&instance, 2);
+
+        assert_eq!(epoch.increment(), 1);
+        assert_eq!(add_one.call(1).unwrap(), 2);
+        assert!(!is_interrupted(&instance));
+
+        assert_eq!(epoch.increment(), 2);
+        assert!(is_interrupted(&instance));
+        assert!(add_one.call(1).is_err());
+
+        clear_interrupted(&instance);
+        assert_eq!(add_one.call(1).unwrap(), 2);
+    }
+
+    #[test]
+    fn deadline_callback_extends() {
+        let instance = instance();
+        let epoch = Epoch::new();
+        let mut extensions = 2;
+
+        epoch.set_deadline_callback(&instance, 1, move || {
+            if extensions > 0 {
+                extensions -= 1;
+                EpochDeadlineAction::Extend(1)
+            } else {
+                EpochDeadlineAction::Interrupt
+            }
+        });
+
+        epoch.increment();
+        epoch.increment();
+        assert!(!is_interrupted(&instance));
+        epoch.increment();
+        assert!(is_interrupted(&instance));
+
+        // A cleared deadline is never reached.
+        epoch.set_deadline(&instance, 1);
+        epoch.clear_deadline(&instance);
+        epoch.increment();
+        assert!(!is_interrupted(&instance));
+    }
+
+    #[test]
+    fn middleware_shared_by_modules() {
+        // Both modules are compiled with the same middleware.
+        let store = store();
+        let first = instance_in(&store);
+        let second = instance_in(&store);
+
+        let epoch = Epoch::new();
+        epoch.set_deadline(&first, 1);
+        epoch.set_deadline(&second, 2);
+
+        epoch.increment();
+        assert!(is_interrupted(&first));
+        assert!(!is_interrupted(&second));
+        epoch.increment();
+        assert!(is_interrupted(&second));
+    }
+
+    #[test]
+    fn deadline_callback_sets_deadline() {
+        let first = instance();
+        let second = instance();
+        let epoch = Arc::new(Epoch::new());
+
+        // The callback runs once the epoch is unlocked, so it can set
+        // deadlines itself.
+        let (callback_epoch, callback_second) = (epoch.clone(), second.clone());
+        epoch.set_deadline_callback(&first, 1, move || {
+            callback_epoch.set_deadline(&callback_second, 1);
+            EpochDeadlineAction::Interrupt
+        });
+
+        epoch.increment();
+        assert!(is_interrupted(&first));
+        assert!(!is_interrupted(&second));
+        epoch.increment();
+        assert!(is_interrupted(&second));
+    }
+
+    #[test]
+    fn replaced_deadlines_are_not_reached() {
+        let instance = instance();
+        let epoch = Epoch::new();
+
+        for _ in 0..100 {
+            epoch.set_deadline(&instance, 2);
+        }
+        epoch.increment();
+        assert!(!is_interrupted(&instance));
+
+        epoch.set_deadline(&instance, 3);
+        epoch.increment();
+        epoch.increment();
+        assert!(!is_interrupted(&instance));
+        epoch.increment();
+        assert!(is_interrupted(&instance));
+    }
+}
@@ -1,6 +1,8 @@
+pub mod epoch;
 pub mod metering;
 
 // The most commonly used symbol are exported at top level of the
 // module. Others are available via modules,
 // e.g. `wasmer_middlewares::metering::get_remaining_points`
+pub use epoch::EpochInterruption;
 pub use metering::Metering;
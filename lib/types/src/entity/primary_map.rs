@@ -161,6 +161,34 @@ where
     }
 }
 
+/// Access to an archived `PrimaryMap` in place, without deserializing it.
+#[cfg(feature = "enable-rkyv")]
+impl<K, V> ArchivedPrimaryMap<K, V>
+where
+    K: EntityRef,
+    V: Archive,
+{
+    /// Get the archived element at `k` if it exists.
+    pub fn get(&self, k: K) -> Option<&V::Archived> {
+        self.elems.get(k.index())
+    }
+
+    /// Get the total number of entity references created.
+    pub fn len(&self) -> usize {
+        self.elems.len()
+    }
+
+    /// Check if the map is empty.
+    pub fn is_empty(&self) -> bool {
+        self.elems.is_empty()
+    }
+
+    /// Iterate over all the archived values in this map.
+    pub fn values(&self) -> slice::Iter<V::Archived> {
+        self.elems.iter()
+    }
+}
+
 impl<K, V> Default for PrimaryMap<K, V>
 where
     K: EntityRef,
@@ -88,7 +88,8 @@ pub use crate::memory_view::{Atomically, MemoryView};
 pub use crate::module::{ExportsIterator, ImportsIterator, ModuleInfo};
 pub use crate::native::{NativeWasmType, ValueType};
 pub use crate::units::{
-    Bytes, PageCountOutOfRange, Pages, WASM_MAX_PAGES, WASM_MIN_PAGES, WASM_PAGE_SIZE,
+    Bytes, PageCountOutOfRange, Pages, WASM64_MAX_PAGES, WASM_MAX_PAGES, WASM_MIN_PAGES,
+    WASM_PAGE_SIZE,
 };
 pub use crate::values::{Value, WasmValueType};
 pub use types::{
@@ -103,6 +103,45 @@ pub enum LibCall {
     /// data.drop
     DataDrop,
 
+    /// memory.size for local 64-bit memories
+    Memory64Size,
+
+    /// memory.size for imported 64-bit memories
+    ImportedMemory64Size,
+
+    /// memory.copy for local 64-bit memories
+    Memory64Copy,
+
+    /// memory.copy for imported 64-bit memories
+    ImportedMemory64Copy,
+
+    /// memory.fill for local 64-bit memories
+    Memory64Fill,
+
+    /// memory.fill for imported 64-bit memories
+    ImportedMemory64Fill,
+
+    /// memory.init for 64-bit memories
+    Memory64Init,
+
+    /// memory.atomic.wait32 for local memories
+    Memory32AtomicWait32,
+
+    /// memory.atomic.wait32 for imported memories
+    ImportedMemory32AtomicWait32,
+
+    /// memory.atomic.wait64 for local memories
+    Memory32AtomicWait64,
+
+    /// memory.atomic.wait64 for imported memories
+    ImportedMemory32AtomicWait64,
+
+    /// memory.atomic.notify for local memories
+    Memory32AtomicNotify,
+
+    /// memory.atomic.notify for imported memories
+    ImportedMemory32AtomicNotify,
+
     /// A custom trap
     RaiseTrap,
 
@@ -144,6 +183,19 @@ impl LibCall {
             Self::ImportedMemory32Fill => "wasmer_vm_imported_memory32_fill",
             Self::Memory32Init => "wasmer_vm_memory32_init",
             Self::DataDrop => "wasmer_vm_data_drop",
+            Self::Memory64Size => "wasmer_vm_memory64_size",
+            Self::ImportedMemory64Size => "wasmer_vm_imported_memory64_size",
+            Self::Memory64Copy => "wasmer_vm_memory64_copy",
+            Self::ImportedMemory64Copy => "wasmer_vm_imported_memory64_copy",
+            Self::Memory64Fill => "wasmer_vm_memory64_fill",
+            Self::ImportedMemory64Fill => "wasmer_vm_imported_memory64_fill",
+            Self::Memory64Init => "wasmer_vm_memory64_init",
+            Self::Memory32AtomicWait32 => "wasmer_vm_memory32_atomic_wait32",
+            Self::ImportedMemory32AtomicWait32 => "wasmer_vm_imported_memory32_atomic_wait32",
+            Self::Memory32AtomicWait64 => "wasmer_vm_memory32_atomic_wait64",
+            Self::ImportedMemory32AtomicWait64 => "wasmer_vm_imported_memory32_atomic_wait64",
+            Self::Memory32AtomicNotify => "wasmer_vm_memory32_atomic_notify",
+            Self::ImportedMemory32AtomicNotify => "wasmer_vm_imported_memory32_atomic_notify",
             Self::RaiseTrap => "wasmer_vm_raise_trap",
             // We have to do this because macOS requires a leading `_` and it's not
             // a normal function, it's a static variable, so we have to do it manually.
@@ -25,7 +25,7 @@ use rkyv::{
 use serde::{Deserialize, Serialize};
 #[cfg(feature = "enable-rkyv")]
 use std::collections::BTreeMap;
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
 use std::fmt;
 use std::iter::ExactSizeIterator;
 use std::sync::atomic::{AtomicUsize, Ordering::SeqCst};
@@ -132,6 +132,14 @@ pub struct ModuleInfo {
 
     /// Number of imported globals in the module.
     pub num_imported_globals: usize,
+
+    /// Mutable globals that the host may write while the module runs,
+    /// e.g. the flags set by middlewares, and whose reads must not be
+    /// hoisted or merged by the compilers.
+    ///
+    /// It only matters at compile time, so it is not serialized.
+    #[cfg_attr(feature = "enable-serde", serde(skip_serializing, skip_deserializing))]
+    pub volatile_globals: HashSet<GlobalIndex>,
 }
 
 /// Mirror version of ModuleInfo that can derive rkyv traits
@@ -213,6 +221,7 @@ impl From<ArchivableModuleInfo> for ModuleInfo {
             num_imported_tables: it.num_imported_tables,
             num_imported_memories: it.num_imported_memories,
             num_imported_globals: it.num_imported_globals,
+            volatile_globals: Default::default(),
         }
     }
 }
@@ -254,7 +263,8 @@ impl<D: Fallible + ?Sized + SharedDeserializeRegistry> RkyvDeserialize<ModuleInf
     }
 }
 
-// For test serialization correctness, everything except module id should be same
+// For test serialization correctness, everything except module id and
+// volatile globals should be same
 impl PartialEq for ModuleInfo {
     fn eq(&self, other: &Self) -> bool {
         self.name == other.name
@@ -4,7 +4,7 @@ use crate::lib::std::fmt;
 use crate::lib::std::format;
 use crate::lib::std::string::{String, ToString};
 use crate::lib::std::vec::Vec;
-use crate::units::Pages;
+use crate::units::{Pages, WASM64_MAX_PAGES};
 use crate::values::{Value, WasmValueType};
 use loupe::{MemoryUsage, MemoryUsageTracker};
 
@@ -178,11 +178,13 @@ fn is_memory_compatible(exported: &MemoryType, imported: &MemoryType) -> bool {
         minimum: exported_minimum,
         maximum: exported_maximum,
         shared: exported_shared,
+        memory64: exported_memory64,
     } = exported;
     let MemoryType {
         minimum: imported_minimum,
         maximum: imported_maximum,
         shared: imported_shared,
+        memory64: imported_memory64,
     } = imported;
 
     imported_minimum <= exported_minimum
@@ -190,6 +192,7 @@ fn is_memory_compatible(exported: &MemoryType, imported: &MemoryType) -> bool {
             || (!exported_maximum.is_none()
                 && imported_maximum.unwrap() >= exported_maximum.unwrap()))
         && exported_shared == imported_shared
+        && exported_memory64 == imported_memory64
 }
 
 macro_rules! accessors {
@@ -534,6 +537,9 @@ pub struct MemoryType {
     pub maximum: Option<Pages>,
     /// Whether the memory may be shared between multiple threads.
     pub shared: bool,
+    /// Whether the memory is indexed with 64-bit addresses, as defined
+    /// by the memory64 proposal.
+    pub memory64: bool,
 }
 
 impl MemoryType {
@@ -547,6 +553,29 @@ impl MemoryType {
             minimum: minimum.into(),
             maximum: maximum.map(Into::into),
             shared,
+            memory64: false,
+        }
+    }
+
+    /// Creates a new descriptor for a 64-bit WebAssembly memory given
+    /// the specified limits of the memory.
+    pub fn new64<IntoPages>(minimum: IntoPages, maximum: Option<IntoPages>, shared: bool) -> Self
+    where
+        IntoPages: Into<Pages>,
+    {
+        Self {
+            memory64: true,
+            ..Self::new(minimum, maximum, shared)
+        }
+    }
+
+    /// Returns the largest number of pages the memory can be indexed
+    /// with, whatever its declared maximum.
+    pub fn page_limit(&self) -> Pages {
+        if self.memory64 {
+            Pages(WASM64_MAX_PAGES)
+        } else {
+            Pages::max_value()
         }
     }
 }
@@ -554,10 +583,11 @@ impl MemoryType {
 impl fmt::Display for MemoryType {
     fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
         let shared = if self.shared { "shared" } else { "not shared" };
+        let index = if self.memory64 { " 64-bit" } else { "" };
         if let Some(maximum) = self.maximum {
-            write!(f, "{} ({:?}..{:?})", shared, self.minimum, maximum)
+            write!(f, "{}{} ({:?}..{:?})", shared, index, self.minimum, maximum)
         } else {
-            write!(f, "{} ({:?}..)", shared, self.minimum)
+            write!(f, "{}{} ({:?}..)", shared, index, self.minimum)
         }
     }
 }
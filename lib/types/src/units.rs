@@ -18,6 +18,13 @@ pub const WASM_PAGE_SIZE: usize = 0x10000;
 /// The number of pages we can have before we run out of byte index space.
 pub const WASM_MAX_PAGES: u32 = 0x10000;
 
+/// The number of pages a 64-bit memory can have.
+///
+/// The memory64 proposal allows up to 2^48 pages, but this is limited
+/// by the `Pages` type, which is still far beyond the address space of
+/// current hosts.
+pub const WASM64_MAX_PAGES: u32 = u32::MAX;
+
 /// The minimum number of pages allowed.
 pub const WASM_MIN_PAGES: u32 = 0x100;
 
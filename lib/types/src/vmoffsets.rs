@@ -124,9 +124,75 @@ impl VMBuiltinFunctionIndex {
     pub const fn get_externref_dec_index() -> Self {
         Self(25)
     }
+    /// Returns an index for wasm's `memory.atomic.wait32` for locally
+    /// defined memories.
+    pub const fn get_memory_atomic_wait32_index() -> Self {
+        Self(26)
+    }
+    /// Returns an index for wasm's `memory.atomic.wait32` for imported
+    /// memories.
+    pub const fn get_imported_memory_atomic_wait32_index() -> Self {
+        Self(27)
+    }
+    /// Returns an index for wasm's `memory.atomic.wait64` for locally
+    /// defined memories.
+    pub const fn get_memory_atomic_wait64_index() -> Self {
+        Self(28)
+    }
+    /// Returns an index for wasm's `memory.atomic.wait64` for imported
+    /// memories.
+    pub const fn get_imported_memory_atomic_wait64_index() -> Self {
+        Self(29)
+    }
+    /// Returns an index for wasm's `memory.atomic.notify` for locally
+    /// defined memories.
+    pub const fn get_memory_atomic_notify_index() -> Self {
+        Self(30)
+    }
+    /// Returns an index for wasm's `memory.atomic.notify` for imported
+    /// memories.
+    pub const fn get_imported_memory_atomic_notify_index() -> Self {
+        Self(31)
+    }
+    /// Returns an index for wasm's `memory.grow` for locally defined 64-bit memories.
+    pub const fn get_memory64_grow_index() -> Self {
+        Self(32)
+    }
+    /// Returns an index for wasm's `memory.grow` for imported 64-bit memories.
+    pub const fn get_imported_memory64_grow_index() -> Self {
+        Self(33)
+    }
+    /// Returns an index for wasm's `memory.size` for locally defined 64-bit memories.
+    pub const fn get_memory64_size_index() -> Self {
+        Self(34)
+    }
+    /// Returns an index for wasm's `memory.size` for imported 64-bit memories.
+    pub const fn get_imported_memory64_size_index() -> Self {
+        Self(35)
+    }
+    /// Returns an index for wasm's `memory.copy` for locally defined 64-bit memories.
+    pub const fn get_memory64_copy_index() -> Self {
+        Self(36)
+    }
+    /// Returns an index for wasm's `memory.copy` for imported 64-bit memories.
+    pub const fn get_imported_memory64_copy_index() -> Self {
+        Self(37)
+    }
+    /// Returns an index for wasm's `memory.fill` for locally defined 64-bit memories.
+    pub const fn get_memory64_fill_index() -> Self {
+        Self(38)
+    }
+    /// Returns an index for wasm's `memory.fill` for imported 64-bit memories.
+    pub const fn get_imported_memory64_fill_index() -> Self {
+        Self(39)
+    }
+    /// Returns an index for wasm's `memory.init` for 64-bit memories.
+    pub const fn get_memory64_init_index() -> Self {
+        Self(40)
+    }
     /// Returns the total number of builtin functions.
     pub const fn builtin_functions_total_number() -> u32 {
-        26
+        41
     }
 
     /// Return the index as an u32 number.
@@ -11,6 +11,8 @@ use loupe::MemoryUsage;
 use std::mem;
 use std::sync::Arc;
 use wasmer_artifact::{MetadataHeader, SerializeError};
+#[cfg(feature = "compiler")]
+use wasmer_compiler::Compilation;
 use wasmer_compiler::{
     CompileError, CompileModuleInfo, CompiledFunctionFrameInfo, CpuFeature, CustomSection, Dwarf,
     Features, FunctionBody, ModuleEnvironment, ModuleMiddlewareChain, Relocation, SectionIndex,
@@ -75,15 +77,31 @@ impl UniversalArtifactBuild {
             translation.module_translation_state.as_ref().unwrap(),
             translation.function_body_inputs,
         )?;
-        let function_call_trampolines = compilation.get_function_call_trampolines();
-        let dynamic_function_trampolines = compilation.get_dynamic_function_trampolines();
-
         let data_initializers = translation
             .data_initializers
             .iter()
             .map(OwnedDataInitializer::new)
             .collect::<Vec<_>>()
             .into_boxed_slice();
+        Ok(Self::from_compilation(
+            compilation,
+            compile_info,
+            data_initializers,
+            target,
+        ))
+    }
+
+    /// Assembles a `UniversalArtifactBuild` from the compilation of a
+    /// module and the data initializers of the module.
+    #[cfg(feature = "compiler")]
+    pub fn from_compilation(
+        compilation: Compilation,
+        compile_info: CompileModuleInfo,
+        data_initializers: Box<[OwnedDataInitializer]>,
+        target: &Target,
+    ) -> Self {
+        let function_call_trampolines = compilation.get_function_call_trampolines();
+        let dynamic_function_trampolines = compilation.get_dynamic_function_trampolines();
 
         let frame_infos = compilation.get_frame_info();
 
@@ -113,7 +131,7 @@ impl UniversalArtifactBuild {
             data_initializers,
             cpu_features: target.cpu_features().as_u64(),
         };
-        Ok(Self { serializable })
+        Self { serializable }
     }
 
     /// Compile a data buffer into a `UniversalArtifactBuild`, which may then be instantiated.
@@ -129,6 +147,14 @@ impl UniversalArtifactBuild {
         Self { serializable }
     }
 
+    /// Replace the module information of this artifact with `module`,
+    /// so that several artifacts of the same module, e.g. compiled by
+    /// different compilers, share it. The caller must ensure that
+    /// `module` describes the module this artifact was compiled from.
+    pub fn share_module(&mut self, module: Arc<ModuleInfo>) {
+        self.serializable.compile_info.module = module;
+    }
+
     /// Get the default extension when serializing this artifact
     pub fn get_default_extension(_triple: &Triple) -> &'static str {
         // `.wasmu` is the default extension for all the triples. It
@@ -1,6 +1,7 @@
 //! Universal compilation.
 
 use loupe::MemoryUsage;
+use std::sync::Arc;
 use wasmer_compiler::CompileError;
 #[cfg(feature = "compiler")]
 use wasmer_compiler::Compiler;
@@ -11,7 +12,7 @@ use wasmer_types::Features;
 pub struct UniversalEngineBuilder {
     /// The compiler
     #[cfg(feature = "compiler")]
-    compiler: Option<Box<dyn Compiler>>,
+    compiler: Option<Arc<dyn Compiler>>,
     /// The features to compile the Wasm module with
     features: Features,
 }
@@ -19,7 +20,10 @@ pub struct UniversalEngineBuilder {
 impl UniversalEngineBuilder {
     /// Create a new builder with pre-made components
     pub fn new(compiler: Option<Box<dyn Compiler>>, features: Features) -> Self {
-        UniversalEngineBuilder { compiler, features }
+        UniversalEngineBuilder {
+            compiler: compiler.map(Arc::from),
+            features,
+        }
     }
 
     /// Gets the compiler associated to this engine.
@@ -33,6 +37,15 @@ impl UniversalEngineBuilder {
         Ok(&**self.compiler.as_ref().unwrap())
     }
 
+    /// Gets the compiler associated to this engine, to compile with it
+    /// without borrowing the engine.
+    #[cfg(feature = "compiler")]
+    pub fn shared_compiler(&self) -> Result<Arc<dyn Compiler>, CompileError> {
+        self.compiler.clone().ok_or_else(|| {
+            CompileError::Codegen("The UniversalEngine is not compiled in.".to_string())
+        })
+    }
+
     /// Gets the compiler associated to this engine.
     #[cfg(not(feature = "compiler"))]
     pub fn compiler(&self) -> Result<&dyn Compiler, CompileError> {
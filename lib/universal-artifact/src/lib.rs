@@ -27,7 +27,7 @@ mod trampoline;
 
 pub use crate::artifact::UniversalArtifactBuild;
 pub use crate::engine::UniversalEngineBuilder;
-pub use crate::serialize::SerializableModule;
+pub use crate::serialize::{ArchivedSerializableModule, SerializableModule};
 pub use crate::trampoline::*;
 pub use wasmer_artifact::{ArtifactCreate, MetadataHeader, Upcastable};
 
@@ -78,11 +78,13 @@ impl SerializableModule {
         Self::deserialize_from_archive(archived)
     }
 
+    /// Access the archive of a Module in a slice, in place.
+    ///
     /// # Safety
     ///
     /// This method is unsafe.
     /// Please check `SerializableModule::deserialize` for more details.
-    unsafe fn archive_from_slice<'a>(
+    pub unsafe fn archive_from_slice<'a>(
         metadata_slice: &'a [u8],
     ) -> Result<&'a ArchivedSerializableModule, DeserializeError> {
         if metadata_slice.len() < 8 {
@@ -99,6 +101,57 @@ impl SerializableModule {
         ))
     }
 
+    /// Deserialize a compilation module from an archive, except for the
+    /// function bodies, the trampolines and the custom sections, which
+    /// are left empty. They are the bulk of the archive, and can be
+    /// copied straight from it into executable memory instead.
+    pub fn deserialize_metadata_from_archive(
+        archived: &ArchivedSerializableModule,
+    ) -> Result<Self, DeserializeError> {
+        let mut deserializer = SharedDeserializeMap::new();
+        let compilation = &archived.compilation;
+        let to_error = |e| DeserializeError::CorruptedBinary(format!("{:?}", e));
+        Ok(Self {
+            compilation: SerializableCompilation {
+                function_bodies: PrimaryMap::new(),
+                function_relocations: RkyvDeserialize::deserialize(
+                    &compilation.function_relocations,
+                    &mut deserializer,
+                )
+                .map_err(to_error)?,
+                function_frame_info: RkyvDeserialize::deserialize(
+                    &compilation.function_frame_info,
+                    &mut deserializer,
+                )
+                .map_err(to_error)?,
+                function_call_trampolines: PrimaryMap::new(),
+                dynamic_function_trampolines: PrimaryMap::new(),
+                custom_sections: PrimaryMap::new(),
+                custom_section_relocations: RkyvDeserialize::deserialize(
+                    &compilation.custom_section_relocations,
+                    &mut deserializer,
+                )
+                .map_err(to_error)?,
+                debug: RkyvDeserialize::deserialize(&compilation.debug, &mut deserializer)
+                    .map_err(to_error)?,
+                libcall_trampolines: RkyvDeserialize::deserialize(
+                    &compilation.libcall_trampolines,
+                    &mut deserializer,
+                )
+                .map_err(to_error)?,
+                libcall_trampoline_len: compilation.libcall_trampoline_len,
+            },
+            compile_info: RkyvDeserialize::deserialize(&archived.compile_info, &mut deserializer)
+                .map_err(to_error)?,
+            data_initializers: RkyvDeserialize::deserialize(
+                &archived.data_initializers,
+                &mut deserializer,
+            )
+            .map_err(to_error)?,
+            cpu_features: archived.cpu_features,
+        })
+    }
+
     /// Deserialize a compilation module from an archive
     pub fn deserialize_from_archive(
         archived: &ArchivedSerializableModule,
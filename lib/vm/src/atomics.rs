@@ -0,0 +1,235 @@
+//! Wait queues for `memory.atomic.wait32`, `memory.atomic.wait64` and
+//! `memory.atomic.notify`.
+//!
+//! Waiters are queued by the host address they wait on. It is the same
+//! for all the instances importing a shared memory, because shared
+//! memories never move. The queues are spread over a fixed number of
+//! buckets, each protected by its own lock, so that threads waiting on
+//! unrelated addresses don't contend. A waiting thread is parked, which
+//! is a futex wait on Linux, and is unparked by `notify`.
+
+use std::collections::{HashMap, VecDeque};
+use std::convert::TryFrom;
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread::{self, Thread};
+use std::time::{Duration, Instant};
+
+/// The result of a wait, as returned to WebAssembly.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(u32)]
+pub(crate) enum WaitResult {
+    /// The waiter has been woken up by a `notify`.
+    Ok = 0,
+    /// The value in memory was not the expected one.
+    NotEqual = 1,
+    /// The timeout has expired before a `notify`.
+    TimedOut = 2,
+}
+
+/// The error of a wait on a memory that is not shared.
+#[derive(Debug, thiserror::Error)]
+#[error("atomic wait on a non-shared memory")]
+pub(crate) struct UnsharedMemoryWait;
+
+/// The number of buckets, a power of two.
+const BUCKETS: usize = 64;
+
+struct Waiter {
+    thread: Thread,
+    woken: AtomicBool,
+}
+
+#[derive(Default)]
+struct Bucket {
+    queues: Mutex<HashMap<usize, VecDeque<Arc<Waiter>>>>,
+}
+
+lazy_static::lazy_static! {
+    static ref WAIT_QUEUES: Vec<Bucket> = (0..BUCKETS).map(|_| Bucket::default()).collect();
+}
+
+fn bucket(address: usize) -> &'static Bucket {
+    // The low bits are always 0 for aligned addresses.
+    &WAIT_QUEUES[(address >> 3) & (BUCKETS - 1)]
+}
+
+/// Waits on the 32-bit value at `address`.
+///
+/// # Safety
+/// `address` must be valid and aligned for an atomic 32-bit access.
+pub(crate) unsafe fn wait32(address: *const u8, expected: u32, timeout: i64) -> WaitResult {
+    let value = &*(address as *const AtomicU32);
+    wait(
+        address as usize,
+        || value.load(Ordering::SeqCst) == expected,
+        timeout,
+    )
+}
+
+/// Waits on the 64-bit value at `address`.
+///
+/// # Safety
+/// `address` must be valid and aligned for an atomic 64-bit access.
+pub(crate) unsafe fn wait64(address: *const u8, expected: u64, timeout: i64) -> WaitResult {
+    let value = &*(address as *const AtomicU64);
+    wait(
+        address as usize,
+        || value.load(Ordering::SeqCst) == expected,
+        timeout,
+    )
+}
+
+/// Parks the current thread until it's notified on `address`, or until
+/// `timeout` nanoseconds have elapsed if it's not negative.
+fn wait(address: usize, is_expected: impl FnOnce() -> bool, timeout: i64) -> WaitResult {
+    let bucket = bucket(address);
+    let waiter = Arc::new(Waiter {
+        thread: thread::current(),
+        woken: AtomicBool::new(false),
+    });
+
+    {
+        let mut queues = bucket.queues.lock().unwrap();
+
+        // The value is read with the lock held, so that a `notify`
+        // following a store can't be missed.
+        if !is_expected() {
+            return WaitResult::NotEqual;
+        }
+
+        queues.entry(address).or_default().push_back(waiter.clone());
+    }
+
+    let deadline = u64::try_from(timeout)
+        .ok()
+        .map(|timeout| Instant::now() + Duration::from_nanos(timeout));
+
+    loop {
+        if waiter.woken.load(Ordering::Acquire) {
+            return WaitResult::Ok;
+        }
+
+        match deadline {
+            None => thread::park(),
+            Some(deadline) => {
+                let now = Instant::now();
+
+                if now >= deadline {
+                    break;
+                }
+
+                thread::park_timeout(deadline - now);
+            }
+        }
+    }
+
+    // The timeout has expired: leave the queue, unless a `notify` has
+    // just dequeued us.
+    let mut queues = bucket.queues.lock().unwrap();
+
+    if waiter.woken.load(Ordering::Acquire) {
+        return WaitResult::Ok;
+    }
+
+    if let Some(queue) = queues.get_mut(&address) {
+        queue.retain(|other| !Arc::ptr_eq(other, &waiter));
+
+        if queue.is_empty() {
+            queues.remove(&address);
+        }
+    }
+
+    WaitResult::TimedOut
+}
+
+/// Wakes up to `count` threads waiting on `address`, in the order they
+/// started waiting, and returns the number of threads woken up.
+pub(crate) fn notify(address: *const u8, count: u32) -> u32 {
+    let address = address as usize;
+    let mut queues = bucket(address).queues.lock().unwrap();
+
+    let queue = match queues.get_mut(&address) {
+        Some(queue) => queue,
+        None => return 0,
+    };
+
+    let mut woken = 0;
+
+    while woken < count {
+        let waiter = match queue.pop_front() {
+            Some(waiter) => waiter,
+            None => break,
+        };
+
+        waiter.woken.store(true, Ordering::Release);
+        waiter.thread.unpark();
+        woken += 1;
+    }
+
+    if queue.is_empty() {
+        queues.remove(&address);
+    }
+
+    woken
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Barrier;
+
+    #[test]
+    fn wait_not_equal() {
+        let value = AtomicU32::new(1);
+
+        assert_eq!(
+            unsafe { wait32(&value as *const _ as *const u8, 0, -1) },
+            WaitResult::NotEqual
+        );
+    }
+
+    #[test]
+    fn wait_timed_out() {
+        let value = AtomicU64::new(0);
+        let address = &value as *const _ as *const u8;
+
+        assert_eq!(
+            unsafe { wait64(address, 0, 1_000_000) },
+            WaitResult::TimedOut
+        );
+
+        // The waiter has left the queue.
+        assert_eq!(notify(address, 1), 0);
+    }
+
+    #[test]
+    fn notify_wakes_waiters() {
+        static VALUE: AtomicU32 = AtomicU32::new(0);
+        let address = &VALUE as *const _ as usize;
+        let barrier = Arc::new(Barrier::new(3));
+
+        let waiters: Vec<_> = (0..2)
+            .map(|_| {
+                let barrier = barrier.clone();
+
+                thread::spawn(move || {
+                    barrier.wait();
+                    unsafe { wait32(address as *const u8, 0, -1) }
+                })
+            })
+            .collect();
+
+        barrier.wait();
+
+        let mut woken = 0;
+        while woken < 2 {
+            woken += notify(address as *const u8, 2);
+            thread::yield_now();
+        }
+
+        for waiter in waiters {
+            assert_eq!(waiter.join().unwrap(), WaitResult::Ok);
+        }
+    }
+}
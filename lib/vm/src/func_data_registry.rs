@@ -4,20 +4,43 @@
 //! This registry also helps ensure that the `VMFuncRef`s can stay valid for as
 //! long as we need them to.
 
-use crate::vmcontext::VMCallerCheckedAnyfunc;
+use crate::vmcontext::{VMCallerCheckedAnyfunc, VMContext};
 use loupe::MemoryUsage;
+use std::cell::UnsafeCell;
+use std::collections::hash_map::DefaultHasher;
 use std::collections::HashMap;
-use std::sync::Mutex;
+use std::hash::{Hash, Hasher};
+use std::mem::MaybeUninit;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{RwLock, RwLockReadGuard, RwLockWriteGuard, TryLockError};
+
+/// The number of shards, selected by the hash of the environment of the
+/// `anyfunc`.
+const SHARDS: usize = 16;
+
+/// The number of `anyfunc`s in a chunk of a shard's arena.
+const CHUNK_LEN: usize = 256;
 
 /// The registry that holds the values that `VMFuncRef`s point to.
+///
+/// The values are spread over shards by the hash of their environment, each
+/// protected by its own lock, so that threads registering functions of
+/// different instances don't contend, and registering a function that is
+/// already registered only takes a shared lock. Each shard stores its
+/// values in an arena of fixed-size chunks, so that they never move.
+///
+/// The values of an instance are released with `release_vmctx` when the
+/// instance is freed, and their slots are reused.
 #[derive(Debug, MemoryUsage)]
 pub struct FuncDataRegistry {
     // This structure is stored in an `Engine` and is intended to be shared
     // across many instances. Ideally instances can themselves be sent across
     // threads, and ideally we can compile across many threads. As a result we
-    // use interior mutability here with a lock to avoid having callers to
+    // use interior mutability here with locks to avoid having callers to
     // externally synchronize calls to compilation.
-    inner: Mutex<Inner>,
+    shards: Vec<RwLock<Shard>>,
+    #[loupe(skip)]
+    counters: Counters,
 }
 
 // We use raw pointers but the data never moves, so it's not a problem
@@ -87,35 +110,296 @@ impl std::ops::DerefMut for VMFuncRef {
 unsafe impl Send for VMFuncRef {}
 unsafe impl Sync for VMFuncRef {}
 
-#[derive(Debug, Default, MemoryUsage)]
-struct Inner {
-    func_data: Vec<Box<VMCallerCheckedAnyfunc>>,
-    anyfunc_to_index: HashMap<VMCallerCheckedAnyfunc, usize>,
+/// A chunk of a shard's arena. A slot is initialized once it has been
+/// handed out by `Shard::allocate`.
+type Chunk = Box<[UnsafeCell<MaybeUninit<VMCallerCheckedAnyfunc>>]>;
+
+#[derive(Default, MemoryUsage)]
+struct Shard {
+    anyfunc_to_slot: HashMap<VMCallerCheckedAnyfunc, usize>,
+    /// The slots in use by each environment.
+    env_to_slots: HashMap<usize, Vec<usize>>,
+    #[loupe(skip)]
+    chunks: Vec<Chunk>,
+    /// The number of slots handed out so far, in use or free.
+    allocated: usize,
+    free_slots: Vec<usize>,
+}
+
+impl std::fmt::Debug for Shard {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("Shard")
+            .field("anyfunc_to_slot", &self.anyfunc_to_slot)
+            .field("env_to_slots", &self.env_to_slots)
+            .field("chunks", &self.chunks.len())
+            .field("free_slots", &self.free_slots)
+            .finish()
+    }
+}
+
+impl Shard {
+    fn slot_ptr(&self, slot: usize) -> *mut VMCallerCheckedAnyfunc {
+        self.chunks[slot / CHUNK_LEN][slot % CHUNK_LEN].get() as *mut VMCallerCheckedAnyfunc
+    }
+
+    /// Stores `anyfunc` in a free slot of the arena, and returns the slot.
+    fn allocate(&mut self, anyfunc: VMCallerCheckedAnyfunc) -> usize {
+        let slot = match self.free_slots.pop() {
+            Some(slot) => slot,
+            None => {
+                if self.allocated == self.chunks.len() * CHUNK_LEN {
+                    self.chunks.push(
+                        (0..CHUNK_LEN)
+                            .map(|_| UnsafeCell::new(MaybeUninit::uninit()))
+                            .collect(),
+                    );
+                }
+                self.allocated += 1;
+                self.allocated - 1
+            }
+        };
+
+        // The slot is either fresh, or was released: no `VMFuncRef` may
+        // point to it anymore.
+        unsafe { self.slot_ptr(slot).write(anyfunc) };
+        slot
+    }
+}
+
+#[derive(Debug, Default)]
+struct Counters {
+    registrations: AtomicUsize,
+    deduplicated: AtomicUsize,
+    released: AtomicUsize,
+    contended: AtomicUsize,
+}
+
+/// Statistics about a [`FuncDataRegistry`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct FuncDataRegistryStats {
+    /// The number of functions currently registered.
+    pub live: usize,
+    /// The number of calls to `register` that stored a new function.
+    pub registrations: usize,
+    /// The number of calls to `register` that found the function
+    /// already registered.
+    pub deduplicated: usize,
+    /// The number of functions released by `release_vmctx`.
+    pub released: usize,
+    /// The number of times a thread had to wait for a lock held by
+    /// another thread.
+    pub contended: usize,
 }
 
 impl FuncDataRegistry {
     /// Create a new `FuncDataRegistry`.
     pub fn new() -> Self {
         Self {
-            inner: Default::default(),
+            shards: (0..SHARDS).map(|_| RwLock::default()).collect(),
+            counters: Counters::default(),
+        }
+    }
+
+    fn env_of(anyfunc: &VMCallerCheckedAnyfunc) -> usize {
+        unsafe { anyfunc.vmctx.host_env as usize }
+    }
+
+    fn shard_of(env: usize) -> usize {
+        let mut hasher = DefaultHasher::new();
+        env.hash(&mut hasher);
+        hasher.finish() as usize % SHARDS
+    }
+
+    fn read(&self, shard: usize) -> RwLockReadGuard<'_, Shard> {
+        match self.shards[shard].try_read() {
+            Ok(guard) => guard,
+            Err(TryLockError::WouldBlock) => {
+                self.counters.contended.fetch_add(1, Ordering::Relaxed);
+                self.shards[shard].read().unwrap()
+            }
+            Err(TryLockError::Poisoned(e)) => panic!("{}", e),
+        }
+    }
+
+    fn write(&self, shard: usize) -> RwLockWriteGuard<'_, Shard> {
+        match self.shards[shard].try_write() {
+            Ok(guard) => guard,
+            Err(TryLockError::WouldBlock) => {
+                self.counters.contended.fetch_add(1, Ordering::Relaxed);
+                self.shards[shard].write().unwrap()
+            }
+            Err(TryLockError::Poisoned(e)) => panic!("{}", e),
         }
     }
 
-    /// Register a signature and return its unique index.
+    /// Register a function and return its unique `VMFuncRef`.
     pub fn register(&self, anyfunc: VMCallerCheckedAnyfunc) -> VMFuncRef {
-        let mut inner = self.inner.lock().unwrap();
-        if let Some(&idx) = inner.anyfunc_to_index.get(&anyfunc) {
-            let data: &Box<_> = &inner.func_data[idx];
-            let inner_ptr: &VMCallerCheckedAnyfunc = &*data;
-            VMFuncRef(inner_ptr)
-        } else {
-            let idx = inner.func_data.len();
-            inner.func_data.push(Box::new(anyfunc.clone()));
-            inner.anyfunc_to_index.insert(anyfunc, idx);
-
-            let data: &Box<_> = &inner.func_data[idx];
-            let inner_ptr: &VMCallerCheckedAnyfunc = &*data;
-            VMFuncRef(inner_ptr)
+        let env = Self::env_of(&anyfunc);
+        let shard_index = Self::shard_of(env);
+
+        // Fast path: the function is already registered.
+        {
+            let shard = self.read(shard_index);
+
+            if let Some(&slot) = shard.anyfunc_to_slot.get(&anyfunc) {
+                self.counters.deduplicated.fetch_add(1, Ordering::Relaxed);
+                return VMFuncRef(shard.slot_ptr(slot));
+            }
+        }
+
+        let mut shard = self.write(shard_index);
+
+        // Another thread may have registered it in the meantime.
+        if let Some(&slot) = shard.anyfunc_to_slot.get(&anyfunc) {
+            self.counters.deduplicated.fetch_add(1, Ordering::Relaxed);
+            return VMFuncRef(shard.slot_ptr(slot));
+        }
+
+        let slot = shard.allocate(anyfunc);
+        shard.anyfunc_to_slot.insert(anyfunc, slot);
+        shard.env_to_slots.entry(env).or_default().push(slot);
+        self.counters.registrations.fetch_add(1, Ordering::Relaxed);
+
+        VMFuncRef(shard.slot_ptr(slot))
+    }
+
+    /// Release the functions whose environment is `vmctx`, so that their
+    /// slots can be reused, and return how many were released.
+    ///
+    /// This is called when the instance owning `vmctx` is freed: no
+    /// `VMFuncRef` to its functions may be used anymore.
+    pub fn release_vmctx(&self, vmctx: *mut VMContext) -> usize {
+        let env = vmctx as usize;
+        let shard_index = Self::shard_of(env);
+
+        // Fast path: most instances never had a function registered.
+        if !self.read(shard_index).env_to_slots.contains_key(&env) {
+            return 0;
+        }
+
+        let mut shard = self.write(shard_index);
+        let slots = match shard.env_to_slots.remove(&env) {
+            Some(slots) => slots,
+            None => return 0,
+        };
+
+        for &slot in &slots {
+            let anyfunc = unsafe { *shard.slot_ptr(slot) };
+            shard.anyfunc_to_slot.remove(&anyfunc);
+        }
+        shard.free_slots.extend_from_slice(&slots);
+
+        self.counters
+            .released
+            .fetch_add(slots.len(), Ordering::Relaxed);
+        slots.len()
+    }
+
+    /// Returns statistics about this registry.
+    pub fn stats(&self) -> FuncDataRegistryStats {
+        FuncDataRegistryStats {
+            live: self
+                .shards
+                .iter()
+                .map(|shard| shard.read().unwrap().anyfunc_to_slot.len())
+                .sum(),
+            registrations: self.counters.registrations.load(Ordering::Relaxed),
+            deduplicated: self.counters.deduplicated.load(Ordering::Relaxed),
+            released: self.counters.released.load(Ordering::Relaxed),
+            contended: self.counters.contended.load(Ordering::Relaxed),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::vmcontext::{VMFunctionEnvironment, VMSharedSignatureIndex};
+    use std::sync::Arc;
+    use std::thread;
+
+    fn anyfunc(n: usize) -> VMCallerCheckedAnyfunc {
+        // Functions share their environment in groups of 8.
+        VMCallerCheckedAnyfunc {
+            func_ptr: n as _,
+            type_index: VMSharedSignatureIndex::new(0),
+            vmctx: VMFunctionEnvironment {
+                vmctx: vmctx(n / 8),
+            },
+        }
+    }
+
+    fn vmctx(n: usize) -> *mut VMContext {
+        ((n + 1) * 64) as _
+    }
+
+    #[test]
+    fn register_deduplicates() {
+        let registry = FuncDataRegistry::new();
+        let a = registry.register(anyfunc(1));
+        let b = registry.register(anyfunc(2));
+
+        assert_ne!(a, b);
+        assert_eq!(registry.register(anyfunc(1)), a);
+        assert_eq!(unsafe { **a }, anyfunc(1));
+        assert_eq!(unsafe { **b }, anyfunc(2));
+
+        let stats = registry.stats();
+        assert_eq!(stats.live, 2);
+        assert_eq!(stats.registrations, 2);
+        assert_eq!(stats.deduplicated, 1);
+    }
+
+    #[test]
+    fn pointers_are_stable() {
+        let registry = FuncDataRegistry::new();
+        let funcrefs: Vec<_> = (0..4 * SHARDS * CHUNK_LEN)
+            .map(|n| registry.register(anyfunc(n)))
+            .collect();
+
+        for (n, funcref) in funcrefs.into_iter().enumerate() {
+            assert_eq!(unsafe { **funcref }, anyfunc(n));
         }
     }
+
+    #[test]
+    fn release_reuses_slots() {
+        let registry = FuncDataRegistry::new();
+        let funcrefs: Vec<_> = (0..64).map(|n| registry.register(anyfunc(n))).collect();
+
+        assert_eq!(registry.release_vmctx(vmctx(0)), 8);
+        assert_eq!(registry.release_vmctx(vmctx(0)), 0);
+        assert_eq!(registry.release_vmctx(vmctx(100)), 0);
+        assert_eq!(registry.stats().live, 56);
+        assert_eq!(registry.register(anyfunc(8)), funcrefs[8]);
+
+        // The released slots are reused before the arenas grow.
+        let shard = FuncDataRegistry::shard_of(vmctx(0) as usize);
+        let reused = (8..)
+            .find(|&n| FuncDataRegistry::shard_of(vmctx(n) as usize) == shard)
+            .unwrap();
+        for n in reused * 8..(reused + 1) * 8 {
+            assert!(funcrefs[..8].contains(&registry.register(anyfunc(n))));
+        }
+    }
+
+    #[test]
+    fn concurrent_registrations_agree() {
+        let registry = Arc::new(FuncDataRegistry::new());
+
+        let threads: Vec<_> = (0..8)
+            .map(|_| {
+                let registry = registry.clone();
+                thread::spawn(move || {
+                    (0..1024)
+                        .map(|n| registry.register(anyfunc(n)).0 as usize)
+                        .collect::<Vec<_>>()
+                })
+            })
+            .collect();
+
+        let funcrefs: Vec<_> = threads.into_iter().map(|t| t.join().unwrap()).collect();
+        assert!(funcrefs.windows(2).all(|pair| pair[0] == pair[1]));
+        assert_eq!(registry.stats().live, 1024);
+    }
 }
@@ -1,4 +1,5 @@
 use super::{Instance, InstanceRef};
+use crate::pooling::InstanceSlot;
 use crate::vmcontext::{VMMemoryDefinition, VMTableDefinition};
 use crate::VMOffsets;
 use std::alloc::{self, Layout};
@@ -41,11 +42,17 @@ pub struct InstanceAllocator {
     /// `instance_ptr` buffer. If it has not when being dropped,
     /// the buffer should be freed.
     consumed: bool,
+
+    /// The pool slot holding the `instance_ptr` buffer, if it comes
+    /// from a [`PoolingAllocator`](crate::PoolingAllocator). Otherwise
+    /// the buffer has been allocated with `std::alloc`.
+    slot: Option<InstanceSlot>,
 }
 
 impl Drop for InstanceAllocator {
     fn drop(&mut self) {
-        if !self.consumed {
+        // A pool slot is given back to its pool when dropped.
+        if !self.consumed && self.slot.is_none() {
             // If `consumed` has not been set, then we still have ownership
             // over the buffer and must free it.
             let instance_ptr = self.instance_ptr.as_ptr();
@@ -86,11 +93,44 @@ impl InstanceAllocator {
             alloc::handle_alloc_error(instance_layout);
         };
 
+        Self::with_buffer(instance_ptr, instance_layout, offsets, None)
+    }
+
+    /// Like [`InstanceAllocator::new`], but the instance data is
+    /// stored in a pool slot.
+    ///
+    /// The slot must be at least as large as `instance_layout`, and
+    /// aligned on it.
+    pub(crate) fn new_in_slot(
+        offsets: VMOffsets,
+        instance_layout: Layout,
+        slot: InstanceSlot,
+    ) -> (
+        Self,
+        Vec<NonNull<VMMemoryDefinition>>,
+        Vec<NonNull<VMTableDefinition>>,
+    ) {
+        let instance_ptr = slot.as_ptr().cast();
+
+        Self::with_buffer(instance_ptr, instance_layout, offsets, Some(slot))
+    }
+
+    fn with_buffer(
+        instance_ptr: NonNull<Instance>,
+        instance_layout: Layout,
+        offsets: VMOffsets,
+        slot: Option<InstanceSlot>,
+    ) -> (
+        Self,
+        Vec<NonNull<VMMemoryDefinition>>,
+        Vec<NonNull<VMTableDefinition>>,
+    ) {
         let allocator = Self {
             instance_ptr,
             instance_layout,
             offsets,
             consumed: false,
+            slot,
         };
 
         // # Safety
@@ -104,7 +144,7 @@ impl InstanceAllocator {
     }
 
     /// Calculate the appropriate layout for the [`Instance`].
-    fn instance_layout(offsets: &VMOffsets) -> Layout {
+    pub(crate) fn instance_layout(offsets: &VMOffsets) -> Layout {
         let vmctx_size = usize::try_from(offsets.size_of_vmctx())
             .expect("Failed to convert the size of `vmctx` to a `usize`");
 
@@ -201,10 +241,11 @@ impl InstanceAllocator {
         }
         let instance = self.instance_ptr;
         let instance_layout = self.instance_layout;
+        let slot = self.slot.take();
 
         // This is correct because of the invariants of `Self` and
         // because we write `Instance` to the pointer in this function.
-        unsafe { InstanceRef::new(instance, instance_layout) }
+        unsafe { InstanceRef::new(instance, instance_layout, slot) }
     }
 
     /// Get the [`VMOffsets`] for the allocated buffer.
@@ -9,15 +9,19 @@
 
 mod allocator;
 mod r#ref;
+mod snapshot;
 
 pub use allocator::InstanceAllocator;
 pub use r#ref::{InstanceRef, WeakInstanceRef, WeakOrStrongInstanceRef};
+pub use snapshot::{InstanceSnapshot, SnapshotError};
 
+use crate::atomics;
 use crate::export::VMExtern;
-use crate::func_data_registry::VMFuncRef;
+use crate::func_data_registry::{FuncDataRegistry, VMFuncRef};
 use crate::global::Global;
 use crate::imports::Imports;
 use crate::memory::{Memory, MemoryError};
+use crate::memory_image::MemoryImages;
 use crate::table::{Table, TableElement};
 use crate::trap::{catch_traps, Trap, TrapCode, TrapHandler};
 use crate::vmcontext::{
@@ -97,6 +101,17 @@ pub(crate) struct Instance {
     /// instance.
     funcrefs: BoxedSlice<FunctionIndex, VMCallerCheckedAnyfunc>,
 
+    /// The registry of the engine, where the `VMFuncRef`s to the functions
+    /// of this instance handed out to the host are released from when the
+    /// instance is freed.
+    #[loupe(skip)]
+    func_data_registry: Arc<FuncDataRegistry>,
+
+    /// Keeps the executable memory of the functions of this instance
+    /// alive, when the engine reclaims it.
+    #[loupe(skip)]
+    code_handle: Option<Arc<dyn Any + Send + Sync>>,
+
     /// Hosts can store arbitrary per-instance information here.
     host_state: Box<dyn Any>,
 
@@ -734,9 +749,9 @@ impl Instance {
     pub(crate) fn local_memory_copy(
         &self,
         memory_index: LocalMemoryIndex,
-        dst: u32,
-        src: u32,
-        len: u32,
+        dst: u64,
+        src: u64,
+        len: u64,
     ) -> Result<(), Trap> {
         // https://webassembly.github.io/reference-types/core/exec/instructions.html#exec-memory-copy
 
@@ -749,9 +764,9 @@ impl Instance {
     pub(crate) fn imported_memory_copy(
         &self,
         memory_index: MemoryIndex,
-        dst: u32,
-        src: u32,
-        len: u32,
+        dst: u64,
+        src: u64,
+        len: u64,
     ) -> Result<(), Trap> {
         let import = self.imported_memory(memory_index);
         let memory = unsafe { import.definition.as_ref() };
@@ -767,9 +782,9 @@ impl Instance {
     pub(crate) fn local_memory_fill(
         &self,
         memory_index: LocalMemoryIndex,
-        dst: u32,
+        dst: u64,
         val: u32,
-        len: u32,
+        len: u64,
     ) -> Result<(), Trap> {
         let memory = self.memory(memory_index);
         // The following memory fill is not synchronized and is not atomic:
@@ -784,9 +799,9 @@ impl Instance {
     pub(crate) fn imported_memory_fill(
         &self,
         memory_index: MemoryIndex,
-        dst: u32,
+        dst: u64,
         val: u32,
-        len: u32,
+        len: u64,
     ) -> Result<(), Trap> {
         let import = self.imported_memory(memory_index);
         let memory = unsafe { import.definition.as_ref() };
@@ -794,6 +809,102 @@ impl Instance {
         unsafe { memory.memory_fill(dst, val, len) }
     }
 
+    /// Return the `VMMemoryDefinition` of a local or imported memory.
+    fn memory_definition(&self, memory_index: MemoryIndex) -> VMMemoryDefinition {
+        match self.module.local_memory_index(memory_index) {
+            Some(local_memory_index) => self.memory(local_memory_index),
+            None => unsafe { *self.imported_memory(memory_index).definition.as_ref() },
+        }
+    }
+
+    /// Return the host address of an atomic access of `size` bytes at
+    /// `addr`, in a memory that can be waited on.
+    ///
+    /// # Errors
+    ///
+    /// Returns a `Trap` error if the access is unaligned or out of
+    /// bounds, or if the memory is not shared.
+    fn wait_address(
+        &self,
+        memory_index: MemoryIndex,
+        addr: u32,
+        size: u32,
+    ) -> Result<*const u8, Trap> {
+        let address = self
+            .memory_definition(memory_index)
+            .atomic_address(addr, size)?;
+
+        // No other thread can notify a waiter of an unshared memory.
+        if !self.module.memories[memory_index].shared {
+            return Err(Trap::User(Box::new(atomics::UnsharedMemoryWait)));
+        }
+
+        Ok(address)
+    }
+
+    /// Perform the `memory.atomic.wait32` operation on a local or imported
+    /// memory.
+    ///
+    /// # Errors
+    ///
+    /// Returns a `Trap` error if the access is unaligned or out of
+    /// bounds, or if the memory is not shared.
+    pub(crate) fn memory_atomic_wait32(
+        &self,
+        memory_index: MemoryIndex,
+        addr: u32,
+        expected: u32,
+        timeout: i64,
+    ) -> Result<u32, Trap> {
+        let address = self.wait_address(memory_index, addr, 4)?;
+
+        Ok(unsafe { atomics::wait32(address, expected, timeout) } as u32)
+    }
+
+    /// Perform the `memory.atomic.wait64` operation on a local or imported
+    /// memory.
+    ///
+    /// # Errors
+    ///
+    /// Returns a `Trap` error if the access is unaligned or out of
+    /// bounds, or if the memory is not shared.
+    pub(crate) fn memory_atomic_wait64(
+        &self,
+        memory_index: MemoryIndex,
+        addr: u32,
+        expected: u64,
+        timeout: i64,
+    ) -> Result<u32, Trap> {
+        let address = self.wait_address(memory_index, addr, 8)?;
+
+        Ok(unsafe { atomics::wait64(address, expected, timeout) } as u32)
+    }
+
+    /// Perform the `memory.atomic.notify` operation on a local or imported
+    /// memory, and return the number of waiters woken up.
+    ///
+    /// # Errors
+    ///
+    /// Returns a `Trap` error if the access is unaligned or out of
+    /// bounds.
+    pub(crate) fn memory_atomic_notify(
+        &self,
+        memory_index: MemoryIndex,
+        addr: u32,
+        count: u32,
+    ) -> Result<u32, Trap> {
+        let address = self
+            .memory_definition(memory_index)
+            .atomic_address(addr, 4)?;
+
+        // An unshared memory has no waiters.
+        if !self.module.memories[memory_index].shared {
+            return Ok(0);
+        }
+
+        Ok(atomics::notify(address, count))
+    }
+
     /// Performs the `memory.init` operation.
     ///
     /// # Errors
@@ -805,7 +916,7 @@ impl Instance {
         &self,
         memory_index: MemoryIndex,
         data_index: DataIndex,
-        dst: u32,
+        dst: u64,
         src: u32,
         len: u32,
     ) -> Result<(), Trap> {
@@ -818,9 +929,9 @@ impl Instance {
         if src
             .checked_add(len)
             .map_or(true, |n| n as usize > data.len())
-            || dst.checked_add(len).map_or(true, |m| {
-                usize::try_from(m).unwrap() > memory.current_length
-            })
+            || dst
+                .checked_add(u64::from(len))
+                .map_or(true, |m| m > memory.current_length as u64)
         {
             return Err(Trap::lib(TrapCode::HeapAccessOutOfBounds));
         }
@@ -828,7 +939,7 @@ impl Instance {
         let src_slice = &data[src as usize..(src + len) as usize];
 
         unsafe {
-            let dst_start = memory.base.add(dst as usize);
+            let dst_start = memory.base.add(usize::try_from(dst).unwrap());
             let dst_slice = slice::from_raw_parts_mut(dst_start, len as usize);
             dst_slice.copy_from_slice(src_slice);
         }
@@ -864,6 +975,14 @@ impl Instance {
     }
 }
 
+impl Drop for Instance {
+    fn drop(&mut self) {
+        // The `VMFuncRef`s to the functions of this instance can't be called
+        // anymore, so their slots in the registry can be reused.
+        self.func_data_registry.release_vmctx(self.vmctx_ptr());
+    }
+}
+
 /// A handle holding an `InstanceRef`, which holds an `Instance`
 /// of a WebAssembly module.
 ///
@@ -908,6 +1027,8 @@ impl InstanceHandle {
         finished_globals: BoxedSlice<LocalGlobalIndex, Arc<Global>>,
         imports: Imports,
         vmshared_signatures: BoxedSlice<SignatureIndex, VMSharedSignatureIndex>,
+        func_data_registry: Arc<FuncDataRegistry>,
+        code_handle: Option<Arc<dyn Any + Send + Sync>>,
         host_state: Box<dyn Any>,
         imported_function_envs: BoxedSlice<FunctionIndex, ImportFunctionEnv>,
     ) -> Result<Self, Trap> {
@@ -935,6 +1056,8 @@ impl InstanceHandle {
                 passive_data,
                 host_state,
                 funcrefs,
+                func_data_registry,
+                code_handle,
                 imported_function_envs,
                 vmctx: VMContext {},
             };
@@ -1013,6 +1136,10 @@ impl InstanceHandle {
 
     /// Finishes the instantiation process started by `Instance::new`.
     ///
+    /// The local memories that have an image in `memory_images` are
+    /// initialized by mapping it, instead of copying their data
+    /// initializers, when they support it.
+    ///
     /// # Safety
     ///
     /// Only safe to call immediately after instantiation.
@@ -1020,12 +1147,13 @@ impl InstanceHandle {
         &self,
         trap_handler: &(dyn TrapHandler + 'static),
         data_initializers: &[DataInitializer<'_>],
+        memory_images: Option<&MemoryImages>,
     ) -> Result<(), Trap> {
         let instance = self.instance().as_ref();
 
         // Apply the initializers.
         initialize_tables(instance)?;
-        initialize_memories(instance, data_initializers)?;
+        initialize_memories(instance, data_initializers, memory_images)?;
 
         // The WebAssembly spec specifies that the start function is
         // invoked automatically at instantiation time.
@@ -1271,13 +1399,19 @@ fn get_memory_init_start(init: &DataInitializer<'_>, instance: &Instance) -> usi
     let mut start = init.location.offset;
 
     if let Some(base) = init.location.base {
-        let val = unsafe {
+        let global = unsafe {
             if let Some(def_index) = instance.module.local_global_index(base) {
-                instance.global(def_index).to_u32()
+                instance.global(def_index)
             } else {
-                instance.imported_global(base).definition.as_ref().to_u32()
+                instance.imported_global(base).definition.as_ref().clone()
             }
         };
+        // The offset of a 64-bit memory is a 64-bit global.
+        let val = if instance.module.memories[init.location.memory_index].memory64 {
+            global.to_u64()
+        } else {
+            u64::from(global.to_u32())
+        };
         start += usize::try_from(val).unwrap();
     }
 
@@ -1380,8 +1514,30 @@ fn initialize_passive_elements(instance: &Instance) {
 fn initialize_memories(
     instance: &Instance,
     data_initializers: &[DataInitializer<'_>],
+    memory_images: Option<&MemoryImages>,
 ) -> Result<(), Trap> {
+    // The memories initialized from their image. Any error while
+    // mapping an image falls back to copying the data initializers.
+    let mut mapped = vec![false; instance.module.memories.len()];
+
+    if let Some(memory_images) = memory_images {
+        for (local_index, image) in memory_images.iter() {
+            let image = match image {
+                Some(image) => image,
+                None => continue,
+            };
+
+            if let Ok(true) = unsafe { instance.memories[local_index].map_image(image) } {
+                mapped[instance.module.memory_index(local_index).index()] = true;
+            }
+        }
+    }
+
     for init in data_initializers {
+        if mapped[init.location.memory_index.index()] {
+            continue;
+        }
+
         let memory = instance.get_memory(init.location.memory_index);
 
         let start = get_memory_init_start(init, instance);
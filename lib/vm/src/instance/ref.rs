@@ -1,4 +1,5 @@
 use super::Instance;
+use crate::pooling::InstanceSlot;
 use loupe::{MemoryUsage, MemoryUsageTracker};
 use std::alloc::Layout;
 use std::convert::TryFrom;
@@ -21,6 +22,11 @@ struct InstanceInner {
     /// The layout of `Instance` (which can vary).
     instance_layout: Layout,
 
+    /// The pool slot holding the `Instance`, if any. It is given back
+    /// to its pool once the `Instance` is dropped. Otherwise the
+    /// `Instance` has been allocated with `alloc`.
+    slot: Option<InstanceSlot>,
+
     /// The `Instance` itself. It must be the last field of
     /// `InstanceRef` since `Instance` is dyamically-sized.
     ///
@@ -45,7 +51,10 @@ impl InstanceInner {
         let instance_ptr = self.instance.as_ptr();
 
         ptr::drop_in_place(instance_ptr);
-        std::alloc::dealloc(instance_ptr as *mut u8, self.instance_layout);
+
+        if self.slot.is_none() {
+            std::alloc::dealloc(instance_ptr as *mut u8, self.instance_layout);
+        }
     }
 
     /// Get a reference to the `Instance`.
@@ -124,9 +133,14 @@ impl InstanceRef {
     /// and correctly initialized pointer to `Instance`. See
     /// [`InstanceAllocator`] for an example of how to correctly use
     /// this API.
-    pub(super) unsafe fn new(instance: NonNull<Instance>, instance_layout: Layout) -> Self {
+    pub(super) unsafe fn new(
+        instance: NonNull<Instance>,
+        instance_layout: Layout,
+        slot: Option<InstanceSlot>,
+    ) -> Self {
         Self(Arc::new(InstanceInner {
             instance_layout,
+            slot,
             instance,
         }))
     }
@@ -0,0 +1,371 @@
+//! Snapshots of the state of an instance.
+//!
+//! An [`InstanceSnapshot`] captures the content of the locally-defined
+//! memories, tables and globals of an instance once it has been
+//! initialized, e.g. once its start function and its `_initialize`
+//! export have run. New instances of the same module can then be
+//! restored from the snapshot instead of being initialized again: the
+//! memories map an image of the captured content copy-on-write (see
+//! [`MemoryImage`]), and the start function is not invoked.
+//!
+//! Imported memories, tables and globals are not captured, they belong
+//! to the importer.
+
+use super::{Instance, InstanceHandle};
+use crate::func_data_registry::VMFuncRef;
+use crate::memory::MemoryError;
+use crate::memory_image::MemoryImage;
+use crate::table::TableElement;
+use std::collections::HashMap;
+use std::fmt;
+use std::slice;
+use std::sync::Arc;
+use thiserror::Error;
+use wasmer_types::entity::{EntityRef, PrimaryMap};
+use wasmer_types::{
+    DataIndex, ElemIndex, ExternRef, FunctionIndex, LocalGlobalIndex, LocalMemoryIndex,
+    LocalTableIndex, ModuleInfo, Pages, Type, VMExternRef,
+};
+
+/// Error type describing things that can go wrong when taking or
+/// restoring an [`InstanceSnapshot`].
+#[derive(Error, Debug)]
+pub enum SnapshotError {
+    /// A table or a global refers to a function that is neither defined
+    /// nor imported by the instance, and that can't be resolved in
+    /// another instance.
+    #[error("A table or a global refers to a function foreign to the instance")]
+    ForeignFunction,
+    /// The snapshot was taken from an instance of another module.
+    #[error("The snapshot was taken from an instance of another module")]
+    ModuleMismatch,
+    /// A memory couldn't be restored.
+    #[error(transparent)]
+    Memory(#[from] MemoryError),
+    /// A table couldn't be grown to the size it had in the snapshot.
+    #[error("The table could not grow to {0} elements")]
+    Table(u32),
+}
+
+/// The value of a function reference, relative to the instance.
+#[derive(Clone, Copy)]
+enum FuncRefValue {
+    Null,
+    Function(FunctionIndex),
+}
+
+enum GlobalValue {
+    /// The value of a numeric or vector global.
+    Bits(u128),
+    FuncRef(FuncRefValue),
+    ExternRef(ExternRef),
+}
+
+enum ElementValue {
+    FuncRef(FuncRefValue),
+    ExternRef(ExternRef),
+}
+
+enum MemoryContent {
+    Image(MemoryImage),
+    /// The content of the memory, when it's too small for an image, or
+    /// when images are not supported.
+    Bytes(Box<[u8]>),
+}
+
+struct MemorySnapshot {
+    size: Pages,
+    content: MemoryContent,
+}
+
+/// The state of an instance, captured by [`InstanceHandle::snapshot`]
+/// and restored by [`InstanceHandle::restore_snapshot`]. See the module
+/// documentation.
+pub struct InstanceSnapshot {
+    module: Arc<ModuleInfo>,
+    memories: PrimaryMap<LocalMemoryIndex, MemorySnapshot>,
+    tables: PrimaryMap<LocalTableIndex, Vec<ElementValue>>,
+    globals: PrimaryMap<LocalGlobalIndex, GlobalValue>,
+    dropped_elements: Vec<ElemIndex>,
+    dropped_data: Vec<DataIndex>,
+}
+
+/// # Safety
+/// The snapshot is immutable. The only pointers it holds are the ones of
+/// the `ExternRef`s, whose data is `Send + Sync` and whose reference
+/// count is atomic.
+unsafe impl Send for InstanceSnapshot {}
+/// # Safety
+/// See the `Send` implementation.
+unsafe impl Sync for InstanceSnapshot {}
+
+impl InstanceSnapshot {
+    /// Returns the module of the instance this snapshot was taken from.
+    pub fn module(&self) -> &Arc<ModuleInfo> {
+        &self.module
+    }
+}
+
+impl fmt::Debug for InstanceSnapshot {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("InstanceSnapshot")
+            .field("memories", &self.memories.len())
+            .field("tables", &self.tables.len())
+            .field("globals", &self.globals.len())
+            .finish()
+    }
+}
+
+/// Resolves the function references of an instance to function indices.
+struct FuncRefResolver<'a> {
+    instance: &'a Instance,
+    /// The `VMCallerCheckedAnyfunc`s of the instance, by address.
+    by_address: HashMap<usize, FunctionIndex>,
+}
+
+impl<'a> FuncRefResolver<'a> {
+    fn new(instance: &'a Instance) -> Self {
+        let by_address = instance
+            .funcrefs
+            .iter()
+            .map(|(index, anyfunc)| (anyfunc as *const _ as usize, index))
+            .collect();
+
+        Self {
+            instance,
+            by_address,
+        }
+    }
+
+    fn resolve(&self, funcref: VMFuncRef) -> Result<FuncRefValue, SnapshotError> {
+        if funcref.is_null() {
+            return Ok(FuncRefValue::Null);
+        }
+
+        if let Some(index) = self.by_address.get(&(funcref.0 as usize)) {
+            return Ok(FuncRefValue::Function(*index));
+        }
+
+        // The host may have stored a copy of one of the instance's
+        // `VMCallerCheckedAnyfunc`s, registered in the engine's
+        // `FuncDataRegistry`.
+        let anyfunc = unsafe { &*funcref.0 };
+
+        self.instance
+            .funcrefs
+            .iter()
+            .find(|(_, candidate)| unsafe {
+                candidate.func_ptr == anyfunc.func_ptr
+                    && candidate.type_index == anyfunc.type_index
+                    && candidate.vmctx.host_env == anyfunc.vmctx.host_env
+            })
+            .map(|(index, _)| FuncRefValue::Function(index))
+            .ok_or(SnapshotError::ForeignFunction)
+    }
+}
+
+impl Instance {
+    fn funcref_value(&self, value: FuncRefValue) -> VMFuncRef {
+        match value {
+            FuncRefValue::Null => VMFuncRef::null(),
+            FuncRefValue::Function(index) => self.get_vm_funcref(index),
+        }
+    }
+}
+
+impl InstanceHandle {
+    /// Captures the state of the locally-defined memories, tables and
+    /// globals of this instance.
+    ///
+    /// The instance must not be running, on this thread or any other,
+    /// while the snapshot is taken.
+    pub fn snapshot(&self) -> Result<InstanceSnapshot, SnapshotError> {
+        let instance = self.instance().as_ref();
+        let module = &instance.module;
+        let resolver = FuncRefResolver::new(instance);
+
+        let memories = instance
+            .memories
+            .iter()
+            .map(|(index, memory)| {
+                let definition = instance.memory(index);
+                let bytes =
+                    unsafe { slice::from_raw_parts(definition.base, definition.current_length) };
+
+                let content = match MemoryImage::capture(bytes) {
+                    Some(image) => MemoryContent::Image(image),
+                    None => MemoryContent::Bytes(bytes.into()),
+                };
+
+                MemorySnapshot {
+                    size: memory.size(),
+                    content,
+                }
+            })
+            .collect();
+
+        let tables = instance
+            .tables
+            .values()
+            .map(|table| {
+                (0..table.size())
+                    .map(|index| match table.get(index) {
+                        Some(TableElement::FuncRef(funcref)) => {
+                            resolver.resolve(funcref).map(ElementValue::FuncRef)
+                        }
+                        Some(TableElement::ExternRef(extern_ref)) => {
+                            Ok(ElementValue::ExternRef(extern_ref))
+                        }
+                        None => unreachable!("table index within bounds"),
+                    })
+                    .collect::<Result<Vec<_>, _>>()
+            })
+            .collect::<Result<PrimaryMap<_, _>, _>>()?;
+
+        let globals = (0..instance.globals.len())
+            .map(|index| {
+                let local_index = LocalGlobalIndex::new(index);
+                let global_index = module.global_index(local_index);
+                let definition = instance.global(local_index);
+
+                Ok(match module.globals[global_index].ty {
+                    Type::FuncRef => {
+                        GlobalValue::FuncRef(resolver.resolve(definition.to_funcref())?)
+                    }
+                    Type::ExternRef => {
+                        GlobalValue::ExternRef(definition.to_externref().ref_clone().into())
+                    }
+                    _ => GlobalValue::Bits(definition.to_u128()),
+                })
+            })
+            .collect::<Result<PrimaryMap<_, _>, _>>()?;
+
+        let passive_elements = instance.passive_elements.borrow();
+        let dropped_elements = module
+            .passive_elements
+            .keys()
+            .filter(|index| !passive_elements.contains_key(index))
+            .copied()
+            .collect();
+
+        let passive_data = instance.passive_data.borrow();
+        let dropped_data = module
+            .passive_data
+            .keys()
+            .filter(|index| !passive_data.contains_key(index))
+            .copied()
+            .collect();
+
+        Ok(InstanceSnapshot {
+            module: module.clone(),
+            memories,
+            tables,
+            globals,
+            dropped_elements,
+            dropped_data,
+        })
+    }
+
+    /// Restores the state captured in `snapshot` into this instance. It
+    /// replaces [`InstanceHandle::finish_instantiation`]: the memories
+    /// and the tables are not initialized from the module, and the start
+    /// function is not invoked.
+    ///
+    /// # Safety
+    ///
+    /// Only safe to call immediately after instantiation, instead of
+    /// `finish_instantiation`.
+    pub unsafe fn restore_snapshot(
+        &self,
+        snapshot: &InstanceSnapshot,
+    ) -> Result<(), SnapshotError> {
+        let instance = self.instance().as_ref();
+
+        if !Arc::ptr_eq(&instance.module, &snapshot.module) {
+            return Err(SnapshotError::ModuleMismatch);
+        }
+
+        for (index, memory_snapshot) in snapshot.memories.iter() {
+            let memory = &instance.memories[index];
+            let size = memory.size();
+
+            if memory_snapshot.size > size {
+                memory.grow(memory_snapshot.size - size)?;
+            }
+
+            let definition = instance.memory(index);
+            let bytes = slice::from_raw_parts_mut(definition.base, definition.current_length);
+
+            match &memory_snapshot.content {
+                MemoryContent::Image(image) => {
+                    // Fall back to copying the image when it can't be
+                    // mapped.
+                    if !memory.map_image(image).unwrap_or(false) {
+                        image.copy_into(bytes).map_err(MemoryError::Region)?;
+                    }
+                }
+                MemoryContent::Bytes(content) => bytes[..content.len()].copy_from_slice(content),
+            }
+        }
+
+        for (index, elements) in snapshot.tables.iter() {
+            let table = instance.get_local_table(index);
+            let len = elements.len() as u32;
+            let size = table.size();
+
+            if len > size {
+                let init_value = match table.ty().ty {
+                    Type::ExternRef => TableElement::ExternRef(ExternRef::null()),
+                    _ => TableElement::FuncRef(VMFuncRef::null()),
+                };
+
+                table
+                    .grow(len - size, init_value)
+                    .ok_or(SnapshotError::Table(len))?;
+            }
+
+            for (i, element) in elements.iter().enumerate() {
+                let element = match element {
+                    ElementValue::FuncRef(value) => {
+                        TableElement::FuncRef(instance.funcref_value(*value))
+                    }
+                    ElementValue::ExternRef(extern_ref) => {
+                        TableElement::ExternRef(extern_ref.clone())
+                    }
+                };
+
+                table
+                    .set(i as u32, element)
+                    .map_err(|_| SnapshotError::Table(len))?;
+            }
+        }
+
+        for (index, value) in snapshot.globals.iter() {
+            let definition = &mut *instance.global_ptr(index).as_ptr();
+
+            match value {
+                GlobalValue::Bits(bits) => *definition.as_u128_mut() = *bits,
+                GlobalValue::FuncRef(value) => {
+                    *definition.as_funcref_mut() = instance.funcref_value(*value)
+                }
+                GlobalValue::ExternRef(extern_ref) => {
+                    let previous = definition.as_externref_mut();
+                    previous.ref_drop();
+                    *previous = VMExternRef::from(extern_ref.clone());
+                }
+            }
+        }
+
+        let mut passive_elements = instance.passive_elements.borrow_mut();
+        for index in &snapshot.dropped_elements {
+            passive_elements.remove(index);
+        }
+
+        let mut passive_data = instance.passive_data.borrow_mut();
+        for index in &snapshot.dropped_data {
+            passive_data.remove(index);
+        }
+
+        Ok(())
+    }
+}
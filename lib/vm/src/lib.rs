@@ -20,13 +20,16 @@
     )
 )]
 
+mod atomics;
 mod export;
 mod func_data_registry;
 mod global;
 mod imports;
 mod instance;
 mod memory;
+mod memory_image;
 mod mmap;
+mod pooling;
 mod probestack;
 mod sig_registry;
 mod table;
@@ -36,15 +39,17 @@ mod vmcontext;
 pub mod libcalls;
 
 pub use crate::export::*;
-pub use crate::func_data_registry::{FuncDataRegistry, VMFuncRef};
+pub use crate::func_data_registry::{FuncDataRegistry, FuncDataRegistryStats, VMFuncRef};
 pub use crate::global::*;
 pub use crate::imports::Imports;
 pub use crate::instance::{
     ImportFunctionEnv, ImportInitializerFuncPtr, InstanceAllocator, InstanceHandle,
-    WeakOrStrongInstanceRef,
+    InstanceSnapshot, SnapshotError, WeakOrStrongInstanceRef,
 };
-pub use crate::memory::{LinearMemory, Memory, MemoryError};
-pub use crate::mmap::Mmap;
+pub use crate::memory::{reservation_size, LinearMemory, Memory, MemoryError};
+pub use crate::memory_image::{MemoryImage, MemoryImages};
+pub use crate::mmap::{huge_page_size, Mmap, PageBacking};
+pub use crate::pooling::{PoolingAllocator, PoolingConfig, PoolingStats};
 pub use crate::probestack::PROBESTACK;
 pub use crate::sig_registry::SignatureRegistry;
 pub use crate::table::{LinearTable, Table, TableElement};
@@ -43,6 +43,7 @@ use crate::table::{RawTableElement, TableElement};
 use crate::trap::{raise_lib_trap, Trap, TrapCode};
 use crate::vmcontext::VMContext;
 use crate::{on_host_stack, VMExternRef};
+use std::convert::TryFrom;
 pub use wasmer_types::LibCall;
 use wasmer_types::{
     DataIndex, ElemIndex, FunctionIndex, LocalMemoryIndex, LocalTableIndex, MemoryIndex,
@@ -212,6 +213,81 @@ pub unsafe extern "C" fn wasmer_vm_imported_memory32_size(
     instance.imported_memory_size(memory_index).0
 }
 
+/// Implementation of memory.grow for locally-defined 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory64_grow(
+    vmctx: *mut VMContext,
+    delta: u64,
+    memory_index: u32,
+) -> u64 {
+    on_host_stack(|| {
+        let instance = (&*vmctx).instance();
+        let memory_index = LocalMemoryIndex::from_u32(memory_index);
+
+        u32::try_from(delta)
+            .ok()
+            .and_then(|delta| instance.memory_grow(memory_index, delta).ok())
+            .map(|pages| u64::from(pages.0))
+            .unwrap_or(u64::max_value())
+    })
+}
+
+/// Implementation of memory.grow for imported 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory64_grow(
+    vmctx: *mut VMContext,
+    delta: u64,
+    memory_index: u32,
+) -> u64 {
+    on_host_stack(|| {
+        let instance = (&*vmctx).instance();
+        let memory_index = MemoryIndex::from_u32(memory_index);
+
+        u32::try_from(delta)
+            .ok()
+            .and_then(|delta| instance.imported_memory_grow(memory_index, delta).ok())
+            .map(|pages| u64::from(pages.0))
+            .unwrap_or(u64::max_value())
+    })
+}
+
+/// Implementation of memory.size for locally-defined 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory64_size(vmctx: *mut VMContext, memory_index: u32) -> u64 {
+    let instance = (&*vmctx).instance();
+    let memory_index = LocalMemoryIndex::from_u32(memory_index);
+
+    u64::from(instance.memory_size(memory_index).0)
+}
+
+/// Implementation of memory.size for imported 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory64_size(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+) -> u64 {
+    let instance = (&*vmctx).instance();
+    let memory_index = MemoryIndex::from_u32(memory_index);
+
+    u64::from(instance.imported_memory_size(memory_index).0)
+}
+
 /// Implementation of `table.copy`.
 ///
 /// # Safety
@@ -553,7 +629,7 @@ pub unsafe extern "C" fn wasmer_vm_memory32_copy(
     let result = {
         let memory_index = LocalMemoryIndex::from_u32(memory_index);
         let instance = (&*vmctx).instance();
-        instance.local_memory_copy(memory_index, dst, src, len)
+        instance.local_memory_copy(memory_index, dst.into(), src.into(), len.into())
     };
     if let Err(trap) = result {
         raise_lib_trap(trap);
@@ -576,7 +652,7 @@ pub unsafe extern "C" fn wasmer_vm_imported_memory32_copy(
     let result = {
         let memory_index = MemoryIndex::from_u32(memory_index);
         let instance = (&*vmctx).instance();
-        instance.imported_memory_copy(memory_index, dst, src, len)
+        instance.imported_memory_copy(memory_index, dst.into(), src.into(), len.into())
     };
     if let Err(trap) = result {
         raise_lib_trap(trap);
@@ -599,7 +675,7 @@ pub unsafe extern "C" fn wasmer_vm_memory32_fill(
     let result = {
         let memory_index = LocalMemoryIndex::from_u32(memory_index);
         let instance = (&*vmctx).instance();
-        instance.local_memory_fill(memory_index, dst, val, len)
+        instance.local_memory_fill(memory_index, dst.into(), val, len.into())
     };
     if let Err(trap) = result {
         raise_lib_trap(trap);
@@ -618,6 +694,246 @@ pub unsafe extern "C" fn wasmer_vm_imported_memory32_fill(
     dst: u32,
     val: u32,
     len: u32,
+) {
+    let result = {
+        let memory_index = MemoryIndex::from_u32(memory_index);
+        let instance = (&*vmctx).instance();
+        instance.imported_memory_fill(memory_index, dst.into(), val, len.into())
+    };
+    if let Err(trap) = result {
+        raise_lib_trap(trap);
+    }
+}
+
+/// Implementation of `memory.atomic.wait32` for locally-defined memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory32_atomic_wait32(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    addr: u32,
+    expected: u32,
+    timeout: i64,
+) -> u32 {
+    let result = on_host_stack(|| {
+        let instance = (&*vmctx).instance();
+        let memory_index = instance
+            .module_ref()
+            .memory_index(LocalMemoryIndex::from_u32(memory_index));
+        instance.memory_atomic_wait32(memory_index, addr, expected, timeout)
+    });
+    match result {
+        Ok(ret) => ret,
+        Err(trap) => raise_lib_trap(trap),
+    }
+}
+
+/// Implementation of `memory.atomic.wait32` for imported memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory32_atomic_wait32(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    addr: u32,
+    expected: u32,
+    timeout: i64,
+) -> u32 {
+    let result = on_host_stack(|| {
+        let instance = (&*vmctx).instance();
+        let memory_index = MemoryIndex::from_u32(memory_index);
+        instance.memory_atomic_wait32(memory_index, addr, expected, timeout)
+    });
+    match result {
+        Ok(ret) => ret,
+        Err(trap) => raise_lib_trap(trap),
+    }
+}
+
+/// Implementation of `memory.atomic.wait64` for locally-defined memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory32_atomic_wait64(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    addr: u32,
+    expected: u64,
+    timeout: i64,
+) -> u32 {
+    let result = on_host_stack(|| {
+        let instance = (&*vmctx).instance();
+        let memory_index = instance
+            .module_ref()
+            .memory_index(LocalMemoryIndex::from_u32(memory_index));
+        instance.memory_atomic_wait64(memory_index, addr, expected, timeout)
+    });
+    match result {
+        Ok(ret) => ret,
+        Err(trap) => raise_lib_trap(trap),
+    }
+}
+
+/// Implementation of `memory.atomic.wait64` for imported memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory32_atomic_wait64(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    addr: u32,
+    expected: u64,
+    timeout: i64,
+) -> u32 {
+    let result = on_host_stack(|| {
+        let instance = (&*vmctx).instance();
+        let memory_index = MemoryIndex::from_u32(memory_index);
+        instance.memory_atomic_wait64(memory_index, addr, expected, timeout)
+    });
+    match result {
+        Ok(ret) => ret,
+        Err(trap) => raise_lib_trap(trap),
+    }
+}
+
+/// Implementation of `memory.atomic.notify` for locally-defined memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory32_atomic_notify(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    addr: u32,
+    count: u32,
+) -> u32 {
+    let result = {
+        let instance = (&*vmctx).instance();
+        let memory_index = instance
+            .module_ref()
+            .memory_index(LocalMemoryIndex::from_u32(memory_index));
+        instance.memory_atomic_notify(memory_index, addr, count)
+    };
+    match result {
+        Ok(ret) => ret,
+        Err(trap) => raise_lib_trap(trap),
+    }
+}
+
+/// Implementation of `memory.atomic.notify` for imported memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory32_atomic_notify(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    addr: u32,
+    count: u32,
+) -> u32 {
+    let result = {
+        let instance = (&*vmctx).instance();
+        let memory_index = MemoryIndex::from_u32(memory_index);
+        instance.memory_atomic_notify(memory_index, addr, count)
+    };
+    match result {
+        Ok(ret) => ret,
+        Err(trap) => raise_lib_trap(trap),
+    }
+}
+
+/// Implementation of `memory.copy` for locally defined 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory64_copy(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    dst: u64,
+    src: u64,
+    len: u64,
+) {
+    let result = {
+        let memory_index = LocalMemoryIndex::from_u32(memory_index);
+        let instance = (&*vmctx).instance();
+        instance.local_memory_copy(memory_index, dst, src, len)
+    };
+    if let Err(trap) = result {
+        raise_lib_trap(trap);
+    }
+}
+
+/// Implementation of `memory.copy` for imported 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory64_copy(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    dst: u64,
+    src: u64,
+    len: u64,
+) {
+    let result = {
+        let memory_index = MemoryIndex::from_u32(memory_index);
+        let instance = (&*vmctx).instance();
+        instance.imported_memory_copy(memory_index, dst, src, len)
+    };
+    if let Err(trap) = result {
+        raise_lib_trap(trap);
+    }
+}
+
+/// Implementation of `memory.fill` for locally defined 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory64_fill(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    dst: u64,
+    val: u32,
+    len: u64,
+) {
+    let result = {
+        let memory_index = LocalMemoryIndex::from_u32(memory_index);
+        let instance = (&*vmctx).instance();
+        instance.local_memory_fill(memory_index, dst, val, len)
+    };
+    if let Err(trap) = result {
+        raise_lib_trap(trap);
+    }
+}
+
+/// Implementation of `memory.fill` for imported 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_imported_memory64_fill(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    dst: u64,
+    val: u32,
+    len: u64,
 ) {
     let result = {
         let memory_index = MemoryIndex::from_u32(memory_index);
@@ -642,6 +958,31 @@ pub unsafe extern "C" fn wasmer_vm_memory32_init(
     dst: u32,
     src: u32,
     len: u32,
+) {
+    let result = {
+        let memory_index = MemoryIndex::from_u32(memory_index);
+        let data_index = DataIndex::from_u32(data_index);
+        let instance = (&*vmctx).instance();
+        instance.memory_init(memory_index, data_index, dst.into(), src, len)
+    };
+    if let Err(trap) = result {
+        raise_lib_trap(trap);
+    }
+}
+
+/// Implementation of `memory.init` for 64-bit memories.
+///
+/// # Safety
+///
+/// `vmctx` must be dereferenceable.
+#[no_mangle]
+pub unsafe extern "C" fn wasmer_vm_memory64_init(
+    vmctx: *mut VMContext,
+    memory_index: u32,
+    data_index: u32,
+    dst: u64,
+    src: u32,
+    len: u32,
 ) {
     let result = {
         let memory_index = MemoryIndex::from_u32(memory_index);
@@ -720,7 +1061,20 @@ pub fn function_pointer(libcall: LibCall) -> usize {
         LibCall::Memory32Fill => wasmer_vm_memory32_fill as usize,
         LibCall::ImportedMemory32Fill => wasmer_vm_memory32_fill as usize,
         LibCall::Memory32Init => wasmer_vm_memory32_init as usize,
+        LibCall::Memory64Size => wasmer_vm_memory64_size as usize,
+        LibCall::ImportedMemory64Size => wasmer_vm_imported_memory64_size as usize,
+        LibCall::Memory64Copy => wasmer_vm_memory64_copy as usize,
+        LibCall::ImportedMemory64Copy => wasmer_vm_imported_memory64_copy as usize,
+        LibCall::Memory64Fill => wasmer_vm_memory64_fill as usize,
+        LibCall::ImportedMemory64Fill => wasmer_vm_imported_memory64_fill as usize,
+        LibCall::Memory64Init => wasmer_vm_memory64_init as usize,
         LibCall::DataDrop => wasmer_vm_data_drop as usize,
+        LibCall::Memory32AtomicWait32 => wasmer_vm_memory32_atomic_wait32 as usize,
+        LibCall::ImportedMemory32AtomicWait32 => wasmer_vm_imported_memory32_atomic_wait32 as usize,
+        LibCall::Memory32AtomicWait64 => wasmer_vm_memory32_atomic_wait64 as usize,
+        LibCall::ImportedMemory32AtomicWait64 => wasmer_vm_imported_memory32_atomic_wait64 as usize,
+        LibCall::Memory32AtomicNotify => wasmer_vm_memory32_atomic_notify as usize,
+        LibCall::ImportedMemory32AtomicNotify => wasmer_vm_imported_memory32_atomic_notify as usize,
         LibCall::Probestack => wasmer_vm_probestack as usize,
         LibCall::RaiseTrap => wasmer_vm_raise_trap as usize,
     }
@@ -5,15 +5,19 @@
 //!
 //! `LinearMemory` is to WebAssembly linear memories what `Table` is to WebAssembly tables.
 
-use crate::mmap::Mmap;
+use crate::memory_image::MemoryImage;
+use crate::mmap::{Mmap, PageBacking};
+use crate::pooling::MemorySlot;
 use crate::vmcontext::VMMemoryDefinition;
-use loupe::MemoryUsage;
-use more_asserts::assert_ge;
+use loupe::{MemoryUsage, MemoryUsageTracker};
+use more_asserts::{assert_ge, assert_lt};
 use std::borrow::BorrowMut;
 use std::cell::UnsafeCell;
 use std::convert::TryInto;
 use std::fmt;
+use std::ops::{Deref, DerefMut};
 use std::ptr::NonNull;
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Mutex;
 use thiserror::Error;
 use wasmer_types::{Bytes, MemoryStyle, MemoryType, Pages};
@@ -78,6 +82,25 @@ pub trait Memory: fmt::Debug + Send + Sync + MemoryUsage {
     ///
     /// The pointer returned in [`VMMemoryDefinition`] must be valid for the lifetime of this memory.
     fn vmmemory(&self) -> NonNull<VMMemoryDefinition>;
+
+    /// Initializes the memory with a copy-on-write mapping of `image`.
+    ///
+    /// Returns `Ok(false)` if the memory doesn't support images, in
+    /// which case its data initializers must be copied instead, which
+    /// is what the default implementation does.
+    ///
+    /// # Safety
+    ///
+    /// The memory must be freshly created, and not in use yet.
+    unsafe fn map_image(&self, image: &MemoryImage) -> Result<bool, MemoryError> {
+        let _ = image;
+        Ok(false)
+    }
+
+    /// Returns the kind of pages backing the memory.
+    fn page_backing(&self) -> PageBacking {
+        PageBacking::Base
+    }
 }
 
 /// A linear memory instance.
@@ -95,6 +118,9 @@ pub struct LinearMemory {
     /// Our chosen implementation style.
     style: MemoryStyle,
 
+    /// The kind of pages requested for the memory, also when it moves.
+    requested_backing: PageBacking,
+
     // Size in bytes of extra guard pages after the end to optimize loads and stores with
     // constant offsets.
     offset_guard_size: usize,
@@ -135,18 +161,93 @@ unsafe impl Sync for LinearMemory {}
 #[derive(Debug, MemoryUsage)]
 struct WasmMmap {
     // Our OS allocation of mmap'd memory.
-    alloc: Mmap,
+    alloc: MmapBacking,
     // The current logical size in wasm pages of this linear memory.
     size: Pages,
 }
 
+impl Drop for WasmMmap {
+    fn drop(&mut self) {
+        if let MmapBacking::Pooled(slot) = &mut self.alloc {
+            slot.set_accessible(self.size.bytes().0);
+        }
+    }
+}
+
+/// Where the mmap'd memory of a `WasmMmap` comes from.
+#[derive(Debug)]
+enum MmapBacking {
+    /// The memory has been mapped for this linear memory only.
+    Owned(Mmap),
+    /// The memory is a slot of a `PoolingAllocator`, which is given
+    /// back to the pool when dropped.
+    Pooled(MemorySlot),
+}
+
+impl Deref for MmapBacking {
+    type Target = Mmap;
+
+    fn deref(&self) -> &Mmap {
+        match self {
+            Self::Owned(mmap) => mmap,
+            Self::Pooled(slot) => slot.mmap(),
+        }
+    }
+}
+
+impl DerefMut for MmapBacking {
+    fn deref_mut(&mut self) -> &mut Mmap {
+        match self {
+            Self::Owned(mmap) => mmap,
+            Self::Pooled(slot) => slot.mmap_mut(),
+        }
+    }
+}
+
+impl MemoryUsage for MmapBacking {
+    fn size_of_val(&self, tracker: &mut dyn MemoryUsageTracker) -> usize {
+        self.deref().size_of_val(tracker)
+    }
+}
+
+/// Returns the number of bytes to reserve for a memory of type `memory`
+/// with the style `style`, including the offset guard.
+pub fn reservation_size(memory: &MemoryType, style: &MemoryStyle) -> usize {
+    let minimum_pages = match style {
+        // A shared memory can't move when it grows, since other threads
+        // may be accessing it: its maximum is reserved up front.
+        MemoryStyle::Dynamic { .. } if memory.shared => memory.maximum.unwrap_or(memory.minimum),
+        MemoryStyle::Dynamic { .. } => memory.minimum,
+        MemoryStyle::Static { bound, .. } => {
+            assert_ge!(*bound, memory.minimum);
+            *bound
+        }
+    };
+
+    minimum_pages
+        .bytes()
+        .0
+        .checked_add(style.offset_guard_size() as usize)
+        .unwrap()
+}
+
 impl LinearMemory {
     /// Create a new linear memory instance with specified minimum and maximum number of wasm pages.
     ///
     /// This creates a `LinearMemory` with owned metadata: this can be used to create a memory
     /// that will be imported into Wasm modules.
     pub fn new(memory: &MemoryType, style: &MemoryStyle) -> Result<Self, MemoryError> {
-        unsafe { Self::new_internal(memory, style, None) }
+        unsafe { Self::new_internal(memory, style, None, None, PageBacking::Base) }
+    }
+
+    /// Like [`LinearMemory::new`], but the memory is backed by the kind
+    /// of pages requested by `backing` when the system provides them.
+    pub fn new_with_backing(
+        memory: &MemoryType,
+        style: &MemoryStyle,
+        backing: PageBacking,
+    ) -> Result<Self, MemoryError> {
+        unsafe { Self::new_internal(memory, style, None, None, backing) }
     }
 
     /// Create a new linear memory instance with specified minimum and maximum number of wasm pages.
@@ -161,27 +262,73 @@ impl LinearMemory {
         style: &MemoryStyle,
         vm_memory_location: NonNull<VMMemoryDefinition>,
     ) -> Result<Self, MemoryError> {
-        Self::new_internal(memory, style, Some(vm_memory_location))
+        Self::new_internal(
+            memory,
+            style,
+            Some(vm_memory_location),
+            None,
+            PageBacking::Base,
+        )
+    }
+
+    /// Like [`LinearMemory::from_definition`], but the memory is backed
+    /// by the kind of pages requested by `backing` when the system
+    /// provides them.
+    ///
+    /// # Safety
+    /// - `vm_memory_location` must point to a valid location in VM memory.
+    pub unsafe fn from_definition_with_backing(
+        memory: &MemoryType,
+        style: &MemoryStyle,
+        vm_memory_location: NonNull<VMMemoryDefinition>,
+        backing: PageBacking,
+    ) -> Result<Self, MemoryError> {
+        Self::new_internal(memory, style, Some(vm_memory_location), None, backing)
     }
 
-    /// Build a `LinearMemory` with either self-owned or VM owned metadata.
+    /// Like [`LinearMemory::from_definition`], but the memory is
+    /// mapped in `slot`, which must be large enough to hold the
+    /// [`reservation_size`] of the memory.
+    ///
+    /// # Safety
+    /// - `vm_memory_location` must point to a valid location in VM memory.
+    pub(crate) unsafe fn from_definition_in_slot(
+        memory: &MemoryType,
+        style: &MemoryStyle,
+        vm_memory_location: NonNull<VMMemoryDefinition>,
+        slot: MemorySlot,
+    ) -> Result<Self, MemoryError> {
+        Self::new_internal(
+            memory,
+            style,
+            Some(vm_memory_location),
+            Some(slot),
+            PageBacking::Base,
+        )
+    }
+
+    /// Build a `LinearMemory` with either self-owned or VM owned metadata,
+    /// in either a new mapping or a pool slot.
     unsafe fn new_internal(
         memory: &MemoryType,
         style: &MemoryStyle,
         vm_memory_location: Option<NonNull<VMMemoryDefinition>>,
+        slot: Option<MemorySlot>,
+        requested_backing: PageBacking,
     ) -> Result<Self, MemoryError> {
-        if memory.minimum > Pages::max_value() {
+        // The limit is `65536` pages for 32-bit memories.
+        let page_limit = memory.page_limit();
+        if memory.minimum > page_limit {
             return Err(MemoryError::MinimumMemoryTooLarge {
                 min_requested: memory.minimum,
-                max_allowed: Pages::max_value(),
+                max_allowed: page_limit,
             });
         }
-        // `maximum` cannot be set to more than `65536` pages.
         if let Some(max) = memory.maximum {
-            if max > Pages::max_value() {
+            if max > page_limit {
                 return Err(MemoryError::MaximumMemoryTooLarge {
                     max_requested: max,
-                    max_allowed: Pages::max_value(),
+                    max_allowed: page_limit,
                 });
             }
             if max < memory.minimum {
@@ -192,6 +339,10 @@ impl LinearMemory {
                     ),
                 });
             }
+        } else if memory.shared {
+            return Err(MemoryError::InvalidMemory {
+                reason: "shared memories must have a maximum size".to_string(),
+            });
         }
 
         let offset_guard_bytes = style.offset_guard_size() as usize;
@@ -205,21 +356,34 @@ impl LinearMemory {
                 MemoryStyle::Static { .. } => true,
             };
 
-        let minimum_pages = match style {
-            MemoryStyle::Dynamic { .. } => memory.minimum,
-            MemoryStyle::Static { bound, .. } => {
-                assert_ge!(*bound, memory.minimum);
-                *bound
-            }
-        };
-        let minimum_bytes = minimum_pages.bytes().0;
-        let request_bytes = minimum_bytes.checked_add(offset_guard_bytes).unwrap();
+        let request_bytes = reservation_size(memory, style);
         let mapped_pages = memory.minimum;
         let mapped_bytes = mapped_pages.bytes();
 
-        let mut mmap = WasmMmap {
-            alloc: Mmap::accessible_reserved(mapped_bytes.0, request_bytes)
+        let alloc = match slot {
+            Some(mut slot) => {
+                assert_lt!(request_bytes, slot.mmap().len());
+
+                if mapped_bytes.0 > 0 {
+                    slot.mmap_mut()
+                        .make_accessible(0, mapped_bytes.0)
+                        .map_err(MemoryError::Region)?;
+                }
+
+                MmapBacking::Pooled(slot)
+            }
+            None => MmapBacking::Owned(
+                Mmap::accessible_reserved_with_backing(
+                    mapped_bytes.0,
+                    request_bytes,
+                    requested_backing,
+                )
                 .map_err(MemoryError::Region)?,
+            ),
+        };
+
+        let mut mmap = WasmMmap {
+            alloc,
             size: memory.minimum,
         };
 
@@ -248,6 +412,7 @@ impl LinearMemory {
             },
             memory: *memory,
             style: style.clone(),
+            requested_backing,
         })
     }
 
@@ -287,7 +452,12 @@ impl Memory for LinearMemory {
         unsafe {
             let md_ptr = self.get_vm_memory_definition();
             let md = md_ptr.as_ref();
-            Bytes::from(md.current_length).try_into().unwrap()
+            let current_length = if self.memory.shared {
+                (*(&md.current_length as *const usize as *const AtomicUsize)).load(Ordering::SeqCst)
+            } else {
+                md.current_length
+            };
+            Bytes::from(current_length).try_into().unwrap()
         }
     }
 
@@ -305,7 +475,10 @@ impl Memory for LinearMemory {
 
         let new_pages = mmap
             .size
-            .checked_add(delta)
+            .0
+            .checked_add(delta.0)
+            .map(Pages)
+            .filter(|new_pages| *new_pages <= self.memory.page_limit())
             .ok_or(MemoryError::CouldNotGrow {
                 current: mmap.size,
                 attempted_delta: delta,
@@ -324,7 +497,7 @@ impl Memory for LinearMemory {
         // Wasm linear memories are never allowed to grow beyond what is
         // indexable. If the memory has no maximum, enforce the greatest
         // limit here.
-        if new_pages >= Pages::max_value() {
+        if new_pages >= self.memory.page_limit() {
             // Linear memory size would exceed the index range.
             return Err(MemoryError::CouldNotGrow {
                 current: mmap.size,
@@ -337,6 +510,15 @@ impl Memory for LinearMemory {
         let new_bytes = new_pages.bytes().0;
 
         if new_bytes > mmap.alloc.len() - self.offset_guard_size {
+            // A shared memory has reserved its maximum, and must never
+            // move anyway.
+            if self.memory.shared {
+                return Err(MemoryError::CouldNotGrow {
+                    current: mmap.size,
+                    attempted_delta: delta,
+                });
+            }
+
             // If the new size is within the declared maximum, but needs more memory than we
             // have on hand, it's a dynamic heap and it can move.
             let guard_bytes = self.offset_guard_size;
@@ -348,13 +530,24 @@ impl Memory for LinearMemory {
                         attempted_delta: Bytes(guard_bytes).try_into().unwrap(),
                     })?;
 
-            let mut new_mmap =
-                Mmap::accessible_reserved(new_bytes, request_bytes).map_err(MemoryError::Region)?;
+            let mut new_mmap = Mmap::accessible_reserved_with_backing(
+                new_bytes,
+                request_bytes,
+                self.requested_backing,
+            )
+            .map_err(MemoryError::Region)?;
 
-            let copy_len = mmap.alloc.len() - self.offset_guard_size;
+            // Only the accessible part of the old mapping is copied: a
+            // pool slot may be larger than the memory's reservation.
+            let copy_len = prev_bytes;
             new_mmap.as_mut_slice()[..copy_len].copy_from_slice(&mmap.alloc.as_slice()[..copy_len]);
 
-            mmap.alloc = new_mmap;
+            // A pool slot is given back to the pool once replaced.
+            if let MmapBacking::Pooled(slot) = &mut mmap.alloc {
+                slot.set_accessible(prev_bytes);
+            }
+
+            mmap.alloc = MmapBacking::Owned(new_mmap);
         } else if delta_bytes > 0 {
             // Make the newly allocated pages accessible.
             mmap.alloc
@@ -368,8 +561,17 @@ impl Memory for LinearMemory {
         unsafe {
             let mut md_ptr = self.get_vm_memory_definition();
             let md = md_ptr.as_mut();
-            md.current_length = new_pages.bytes().0.try_into().unwrap();
-            md.base = mmap.alloc.as_mut_ptr() as _;
+            let new_length = new_pages.bytes().0.try_into().unwrap();
+
+            if self.memory.shared {
+                // The base doesn't change, but the length may be read
+                // concurrently by the other threads.
+                (*(&mut md.current_length as *mut usize as *const AtomicUsize))
+                    .store(new_length, Ordering::SeqCst);
+            } else {
+                md.current_length = new_length;
+                md.base = mmap.alloc.as_mut_ptr() as _;
+            }
         }
 
         Ok(prev_pages)
@@ -380,4 +582,27 @@ impl Memory for LinearMemory {
         let _mmap_guard = self.mmap.lock().unwrap();
         unsafe { self.get_vm_memory_definition() }
     }
+
+    /// Map `image` at the start of the memory, if it fits in its
+    /// current size.
+    unsafe fn map_image(&self, image: &MemoryImage) -> Result<bool, MemoryError> {
+        let mut mmap_guard = self.mmap.lock().unwrap();
+        let mmap = mmap_guard.borrow_mut();
+
+        if image.len() > mmap.size.bytes().0 {
+            return Ok(false);
+        }
+
+        image
+            .map_into(&mut mmap.alloc)
+            .map_err(MemoryError::Region)?;
+
+        Ok(true)
+    }
+
+    /// Returns the kind of pages obtained for the memory, which may be
+    /// less than what was requested.
+    fn page_backing(&self) -> PageBacking {
+        self.mmap.lock().unwrap().alloc.backing()
+    }
 }
@@ -0,0 +1,350 @@
+//! Copy-on-write images of the initial content of linear memories.
+//!
+//! Data segments are normally copied into a linear memory every time
+//! a module is instantiated, which costs O(size of the data) for each
+//! instance. When all the active segments of a memory are at constant,
+//! non-overlapping, in-bounds offsets, the initial content of the
+//! memory is known ahead of time: it is written once in a memory file
+//! (a `memfd`), the memory image, which is then mapped privately
+//! (`MAP_PRIVATE`) at the start of each new memory. Initializing a
+//! memory then only costs the page faults of the pages actually
+//! touched, and the clean pages are shared by all the instances.
+//!
+//! Memory images are only supported on Linux. Everywhere else, and
+//! for the memories that don't qualify, the data segments are copied
+//! eagerly.
+
+use crate::mmap::Mmap;
+use std::fmt;
+use wasmer_types::entity::PrimaryMap;
+use wasmer_types::{LocalMemoryIndex, ModuleInfo, OwnedDataInitializer};
+
+/// The minimum amount of data for which a memory image is built. Below
+/// it, copying the data is cheaper than mapping it.
+const MIN_IMAGE_DATA_SIZE: usize = 64 * 1024;
+
+/// The memory images of the local memories of a module, see
+/// [`MemoryImage::build_all`].
+pub type MemoryImages = PrimaryMap<LocalMemoryIndex, Option<MemoryImage>>;
+
+/// The initial content of a linear memory, stored in a sealed memory
+/// file. See the module documentation.
+pub struct MemoryImage {
+    #[cfg(target_os = "linux")]
+    file: std::fs::File,
+    /// The length of the image, a multiple of the native page size.
+    len: usize,
+}
+
+impl MemoryImage {
+    /// Builds the memory images of all the local memories of `module`.
+    ///
+    /// A memory has no image if it can't, or doesn't need to, be
+    /// initialized with one. Its data initializers must be applied by
+    /// copying them instead.
+    pub fn build_all(
+        module: &ModuleInfo,
+        data_initializers: &[OwnedDataInitializer],
+    ) -> MemoryImages {
+        (module.num_imported_memories..module.memories.len())
+            .map(|index| {
+                let local_index = LocalMemoryIndex::new(index - module.num_imported_memories);
+                Self::build(module, local_index, data_initializers)
+            })
+            .collect()
+    }
+
+    /// Builds the memory image of a local memory of `module`, if all
+    /// its data initializers are at constant, non-overlapping, offsets
+    /// within its initial size.
+    pub fn build(
+        module: &ModuleInfo,
+        local_index: LocalMemoryIndex,
+        data_initializers: &[OwnedDataInitializer],
+    ) -> Option<Self> {
+        let memory_index = module.memory_index(local_index);
+        let minimum_bytes = module.memories[memory_index].minimum.bytes().0;
+
+        let mut segments = data_initializers
+            .iter()
+            .filter(|init| init.location.memory_index == memory_index)
+            .map(|init| {
+                if init.location.base.is_some() {
+                    return None;
+                }
+
+                let start = init.location.offset;
+                let end = start.checked_add(init.data.len())?;
+
+                Some((start, end, &*init.data))
+            })
+            .collect::<Option<Vec<_>>>()?;
+
+        let data_size = segments
+            .iter()
+            .map(|(_, _, data)| data.len())
+            .sum::<usize>();
+
+        if data_size < MIN_IMAGE_DATA_SIZE {
+            return None;
+        }
+
+        // Segments are applied in order, so that a later one overwrites
+        // an earlier one: overlapping segments would have to be
+        // reordered carefully. Just don't build an image for them.
+        segments.sort_by_key(|(start, _, _)| *start);
+
+        if segments.windows(2).any(|pair| pair[0].1 > pair[1].0) {
+            return None;
+        }
+
+        let end = segments.last()?.1;
+
+        if end > minimum_bytes {
+            return None;
+        }
+
+        let page_size = region::page::size();
+        let len = (end + (page_size - 1)) & !(page_size - 1);
+
+        Self::create(len, &segments)
+    }
+
+    /// Builds a memory image of the current content of a linear memory,
+    /// `bytes`, whose length must be a multiple of the native page size.
+    ///
+    /// Only the pages that aren't zero are written in the image, so
+    /// that the untouched parts of the memory don't use any space.
+    pub fn capture(bytes: &[u8]) -> Option<Self> {
+        if bytes.len() < MIN_IMAGE_DATA_SIZE {
+            return None;
+        }
+
+        let page_size = region::page::size();
+        assert_eq!(bytes.len() & (page_size - 1), 0);
+
+        // Runs of consecutive non-zero pages.
+        let mut segments: Vec<(usize, usize, &[u8])> = vec![];
+
+        for (index, page) in bytes.chunks(page_size).enumerate() {
+            if page.iter().all(|byte| *byte == 0) {
+                continue;
+            }
+
+            let start = index * page_size;
+
+            match segments.last_mut() {
+                Some((run_start, end, data)) if *end == start => {
+                    *end = start + page_size;
+                    *data = &bytes[*run_start..*end];
+                }
+                _ => segments.push((start, start + page_size, page)),
+            }
+        }
+
+        Self::create(bytes.len(), &segments)
+    }
+
+    #[cfg(target_os = "linux")]
+    fn create(len: usize, segments: &[(usize, usize, &[u8])]) -> Option<Self> {
+        use std::convert::TryInto;
+        use std::os::unix::fs::FileExt;
+        use std::os::unix::io::{AsRawFd, FromRawFd};
+
+        let fd = unsafe {
+            libc::memfd_create(
+                b"wasm-memory-image\0".as_ptr() as *const libc::c_char,
+                libc::MFD_CLOEXEC | libc::MFD_ALLOW_SEALING,
+            )
+        };
+
+        if fd < 0 {
+            return None;
+        }
+
+        let file = unsafe { std::fs::File::from_raw_fd(fd) };
+        file.set_len(len.try_into().ok()?).ok()?;
+
+        for (start, _, data) in segments {
+            file.write_all_at(data, *start as u64).ok()?;
+        }
+
+        // The image is shared by all the memories mapping it: make sure
+        // nobody can modify it anymore.
+        let seals =
+            libc::F_SEAL_SEAL | libc::F_SEAL_SHRINK | libc::F_SEAL_GROW | libc::F_SEAL_WRITE;
+
+        if unsafe { libc::fcntl(file.as_raw_fd(), libc::F_ADD_SEALS, seals) } != 0 {
+            return None;
+        }
+
+        Some(Self { file, len })
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn create(_len: usize, _segments: &[(usize, usize, &[u8])]) -> Option<Self> {
+        None
+    }
+
+    /// The length of the image, in bytes.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Whether the image is empty.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Copies the content of the image at the start of `dst`, which
+    /// must be at least `self.len()` bytes long. This is the fallback
+    /// for the memories that can't map the image.
+    pub fn copy_into(&self, dst: &mut [u8]) -> Result<(), String> {
+        let dst = &mut dst[..self.len];
+
+        #[cfg(target_os = "linux")]
+        {
+            use std::os::unix::fs::FileExt;
+
+            self.file.read_exact_at(dst, 0).map_err(|e| e.to_string())
+        }
+
+        #[cfg(not(target_os = "linux"))]
+        {
+            let _ = dst;
+            Err("Memory images are not supported on this platform".to_string())
+        }
+    }
+
+    /// Maps the image privately at the start of `mmap`, whose first
+    /// `self.len()` bytes must be accessible.
+    ///
+    /// # Safety
+    ///
+    /// The content of those bytes is replaced, and must not be in use.
+    pub(crate) unsafe fn map_into(&self, mmap: &mut Mmap) -> Result<(), String> {
+        #[cfg(target_os = "linux")]
+        {
+            use std::os::unix::io::AsRawFd;
+
+            mmap.map_file(0, self.len, self.file.as_raw_fd())
+        }
+
+        #[cfg(not(target_os = "linux"))]
+        {
+            let _ = mmap;
+            Err("Memory images are not supported on this platform".to_string())
+        }
+    }
+}
+
+impl fmt::Debug for MemoryImage {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("MemoryImage")
+            .field("len", &self.len)
+            .finish()
+    }
+}
+
+#[cfg(all(test, target_os = "linux"))]
+mod tests {
+    use super::*;
+    use crate::mmap::{huge_page_size, PageBacking};
+    use wasmer_types::entity::EntityRef;
+    use wasmer_types::{DataInitializerLocation, MemoryIndex, MemoryType, Pages};
+
+    fn build(data_initializers: &[OwnedDataInitializer]) -> Option<MemoryImage> {
+        let mut module = ModuleInfo::new();
+        module.memories.push(MemoryType::new(Pages(4), None, false));
+
+        MemoryImage::build(&module, LocalMemoryIndex::new(0), data_initializers)
+    }
+
+    fn data(offset: usize, len: usize, byte: u8) -> OwnedDataInitializer {
+        OwnedDataInitializer {
+            location: DataInitializerLocation {
+                memory_index: MemoryIndex::new(0),
+                base: None,
+                offset,
+            },
+            data: vec![byte; len].into_boxed_slice(),
+        }
+    }
+
+    #[test]
+    fn image_is_mapped_privately() {
+        let image = build(&[data(0x100, 0x1_0000, 1), data(0x2_0000, 0x1_0000, 2)]).unwrap();
+        assert_eq!(image.len(), 0x3_0000);
+
+        let mut mmap = Mmap::accessible_reserved(0x4_0000, 0x5_0000).unwrap();
+        unsafe { image.map_into(&mut mmap) }.unwrap();
+
+        let bytes = mmap.as_mut_slice();
+        assert_eq!(bytes[0xff], 0);
+        assert_eq!(bytes[0x100], 1);
+        assert_eq!(bytes[0x1_0100], 0);
+        assert_eq!(bytes[0x2_0000], 2);
+        assert_eq!(bytes[0x3_0000], 0);
+
+        // Writes are not shared with the other memories.
+        bytes[0x100] = 3;
+        let mut other = Mmap::accessible_reserved(0x4_0000, 0x5_0000).unwrap();
+        unsafe { image.map_into(&mut other) }.unwrap();
+        assert_eq!(other.as_slice()[0x100], 1);
+
+        // Resetting the memory drops the mapping of the image.
+        mmap.reset(0x4_0000).unwrap();
+        mmap.make_accessible(0, 0x4_0000).unwrap();
+        assert_eq!(mmap.as_slice()[0x100], 0);
+    }
+
+    #[test]
+    fn image_is_mapped_over_huge_pages() {
+        let huge_page_size = huge_page_size();
+        let image = build(&[data(0x100, 0x1_0000, 1)]).unwrap();
+
+        let mut mmap = Mmap::accessible_reserved_with_backing(
+            2 * huge_page_size,
+            4 * huge_page_size,
+            PageBacking::HugeTlb,
+        )
+        .unwrap();
+        mmap.as_mut_slice()[huge_page_size] = 2;
+        unsafe { image.map_into(&mut mmap) }.unwrap();
+
+        // The image can't replace a part of a `MAP_HUGETLB` page: the
+        // memory falls back to transparent huge pages, and keeps the
+        // content that is not replaced.
+        assert_ne!(mmap.backing(), PageBacking::HugeTlb);
+        let bytes = mmap.as_slice();
+        assert_eq!(bytes[0xff], 0);
+        assert_eq!(bytes[0x100], 1);
+        assert_eq!(bytes[huge_page_size], 2);
+    }
+
+    #[test]
+    fn captured_image_skips_zero_pages() {
+        let page_size = region::page::size();
+        let mut bytes = vec![0; 0x4_0000];
+        bytes[0] = 1;
+        bytes[page_size] = 2;
+        bytes[0x3_0000] = 3;
+
+        let image = MemoryImage::capture(&bytes).unwrap();
+        assert_eq!(image.len(), bytes.len());
+
+        let mut copy = vec![0xff; bytes.len()];
+        image.copy_into(&mut copy).unwrap();
+        assert_eq!(copy, bytes);
+    }
+
+    #[test]
+    fn no_image_for_unsuitable_segments() {
+        // Too small.
+        assert!(build(&[data(0, 0x100, 1)]).is_none());
+        // Overlapping.
+        assert!(build(&[data(0, 0x1_0000, 1), data(0x8000, 0x1_0000, 2)]).is_none());
+        // Out of the initial size.
+        assert!(build(&[data(0x3_8000, 0x1_0000, 1)]).is_none());
+    }
+}
@@ -16,6 +16,58 @@ fn round_up_to_page_size(size: usize, page_size: usize) -> usize {
     (size + (page_size - 1)) & !(page_size - 1)
 }
 
+/// The kind of pages backing the accessible memory of an [`Mmap`],
+/// from the least to the most efficient for the TLB.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash, MemoryUsage)]
+pub enum PageBacking {
+    /// Pages of the native size.
+    Base,
+    /// Transparent huge pages: the memory is advised with
+    /// `MADV_HUGEPAGE`, and the kernel backs what it can of it with
+    /// huge pages. Requires transparent huge pages not to be disabled
+    /// on the system.
+    TransparentHuge,
+    /// Huge pages from the pool reserved by the administrator in
+    /// `/proc/sys/vm/nr_hugepages`, mapped with `MAP_HUGETLB`.
+    HugeTlb,
+}
+
+impl Default for PageBacking {
+    fn default() -> Self {
+        Self::Base
+    }
+}
+
+#[cfg(target_os = "linux")]
+lazy_static::lazy_static! {
+    static ref HUGE_PAGE_SIZE: usize = std::fs::read_to_string("/proc/meminfo")
+        .ok()
+        .and_then(|meminfo| {
+            let line = meminfo.lines().find(|line| line.starts_with("Hugepagesize:"))?;
+            let kib = line.split_whitespace().nth(1)?.parse::<usize>().ok()?;
+            Some(kib * 1024)
+        })
+        .unwrap_or(2 << 20);
+
+    static ref TRANSPARENT_HUGE_PAGES: bool =
+        std::fs::read_to_string("/sys/kernel/mm/transparent_hugepage/enabled")
+            .map(|enabled| !enabled.contains("[never]"))
+            .unwrap_or(false);
+}
+
+/// Returns the size of the huge pages of the system, or the native page
+/// size where huge pages are not supported.
+pub fn huge_page_size() -> usize {
+    #[cfg(target_os = "linux")]
+    {
+        *HUGE_PAGE_SIZE
+    }
+    #[cfg(not(target_os = "linux"))]
+    {
+        region::page::size()
+    }
+}
+
 /// A simple struct consisting of a page-aligned pointer to page-aligned
 /// and initially-zeroed memory and a length.
 #[derive(Debug)]
@@ -26,6 +78,10 @@ pub struct Mmap {
     // the coordination all happens at the OS layer.
     ptr: usize,
     len: usize,
+    backing: PageBacking,
+    /// The offsets of the huge pages mapped with `MAP_HUGETLB`.
+    #[cfg_attr(not(target_os = "linux"), allow(dead_code))]
+    huge_tlb_pages: Vec<usize>,
 }
 
 impl Mmap {
@@ -38,6 +94,8 @@ impl Mmap {
         Self {
             ptr: empty.as_ptr() as usize,
             len: 0,
+            backing: PageBacking::Base,
+            huge_tlb_pages: Vec::new(),
         }
     }
 
@@ -86,6 +144,8 @@ impl Mmap {
             Self {
                 ptr: ptr as usize,
                 len: mapping_size,
+                backing: PageBacking::Base,
+                huge_tlb_pages: Vec::new(),
             }
         } else {
             // Reserve the mapping size.
@@ -106,6 +166,8 @@ impl Mmap {
             let mut result = Self {
                 ptr: ptr as usize,
                 len: mapping_size,
+                backing: PageBacking::Base,
+                huge_tlb_pages: Vec::new(),
             };
 
             if accessible_size != 0 {
@@ -156,6 +218,8 @@ impl Mmap {
             Self {
                 ptr: ptr as usize,
                 len: mapping_size,
+                backing: PageBacking::Base,
+                huge_tlb_pages: Vec::new(),
             }
         } else {
             // Reserve the mapping size.
@@ -168,6 +232,8 @@ impl Mmap {
             let mut result = Self {
                 ptr: ptr as usize,
                 len: mapping_size,
+                backing: PageBacking::Base,
+                huge_tlb_pages: Vec::new(),
             };
 
             if accessible_size != 0 {
@@ -179,6 +245,214 @@ impl Mmap {
         })
     }
 
+    /// Like [`Mmap::accessible_reserved`], but the accessible memory is
+    /// backed by the kind of pages requested by `backing`, if the system
+    /// provides them. The reservation is then aligned to the huge page
+    /// size. [`Mmap::backing`] tells which backing has been obtained.
+    ///
+    /// Huge pages are only supported on Linux.
+    pub fn accessible_reserved_with_backing(
+        accessible_size: usize,
+        mapping_size: usize,
+        backing: PageBacking,
+    ) -> Result<Self, String> {
+        #[cfg(target_os = "linux")]
+        if backing != PageBacking::Base && mapping_size != 0 {
+            return Self::huge_accessible_reserved(accessible_size, mapping_size, backing);
+        }
+
+        let _ = backing;
+        Self::accessible_reserved(accessible_size, mapping_size)
+    }
+
+    #[cfg(target_os = "linux")]
+    fn huge_accessible_reserved(
+        accessible_size: usize,
+        mapping_size: usize,
+        backing: PageBacking,
+    ) -> Result<Self, String> {
+        let page_size = region::page::size();
+        assert_le!(accessible_size, mapping_size);
+        assert_eq!(mapping_size & (page_size - 1), 0);
+        assert_eq!(accessible_size & (page_size - 1), 0);
+
+        // Reserve one more huge page, to align the start of the mapping.
+        let huge_page_size = huge_page_size();
+        let padded_size = mapping_size
+            .checked_add(huge_page_size)
+            .ok_or_else(|| "mapping size overflow".to_string())?;
+        let ptr = unsafe {
+            libc::mmap(
+                ptr::null_mut(),
+                padded_size,
+                libc::PROT_NONE,
+                libc::MAP_PRIVATE | libc::MAP_ANON,
+                -1,
+                0,
+            )
+        };
+        if ptr as isize == -1_isize {
+            return Err(io::Error::last_os_error().to_string());
+        }
+
+        // Give the unaligned head and tail back.
+        let start = round_up_to_page_size(ptr as usize, huge_page_size);
+        let head = start - ptr as usize;
+        let tail = padded_size - head - mapping_size;
+        unsafe {
+            if head != 0 {
+                libc::munmap(ptr, head);
+            }
+            if tail != 0 {
+                libc::munmap((start + mapping_size) as *mut libc::c_void, tail);
+            }
+        }
+
+        let mut result = Self {
+            ptr: start,
+            len: mapping_size,
+            backing: PageBacking::Base,
+            huge_tlb_pages: Vec::new(),
+        };
+        result.backing = match backing {
+            PageBacking::Base => PageBacking::Base,
+            PageBacking::TransparentHuge => result.advise_huge_pages(),
+            PageBacking::HugeTlb => PageBacking::HugeTlb,
+        };
+
+        if accessible_size != 0 {
+            unsafe {
+                region::protect(
+                    start as *const u8,
+                    accessible_size,
+                    region::Protection::READ_WRITE,
+                )
+            }
+            .map_err(|e| e.to_string())?;
+            result.map_huge_pages(0, accessible_size)?;
+        }
+
+        Ok(result)
+    }
+
+    /// Advise the whole mapping to be backed by transparent huge pages,
+    /// and return the backing obtained.
+    #[cfg(target_os = "linux")]
+    fn advise_huge_pages(&self) -> PageBacking {
+        if !*TRANSPARENT_HUGE_PAGES {
+            return PageBacking::Base;
+        }
+
+        let advised =
+            unsafe { libc::madvise(self.ptr as *mut libc::c_void, self.len, libc::MADV_HUGEPAGE) };
+
+        if advised == 0 {
+            PageBacking::TransparentHuge
+        } else {
+            PageBacking::Base
+        }
+    }
+
+    /// Replace the whole huge pages of the freshly accessible memory
+    /// starting at `start` and extending for `len` bytes by `MAP_HUGETLB`
+    /// pages, if the mapping is backed by them. The parts of the range
+    /// that don't cover a whole huge page keep their native pages.
+    ///
+    /// Once the huge page pool is exhausted, the whole mapping falls
+    /// back to transparent huge pages, see
+    /// [`Mmap::fall_back_from_huge_tlb`].
+    #[cfg(target_os = "linux")]
+    fn map_huge_pages(&mut self, start: usize, len: usize) -> Result<(), String> {
+        if self.backing != PageBacking::HugeTlb {
+            return Ok(());
+        }
+
+        let huge_page_size = huge_page_size();
+        let end = (self.ptr + start + len) & !(huge_page_size - 1);
+        let mut chunk = round_up_to_page_size(self.ptr + start, huge_page_size);
+
+        while chunk + huge_page_size <= end {
+            let ptr = unsafe {
+                libc::mmap(
+                    chunk as *mut libc::c_void,
+                    huge_page_size,
+                    libc::PROT_READ | libc::PROT_WRITE,
+                    libc::MAP_PRIVATE | libc::MAP_ANON | libc::MAP_FIXED | libc::MAP_HUGETLB,
+                    -1,
+                    0,
+                )
+            };
+
+            if ptr as isize == -1_isize {
+                // The previous pages may be gone with a failed
+                // `MAP_FIXED`: map them again. They were fresh anyway.
+                let ptr = unsafe {
+                    libc::mmap(
+                        chunk as *mut libc::c_void,
+                        huge_page_size,
+                        libc::PROT_READ | libc::PROT_WRITE,
+                        libc::MAP_PRIVATE | libc::MAP_ANON | libc::MAP_FIXED,
+                        -1,
+                        0,
+                    )
+                };
+                if ptr as isize == -1_isize {
+                    return Err(io::Error::last_os_error().to_string());
+                }
+
+                return self.fall_back_from_huge_tlb();
+            }
+
+            self.huge_tlb_pages.push(chunk - self.ptr);
+            chunk += huge_page_size;
+        }
+
+        Ok(())
+    }
+
+    /// Replace the `MAP_HUGETLB` pages of the mapping by native pages,
+    /// keeping their content, and advise the whole mapping to be backed
+    /// by transparent huge pages instead, so that [`Mmap::backing`]
+    /// describes all of the accessible memory rather than only its
+    /// latest part.
+    #[cfg(target_os = "linux")]
+    fn fall_back_from_huge_tlb(&mut self) -> Result<(), String> {
+        let huge_page_size = huge_page_size();
+        let mut content = Vec::new();
+
+        while let Some(offset) = self.huge_tlb_pages.pop() {
+            let page = (self.ptr + offset) as *mut u8;
+            content.resize(huge_page_size, 0);
+
+            unsafe {
+                ptr::copy_nonoverlapping(page, content.as_mut_ptr(), huge_page_size);
+                let ptr = libc::mmap(
+                    page as *mut libc::c_void,
+                    huge_page_size,
+                    libc::PROT_READ | libc::PROT_WRITE,
+                    libc::MAP_PRIVATE | libc::MAP_ANON | libc::MAP_FIXED,
+                    -1,
+                    0,
+                );
+                if ptr as isize == -1_isize {
+                    return Err(io::Error::last_os_error().to_string());
+                }
+                ptr::copy_nonoverlapping(content.as_ptr(), page, huge_page_size);
+            }
+        }
+
+        self.backing = self.advise_huge_pages();
+
+        Ok(())
+    }
+
+    /// Return the kind of pages backing the accessible memory. With
+    /// [`PageBacking::HugeTlb`], the ranges of accessible memory that
+    /// don't cover a whole huge page are still backed by native pages.
+    pub fn backing(&self) -> PageBacking {
+        self.backing
+    }
+
     /// Make the memory starting at `start` and extending for `len` bytes accessible.
     /// `start` and `len` must be native page-size multiples and describe a range within
     /// `self`'s reserved memory.
@@ -193,7 +467,12 @@ impl Mmap {
         // Commit the accessible size.
         let ptr = self.ptr as *const u8;
         unsafe { region::protect(ptr.add(start), len, region::Protection::READ_WRITE) }
-            .map_err(|e| e.to_string())
+            .map_err(|e| e.to_string())?;
+
+        #[cfg(target_os = "linux")]
+        self.map_huge_pages(start, len)?;
+
+        Ok(())
     }
 
     /// Make the memory starting at `start` and extending for `len` bytes accessible.
@@ -228,6 +507,154 @@ impl Mmap {
         Ok(())
     }
 
+    /// Map the `len` bytes at the start of the file `fd` privately over
+    /// the memory starting at `start`, which becomes accessible. Writes
+    /// are copied on write and never reach the file. `start` and `len`
+    /// must be native page-size multiples and describe a range within
+    /// `self`'s reserved memory.
+    ///
+    /// `MAP_HUGETLB` pages can't be partly replaced by the native pages
+    /// of a file, so a mapping backed by them falls back to transparent
+    /// huge pages first, keeping its content.
+    ///
+    /// # Safety
+    ///
+    /// The previous content of the memory in this range is replaced, it
+    /// must not be in use.
+    #[cfg(target_os = "linux")]
+    pub unsafe fn map_file(
+        &mut self,
+        start: usize,
+        len: usize,
+        fd: std::os::unix::io::RawFd,
+    ) -> Result<(), String> {
+        let page_size = region::page::size();
+        assert_eq!(start & (page_size - 1), 0);
+        assert_eq!(len & (page_size - 1), 0);
+        assert_le!(len, self.len);
+        assert_le!(start, self.len - len);
+
+        if self.backing == PageBacking::HugeTlb {
+            self.fall_back_from_huge_tlb()?;
+        }
+
+        let ptr = libc::mmap(
+            (self.ptr + start) as *mut libc::c_void,
+            len,
+            libc::PROT_READ | libc::PROT_WRITE,
+            libc::MAP_PRIVATE | libc::MAP_FIXED,
+            fd,
+            0,
+        );
+
+        if ptr as isize == -1_isize {
+            return Err(io::Error::last_os_error().to_string());
+        }
+
+        Ok(())
+    }
+
+    /// Reset the first `accessible_size` bytes of the memory to zero and
+    /// make them inaccessible again, without unmapping them, so that the
+    /// reservation can be reused. `accessible_size` must be a native
+    /// page-size multiple, strictly smaller than `self`'s reserved memory.
+    #[cfg(not(target_os = "windows"))]
+    pub fn reset(&mut self, accessible_size: usize) -> Result<(), String> {
+        let page_size = region::page::size();
+        assert_eq!(accessible_size & (page_size - 1), 0);
+        assert_lt!(accessible_size, self.len);
+
+        if accessible_size == 0 {
+            return Ok(());
+        }
+
+        let ptr = self.ptr as *mut u8;
+
+        // On Linux, the pages are replaced by a fresh anonymous mapping,
+        // which drops them and makes them inaccessible in one system
+        // call. Unlike `MADV_DONTNEED`, it also zero-fills the pages
+        // that were mapped from a file by `map_file`. Other systems
+        // don't guarantee that, so the pages are zeroed by hand.
+        #[cfg(target_os = "linux")]
+        {
+            let remapped = unsafe {
+                libc::mmap(
+                    ptr as *mut libc::c_void,
+                    accessible_size,
+                    libc::PROT_NONE,
+                    libc::MAP_PRIVATE | libc::MAP_ANON | libc::MAP_FIXED,
+                    -1,
+                    0,
+                )
+            };
+
+            if remapped as isize == -1_isize {
+                return Err(io::Error::last_os_error().to_string());
+            }
+
+            // The huge pages were all in the accessible memory, which
+            // is now backed by native pages.
+            self.huge_tlb_pages.clear();
+
+            Ok(())
+        }
+        #[cfg(not(target_os = "linux"))]
+        {
+            unsafe {
+                ptr::write_bytes(ptr, 0, accessible_size);
+            }
+
+            unsafe { region::protect(ptr, accessible_size, region::Protection::NONE) }
+                .map_err(|e| e.to_string())
+        }
+    }
+
+    /// Reset the first `accessible_size` bytes of the memory to zero and
+    /// make them inaccessible again, without unmapping them, so that the
+    /// reservation can be reused. `accessible_size` must be a native
+    /// page-size multiple, strictly smaller than `self`'s reserved memory.
+    #[cfg(target_os = "windows")]
+    pub fn reset(&mut self, accessible_size: usize) -> Result<(), String> {
+        use winapi::ctypes::c_void;
+        use winapi::um::memoryapi::VirtualFree;
+        use winapi::um::winnt::MEM_DECOMMIT;
+        let page_size = region::page::size();
+        assert_eq!(accessible_size & (page_size - 1), 0);
+        assert_lt!(accessible_size, self.len);
+
+        if accessible_size == 0 {
+            return Ok(());
+        }
+
+        // Decommitted pages are zero-filled when they are committed again.
+        if unsafe { VirtualFree(self.ptr as *mut c_void, accessible_size, MEM_DECOMMIT) } == 0 {
+            return Err(io::Error::last_os_error().to_string());
+        }
+
+        Ok(())
+    }
+
+    /// Advise the system that the `len` bytes starting at `start` are not
+    /// needed anymore, so that the physical pages backing them can be
+    /// reclaimed. The memory stays accessible, and its content is
+    /// unspecified afterwards. `start` must be a native page-size multiple.
+    ///
+    /// # Safety
+    ///
+    /// The memory in this range must not be in use.
+    pub unsafe fn discard(&self, start: usize, len: usize) {
+        let page_size = region::page::size();
+        assert_eq!(start & (page_size - 1), 0);
+        assert_le!(len, self.len - start);
+
+        #[cfg(target_os = "linux")]
+        libc::madvise(
+            (self.ptr + start) as *mut libc::c_void,
+            len,
+            libc::MADV_DONTNEED,
+        );
+    }
+
     /// Return the allocated memory as a slice of u8.
     pub fn as_slice(&self) -> &[u8] {
         unsafe { slice::from_raw_parts(self.ptr as *const u8, self.len) }
@@ -304,4 +731,33 @@ mod tests {
         assert_eq!(round_up_to_page_size(4096, 4096), 4096);
         assert_eq!(round_up_to_page_size(4097, 4096), 8192);
     }
+
+    #[test]
+    fn huge_page_backing() {
+        let huge_page_size = huge_page_size();
+
+        for &backing in &[
+            PageBacking::Base,
+            PageBacking::TransparentHuge,
+            PageBacking::HugeTlb,
+        ] {
+            let mut mmap =
+                Mmap::accessible_reserved_with_backing(huge_page_size, 4 * huge_page_size, backing)
+                    .unwrap();
+
+            // The backing obtained depends on the system, but never
+            // exceeds the request.
+            assert!(mmap.backing() <= backing);
+            if backing != PageBacking::Base {
+                assert_eq!(mmap.as_ptr() as usize % huge_page_size, 0);
+            }
+
+            mmap.make_accessible(huge_page_size, huge_page_size)
+                .unwrap();
+            let slice = &mut mmap.as_mut_slice()[..2 * huge_page_size];
+            assert!(slice.iter().all(|byte| *byte == 0));
+            slice[0] = 1;
+            slice[2 * huge_page_size - 1] = 1;
+        }
+    }
 }
@@ -0,0 +1,411 @@
+//! A pooling allocator for instances and their linear memories.
+//!
+//! Allocating an instance normally involves a `std::alloc` call for
+//! its `VMContext`, and a fresh `mmap` of the whole reservation of
+//! each of its linear memories, which are unmapped again when the
+//! instance is dropped. When instances are short-lived (e.g. one
+//! instance per request), those system calls and the page-table churn
+//! they cause dominate.
+//!
+//! The [`PoolingAllocator`] reserves a fixed number of instance and
+//! memory slots up front. Slots are recycled when instances are
+//! dropped: their pages are released (which also zeroes them) in
+//! place, without giving their address range back to the system.
+//! When the pool is exhausted, or when an instance or a memory
+//! doesn't fit in a slot, the allocation falls back to the regular,
+//! non-pooled, path.
+
+use crate::instance::InstanceAllocator;
+use crate::memory::{reservation_size, LinearMemory, MemoryError};
+use crate::mmap::Mmap;
+use crate::vmcontext::{VMMemoryDefinition, VMTableDefinition};
+use std::fmt;
+use std::mem;
+use std::ptr::NonNull;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use wasmer_types::{MemoryStyle, MemoryType, ModuleInfo, VMOffsets};
+
+/// Round `size` up to the nearest multiple of `page_size`.
+fn round_up_to_page_size(size: usize, page_size: usize) -> usize {
+    (size + (page_size - 1)) & !(page_size - 1)
+}
+
+/// The configuration of a [`PoolingAllocator`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PoolingConfig {
+    /// The number of instance slots.
+    pub max_instances: usize,
+    /// The size in bytes of an instance slot, which holds the
+    /// `Instance` and its `VMContext`.
+    pub instance_slot_size: usize,
+    /// The number of linear memory slots.
+    pub max_memories: usize,
+    /// The size in bytes of the address space reserved for a linear
+    /// memory slot, including its offset guard. A memory whose
+    /// reservation doesn't fit in a slot isn't pooled.
+    pub memory_slot_size: usize,
+}
+
+impl Default for PoolingConfig {
+    fn default() -> Self {
+        Self {
+            max_instances: 1000,
+            instance_slot_size: 1 << 20,
+            max_memories: 1000,
+            // A 4 GiB static memory with a 2 GiB offset guard, plus a
+            // page, which is what the default tunables use on 64-bit
+            // targets.
+            #[cfg(target_pointer_width = "64")]
+            memory_slot_size: 0x1_8001_0000,
+            #[cfg(not(target_pointer_width = "64"))]
+            memory_slot_size: 0x4002_0000,
+        }
+    }
+}
+
+/// Occupancy statistics of a [`PoolingAllocator`], see
+/// [`PoolingAllocator::stats`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PoolingStats {
+    /// The number of instance slots.
+    pub instance_slots: usize,
+    /// The number of instance slots currently in use.
+    pub instances_in_use: usize,
+    /// The number of instances that could not be allocated in a slot,
+    /// and have been allocated with `std::alloc` instead.
+    pub instance_fallbacks: usize,
+    /// The number of linear memory slots.
+    pub memory_slots: usize,
+    /// The number of linear memory slots currently in use.
+    pub memories_in_use: usize,
+    /// The number of linear memories that could not be allocated in a
+    /// slot, and have been mapped on their own instead.
+    pub memory_fallbacks: usize,
+}
+
+/// The state shared by a [`PoolingAllocator`] and its slots.
+struct PoolInner {
+    instances: Mmap,
+    instance_slots: usize,
+    instance_slot_size: usize,
+    free_instances: Mutex<Vec<usize>>,
+    instances_in_use: AtomicUsize,
+    instance_fallbacks: AtomicUsize,
+
+    memory_slot_size: usize,
+    free_memories: Mutex<Vec<Mmap>>,
+    memory_slots: AtomicUsize,
+    memories_in_use: AtomicUsize,
+    memory_fallbacks: AtomicUsize,
+}
+
+impl PoolInner {
+    fn release_instance(&self, index: usize, used: usize) {
+        let start = index * self.instance_slot_size;
+        let used = round_up_to_page_size(used, region::page::size());
+
+        // Give the physical pages back to the system. The slot stays
+        // mapped, and is fully overwritten by the next instance.
+        unsafe {
+            self.instances.discard(start, used);
+        }
+
+        self.free_instances.lock().unwrap().push(index);
+        self.instances_in_use.fetch_sub(1, Ordering::Relaxed);
+    }
+
+    fn release_memory(&self, mut mmap: Mmap, accessible: usize) {
+        self.memories_in_use.fetch_sub(1, Ordering::Relaxed);
+
+        match mmap.reset(accessible) {
+            Ok(()) => self.free_memories.lock().unwrap().push(mmap),
+            // The slot is lost, it's unmapped when dropped.
+            Err(_) => {
+                self.memory_slots.fetch_sub(1, Ordering::Relaxed);
+            }
+        }
+    }
+}
+
+/// An instance slot taken from a [`PoolingAllocator`]. It is given
+/// back to its pool when dropped.
+pub(crate) struct InstanceSlot {
+    pool: Arc<PoolInner>,
+    index: usize,
+    used: usize,
+}
+
+impl InstanceSlot {
+    /// Returns a pointer to the start of the slot.
+    pub(crate) fn as_ptr(&self) -> NonNull<u8> {
+        unsafe {
+            NonNull::new_unchecked(
+                self.pool
+                    .instances
+                    .as_ptr()
+                    .add(self.index * self.pool.instance_slot_size) as *mut u8,
+            )
+        }
+    }
+}
+
+impl Drop for InstanceSlot {
+    fn drop(&mut self) {
+        self.pool.release_instance(self.index, self.used);
+    }
+}
+
+impl fmt::Debug for InstanceSlot {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("InstanceSlot")
+            .field("index", &self.index)
+            .finish()
+    }
+}
+
+/// A linear memory slot taken from a [`PoolingAllocator`]. It is
+/// reset and given back to its pool when dropped.
+pub(crate) struct MemorySlot {
+    pool: Arc<PoolInner>,
+    mmap: Mmap,
+    accessible: usize,
+}
+
+impl MemorySlot {
+    pub(crate) fn mmap(&self) -> &Mmap {
+        &self.mmap
+    }
+
+    pub(crate) fn mmap_mut(&mut self) -> &mut Mmap {
+        &mut self.mmap
+    }
+
+    /// Records how many bytes at the start of the slot have been made
+    /// accessible, and must be reset when the slot is given back.
+    pub(crate) fn set_accessible(&mut self, accessible: usize) {
+        self.accessible = accessible;
+    }
+}
+
+impl Drop for MemorySlot {
+    fn drop(&mut self) {
+        let mmap = mem::replace(&mut self.mmap, Mmap::new());
+        self.pool.release_memory(mmap, self.accessible);
+    }
+}
+
+impl fmt::Debug for MemorySlot {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("MemorySlot")
+            .field("mmap", &self.mmap)
+            .field("accessible", &self.accessible)
+            .finish()
+    }
+}
+
+/// A pool of pre-reserved instance and linear memory slots, see the
+/// module documentation.
+///
+/// It is used by [`Tunables`] implementations that opt in to pooling.
+/// The slots are returned to the pool when the instances and memories
+/// using them are dropped, so the pool can safely be dropped first.
+///
+/// [`Tunables`]: https://docs.rs/wasmer-engine/*/wasmer_engine/trait.Tunables.html
+#[derive(Clone)]
+pub struct PoolingAllocator {
+    inner: Arc<PoolInner>,
+}
+
+impl PoolingAllocator {
+    /// Creates a new pool, reserving all its slots up front.
+    pub fn new(config: PoolingConfig) -> Result<Self, String> {
+        let page_size = region::page::size();
+        let instance_slot_size = round_up_to_page_size(config.instance_slot_size, page_size);
+        let memory_slot_size = round_up_to_page_size(config.memory_slot_size, page_size);
+
+        let instances_size = instance_slot_size
+            .checked_mul(config.max_instances)
+            .ok_or_else(|| "The instance slots are too large".to_string())?;
+        let instances = Mmap::accessible_reserved(instances_size, instances_size)?;
+
+        let free_memories = (0..config.max_memories)
+            .map(|_| Mmap::accessible_reserved(0, memory_slot_size))
+            .collect::<Result<Vec<_>, _>>()?;
+
+        Ok(Self {
+            inner: Arc::new(PoolInner {
+                instances,
+                instance_slots: config.max_instances,
+                instance_slot_size,
+                // Slots are popped from the end, start with the first ones.
+                free_instances: Mutex::new((0..config.max_instances).rev().collect()),
+                instances_in_use: AtomicUsize::new(0),
+                instance_fallbacks: AtomicUsize::new(0),
+
+                memory_slot_size,
+                free_memories: Mutex::new(free_memories),
+                memory_slots: AtomicUsize::new(config.max_memories),
+                memories_in_use: AtomicUsize::new(0),
+                memory_fallbacks: AtomicUsize::new(0),
+            }),
+        })
+    }
+
+    /// Allocates the instance data for `module`, see
+    /// [`InstanceAllocator::new`].
+    ///
+    /// It is stored in a slot of the pool, if one is available and
+    /// large enough.
+    pub fn allocate_instance(
+        &self,
+        module: &ModuleInfo,
+    ) -> (
+        InstanceAllocator,
+        Vec<NonNull<VMMemoryDefinition>>,
+        Vec<NonNull<VMTableDefinition>>,
+    ) {
+        let offsets = VMOffsets::new(mem::size_of::<usize>() as u8, module);
+        let instance_layout = InstanceAllocator::instance_layout(&offsets);
+        let inner = &self.inner;
+
+        if instance_layout.size() <= inner.instance_slot_size
+            && instance_layout.align() <= region::page::size()
+        {
+            let index = inner.free_instances.lock().unwrap().pop();
+
+            if let Some(index) = index {
+                inner.instances_in_use.fetch_add(1, Ordering::Relaxed);
+
+                let slot = InstanceSlot {
+                    pool: inner.clone(),
+                    index,
+                    used: instance_layout.size(),
+                };
+
+                return InstanceAllocator::new_in_slot(offsets, instance_layout, slot);
+            }
+        }
+
+        inner.instance_fallbacks.fetch_add(1, Ordering::Relaxed);
+
+        InstanceAllocator::new(module)
+    }
+
+    /// Creates a linear memory owned by the VM, see
+    /// [`LinearMemory::from_definition`].
+    ///
+    /// It is mapped in a slot of the pool, if one is available and
+    /// large enough.
+    ///
+    /// # Safety
+    /// - `vm_memory_location` must point to a valid location in VM memory.
+    pub unsafe fn create_vm_memory(
+        &self,
+        memory: &MemoryType,
+        style: &MemoryStyle,
+        vm_memory_location: NonNull<VMMemoryDefinition>,
+    ) -> Result<LinearMemory, MemoryError> {
+        let inner = &self.inner;
+
+        // The reservation must be strictly smaller than the slot, so
+        // that the accessible part can be reset.
+        if reservation_size(memory, style) < inner.memory_slot_size {
+            let mmap = inner.free_memories.lock().unwrap().pop();
+
+            if let Some(mmap) = mmap {
+                inner.memories_in_use.fetch_add(1, Ordering::Relaxed);
+
+                let slot = MemorySlot {
+                    pool: inner.clone(),
+                    mmap,
+                    accessible: 0,
+                };
+
+                return LinearMemory::from_definition_in_slot(
+                    memory,
+                    style,
+                    vm_memory_location,
+                    slot,
+                );
+            }
+        }
+
+        inner.memory_fallbacks.fetch_add(1, Ordering::Relaxed);
+
+        LinearMemory::from_definition(memory, style, vm_memory_location)
+    }
+
+    /// Returns the occupancy statistics of the pool.
+    pub fn stats(&self) -> PoolingStats {
+        let inner = &self.inner;
+
+        PoolingStats {
+            instance_slots: inner.instance_slots,
+            instances_in_use: inner.instances_in_use.load(Ordering::Relaxed),
+            instance_fallbacks: inner.instance_fallbacks.load(Ordering::Relaxed),
+            memory_slots: inner.memory_slots.load(Ordering::Relaxed),
+            memories_in_use: inner.memories_in_use.load(Ordering::Relaxed),
+            memory_fallbacks: inner.memory_fallbacks.load(Ordering::Relaxed),
+        }
+    }
+}
+
+impl fmt::Debug for PoolingAllocator {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("PoolingAllocator")
+            .field("stats", &self.stats())
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::memory::Memory;
+    use wasmer_types::Pages;
+
+    #[test]
+    fn memory_slots_are_reset_and_reused() {
+        let pool = PoolingAllocator::new(PoolingConfig {
+            max_instances: 1,
+            instance_slot_size: 0x1_0000,
+            max_memories: 1,
+            memory_slot_size: 0x10_0000,
+        })
+        .unwrap();
+        let memory_type = MemoryType::new(1, Some(4), false);
+        let style = MemoryStyle::Dynamic {
+            offset_guard_size: 0x1_0000,
+        };
+        let mut definition = Box::new(VMMemoryDefinition {
+            base: std::ptr::null_mut(),
+            current_length: 0,
+        });
+        let location = NonNull::from(&mut *definition);
+
+        for _ in 0..2 {
+            let memory = unsafe { pool.create_vm_memory(&memory_type, &style, location) }.unwrap();
+            memory.grow(Pages(1)).unwrap();
+
+            let stats = pool.stats();
+            assert_eq!(stats.memories_in_use, 1);
+            assert_eq!(stats.memory_fallbacks, 0);
+
+            // The memory is zeroed, even after having been used.
+            let bytes =
+                unsafe { std::slice::from_raw_parts_mut(definition.base, Pages(2).bytes().0) };
+            assert!(bytes.iter().all(|byte| *byte == 0));
+            bytes.iter_mut().for_each(|byte| *byte = 42);
+
+            drop(memory);
+            assert_eq!(pool.stats().memories_in_use, 0);
+        }
+
+        // Memories that don't fit fall back to a regular mapping.
+        let large_type = MemoryType::new(32, None, false);
+        let memory = unsafe { pool.create_vm_memory(&large_type, &style, location) }.unwrap();
+        assert_eq!(pool.stats().memory_fallbacks, 1);
+        drop(memory);
+    }
+}
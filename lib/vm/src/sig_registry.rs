@@ -6,59 +6,166 @@
 
 use crate::vmcontext::VMSharedSignatureIndex;
 use loupe::MemoryUsage;
-use more_asserts::{assert_lt, debug_assert_lt};
-use std::collections::{hash_map, HashMap};
+use more_asserts::assert_lt;
+use std::collections::hash_map::DefaultHasher;
+use std::collections::HashMap;
 use std::convert::TryFrom;
+use std::hash::{Hash, Hasher};
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::RwLock;
 use wasmer_types::FunctionType;
 
+/// The number of bits of a `VMSharedSignatureIndex` that select its
+/// shard. The other bits select its slot in the shard.
+const SHARD_BITS: u32 = 4;
+
+/// The number of shards.
+const SHARDS: usize = 1 << SHARD_BITS;
+
 /// WebAssembly requires that the caller and callee signatures in an indirect
 /// call must match. To implement this efficiently, keep a registry of all
 /// signatures, shared by all instances, so that call sites can just do an
 /// index comparison.
+///
+/// The signatures are spread over shards by their hash, each protected by
+/// its own lock, so that threads registering unrelated signatures don't
+/// contend. Registering a signature that is already registered only takes
+/// a shared lock.
+///
+/// Signatures are reference-counted: each call to `register` must be
+/// balanced by a call to `unregister` once the index isn't used anymore,
+/// after which the index may be given to another signature.
 #[derive(Debug, MemoryUsage)]
 pub struct SignatureRegistry {
     // This structure is stored in an `Engine` and is intended to be shared
     // across many instances. Ideally instances can themselves be sent across
     // threads, and ideally we can compile across many threads. As a result we
-    // use interior mutability here with a lock to avoid having callers to
+    // use interior mutability here with locks to avoid having callers to
     // externally synchronize calls to compilation.
-    inner: RwLock<Inner>,
+    shards: Vec<RwLock<Shard>>,
 }
 
 #[derive(Debug, Default, MemoryUsage)]
-struct Inner {
+struct Shard {
     signature2index: HashMap<FunctionType, VMSharedSignatureIndex>,
-    index2signature: HashMap<VMSharedSignatureIndex, FunctionType>,
+    slots: Vec<Option<Entry>>,
+    free_slots: Vec<usize>,
+}
+
+#[derive(Debug, MemoryUsage)]
+struct Entry {
+    signature: FunctionType,
+    // Incremented under a shared lock by `register`, decremented under the
+    // exclusive lock by `unregister`.
+    #[loupe(skip)]
+    references: AtomicUsize,
+}
+
+impl Shard {
+    fn entry(&self, slot: usize) -> Option<&Entry> {
+        self.slots.get(slot).and_then(Option::as_ref)
+    }
 }
 
 impl SignatureRegistry {
     /// Create a new `SignatureRegistry`.
     pub fn new() -> Self {
         Self {
-            inner: Default::default(),
+            shards: (0..SHARDS).map(|_| RwLock::default()).collect(),
         }
     }
 
+    fn shard_of(sig: &FunctionType) -> usize {
+        let mut hasher = DefaultHasher::new();
+        sig.hash(&mut hasher);
+        hasher.finish() as usize & (SHARDS - 1)
+    }
+
+    /// Splits `idx` into its shard and its slot in the shard.
+    fn locate(idx: VMSharedSignatureIndex) -> (usize, usize) {
+        let bits = idx.as_u32() as usize;
+        (bits & (SHARDS - 1), bits >> SHARD_BITS)
+    }
+
     /// Register a signature and return its unique index.
     pub fn register(&self, sig: &FunctionType) -> VMSharedSignatureIndex {
-        let mut inner = self.inner.write().unwrap();
-        let len = inner.signature2index.len();
-        match inner.signature2index.entry(sig.clone()) {
-            hash_map::Entry::Occupied(entry) => *entry.get(),
-            hash_map::Entry::Vacant(entry) => {
-                // Keep `signature_hash` len under 2**32 -- VMSharedSignatureIndex::new(std::u32::MAX)
-                // is reserved for VMSharedSignatureIndex::default().
-                debug_assert_lt!(
-                    len,
-                    std::u32::MAX as usize,
-                    "Invariant check: signature_hash.len() < std::u32::MAX"
-                );
-                let sig_id = VMSharedSignatureIndex::new(u32::try_from(len).unwrap());
-                entry.insert(sig_id);
-                inner.index2signature.insert(sig_id, sig.clone());
-                sig_id
+        let shard_index = Self::shard_of(sig);
+        let shard = &self.shards[shard_index];
+
+        // Fast path: the signature is already registered.
+        {
+            let shard = shard.read().unwrap();
+
+            if let Some(&idx) = shard.signature2index.get(sig) {
+                let (_, slot) = Self::locate(idx);
+                shard
+                    .entry(slot)
+                    .unwrap()
+                    .references
+                    .fetch_add(1, Ordering::Relaxed);
+
+                return idx;
+            }
+        }
+
+        let mut shard = shard.write().unwrap();
+
+        // Another thread may have registered it in the meantime.
+        if let Some(&idx) = shard.signature2index.get(sig) {
+            let (_, slot) = Self::locate(idx);
+            shard
+                .entry(slot)
+                .unwrap()
+                .references
+                .fetch_add(1, Ordering::Relaxed);
+
+            return idx;
+        }
+
+        let entry = Entry {
+            signature: sig.clone(),
+            references: AtomicUsize::new(1),
+        };
+        let slot = match shard.free_slots.pop() {
+            Some(slot) => {
+                shard.slots[slot] = Some(entry);
+                slot
             }
+            None => {
+                shard.slots.push(Some(entry));
+                shard.slots.len() - 1
+            }
+        };
+
+        // Keep the indices under 2**32 -- VMSharedSignatureIndex::new(std::u32::MAX)
+        // is reserved for VMSharedSignatureIndex::default().
+        assert_lt!(
+            slot,
+            (std::u32::MAX >> SHARD_BITS) as usize,
+            "Invariant check: too many signatures"
+        );
+        let idx =
+            VMSharedSignatureIndex::new(u32::try_from(slot << SHARD_BITS | shard_index).unwrap());
+        shard.signature2index.insert(sig.clone(), idx);
+
+        idx
+    }
+
+    /// Release a reference to the signature at `idx`, taken by `register`.
+    /// The signature is removed from the registry with its last reference.
+    pub fn unregister(&self, idx: VMSharedSignatureIndex) {
+        let (shard_index, slot) = Self::locate(idx);
+        let mut shard = self.shards[shard_index].write().unwrap();
+
+        let last_reference = match shard.entry(slot) {
+            Some(entry) => entry.references.fetch_sub(1, Ordering::Relaxed) == 1,
+            None => return,
+        };
+
+        if last_reference {
+            let entry = shard.slots[slot].take().unwrap();
+            shard.signature2index.remove(&entry.signature);
+            shard.free_slots.push(slot);
         }
     }
 
@@ -67,11 +174,93 @@ impl SignatureRegistry {
     /// Note that for this operation to be semantically correct the `idx` must
     /// have previously come from a call to `register` of this same object.
     pub fn lookup(&self, idx: VMSharedSignatureIndex) -> Option<FunctionType> {
-        self.inner
+        let (shard_index, slot) = Self::locate(idx);
+
+        self.shards
+            .get(shard_index)?
             .read()
             .unwrap()
-            .index2signature
-            .get(&idx)
-            .cloned()
+            .entry(slot)
+            .map(|entry| entry.signature.clone())
+    }
+
+    /// Returns the number of signatures currently registered.
+    pub fn len(&self) -> usize {
+        self.shards
+            .iter()
+            .map(|shard| shard.read().unwrap().signature2index.len())
+            .sum()
+    }
+
+    /// Returns whether no signature is currently registered.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+    use std::thread;
+    use wasmer_types::Type;
+
+    fn signature(params: usize) -> FunctionType {
+        FunctionType::new(vec![Type::I32; params], vec![])
+    }
+
+    #[test]
+    fn register_is_idempotent() {
+        let registry = SignatureRegistry::new();
+        let a = registry.register(&signature(1));
+        let b = registry.register(&signature(2));
+
+        assert_ne!(a, b);
+        assert_eq!(registry.register(&signature(1)), a);
+        assert_eq!(registry.lookup(a), Some(signature(1)));
+        assert_eq!(registry.lookup(b), Some(signature(2)));
+        assert_eq!(registry.len(), 2);
+    }
+
+    #[test]
+    fn unregister_releases_the_last_reference() {
+        let registry = SignatureRegistry::new();
+        let a = registry.register(&signature(1));
+        registry.register(&signature(1));
+
+        registry.unregister(a);
+        assert_eq!(registry.lookup(a), Some(signature(1)));
+
+        registry.unregister(a);
+        assert_eq!(registry.lookup(a), None);
+        assert!(registry.is_empty());
+
+        // The slot is reused.
+        let (shard, _) = SignatureRegistry::locate(a);
+        let reused = (0..)
+            .map(signature)
+            .find(|sig| SignatureRegistry::shard_of(sig) == shard)
+            .unwrap();
+        assert_eq!(registry.register(&reused), a);
+    }
+
+    #[test]
+    fn concurrent_registrations_agree() {
+        let registry = Arc::new(SignatureRegistry::new());
+
+        let threads: Vec<_> = (0..8)
+            .map(|_| {
+                let registry = registry.clone();
+                thread::spawn(move || {
+                    (0..64)
+                        .map(|params| registry.register(&signature(params)))
+                        .collect::<Vec<_>>()
+                })
+            })
+            .collect();
+
+        let indices: Vec<_> = threads.into_iter().map(|t| t.join().unwrap()).collect();
+        assert!(indices.windows(2).all(|pair| pair[0] == pair[1]));
+        assert_eq!(registry.len(), 64);
     }
 }
@@ -3,13 +3,19 @@
 
 //! This is the module that facilitates the usage of Traps
 //! in Wasmer Runtime
+mod stack_pool;
 mod trap;
 mod traphandlers;
 
+pub use stack_pool::{
+    set_stack_pool_limits, stack_pool_limits, stack_pool_stats, StackPoolLimits, StackPoolStats,
+    DEFAULT_STACK_SIZE,
+};
 pub use trap::Trap;
 pub use traphandlers::{
-    catch_traps, on_host_stack, raise_lib_trap, raise_user_trap, wasmer_call_trampoline,
-    TrapHandler, TrapHandlerFn,
+    block_on_wasm_call, capture_backtrace, catch_traps, on_host_stack, raise_lib_trap,
+    raise_user_trap, wasmer_call_trampoline, wasmer_call_trampoline_async,
+    wasmer_call_trampoline_batch, AsyncWasmCall, CallCancelled, TrapHandler, TrapHandlerFn,
 };
 pub use traphandlers::{init_traps, resume_panic};
 pub use wasmer_types::TrapCode;
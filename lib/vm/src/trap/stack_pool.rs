@@ -0,0 +1,273 @@
+//! A cache of the stacks on which WebAssembly code runs.
+//!
+//! Allocating a stack is pretty expensive since it involves several
+//! system calls (`mmap` for the stack itself and `mprotect` for its
+//! guard page). Stacks are therefore kept when a call returns, and
+//! reused by the following calls.
+//!
+//! Each thread has its own cache, which is accessed without any
+//! synchronization. When it is empty, a stack is taken from a global
+//! pool shared by all the threads, and only then allocated. When it
+//! is full, the stack is given back to the global pool, or freed if
+//! the global pool is full too. The stacks cached by a thread are
+//! given back to the global pool when it exits.
+
+use corosensei::stack::DefaultStack;
+use std::cell::RefCell;
+use std::io;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+
+/// The default size, in bytes, of the stacks on which WebAssembly code
+/// runs.
+pub const DEFAULT_STACK_SIZE: usize = 1024 * 1024;
+
+/// Limits on the number of stacks kept by the stack pool, see
+/// [`set_stack_pool_limits`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct StackPoolLimits {
+    /// The maximum number of stacks cached by each thread. A thread
+    /// needs one stack per nested call into WebAssembly.
+    pub per_thread: usize,
+    /// The maximum number of stacks kept in the global pool. Stacks
+    /// beyond this limit are freed.
+    pub global: usize,
+}
+
+const DEFAULT_PER_THREAD_LIMIT: usize = 4;
+const DEFAULT_GLOBAL_LIMIT: usize = 64;
+
+impl Default for StackPoolLimits {
+    fn default() -> Self {
+        Self {
+            per_thread: DEFAULT_PER_THREAD_LIMIT,
+            global: DEFAULT_GLOBAL_LIMIT,
+        }
+    }
+}
+
+/// Statistics about the stack pool since the start of the process, see
+/// [`stack_pool_stats`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct StackPoolStats {
+    /// The number of stacks allocated, i.e. the number of `mmap` calls.
+    pub allocations: u64,
+    /// The number of calls that reused a stack cached by their thread.
+    pub thread_reuses: u64,
+    /// The number of calls that reused a stack from the global pool.
+    pub global_reuses: u64,
+    /// The number of stacks freed because the pool was full, i.e. the
+    /// number of `munmap` calls.
+    pub evictions: u64,
+}
+
+impl StackPoolStats {
+    /// The total number of calls that reused a stack instead of
+    /// allocating a new one.
+    pub fn reuses(&self) -> u64 {
+        self.thread_reuses + self.global_reuses
+    }
+}
+
+/// A stack, along with the size it was requested with.
+type SizedStack = (usize, DefaultStack);
+
+static PER_THREAD_LIMIT: AtomicUsize = AtomicUsize::new(DEFAULT_PER_THREAD_LIMIT);
+static GLOBAL_LIMIT: AtomicUsize = AtomicUsize::new(DEFAULT_GLOBAL_LIMIT);
+
+// Those events are rare compared to the calls, they can be counted
+// globally without contention.
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+static GLOBAL_REUSES: AtomicU64 = AtomicU64::new(0);
+static EVICTIONS: AtomicU64 = AtomicU64::new(0);
+// Reuses from the thread caches of the threads that have exited.
+static EXITED_THREAD_REUSES: AtomicU64 = AtomicU64::new(0);
+
+lazy_static::lazy_static! {
+    static ref GLOBAL_POOL: Mutex<Vec<SizedStack>> = Mutex::new(vec![]);
+    /// The reuse counters of the live thread caches. Each counter is
+    /// only written by its own thread, so that the fast path stays
+    /// free of any contention.
+    static ref THREAD_REUSES: Mutex<Vec<Arc<AtomicU64>>> = Mutex::new(vec![]);
+}
+
+struct ThreadCache {
+    stacks: Vec<SizedStack>,
+    reuses: Arc<AtomicU64>,
+}
+
+impl ThreadCache {
+    fn new() -> Self {
+        let reuses = Arc::new(AtomicU64::new(0));
+        THREAD_REUSES.lock().unwrap().push(reuses.clone());
+
+        Self {
+            stacks: vec![],
+            reuses,
+        }
+    }
+
+    fn take(&mut self, size: usize) -> Option<DefaultStack> {
+        let index = self.stacks.iter().rposition(|(s, _)| *s == size)?;
+
+        // Only this thread writes the counter, no need for an atomic
+        // read-modify-write.
+        let reuses = self.reuses.load(Ordering::Relaxed);
+        self.reuses.store(reuses + 1, Ordering::Relaxed);
+
+        Some(self.stacks.swap_remove(index).1)
+    }
+
+    fn release(&mut self, stack: SizedStack) -> Option<SizedStack> {
+        if self.stacks.len() < PER_THREAD_LIMIT.load(Ordering::Relaxed) {
+            self.stacks.push(stack);
+            None
+        } else {
+            Some(stack)
+        }
+    }
+}
+
+impl Drop for ThreadCache {
+    fn drop(&mut self) {
+        for stack in self.stacks.drain(..) {
+            release_globally(stack);
+        }
+
+        let mut thread_reuses = THREAD_REUSES.lock().unwrap();
+        thread_reuses.retain(|reuses| !Arc::ptr_eq(reuses, &self.reuses));
+        EXITED_THREAD_REUSES.fetch_add(self.reuses.load(Ordering::Relaxed), Ordering::Relaxed);
+    }
+}
+
+thread_local! {
+    static THREAD_CACHE: RefCell<ThreadCache> = RefCell::new(ThreadCache::new());
+}
+
+fn release_globally(stack: SizedStack) {
+    let mut pool = GLOBAL_POOL.lock().unwrap();
+
+    if pool.len() < GLOBAL_LIMIT.load(Ordering::Relaxed) {
+        pool.push(stack);
+    } else {
+        // Free the stack outside of the lock.
+        drop(pool);
+        drop(stack);
+        EVICTIONS.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+/// Takes a stack of `size` bytes from the pool, or allocates a new one.
+pub(super) fn take_stack(size: usize) -> io::Result<DefaultStack> {
+    // The thread cache is not available while the thread exits.
+    if let Ok(Some(stack)) = THREAD_CACHE.try_with(|cache| cache.borrow_mut().take(size)) {
+        return Ok(stack);
+    }
+
+    {
+        let mut pool = GLOBAL_POOL.lock().unwrap();
+
+        if let Some(index) = pool.iter().rposition(|(s, _)| *s == size) {
+            GLOBAL_REUSES.fetch_add(1, Ordering::Relaxed);
+
+            return Ok(pool.swap_remove(index).1);
+        }
+    }
+
+    let stack = DefaultStack::new(size)?;
+    ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+
+    Ok(stack)
+}
+
+/// Gives a stack taken with [`take_stack`] back to the pool.
+pub(super) fn release_stack(size: usize, stack: DefaultStack) {
+    let stack = match THREAD_CACHE.try_with(|cache| cache.borrow_mut().release((size, stack))) {
+        Ok(None) => return,
+        Ok(Some(stack)) => stack,
+        // The thread cache is not available while the thread exits,
+        // and the stack has been dropped with the closure.
+        Err(_) => return,
+    };
+
+    release_globally(stack);
+}
+
+/// Sets the limits on the number of stacks kept by the stack pool.
+///
+/// The global pool is trimmed immediately; the thread caches stop
+/// keeping stacks beyond the new limit.
+pub fn set_stack_pool_limits(limits: StackPoolLimits) {
+    PER_THREAD_LIMIT.store(limits.per_thread, Ordering::Relaxed);
+    GLOBAL_LIMIT.store(limits.global, Ordering::Relaxed);
+
+    let evicted = {
+        let mut pool = GLOBAL_POOL.lock().unwrap();
+        let len = pool.len();
+
+        pool.split_off(len.min(limits.global))
+    };
+
+    EVICTIONS.fetch_add(evicted.len() as u64, Ordering::Relaxed);
+}
+
+/// Returns the limits on the number of stacks kept by the stack pool.
+pub fn stack_pool_limits() -> StackPoolLimits {
+    StackPoolLimits {
+        per_thread: PER_THREAD_LIMIT.load(Ordering::Relaxed),
+        global: GLOBAL_LIMIT.load(Ordering::Relaxed),
+    }
+}
+
+/// Returns statistics about the stack pool since the start of the
+/// process.
+pub fn stack_pool_stats() -> StackPoolStats {
+    let thread_reuses = THREAD_REUSES
+        .lock()
+        .unwrap()
+        .iter()
+        .map(|reuses| reuses.load(Ordering::Relaxed))
+        .sum::<u64>();
+
+    StackPoolStats {
+        allocations: ALLOCATIONS.load(Ordering::Relaxed),
+        thread_reuses: thread_reuses + EXITED_THREAD_REUSES.load(Ordering::Relaxed),
+        global_reuses: GLOBAL_REUSES.load(Ordering::Relaxed),
+        evictions: EVICTIONS.load(Ordering::Relaxed),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::thread;
+
+    #[test]
+    fn stacks_are_reused() {
+        // Use a size that no other test uses, in a fresh thread.
+        const SIZE: usize = 3 * 64 * 1024;
+
+        thread::spawn(|| {
+            let before = stack_pool_stats();
+
+            let stack = take_stack(SIZE).unwrap();
+            release_stack(SIZE, stack);
+            let stack = take_stack(SIZE).unwrap();
+            release_stack(SIZE, stack);
+
+            let after = stack_pool_stats();
+            assert!(after.allocations - before.allocations >= 1);
+            assert!(after.thread_reuses - before.thread_reuses >= 1);
+        })
+        .join()
+        .unwrap();
+
+        // The stack of the exited thread has been given to the global
+        // pool.
+        let before = stack_pool_stats();
+        let stack = take_stack(SIZE).unwrap();
+        let after = stack_pool_stats();
+        assert!(after.global_reuses - before.global_reuses >= 1);
+        release_stack(SIZE, stack);
+    }
+}
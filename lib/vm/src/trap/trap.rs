@@ -1,3 +1,4 @@
+use super::traphandlers::capture_backtrace;
 use backtrace::Backtrace;
 use std::error::Error;
 use wasmer_types::TrapCode;
@@ -55,7 +56,7 @@ impl Trap {
     ///
     /// Internally saves a backtrace when constructed.
     pub fn lib(trap_code: TrapCode) -> Self {
-        let backtrace = Backtrace::new_unresolved();
+        let backtrace = capture_backtrace();
         Trap::Lib {
             trap_code,
             backtrace,
@@ -66,7 +67,7 @@ impl Trap {
     ///
     /// Internally saves a backtrace when constructed.
     pub fn oom() -> Self {
-        let backtrace = Backtrace::new_unresolved();
+        let backtrace = capture_backtrace();
         Trap::OOM { backtrace }
     }
 }
@@ -4,6 +4,7 @@
 //! WebAssembly trap handling, which is built on top of the lower-level
 //! signalhandling mechanisms.
 
+use super::stack_pool::{self, DEFAULT_STACK_SIZE};
 use crate::vmcontext::{VMFunctionBody, VMFunctionEnvironment, VMTrampoline};
 use crate::Trap;
 use backtrace::Backtrace;
@@ -15,13 +16,17 @@ use scopeguard::defer;
 use std::any::Any;
 use std::cell::Cell;
 use std::error::Error;
+use std::future::Future;
 use std::io;
 use std::mem;
 #[cfg(unix)]
 use std::mem::MaybeUninit;
+use std::pin::Pin;
 use std::ptr::{self, NonNull};
 use std::sync::atomic::{compiler_fence, AtomicPtr, Ordering};
-use std::sync::{Mutex, Once};
+use std::sync::{Arc, Once};
+use std::task::{Context, Poll, Wake, Waker};
+use std::thread;
 use wasmer_types::TrapCode;
 
 // TrapInformation can be stored in the "Undefined Instruction" itself.
@@ -98,6 +103,18 @@ pub unsafe trait TrapHandler {
     ///
     /// Returns `true` if `call` returns true, otherwise returns `false`.
     fn custom_trap_handler(&self, call: &dyn Fn(&TrapHandlerFn) -> bool) -> bool;
+
+    /// Returns the size, in bytes, of the stack on which the WebAssembly
+    /// code runs.
+    fn stack_size(&self) -> usize {
+        DEFAULT_STACK_SIZE
+    }
+
+    /// Returns whether the native backtrace is captured when the
+    /// WebAssembly code traps.
+    fn capture_backtraces(&self) -> bool {
+        true
+    }
 }
 
 cfg_if::cfg_if! {
@@ -622,6 +639,56 @@ pub unsafe fn wasmer_call_trampoline(
     })
 }
 
+/// Call the wasm function pointed to by `callee` `count` times in a row.
+///
+/// This is equivalent to calling [`wasmer_call_trampoline`] `count` times,
+/// except that the trap handler and the Wasm stack are only set up once for
+/// the whole batch.
+///
+/// * `values_vec` - points to a buffer which is reused by every call.
+/// * `before_call` - called with the index of the call and `values_vec`
+///   before each call, to store the incoming arguments.
+/// * `after_call` - called with the index of the call and `values_vec` after
+///   each call, to load the outgoing return values.
+///
+/// If a call traps, the batch is stopped and the index of the failing call
+/// is returned along with the trap.
+///
+/// # Safety
+///
+/// Wildly unsafe because it calls raw function pointers and reads/writes raw
+/// function pointers. If a call traps, no destructor owned by `before_call`
+/// or `after_call` runs for the failing call.
+#[allow(clippy::too_many_arguments)]
+pub unsafe fn wasmer_call_trampoline_batch(
+    trap_handler: &(impl TrapHandler + 'static),
+    vmctx: VMFunctionEnvironment,
+    trampoline: VMTrampoline,
+    callee: *const VMFunctionBody,
+    values_vec: *mut u8,
+    count: usize,
+    mut before_call: impl FnMut(usize, *mut u8),
+    mut after_call: impl FnMut(usize, *const u8),
+) -> Result<(), (usize, Trap)> {
+    let trampoline = mem::transmute::<
+        _,
+        extern "C" fn(VMFunctionEnvironment, *const VMFunctionBody, *mut u8),
+    >(trampoline);
+    let mut current = 0;
+
+    catch_traps(trap_handler, || {
+        for index in 0..count {
+            // `current` is read back if the call traps, in which case the
+            // call doesn't return normally: the write must not be delayed.
+            ptr::write_volatile(&mut current, index);
+            before_call(index, values_vec);
+            trampoline(vmctx, callee, values_vec);
+            after_call(index, values_vec);
+        }
+    })
+    .map_err(|trap| (current, trap))
+}
+
 /// Catches any wasm traps that happen within the execution of `closure`,
 /// returning them as a `Result`.
 ///
@@ -639,17 +706,63 @@ where
     on_wasm_stack(trap_handler, closure).map_err(UnwindReason::to_trap)
 }
 
-// We need two separate thread-local variables here:
+// We need three separate thread-local variables here:
 // - YIELDER is set within the new stack and is used to unwind back to the root
-//   of the stack from inside it.
+//   of the stack from inside it, or to suspend an asynchronous call.
 // - TRAP_HANDLER is set from outside the new stack and is solely used from
 //   signal handlers. It must be atomic since it is used by signal handlers.
+// - ASYNC_CONTEXT is set from outside the new stack while an asynchronous call
+//   is polled, and is used by the host functions to poll their futures.
 //
 // We also do per-thread signal stack initialization on the first time
 // TRAP_HANDLER is accessed.
 thread_local! {
-    static YIELDER: Cell<Option<NonNull<Yielder<(), UnwindReason>>>> = Cell::new(None);
+    static YIELDER: Cell<Option<NonNull<Yielder<Resume, Yield>>>> = Cell::new(None);
     static TRAP_HANDLER: AtomicPtr<TrapHandlerContext> = AtomicPtr::new(ptr::null_mut());
+    static ASYNC_CONTEXT: Cell<Option<NonNull<Context<'static>>>> = Cell::new(None);
+}
+
+// An asynchronous call can be resumed on another thread than the one it was
+// suspended on. The accesses to YIELDER around a suspension point must not be
+// inlined, otherwise the compiler could reuse the address of the
+// thread-local variable of the previous thread.
+#[inline(never)]
+fn replace_yielder(
+    yielder: Option<NonNull<Yielder<Resume, Yield>>>,
+) -> Option<NonNull<Yielder<Resume, Yield>>> {
+    YIELDER.with(|cell| cell.replace(yielder))
+}
+
+#[inline(never)]
+fn current_yielder() -> Option<NonNull<Yielder<Resume, Yield>>> {
+    YIELDER.with(|cell| cell.get())
+}
+
+#[inline(never)]
+fn current_async_context() -> Option<NonNull<Context<'static>>> {
+    ASYNC_CONTEXT.with(|cell| cell.get())
+}
+
+#[inline(never)]
+fn replace_async_context(
+    context: Option<NonNull<Context<'static>>>,
+) -> Option<NonNull<Context<'static>>> {
+    ASYNC_CONTEXT.with(|cell| cell.replace(context))
+}
+
+/// Captures the native backtrace of a trap, without resolving its symbols.
+///
+/// The backtrace is empty if the trap handler of the running WebAssembly
+/// code doesn't capture backtraces, see [`TrapHandler::capture_backtraces`].
+pub fn capture_backtrace() -> Backtrace {
+    let ptr = TRAP_HANDLER.with(|ptr| ptr.load(Ordering::Relaxed));
+
+    // The context is installed for as long as the WebAssembly code runs.
+    if !ptr.is_null() && unsafe { !(*(*ptr).custom_trap).capture_backtraces() } {
+        Backtrace::from(vec![])
+    } else {
+        Backtrace::new_unresolved()
+    }
 }
 
 /// Read-only information that is used by signal handlers to handle and recover
@@ -790,7 +903,7 @@ impl<T> TrapHandlerContextInner<T> {
         let backtrace = if signal_trap == Some(TrapCode::StackOverflow) {
             Backtrace::from(vec![])
         } else {
-            Backtrace::new_unresolved()
+            capture_backtrace()
         };
 
         // Set up the register state for exception return to force the
@@ -808,6 +921,25 @@ impl<T> TrapHandlerContextInner<T> {
     }
 }
 
+/// How a coroutine running Wasm code is resumed.
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Resume {
+    /// Continue the execution.
+    Continue,
+    /// The asynchronous call was dropped while suspended: the host function
+    /// which suspended it must return a trap.
+    Cancel,
+}
+
+/// Why a coroutine running Wasm code yielded to its parent.
+enum Yield {
+    /// Unwind to the root of the coroutine, which is then reset.
+    Unwind(UnwindReason),
+    /// A host function of an asynchronous call waits for a future which is
+    /// not ready yet.
+    Suspend,
+}
+
 enum UnwindReason {
     /// A panic caused by the host
     Panic(Box<dyn Any + Send>),
@@ -839,11 +971,9 @@ impl UnwindReason {
 }
 
 unsafe fn unwind_with(reason: UnwindReason) -> ! {
-    let yielder = YIELDER
-        .with(|cell| cell.replace(None))
-        .expect("not running on Wasm stack");
+    let yielder = replace_yielder(None).expect("not running on Wasm stack");
 
-    yielder.as_ref().suspend(reason);
+    yielder.as_ref().suspend(Yield::Unwind(reason));
 
     // on_wasm_stack will forcibly reset the coroutine stack after yielding.
     unreachable!();
@@ -857,33 +987,132 @@ fn on_wasm_stack<F: FnOnce() -> T, T>(
     f: F,
 ) -> Result<T, UnwindReason> {
     // Allocating a new stack is pretty expensive since it involves several
-    // system calls. We therefore keep a cache of pre-allocated stacks which
-    // allows them to be reused multiple times.
-    // FIXME(Amanieu): We should refactor this to avoid the lock.
-    lazy_static::lazy_static! {
-        static ref STACK_POOL: Mutex<Vec<DefaultStack>> = Mutex::new(vec![]);
-    }
-    let stack = STACK_POOL.lock().unwrap().pop().unwrap_or_default();
-    let mut stack = scopeguard::guard(stack, |stack| STACK_POOL.lock().unwrap().push(stack));
+    // system calls. We therefore take the stack from a pool of pre-allocated
+    // stacks which allows them to be reused multiple times.
+    let stack_size = trap_handler.stack_size();
+    let stack = stack_pool::take_stack(stack_size)
+        .map_err(|error| UnwindReason::UserTrap(Box::new(error)))?;
+    let mut stack = scopeguard::guard(stack, |stack| stack_pool::release_stack(stack_size, stack));
 
     // Create a coroutine with a new stack to run the function on.
-    let mut coro = ScopedCoroutine::with_stack(&mut *stack, move |yielder, ()| {
+    let mut coro = ScopedCoroutine::with_stack(&mut *stack, move |yielder, _| {
         // Save the yielder to TLS so that it can be used later.
         YIELDER.with(|cell| cell.set(Some(yielder.into())));
 
         Ok(f())
     });
 
+    // A synchronous call can't be suspended, even when it is nested in an
+    // asynchronous one: its host functions block on their futures instead.
+    let async_context = replace_async_context(None);
+
     // Ensure that YIELDER is reset on exit even if the coroutine panics,
     defer! {
         YIELDER.with(|cell| cell.set(None));
+        replace_async_context(async_context);
     }
 
     // Set up metadata for the trap handler for the duration of the coroutine
     // execution. This is restored to its previous value afterwards.
     TrapHandlerContext::install(trap_handler, coro.trap_handler(), || {
-        match coro.resume(()) {
-            CoroutineResult::Yield(trap) => {
+        match coro.resume(Resume::Continue) {
+            CoroutineResult::Yield(Yield::Unwind(trap)) => {
+                // This came from unwind_with which requires that there be only
+                // Wasm code on the stack.
+                unsafe {
+                    coro.force_reset();
+                }
+                Err(trap)
+            }
+            CoroutineResult::Yield(Yield::Suspend) => {
+                unreachable!("a synchronous call can't be suspended")
+            }
+            CoroutineResult::Return(result) => result,
+        }
+    })
+}
+
+/// A call into Wasm code which the host functions it calls can suspend while
+/// they wait for a future, see [`block_on_wasm_call`]. It is created by
+/// [`wasmer_call_trampoline_async`].
+///
+/// The call is itself a future: each poll resumes the Wasm code on its own
+/// stack, until it returns, traps, or is suspended again. It can be polled
+/// from any thread, so that many calls can be multiplexed on a few threads
+/// by an executor.
+///
+/// If it is dropped while suspended, the host function which suspended it
+/// is resumed with [`CallCancelled`], and must return a trap: the Wasm code
+/// is then unwound and its stack is released.
+pub struct AsyncWasmCall<'a, T> {
+    trap_handler: &'a (dyn TrapHandler + 'static),
+    stack_size: usize,
+    /// The coroutine running the call, until it completes.
+    coro: Option<ScopedCoroutine<'a, Resume, Yield, Result<T, UnwindReason>, DefaultStack>>,
+}
+
+/// # Safety
+/// The state that ties the Wasm code to a thread (the yielder, the context of
+/// the trap handler and the signal stack) is installed again on the polling
+/// thread by each poll.
+unsafe impl<'a, T: Send> Send for AsyncWasmCall<'a, T> {}
+
+impl<'a, T> AsyncWasmCall<'a, T> {
+    /// Prepares a call of `f` on a new Wasm stack. Nothing runs until the
+    /// call is polled.
+    ///
+    /// # Safety
+    ///
+    /// Highly unsafe since `f` won't have any dtors run if it traps.
+    pub unsafe fn new<F>(trap_handler: &'a (dyn TrapHandler + 'static), f: F) -> Result<Self, Trap>
+    where
+        F: FnOnce() -> T + 'a,
+    {
+        let stack_size = trap_handler.stack_size();
+        let stack =
+            stack_pool::take_stack(stack_size).map_err(|error| Trap::User(Box::new(error)))?;
+
+        let coro = ScopedCoroutine::with_stack(stack, move |yielder, _| {
+            // Save the yielder to TLS so that it can be used later.
+            YIELDER.with(|cell| cell.set(Some(yielder.into())));
+
+            Ok(f())
+        });
+
+        Ok(Self {
+            trap_handler,
+            stack_size,
+            coro: Some(coro),
+        })
+    }
+
+    /// Resumes the coroutine, with `context` as the context of the futures
+    /// polled by its host functions. Returns `None` if it is suspended again.
+    fn resume(
+        &mut self,
+        resume: Resume,
+        context: Option<NonNull<Context<'static>>>,
+    ) -> Option<Result<T, UnwindReason>> {
+        let coro = self
+            .coro
+            .as_mut()
+            .expect("`AsyncWasmCall` polled after completion");
+
+        let yielder = replace_yielder(None);
+        let async_context = replace_async_context(context);
+
+        defer! {
+            replace_yielder(yielder);
+            replace_async_context(async_context);
+        }
+
+        let result = TrapHandlerContext::install(self.trap_handler, coro.trap_handler(), || {
+            coro.resume(resume)
+        });
+
+        let result = match result {
+            CoroutineResult::Yield(Yield::Suspend) => return None,
+            CoroutineResult::Yield(Yield::Unwind(trap)) => {
                 // This came from unwind_with which requires that there be only
                 // Wasm code on the stack.
                 unsafe {
@@ -892,10 +1121,160 @@ fn on_wasm_stack<F: FnOnce() -> T, T>(
                 Err(trap)
             }
             CoroutineResult::Return(result) => result,
+        };
+
+        self.release_stack();
+
+        Some(result)
+    }
+
+    fn release_stack(&mut self) {
+        if let Some(coro) = self.coro.take() {
+            stack_pool::release_stack(self.stack_size, coro.into_stack());
+        }
+    }
+}
+
+impl<'a, T> Future for AsyncWasmCall<'a, T> {
+    type Output = Result<T, Trap>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        // Nothing is structurally pinned: the frames of the Wasm code live on
+        // the stack of the coroutine, not in `self`.
+        let this = unsafe { self.get_unchecked_mut() };
+
+        // Ensure that per-thread initialization is done, the call may be
+        // polled from a new thread.
+        if let Err(trap) = lazy_per_thread_init() {
+            return Poll::Ready(Err(trap));
         }
+
+        // The context is only valid for this poll: it is replaced by the
+        // context of the next poll once the call is resumed.
+        let context = NonNull::from(cx).cast::<Context<'static>>();
+
+        match this.resume(Resume::Continue, Some(context)) {
+            Some(result) => Poll::Ready(result.map_err(UnwindReason::to_trap)),
+            None => Poll::Pending,
+        }
+    }
+}
+
+impl<'a, T> Drop for AsyncWasmCall<'a, T> {
+    fn drop(&mut self) {
+        let suspended = self.coro.as_ref().map_or(false, |coro| coro.started());
+
+        if suspended {
+            let _ = lazy_per_thread_init();
+
+            // Unwind the suspended call: the host function waiting for a
+            // future gets `CallCancelled`, and returns a trap.
+            while self.resume(Resume::Cancel, None).is_none() {}
+        } else {
+            self.release_stack();
+        }
+    }
+}
+
+/// Call the wasm function pointed to by `callee`, like
+/// [`wasmer_call_trampoline`], except that the call is returned as an
+/// [`AsyncWasmCall`]: it only runs once polled, and the host functions it
+/// calls can suspend it with [`block_on_wasm_call`].
+///
+/// # Safety
+///
+/// Wildly unsafe because it calls raw function pointers and reads/writes raw
+/// function pointers. `values_vec` must stay valid until the call completes
+/// or is dropped.
+pub unsafe fn wasmer_call_trampoline_async<'a>(
+    trap_handler: &'a (dyn TrapHandler + 'static),
+    vmctx: VMFunctionEnvironment,
+    trampoline: VMTrampoline,
+    callee: *const VMFunctionBody,
+    values_vec: *mut u8,
+) -> Result<AsyncWasmCall<'a, ()>, Trap> {
+    AsyncWasmCall::new(trap_handler, move || {
+        mem::transmute::<_, extern "C" fn(VMFunctionEnvironment, *const VMFunctionBody, *mut u8)>(
+            trampoline,
+        )(vmctx, callee, values_vec);
     })
 }
 
+/// The error returned by [`block_on_wasm_call`] when the asynchronous call it
+/// belongs to is dropped while suspended.
+#[derive(thiserror::Error, Debug)]
+#[error("The asynchronous call was cancelled")]
+pub struct CallCancelled;
+
+/// Waits for `future` to complete, from a host function called by Wasm code.
+///
+/// When the Wasm code was entered through an [`AsyncWasmCall`], the call is
+/// suspended as long as the future is pending: polling the `AsyncWasmCall`
+/// polls the future, and resumes the Wasm code once it is ready. In any other
+/// case, e.g. from a synchronous call, even when it is nested in an
+/// asynchronous one, the current thread is blocked until the future is ready.
+///
+/// The future is always polled on the host stack, and must not panic.
+///
+/// It returns [`CallCancelled`] if the asynchronous call is dropped while
+/// suspended: the host function must then return a trap.
+pub fn block_on_wasm_call<F: Future>(future: F) -> Result<F::Output, CallCancelled> {
+    let mut future = future;
+    // Safety: `future` is shadowed, it can't be moved anymore.
+    let mut future = unsafe { Pin::new_unchecked(&mut future) };
+
+    loop {
+        let on_wasm_stack = current_yielder().is_some();
+        let context = match current_async_context() {
+            Some(context) if on_wasm_stack => context,
+            _ => return Ok(on_host_stack(|| block_on(future))),
+        };
+
+        let poll = on_host_stack(|| future.as_mut().poll(unsafe { &mut *context.as_ptr() }));
+
+        if let Poll::Ready(output) = poll {
+            return Ok(output);
+        }
+
+        if suspend_wasm_call() == Resume::Cancel {
+            return Err(CallCancelled);
+        }
+    }
+}
+
+/// Suspends the asynchronous call running on the current Wasm stack, until
+/// it is polled again or dropped.
+fn suspend_wasm_call() -> Resume {
+    let yielder = replace_yielder(None).expect("not running on Wasm stack");
+    let resume = unsafe { yielder.as_ref() }.suspend(Yield::Suspend);
+
+    // The call may have been resumed on another thread.
+    replace_yielder(Some(yielder));
+
+    resume
+}
+
+/// Blocks the current thread until `future` is ready.
+fn block_on<F: Future>(mut future: Pin<&mut F>) -> F::Output {
+    struct ThreadWaker(thread::Thread);
+
+    impl Wake for ThreadWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.unpark();
+        }
+    }
+
+    let waker = Waker::from(Arc::new(ThreadWaker(thread::current())));
+    let mut context = Context::from_waker(&waker);
+
+    loop {
+        match future.as_mut().poll(&mut context) {
+            Poll::Ready(output) => return output,
+            Poll::Pending => thread::park(),
+        }
+    }
+}
+
 /// When executing on the Wasm stack, temporarily switch back to the host stack
 /// to perform an operation that should not be constrainted by the Wasm stack
 /// limits.
@@ -364,26 +364,29 @@ impl VMMemoryDefinition {
     /// # Safety
     /// The memory is not copied atomically and is not synchronized: it's the
     /// caller's responsibility to synchronize.
-    pub(crate) unsafe fn memory_copy(&self, dst: u32, src: u32, len: u32) -> Result<(), Trap> {
+    ///
+    /// The addresses are 64-bit to support both 32-bit and 64-bit memories.
+    pub(crate) unsafe fn memory_copy(&self, dst: u64, src: u64, len: u64) -> Result<(), Trap> {
         // https://webassembly.github.io/reference-types/core/exec/instructions.html#exec-memory-copy
         if src
             .checked_add(len)
-            .map_or(true, |n| usize::try_from(n).unwrap() > self.current_length)
+            .map_or(true, |n| n > self.current_length as u64)
             || dst
                 .checked_add(len)
-                .map_or(true, |m| usize::try_from(m).unwrap() > self.current_length)
+                .map_or(true, |m| m > self.current_length as u64)
         {
             return Err(Trap::lib(TrapCode::HeapAccessOutOfBounds));
         }
 
         let dst = usize::try_from(dst).unwrap();
         let src = usize::try_from(src).unwrap();
+        let len = usize::try_from(len).unwrap();
 
         // Bounds and casts are checked above, by this point we know that
         // everything is safe.
         let dst = self.base.add(dst);
         let src = self.base.add(src);
-        ptr::copy(src, dst, len as usize);
+        ptr::copy(src, dst, len);
 
         Ok(())
     }
@@ -398,24 +401,50 @@ impl VMMemoryDefinition {
     /// # Safety
     /// The memory is not filled atomically and is not synchronized: it's the
     /// caller's responsibility to synchronize.
-    pub(crate) unsafe fn memory_fill(&self, dst: u32, val: u32, len: u32) -> Result<(), Trap> {
+    ///
+    /// The addresses are 64-bit to support both 32-bit and 64-bit memories.
+    pub(crate) unsafe fn memory_fill(&self, dst: u64, val: u32, len: u64) -> Result<(), Trap> {
         if dst
             .checked_add(len)
-            .map_or(true, |m| usize::try_from(m).unwrap() > self.current_length)
+            .map_or(true, |m| m > self.current_length as u64)
         {
             return Err(Trap::lib(TrapCode::HeapAccessOutOfBounds));
         }
 
-        let dst = isize::try_from(dst).unwrap();
+        let dst = usize::try_from(dst).unwrap();
+        let len = usize::try_from(len).unwrap();
         let val = val as u8;
 
         // Bounds and casts are checked above, by this point we know that
         // everything is safe.
-        let dst = self.base.offset(dst);
-        ptr::write_bytes(dst, val, len as usize);
+        let dst = self.base.add(dst);
+        ptr::write_bytes(dst, val, len);
 
         Ok(())
     }
+
+    /// Returns the host address of the `size` bytes at `addr`, for an
+    /// atomic access.
+    ///
+    /// # Errors
+    ///
+    /// Returns a `Trap` error if `addr` is not aligned on `size`, or if
+    /// the memory range is out of bounds.
+    pub(crate) fn atomic_address(&self, addr: u32, size: u32) -> Result<*const u8, Trap> {
+        if addr % size != 0 {
+            return Err(Trap::lib(TrapCode::UnalignedAtomic));
+        }
+
+        if addr
+            .checked_add(size)
+            .map_or(true, |m| usize::try_from(m).unwrap() > self.current_length)
+        {
+            return Err(Trap::lib(TrapCode::HeapAccessOutOfBounds));
+        }
+
+        // The bounds are checked above.
+        Ok(unsafe { self.base.add(usize::try_from(addr).unwrap()) })
+    }
 }
 
 #[cfg(test)]
@@ -809,6 +838,11 @@ impl VMSharedSignatureIndex {
     pub fn new(value: u32) -> Self {
         Self(value)
     }
+
+    /// Returns the raw value of the index.
+    pub(crate) fn as_u32(self) -> u32 {
+        self.0
+    }
 }
 
 impl Default for VMSharedSignatureIndex {
@@ -948,6 +982,37 @@ impl VMBuiltinFunctionsArray {
             wasmer_vm_externref_inc as usize;
         ptrs[VMBuiltinFunctionIndex::get_externref_dec_index().index() as usize] =
             wasmer_vm_externref_dec as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory_atomic_wait32_index().index() as usize] =
+            wasmer_vm_memory32_atomic_wait32 as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory_atomic_wait32_index().index() as usize] =
+            wasmer_vm_imported_memory32_atomic_wait32 as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory_atomic_wait64_index().index() as usize] =
+            wasmer_vm_memory32_atomic_wait64 as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory_atomic_wait64_index().index() as usize] =
+            wasmer_vm_imported_memory32_atomic_wait64 as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory_atomic_notify_index().index() as usize] =
+            wasmer_vm_memory32_atomic_notify as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory_atomic_notify_index().index() as usize] =
+            wasmer_vm_imported_memory32_atomic_notify as usize;
+
+        ptrs[VMBuiltinFunctionIndex::get_memory64_grow_index().index() as usize] =
+            wasmer_vm_memory64_grow as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory64_grow_index().index() as usize] =
+            wasmer_vm_imported_memory64_grow as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory64_size_index().index() as usize] =
+            wasmer_vm_memory64_size as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory64_size_index().index() as usize] =
+            wasmer_vm_imported_memory64_size as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory64_copy_index().index() as usize] =
+            wasmer_vm_memory64_copy as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory64_copy_index().index() as usize] =
+            wasmer_vm_imported_memory64_copy as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory64_fill_index().index() as usize] =
+            wasmer_vm_memory64_fill as usize;
+        ptrs[VMBuiltinFunctionIndex::get_imported_memory64_fill_index().index() as usize] =
+            wasmer_vm_imported_memory64_fill as usize;
+        ptrs[VMBuiltinFunctionIndex::get_memory64_init_index().index() as usize] =
+            wasmer_vm_memory64_init as usize;
 
         debug_assert!(ptrs.iter().cloned().all(|p| p != 0));
 
@@ -0,0 +1,87 @@
+use anyhow::Result;
+use wasmer_middlewares::epoch::{is_interrupted, Epoch};
+use wasmer_middlewares::EpochInterruption;
+
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+use std::thread;
+use std::time::Duration;
+use wasmer::*;
+
+/// Increments `epoch` every millisecond until the returned flag is
+/// set.
+fn start_ticker(epoch: Arc<Epoch>) -> (Arc<AtomicBool>, thread::JoinHandle<()>) {
+    let stop = Arc::new(AtomicBool::new(false));
+    let ticker = {
+        let stop = stop.clone();
+        thread::spawn(move || {
+            while !stop.load(Ordering::SeqCst) {
+                thread::sleep(Duration::from_millis(1));
+                epoch.increment();
+            }
+        })
+    };
+
+    (stop, ticker)
+}
+
+#[compiler_test(epoch)]
+fn epoch_interrupts_loop(mut config: crate::Config) -> Result<()> {
+    config.middlewares.push(Arc::new(EpochInterruption::new()));
+    let store = config.store();
+    // The loop doesn't write any state, so the check of the
+    // interruption flag is the only thing that can end it: it must not
+    // be hoisted out of the loop.
+    let wat = r#"(module
+        (func (export "spin")
+           (loop (br 0)))
+)"#;
+    let module = Module::new(&store, wat)?;
+    let instance = Instance::new(&module, &imports! {})?;
+    let spin: NativeFunc<(), ()> = instance.exports.get_native_function("spin")?;
+
+    let epoch = Arc::new(Epoch::new());
+    epoch.set_deadline(&instance, 10);
+    let (stop, ticker) = start_ticker(epoch.clone());
+
+    let result = spin.call();
+    stop.store(true, Ordering::SeqCst);
+    ticker.join().unwrap();
+
+    assert!(result.is_err());
+    assert!(is_interrupted(&instance));
+    Ok(())
+}
+
+#[compiler_test(epoch)]
+fn epoch_middleware_shared_by_modules(mut config: crate::Config) -> Result<()> {
+    config.middlewares.push(Arc::new(EpochInterruption::new()));
+    let store = config.store();
+    let spin = Module::new(&store, r#"(module (func (export "spin") (loop (br 0))))"#)?;
+    let add = Module::new(
+        &store,
+        r#"(module
+        (func (export "add") (param i32 i32) (result i32)
+           (i32.add (local.get 0)
+                    (local.get 1)))
+)"#,
+    )?;
+    let spin = Instance::new(&spin, &imports! {})?;
+    let add = Instance::new(&add, &imports! {})?;
+    let add_fn: NativeFunc<(i32, i32), i32> = add.exports.get_native_function("add")?;
+
+    let epoch = Arc::new(Epoch::new());
+    epoch.set_deadline(&spin, 10);
+    epoch.set_deadline(&add, 1_000_000);
+    let (stop, ticker) = start_ticker(epoch.clone());
+
+    let result = spin.exports.get_native_function::<(), ()>("spin")?.call();
+    stop.store(true, Ordering::SeqCst);
+    ticker.join().unwrap();
+
+    assert!(result.is_err());
+    assert!(is_interrupted(&spin));
+    assert!(!is_interrupted(&add));
+    assert_eq!(add_fn.call(4, 6)?, 10);
+    Ok(())
+}
@@ -0,0 +1,131 @@
+use anyhow::Result;
+use std::collections::HashMap;
+use std::panic::{self, AssertUnwindSafe};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use wasmer::*;
+
+#[derive(Debug, Default)]
+struct MemoryCache {
+    functions: Mutex<HashMap<FunctionCacheKey, Vec<u8>>>,
+    hits: AtomicUsize,
+}
+
+// The functions are only ever stored by the compilers.
+unsafe impl FunctionCache for MemoryCache {
+    fn load(&self, key: &FunctionCacheKey) -> Option<Vec<u8>> {
+        let bytes = self.functions.lock().unwrap().get(key).cloned();
+        if bytes.is_some() {
+            self.hits.fetch_add(1, Ordering::SeqCst);
+        }
+        bytes
+    }
+
+    fn store(&self, key: &FunctionCacheKey, bytes: &[u8]) {
+        self.functions.lock().unwrap().insert(*key, bytes.to_vec());
+    }
+}
+
+/// A store with an engine of its own, as in another process, which
+/// compiles with `cache`.
+fn store_with_cache(config: &crate::Config, cache: &Arc<MemoryCache>) -> Store {
+    let mut compiler_config = config.compiler_config(config.canonicalize_nans);
+    compiler_config.function_cache(cache.clone());
+    let engine = config.engine(compiler_config);
+    Store::new(&*engine)
+}
+
+/// Prepends a custom section to `wasm`, which moves its functions
+/// without changing them.
+fn with_padding(wasm: &[u8]) -> Vec<u8> {
+    let mut padded = wasm[..8].to_vec();
+    padded.extend_from_slice(&[0, 4, 3, b'p', b'a', b'd']);
+    padded.extend_from_slice(&wasm[8..]);
+    padded
+}
+
+#[cfg_attr(target_env = "musl", ignore)]
+#[compiler_test(function_cache)]
+fn cached_functions_trap(config: crate::Config) -> Result<()> {
+    if config.engine != crate::Engine::Universal {
+        return Ok(());
+    }
+    let wasm = wat2wasm(
+        br#"
+        (module $hello_mod
+            (func (export "run") (call $hello))
+            (func $hello (unreachable))
+        )
+    "#,
+    )?;
+    let cache = Arc::new(MemoryCache::default());
+    let trace = |wasm: &[u8]| -> Result<Vec<FrameInfo>> {
+        let store = store_with_cache(&config, &cache);
+        let module = Module::new(&store, wasm)?;
+        let instance = Instance::new(&module, &imports! {})?;
+        let run = instance.exports.get_function("run")?;
+        let error = run.call(&[]).err().expect("error calling function");
+        assert!(
+            error.message().contains("unreachable"),
+            "wrong message: {}",
+            error.message()
+        );
+        Ok(error.trace().to_vec())
+    };
+
+    let compiled = trace(&wasm[..])?;
+    assert_eq!(cache.hits.load(Ordering::SeqCst), 0);
+    let cached = trace(&with_padding(&wasm))?;
+    assert_eq!(cache.hits.load(Ordering::SeqCst), 2);
+
+    assert_eq!(cached.len(), 2);
+    assert_eq!(cached[0].function_name(), Some("hello"));
+    for (compiled, cached) in compiled.iter().zip(cached.iter()) {
+        assert_eq!(cached.module_name(), compiled.module_name());
+        assert_eq!(cached.func_index(), compiled.func_index());
+        assert_eq!(cached.func_offset(), compiled.func_offset());
+        assert_eq!(cached.module_offset(), compiled.module_offset() + 6);
+    }
+    Ok(())
+}
+
+#[compiler_test(function_cache)]
+fn cached_functions_unwind(config: crate::Config) -> Result<()> {
+    if config.engine != crate::Engine::Universal {
+        return Ok(());
+    }
+    // The panic unwinds through both functions, with the `.eh_frame`
+    // entries stored along with them.
+    let wasm = wat2wasm(
+        br#"
+        (module
+            (import "" "foo" (func $foo))
+            (func $call_foo (call $foo))
+            (func (export "run") (call $call_foo))
+        )
+    "#,
+    )?;
+    let cache = Arc::new(MemoryCache::default());
+    for hits in [0, 2] {
+        let store = store_with_cache(&config, &cache);
+        let module = Module::new(&store, &wasm)?;
+        assert_eq!(cache.hits.load(Ordering::SeqCst), hits);
+        let sig = FunctionType::new(vec![], vec![]);
+        let foo = Function::new(&store, &sig, |_| panic!("this is a panic"));
+        let instance = Instance::new(
+            &module,
+            &imports! {
+                "" => {
+                    "foo" => foo,
+                }
+            },
+        )?;
+        let run = instance.exports.get_function("run")?.clone();
+        let err = panic::catch_unwind(AssertUnwindSafe(|| {
+            drop(run.call(&[]));
+        }))
+        .unwrap_err();
+        assert_eq!(err.downcast_ref::<&'static str>(), Some(&"this is a panic"));
+    }
+    Ok(())
+}
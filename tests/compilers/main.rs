@@ -7,6 +7,8 @@ extern crate compiler_test_derive;
 
 mod config;
 mod deterministic;
+mod epoch;
+mod function_cache;
 mod imports;
 mod issues;
 mod metering;
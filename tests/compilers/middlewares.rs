@@ -205,3 +205,59 @@ fn middleware_chain_order_2(mut config: crate::Config) -> Result<()> {
     assert_eq!(result, 48);
     Ok(())
 }
+
+#[cfg(feature = "universal")]
+#[compiler_test(middlewares)]
+fn middleware_tier_up(mut config: crate::Config) -> Result<()> {
+    if config.engine != crate::Engine::Universal {
+        return Ok(());
+    }
+    // The optimizing tier applies a middleware the first tier doesn't,
+    // which tells apart the code of each tier.
+    let compiler_config = config.compiler_config(config.canonicalize_nans);
+    config.set_middlewares(vec![
+        Arc::new(Add2MulGen { value_off: 0 }) as Arc<dyn ModuleMiddleware>
+    ]);
+    let optimizing_config = config.compiler_config(config.canonicalize_nans);
+    let engine = wasmer_engine_universal::Universal::new(compiler_config)
+        .tier_up(optimizing_config, 5)
+        .engine();
+    let store = Store::new(&engine);
+    // The name section is left out of what is recompiled.
+    let wat = r#"(module
+        (func $add (export "add") (param i32 i32) (result i32)
+           (i32.add (local.get 0)
+                    (local.get 1)))
+        (func $cold_add (export "cold_add") (param i32 i32) (result i32)
+           (i32.add (local.get 0)
+                    (local.get 1)))
+        (func $call_add (export "call_add") (param i32 i32) (result i32)
+           (call $add (local.get 0)
+                      (local.get 1)))
+)"#;
+    let module = Module::new(&store, wat).unwrap();
+
+    let import_object = imports! {};
+    let instance = Instance::new(&module, &import_object)?;
+    let add: NativeFunc<(i32, i32), i32> = instance.exports.get_native_function("add")?;
+    let cold_add: NativeFunc<(i32, i32), i32> = instance.exports.get_native_function("cold_add")?;
+    let call_add: NativeFunc<(i32, i32), i32> = instance.exports.get_native_function("call_add")?;
+
+    // `add` gets hot, the other functions are only called once.
+    for _ in 0..5 {
+        assert_eq!(add.call(4, 6)?, 10);
+    }
+    engine.wait_for_tier_up();
+
+    // The running instance switches to the optimized code of `add`, which
+    // the first tier code of `call_add` calls too.
+    assert_eq!(add.call(4, 6)?, 24);
+    assert_eq!(call_add.call(4, 6)?, 24);
+    assert_eq!(cold_add.call(4, 6)?, 10);
+
+    // So do the instances created since.
+    let instance = Instance::new(&module, &import_object)?;
+    let add: NativeFunc<(i32, i32), i32> = instance.exports.get_native_function("add")?;
+    assert_eq!(add.call(4, 6)?, 24);
+    Ok(())
+}
@@ -74,3 +74,78 @@ fn test_deserialize(config: crate::Config) -> Result<()> {
     assert_eq!(result.to_vec(), vec![Value::I64(1500)]);
     Ok(())
 }
+
+#[compiler_test(serialize)]
+fn test_deserialize_from_file_mmap(config: crate::Config) -> Result<()> {
+    let store = config.store();
+    let wat = r#"
+        (module $name
+            (import "host" "add_one" (func $add_one (param i32) (result i32)))
+            (func (export "test_call") (param i32) (result i32)
+                (call $add_one (i32.mul (local.get 0) (i32.const 2)))
+            )
+        )
+    "#;
+
+    let module = Module::new(&store, wat)?;
+    let serialized_bytes = module.serialize()?;
+    let file = tempfile::NamedTempFile::new()?;
+    module.serialize_to_file(file.path())?;
+
+    let headless_store = config.headless_store();
+    let deserialized_module =
+        unsafe { Module::deserialize_from_file_mmap(&headless_store, file.path())? };
+    assert_eq!(deserialized_module.name(), Some("name"));
+    assert_eq!(deserialized_module.serialize()?, serialized_bytes);
+
+    let instance = Instance::new(
+        &deserialized_module,
+        &imports! {
+            "host" => {
+                "add_one" => Function::new_native(&headless_store, |x: i32| x + 1)
+            }
+        },
+    )?;
+
+    let test_call = instance.exports.get_native_function::<i32, i32>("test_call")?;
+    assert_eq!(test_call.call(20)?, 41);
+    Ok(())
+}
+
+#[compiler_test(serialize)]
+fn test_deserialize_previous_abi_version(config: crate::Config) -> Result<()> {
+    // Only the Universal engine keeps the metadata header as is in the
+    // serialized bytes.
+    if !matches!(config.engine, crate::Engine::Universal) {
+        return Ok(());
+    }
+
+    let store = config.store();
+    let wat = r#"
+        (module
+            (memory 1)
+            (func (export "grow") (result i32)
+                (memory.grow (i32.const 1))
+            )
+        )
+    "#;
+
+    let module = Module::new(&store, wat)?;
+    let mut serialized_bytes = module.serialize()?;
+
+    // Artifacts serialized before the libcalls and the builtin functions
+    // were renumbered have version 1.
+    let header = serialized_bytes
+        .windows(8)
+        .position(|window| window == b"WASMER\0\0")
+        .expect("the metadata header is missing");
+    serialized_bytes[header + 8..header + 12].copy_from_slice(&1u32.to_ne_bytes());
+
+    let headless_store = config.headless_store();
+    match unsafe { Module::deserialize(&headless_store, &serialized_bytes) } {
+        Err(DeserializeError::Incompatible(_)) => {}
+        Err(error) => panic!("unexpected error: {}", error),
+        Ok(_) => panic!("an artifact of a previous ABI version was deserialized"),
+    }
+    Ok(())
+}
@@ -73,6 +73,46 @@ fn test_trap_trace(config: crate::Config) -> Result<()> {
     Ok(())
 }
 
+#[cfg_attr(target_env = "musl", ignore)]
+#[compiler_test(traps)]
+fn test_trap_trace_capture(config: crate::Config) -> Result<()> {
+    let store = config.store();
+    let wat = r#"
+        (module $hello_mod
+            (func (export "run") (call $hello))
+            (func $hello (unreachable))
+        )
+    "#;
+
+    let module = Module::new(&store, wat)?;
+    let instance = Instance::new(&module, &imports! {})?;
+    let run_func = instance
+        .exports
+        .get_function("run")
+        .expect("expected function export")
+        .clone();
+
+    store.set_capture_backtraces(false);
+    let e = run_func.call(&[]).err().expect("error calling function");
+    assert!(e.trace().is_empty());
+    assert!(
+        e.message().contains("unreachable"),
+        "wrong message: {}",
+        e.message()
+    );
+
+    // The trace is symbolicated on demand, even once the module is gone.
+    store.set_capture_backtraces(true);
+    let e = run_func.call(&[]).err().expect("error calling function");
+    drop(run_func);
+    drop(instance);
+    drop(module);
+    assert_eq!(e.trace().len(), 2);
+    assert_eq!(e.trace()[0].function_name(), Some("hello"));
+
+    Ok(())
+}
+
 #[compiler_test(traps)]
 fn test_trap_trace_cb(config: crate::Config) -> Result<()> {
     let store = config.store();
@@ -469,3 +509,56 @@ fn present_after_module_drop(config: crate::Config) -> Result<()> {
         // assert_eq!(t.trace()[0].func_index(), 0);
     }
 }
+
+#[compiler_test(traps)]
+fn memory64_out_of_bounds(mut config: crate::Config) -> Result<()> {
+    let mut features = Features::new();
+    features.memory64(true);
+    config.set_features(features);
+    let store = config.store();
+
+    // The memory with a maximum is static, the other one is dynamic.
+    for memory in &["(memory i64 1 2)", "(memory i64 1)"] {
+        let wat = format!(
+            r#"(module
+  {}
+  (func (export "store") (param i64 i32)
+    (i32.store (local.get 0) (local.get 1)))
+  (func (export "load") (param i64) (result i32)
+    (i32.load (local.get 0)))
+  (func (export "load_far") (param i64) (result i32)
+    (i32.load offset=0x100000000 (local.get 0)))
+  (func (export "grow") (param i64) (result i64)
+    (memory.grow (local.get 0)))
+  (func (export "size") (result i64)
+    (memory.size)))"#,
+            memory
+        );
+        let module = Module::new(&store, wat)?;
+        let instance = Instance::new(&module, &imports! {})?;
+        let store_fn: NativeFunc<(i64, i32), ()> = instance.exports.get_native_function("store")?;
+        let load: NativeFunc<i64, i32> = instance.exports.get_native_function("load")?;
+        let load_far: NativeFunc<i64, i32> = instance.exports.get_native_function("load_far")?;
+        let grow: NativeFunc<i64, i64> = instance.exports.get_native_function("grow")?;
+        let size: NativeFunc<(), i64> = instance.exports.get_native_function("size")?;
+
+        store_fn.call(65532, 42)?;
+        assert_eq!(load.call(65532)?, 42);
+        // The addresses past the first page, including the ones that
+        // wrap around when the size of the value is added.
+        for &address in &[65533, 65536, 1 << 32, 1 << 40, -4, -1] {
+            let error = load.call(address).unwrap_err();
+            assert_eq!(error.message(), "out of bounds memory access");
+        }
+        for &address in &[0, -1] {
+            let error = load_far.call(address).unwrap_err();
+            assert_eq!(error.message(), "out of bounds memory access");
+        }
+
+        assert_eq!(grow.call(1)?, 1);
+        assert_eq!(size.call()?, 2);
+        assert_eq!(load.call(65536)?, 0);
+        assert!(load.call(131072).is_err());
+    }
+    Ok(())
+}